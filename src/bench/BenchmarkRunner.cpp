@@ -0,0 +1,159 @@
+#include "BenchmarkRunner.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QSysInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QThread>
+
+#include "MathUtils.h"
+
+namespace {
+
+// Benchmarks that are paused most of the time stop after this multiple of
+// the minimum time, measured on the wall clock
+const int MAX_WALL_FACTOR = 20;
+
+double cpuNsSince(std::clock_t start)
+{
+    return (std::clock() - start) * (1e9 / CLOCKS_PER_SEC);
+}
+
+} // namespace
+
+void BenchmarkState::begin(qint64 iteration)
+{
+    m_iteration = iteration;
+    m_running = false;
+    resumeTiming();
+}
+
+void BenchmarkState::end()
+{
+    pauseTiming();
+}
+
+void BenchmarkState::pauseTiming()
+{
+    if (m_running) {
+        m_realNs += m_clock.nsecsElapsed() - m_realStart;
+        m_cpuNs += cpuNsSince(m_cpuStart);
+        m_running = false;
+    }
+}
+
+void BenchmarkState::resumeTiming()
+{
+    if (!m_running) {
+        m_realStart = m_clock.nsecsElapsed();
+        m_cpuStart = std::clock();
+        m_running = true;
+    }
+}
+
+void BenchmarkRunner::add(const QString& name, Function function)
+{
+    m_entries.append({name, std::move(function)});
+}
+
+int BenchmarkRunner::run()
+{
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4\n")
+               .arg("Benchmark", -40).arg("Time (us)", 14).arg("CPU (us)", 14).arg("Iterations", 12);
+    out << QString(83, '-') << "\n";
+    out.flush();
+
+    int count = 0;
+    for (const Entry& entry : m_entries) {
+        if (m_filter.isValid() && !m_filter.pattern().isEmpty() && !m_filter.match(entry.name).hasMatch()) {
+            continue;
+        }
+        const Result result = runOne(entry);
+        m_results.append(result);
+        ++count;
+
+        out << QString("%1 %2 %3 %4\n")
+                   .arg(result.name, -40)
+                   .arg(result.realTimeUs, 14, 'f', 3)
+                   .arg(result.cpuTimeUs, 14, 'f', 3)
+                   .arg(result.iterations, 12);
+        out.flush();
+    }
+    return count;
+}
+
+BenchmarkRunner::Result BenchmarkRunner::runOne(const Entry& entry) const
+{
+    // The first call warms caches and lazy initialization and is not counted
+    BenchmarkState warmup;
+    warmup.m_clock.start();
+    warmup.begin(0);
+    entry.function(warmup);
+    warmup.end();
+
+    BenchmarkState state;
+    state.m_clock.start();
+    QElapsedTimer wall;
+    wall.start();
+
+    qint64 iterations = 0;
+    while (state.m_realNs < m_minTimeNs && wall.nsecsElapsed() < m_minTimeNs * MAX_WALL_FACTOR) {
+        state.begin(iterations);
+        entry.function(state);
+        state.end();
+        ++iterations;
+    }
+
+    Result result;
+    result.name = entry.name;
+    result.iterations = iterations;
+    result.realTimeUs = state.m_realNs / 1000.0 / iterations;
+    result.cpuTimeUs = state.m_cpuNs / 1000.0 / iterations;
+    return result;
+}
+
+bool BenchmarkRunner::writeJson(const QString& filePath, QString* error) const
+{
+    QJsonObject context;
+    context["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    context["host_name"] = QSysInfo::machineHostName();
+    context["executable"] = QCoreApplication::applicationFilePath();
+    context["num_cpus"] = QThread::idealThreadCount();
+    context["simd_level"] = MathUtils::kernelLevel();
+#ifdef NDEBUG
+    context["library_build_type"] = "release";
+#else
+    context["library_build_type"] = "debug";
+#endif
+
+    QJsonArray benchmarks;
+    for (const Result& result : m_results) {
+        QJsonObject entry;
+        entry["name"] = result.name;
+        entry["run_name"] = result.name;
+        entry["run_type"] = "iteration";
+        entry["iterations"] = result.iterations;
+        entry["real_time"] = result.realTimeUs;
+        entry["cpu_time"] = result.cpuTimeUs;
+        entry["time_unit"] = "us";
+        benchmarks.append(entry);
+    }
+
+    QJsonObject root;
+    root["context"] = context;
+    root["benchmarks"] = benchmarks;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(root).toJson()) < 0) {
+        if (error) {
+            *error = QString("Cannot write %1: %2").arg(filePath, file.errorString());
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,92 @@
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+#include <ctime>
+#include <functional>
+
+/**
+ * @brief Timing state passed to a running benchmark.
+ *
+ * Work between pauseTiming() and resumeTiming() is excluded, e.g. setting
+ * up a fresh database for every iteration.
+ */
+class BenchmarkState
+{
+public:
+    qint64 iteration() const { return m_iteration; }
+
+    void pauseTiming();
+    void resumeTiming();
+
+private:
+    friend class BenchmarkRunner;
+
+    void begin(qint64 iteration);
+    void end();
+
+    QElapsedTimer m_clock;
+    qint64 m_iteration = 0;
+    qint64 m_realNs = 0;
+    double m_cpuNs = 0.0;
+    qint64 m_realStart = 0;
+    std::clock_t m_cpuStart = 0;
+    bool m_running = false;
+};
+
+/**
+ * @brief Runs registered benchmarks and reports the mean time per iteration.
+ *
+ * Each benchmark is repeated until its timed work adds up to the minimum
+ * time. Results are printed as a table and can be written as JSON in the
+ * Google Benchmark format, so existing tools can compare two runs.
+ */
+class BenchmarkRunner
+{
+public:
+    using Function = std::function<void(BenchmarkState&)>;
+
+    struct Result {
+        QString name;
+        qint64 iterations = 0;
+        double realTimeUs = 0.0;   // Per iteration
+        double cpuTimeUs = 0.0;    // Per iteration, process CPU time
+    };
+
+    void setMinTime(double seconds) { m_minTimeNs = static_cast<qint64>(seconds * 1e9); }
+    void setFilter(const QRegularExpression& filter) { m_filter = filter; }
+
+    void add(const QString& name, Function function);
+
+    /**
+     * @brief Run all benchmarks whose name matches the filter.
+     * @return Number of benchmarks run
+     */
+    int run();
+
+    const QVector<Result>& results() const { return m_results; }
+
+    /**
+     * @brief Write the results as Google Benchmark JSON.
+     * @return true if successful
+     */
+    bool writeJson(const QString& filePath, QString* error = nullptr) const;
+
+private:
+    struct Entry {
+        QString name;
+        Function function;
+    };
+
+    Result runOne(const Entry& entry) const;
+
+    QVector<Entry> m_entries;
+    QVector<Result> m_results;
+    QRegularExpression m_filter;
+    qint64 m_minTimeNs = 500 * 1000 * 1000;
+};
+
+#endif // BENCHMARKRUNNER_H
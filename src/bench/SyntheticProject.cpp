@@ -0,0 +1,312 @@
+#include "SyntheticProject.h"
+#include "MathUtils.h"
+#include "PointCodec.h"
+#include "Project.h"
+#include "ProjectDatabase.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+// A 36x24 in sheet rendered at 150 DPI, drawn at 1/4" = 1'-0"
+const double SHEET_WIDTH = 5400.0;
+const double SHEET_HEIGHT = 3600.0;
+const double PIXELS_PER_INCH = 150.0 / 48.0;
+const double TWO_PI = 6.283185307179586;
+
+const char* const FAMILIES[] = {"W", "HSS", "C", "MC", "L", "WT", "S", "HP"};
+const int FAMILY_COUNT = sizeof(FAMILIES) / sizeof(FAMILIES[0]);
+
+QPointF clampToSheet(const QPointF& point)
+{
+    return QPointF(std::clamp(point.x(), 0.0, SHEET_WIDTH), std::clamp(point.y(), 0.0, SHEET_HEIGHT));
+}
+
+// Stamps a square pen every half pixel from (x1, y1) to (x2, y2)
+void stampStroke(QImage& sheet, double x1, double y1, double x2, double y2, int pen)
+{
+    const double length = std::hypot(x2 - x1, y2 - y1);
+    const int steps = std::max(1, static_cast<int>(length * 2.0));
+    for (int i = 0; i <= steps; ++i) {
+        const double t = static_cast<double>(i) / steps;
+        const int cx = static_cast<int>(x1 + (x2 - x1) * t) - pen / 2;
+        const int cy = static_cast<int>(y1 + (y2 - y1) * t) - pen / 2;
+        for (int y = std::max(0, cy); y < std::min(sheet.height(), cy + pen); ++y) {
+            uchar* row = sheet.scanLine(y);
+            for (int x = std::max(0, cx); x < std::min(sheet.width(), cx + pen); ++x) {
+                row[x] = 0;
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool SyntheticProject::writeShapesCsv(const QString& filePath, int shapeCount, unsigned seed)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        m_lastError = QString("Cannot write %1: %2").arg(filePath, file.errorString());
+        return false;
+    }
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> jitter(0.9, 1.1);
+
+    QTextStream out(&file);
+    out << "Type,AISC_Manual_Label,W,A,d,bf,tw\n";
+    for (int i = 0; i < shapeCount; ++i) {
+        // (depth, weight) pairs never repeat within a family
+        const int k = i / FAMILY_COUNT;
+        const int depth = 4 + 2 * (k % 20);
+        const double weight = 8.0 + 3.5 * (k / 20) + 0.5 * (k % 20);
+        const double area = weight / 3.4 * jitter(random);
+        out << FAMILIES[i % FAMILY_COUNT] << ','
+            << FAMILIES[i % FAMILY_COUNT] << depth << 'X' << QString::number(weight, 'f', 1) << ','
+            << QString::number(weight, 'f', 1) << ','
+            << QString::number(area, 'f', 2) << ','
+            << QString::number(depth * jitter(random), 'f', 2) << ','
+            << QString::number(depth * 0.5 * jitter(random), 'f', 2) << ','
+            << QString::number(0.2 + weight / 400.0, 'f', 3) << '\n';
+    }
+
+    out.flush();
+    if (file.error() != QFileDevice::NoError) {
+        m_lastError = QString("Cannot write %1: %2").arg(filePath, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool SyntheticProject::generate(const QString& filePath, const Options& options)
+{
+    Project project;
+    if (!project.create(filePath)) {
+        m_lastError = project.lastError();
+        return false;
+    }
+    project.setName(QFileInfo(filePath).completeBaseName());
+
+    const QString csvPath = filePath + ".shapes.csv";
+    if (!writeShapesCsv(csvPath, options.shapeCount, options.seed)) {
+        return false;
+    }
+    const int imported = project.importShapesFromCsv(csvPath);
+    QFile::remove(csvPath);
+    if (imported < 0) {
+        m_lastError = project.lastError();
+        return false;
+    }
+    const QVector<ProjectDatabase::Shape> shapes = project.database()->getAllShapes();
+
+    std::mt19937 random(options.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_real_distribution<double> sheetX(0.0, SHEET_WIDTH);
+    std::uniform_real_distribution<double> sheetY(0.0, SHEET_HEIGHT);
+    std::uniform_real_distribution<double> angle(0.0, TWO_PI);
+    std::geometric_distribution<int> extraVertices(1.0 / std::max(1, options.meanVertices - 1));
+    std::uniform_int_distribution<int> countPoints(1, 40);
+
+    Calibration calibration;
+    calibration.calibrate(QPointF(100, 100), QPointF(100 + 120 * PIXELS_PER_INCH, 100), 120.0);
+
+    for (int p = 0; p < options.pages; ++p) {
+        Page page = Page::createPdfPage("synthetic.pdf", p, options.pages);
+        page.setDisplayName(QString("S-%1").arg(100 + p));
+        page.setSourceSize(QSizeF(36 * 72, 24 * 72));
+        page.setCalibration(calibration);
+        project.addPage(page);
+
+        QVector<TakeoffItem> items;
+        items.reserve(options.itemsPerPage);
+        for (int i = 0; i < options.itemsPerPage; ++i) {
+            const double kindRoll = unit(random);
+            QVector<QPointF> points;
+            TakeoffItem::Kind kind;
+            if (kindRoll < options.countFraction) {
+                kind = TakeoffItem::Count;
+                const int count = countPoints(random);
+                for (int c = 0; c < count; ++c) {
+                    points.append(QPointF(sheetX(random), sheetY(random)));
+                }
+            } else if (kindRoll < options.countFraction + options.polylineFraction) {
+                kind = TakeoffItem::Polyline;
+                const int vertices = std::min(options.maxVertices, 2 + extraVertices(random));
+                QPointF point(sheetX(random), sheetY(random));
+                points.append(point);
+                for (int v = 1; v < vertices; ++v) {
+                    const double step = 20.0 + 280.0 * unit(random);
+                    const double direction = angle(random);
+                    point = clampToSheet(point + QPointF(step * std::cos(direction), step * std::sin(direction)));
+                    points.append(point);
+                }
+            } else {
+                kind = TakeoffItem::Line;
+                const QPointF start(sheetX(random), sheetY(random));
+                const double length = 50.0 + 1450.0 * unit(random);
+                const double direction = angle(random);
+                points = {start, clampToSheet(start + QPointF(length * std::cos(direction),
+                                                              length * std::sin(direction)))};
+            }
+
+            const double lengthInches = kind == TakeoffItem::Count
+                ? 0.0 : MathUtils::polylineLength(points) / PIXELS_PER_INCH;
+            TakeoffItem item(kind, points, lengthInches);
+            item.setPageId(page.id());
+            if (kind == TakeoffItem::Count) {
+                item.setQty(points.size());
+            } else if (unit(random) < 0.05) {
+                item.setQty(2 + static_cast<int>(unit(random) * 6));
+            }
+
+            // Skewed towards the start of the catalog, as real jobs reuse a
+            // few common sizes
+            if (!shapes.isEmpty() && unit(random) < options.assignedFraction) {
+                const double u = unit(random);
+                const int shapeCount = static_cast<int>(shapes.size());
+                const int index = std::min(shapeCount - 1, static_cast<int>(shapeCount * u * u * u));
+                item.setShapeId(shapes[index].id);
+                item.setDesignation(shapes[index].designation);
+            }
+            if (unit(random) < 0.1) {
+                item.setNotes(QString("See detail %1/S-%2").arg(1 + i % 9).arg(500 + p % 20));
+            }
+            items.append(item);
+        }
+
+        if (!project.addTakeoffItems(items)) {
+            m_lastError = project.lastError();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SyntheticProject::generateRows(const QString& filePath, int rows)
+{
+    m_lastError.clear();
+    QFile::remove(filePath);
+    {
+        ProjectDatabase schema;
+        if (!schema.create(filePath)) {
+            m_lastError = schema.lastError();
+            return false;
+        }
+        schema.close();
+    }
+
+    const QString connectionName = "SyntheticRows";
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(filePath);
+        if (!db.open()) {
+            m_lastError = db.lastError().text();
+            QSqlDatabase::removeDatabase(connectionName);
+            return false;
+        }
+
+        // Row n of each table refers to row n of the others
+        const QString sequence = QString("WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL "
+                                         "SELECT i + 1 FROM n WHERE i < %1) ").arg(rows);
+        const QStringList statements = {
+            sequence + "INSERT INTO shapes (id, designation, shape_type, w_lb_per_ft) "
+                       "SELECT i, 'W' || i, 'W', 10.0 + i % 300 FROM n",
+            sequence + "INSERT INTO pages (key, id, type, source_path, pdf_page_index, pdf_total_pages, "
+                       "display_name, calibration_ppi, calib_pt1_x, calib_pt1_y, calib_pt2_x, calib_pt2_y, "
+                       "source_width, source_height) "
+                       "SELECT i, printf('{00000000-0000-0000-0000-%012d}', i), 'pdf', 'synthetic.pdf', "
+                       "i - 1, " + QString::number(rows) + ", 'S-' || i, "
+                       "3.125, 100, 100, 475, 100, 2592, 1728 FROM n",
+            sequence + "INSERT INTO takeoff_items (id, page_id, kind, points_blob, length_in, qty, "
+                       "shape_id, designation, notes) "
+                       "SELECT i, i, 'Line', ?, 120.0, 1, i, 'W' || i, NULL FROM n"
+        };
+
+        const QByteArray points = PointCodec::toBlob({QPointF(100, 100), QPointF(475, 100)});
+        db.transaction();
+        QSqlQuery query(db);
+        for (const QString& sql : statements) {
+            query.prepare(sql);
+            if (sql.contains('?')) {
+                query.addBindValue(points);
+            }
+            if (!query.exec()) {
+                m_lastError = query.lastError().text();
+                db.rollback();
+                break;
+            }
+        }
+        if (m_lastError.isEmpty() && !db.commit()) {
+            m_lastError = db.lastError().text();
+        }
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return m_lastError.isEmpty();
+}
+
+QImage SyntheticProject::renderSheet(int width, int height, unsigned seed) const
+{
+    QImage sheet(width, height, QImage::Format_Grayscale8);
+    sheet.fill(255);
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_int_distribution<int> pen(2, 4);
+
+    // Framing grid: a line every 500 px each way, inset from the border
+    const int bay = 500;
+    for (int y = bay; y < height - bay / 2; y += bay) {
+        stampStroke(sheet, bay / 2, y, width - bay / 2, y, pen(random));
+    }
+    for (int x = bay; x < width - bay / 2; x += bay) {
+        stampStroke(sheet, x, bay / 2, x, height - bay / 2, pen(random));
+    }
+
+    // Braces corner to corner across a bay, or along a run of bays
+    const int columns = width / bay - 2;
+    const int rows = height / bay - 2;
+    const int braces = std::max(1, columns * rows / 100);
+    std::uniform_int_distribution<int> column(1, std::max(1, columns));
+    std::uniform_int_distribution<int> row(1, std::max(1, rows));
+    std::uniform_int_distribution<int> span(1, 6);
+    for (int i = 0; i < braces; ++i) {
+        const double x = column(random) * bay;
+        const double y = row(random) * bay;
+        const double dx = span(random) * bay * (unit(random) < 0.5 ? -1.0 : 1.0);
+        const double dy = span(random) * bay;
+        stampStroke(sheet, x, y, std::clamp(x + dx, 0.0, width - 1.0), std::clamp(y + dy, 0.0, height - 1.0),
+                    pen(random));
+    }
+
+    // Labels: clusters of short strokes inside the bays
+    const int labels = width * height / 5000;
+    std::uniform_real_distribution<double> labelX(0.0, width - 120.0);
+    std::uniform_real_distribution<double> labelY(0.0, height - 30.0);
+    for (int i = 0; i < labels; i += 8) {
+        const double x = labelX(random);
+        const double y = labelY(random);
+        for (int c = 0; c < 8; ++c) {
+            const double cx = x + c * 14.0;
+            const double angle = unit(random) * TWO_PI;
+            const double size = 6.0 + unit(random) * 12.0;
+            stampStroke(sheet, cx, y + 12.0, cx + size * std::cos(angle), y + 12.0 + size * std::sin(angle), 2);
+        }
+    }
+    return sheet;
+}
+
+QString SyntheticProject::lastError() const
+{
+    return m_lastError;
+}
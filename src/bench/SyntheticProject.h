@@ -0,0 +1,82 @@
+#ifndef SYNTHETICPROJECT_H
+#define SYNTHETICPROJECT_H
+
+#include <QImage>
+#include <QString>
+
+/**
+ * @brief Writes synthetic projects for benchmarking.
+ *
+ * Reproduces the shape of large client projects (hundreds of sheets, tens
+ * of thousands of items, long polylines, a full AISC catalog) without
+ * sharing their drawings. Output is deterministic for a given seed.
+ *
+ * Shapes are imported through a generated CSV file, pages are calibrated
+ * PDF pages of a 36x24 in sheet, and items are written in one transaction
+ * per page.
+ */
+class SyntheticProject
+{
+public:
+    struct Options {
+        int pages = 300;
+        int itemsPerPage = 67;          // 300 x 67 is about 20k items
+        double polylineFraction = 0.3;  // Share of items that are polylines
+        double countFraction = 0.1;     // Share of items that are symbol counts
+        int meanVertices = 6;           // Polyline vertices, geometrically distributed
+        int maxVertices = 200;
+        int shapeCount = 2000;          // Size of the shape catalog
+        double assignedFraction = 0.85; // Share of items with a shape assigned
+        unsigned seed = 1;
+    };
+
+    /**
+     * @brief Create a project file with the given contents.
+     * @param filePath Path of the .takeoff.db file; replaced if it exists
+     * @param options What to generate
+     * @return true if successful
+     */
+    bool generate(const QString& filePath, const Options& options);
+
+    /**
+     * @brief Create a project file with bulk rows in the main tables.
+     *
+     * Fills pages, takeoff_items and shapes with the same number of rows
+     * directly in SQL, one item and one shape per page. Much faster than
+     * generate() for large row counts, but the contents are not realistic.
+     * @param filePath Path of the .takeoff.db file; replaced if it exists
+     * @param rows Rows per table
+     * @return true if successful
+     */
+    bool generateRows(const QString& filePath, int rows);
+
+    /**
+     * @brief Write an AISC-style shapes CSV.
+     * @param filePath Path of the CSV file
+     * @param shapeCount Number of rows
+     * @param seed Random seed
+     * @return true if successful
+     */
+    bool writeShapesCsv(const QString& filePath, int shapeCount, unsigned seed);
+
+    /**
+     * @brief Draw a scanned-looking framing plan as a grayscale sheet.
+     *
+     * Black strokes on white: a grid of horizontal and vertical framing
+     * lines, diagonal braces at assorted angles and short text-like
+     * strokes between them. Strokes are stamped pixel by pixel so the
+     * sheet does not depend on font or antialiasing settings.
+     * @param width Sheet width in pixels
+     * @param height Sheet height in pixels
+     * @param seed Random seed
+     * @return Format_Grayscale8 image
+     */
+    QImage renderSheet(int width, int height, unsigned seed) const;
+
+    QString lastError() const;
+
+private:
+    QString m_lastError;
+};
+
+#endif // SYNTHETICPROJECT_H
@@ -0,0 +1,289 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <cmath>
+#include <memory>
+
+#include "BenchmarkRunner.h"
+#include "LineDetector.h"
+#include "SyntheticProject.h"
+#include "MathUtils.h"
+#include "PointCodec.h"
+#include "Project.h"
+#include "ProjectDatabase.h"
+#include "QuoteCalculator.h"
+#include "Trace.h"
+
+namespace {
+
+QVector<QPointF> makePolyline(int count)
+{
+    QVector<QPointF> points;
+    points.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        points.append(QPointF(i * 3.0, 100.0 + 40.0 * std::sin(i * 0.1)));
+    }
+    return points;
+}
+
+// Keeps results alive so the compiler cannot drop the measured work
+volatile double g_sink = 0.0;
+
+void registerBenchmarks(BenchmarkRunner& runner, const QString& projectPath,
+                        const QString& scratchPath, const QString& workDir)
+{
+    // Geometry kernels
+    const QVector<QPointF> polyline = makePolyline(10000);
+    runner.add("MathUtils/PolylineLength/10k", [polyline](BenchmarkState&) {
+        g_sink = g_sink + MathUtils::polylineLength(polyline);
+    });
+    runner.add("MathUtils/BoundingRect/10k", [polyline](BenchmarkState&) {
+        g_sink = g_sink + MathUtils::boundingRect(polyline).width();
+    });
+    runner.add("MathUtils/DistanceToPolyline/10k", [polyline](BenchmarkState&) {
+        g_sink = g_sink + MathUtils::distanceToPolyline(QPointF(15000.0, 90.0), polyline);
+    });
+    const QVector<double> pixels(10000, 150.0);
+    runner.add("MathUtils/PixelsToInches/10k", [pixels, inches = QVector<double>(10000)](BenchmarkState&) mutable {
+        MathUtils::pixelsToInches(pixels.constData(), inches.data(), pixels.size(), 150.0);
+        g_sink = g_sink + inches[0];
+    });
+    const QByteArray blob = PointCodec::toBlob(polyline);
+    runner.add("PointCodec/FromBlob/10k", [blob](BenchmarkState&) {
+        g_sink = g_sink + PointCodec::fromBlob(blob).size();
+    });
+
+    // Read paths, on the unmodified project
+    runner.add("Project/Open", [projectPath](BenchmarkState&) {
+        Project project;
+        project.open(projectPath);
+        g_sink = g_sink + project.takeoffItems().size();
+    });
+
+    auto project = std::make_shared<Project>();
+    project->open(projectPath);
+    QStringList pageIds;
+    for (const Page& page : project->pages()) {
+        pageIds.append(page.id());
+    }
+    if (pageIds.isEmpty()) {
+        pageIds.append(QString());
+    }
+
+    runner.add("Project/PageSwitch", [project, pageIds](BenchmarkState& state) {
+        const QString& pageId = pageIds[state.iteration() % pageIds.size()];
+        g_sink = g_sink + project->takeoffItemsForPage(pageId).size();
+    });
+    runner.add("Project/MeasureItemLengths", [project, pageIds](BenchmarkState& state) {
+        const QString& pageId = pageIds[state.iteration() % pageIds.size()];
+        g_sink = g_sink + project->measureItemLengths(pageId, 150.0).itemIds.size();
+    });
+    runner.add("ProjectDatabase/PageItems", [project, pageIds](BenchmarkState& state) {
+        const QString& pageId = pageIds[state.iteration() % pageIds.size()];
+        g_sink = g_sink + project->database()->getTakeoffItemsForPage(pageId).size();
+    });
+    runner.add("Quote/Refresh/AllPages", [project](BenchmarkState&) {
+        g_sink = g_sink + QuoteCalculator::calculate(*project, 0.5).totalCost;
+    });
+    runner.add("Quote/Refresh/CurrentPage", [project, pageIds](BenchmarkState& state) {
+        const QString& pageId = pageIds[state.iteration() % pageIds.size()];
+        g_sink = g_sink + QuoteCalculator::calculate(*project, 0.5, pageId).totalCost;
+    });
+
+    const QStringList queries = {"W1", "HSS", "C1", "L4", "W", "MC12", "X2"};
+    runner.add("Shapes/Search", [project, queries](BenchmarkState& state) {
+        const QString& text = queries[state.iteration() % queries.size()];
+        g_sink = g_sink + project->searchShapes(text).size();
+    });
+
+    // Full-table reads of 100k rows each, where decoding rows through the
+    // row mappers is most of the work
+    SyntheticProject generator;
+    const QString rowsPath = workDir + "/rows" + Project::FILE_EXTENSION;
+    auto rows = std::make_shared<ProjectDatabase>();
+    if (generator.generateRows(rowsPath, 100000) && rows->open(rowsPath)) {
+        runner.add("Mapper/Pages/100k", [rows](BenchmarkState&) {
+            g_sink = g_sink + rows->getAllPages().size();
+        });
+        runner.add("Mapper/TakeoffItems/100k", [rows](BenchmarkState&) {
+            g_sink = g_sink + rows->getAllTakeoffItems().size();
+        });
+        runner.add("Mapper/Shapes/100k", [rows](BenchmarkState&) {
+            g_sink = g_sink + rows->getAllShapes().size();
+        });
+    } else {
+        QTextStream(stderr) << "Skipping mapper benchmarks: " << generator.lastError()
+                            << rows->lastError() << "\n";
+    }
+
+    // Line detection on a 20k pixel sheet (E size at 400 dpi) through the
+    // global thread pool; the sheet is drawn on the first iteration so
+    // filtering it out costs nothing
+    auto sheet = std::make_shared<QImage>();
+    runner.add("LineDetector/Detect/20k", [sheet](BenchmarkState& state) {
+        if (sheet->isNull()) {
+            state.pauseTiming();
+            *sheet = SyntheticProject().renderSheet(20000, 14000, 1);
+            state.resumeTiming();
+        }
+        g_sink = g_sink + LineDetector::detect(*sheet, LineDetector::Options()).size();
+    });
+
+    // Catalog import into a fresh project each time
+    const QString csvPath = workDir + "/shapes.csv";
+    generator.writeShapesCsv(csvPath, 2000, 1);
+    const QString importPath = workDir + "/import" + Project::FILE_EXTENSION;
+    runner.add("Shapes/ImportCsv/2k", [csvPath, importPath](BenchmarkState& state) {
+        state.pauseTiming();
+        Project target;
+        target.create(importPath);
+        state.resumeTiming();
+        g_sink = g_sink + target.importShapesFromCsv(csvPath);
+        state.pauseTiming();
+        target.close();
+    });
+
+    // Write paths, on a copy so the source project stays as generated
+    auto scratch = std::make_shared<Project>();
+    scratch->open(scratchPath);
+    const QString scratchPage = pageIds.first();
+
+    runner.add("Items/Insert", [scratch, scratchPage](BenchmarkState& state) {
+        const double y = 10.0 + state.iteration() % 3000;
+        TakeoffItem item(TakeoffItem::Line, {QPointF(10, y), QPointF(600, y)}, 189.0);
+        item.setPageId(scratchPage);
+        g_sink = g_sink + scratch->addTakeoffItem(item);
+    });
+    runner.add("Items/Update", [scratch](BenchmarkState& state) {
+        const TakeoffItemStore& items = scratch->takeoffItems();
+        if (items.isEmpty()) {
+            return;
+        }
+        TakeoffItem item = items.item(state.iteration() % items.size());
+        item.setQty(1 + state.iteration() % 4);
+        scratch->updateTakeoffItem(item);
+    });
+
+    // The data side of undoing and redoing an item deletion: the item is
+    // removed, then stored again as the redo/undo commands do
+    runner.add("Items/UndoRedoDelete", [scratch](BenchmarkState& state) {
+        const TakeoffItemStore& items = scratch->takeoffItems();
+        if (items.isEmpty()) {
+            return;
+        }
+        TakeoffItem item = items.item(state.iteration() % items.size());
+        scratch->removeTakeoffItem(item.id());
+        scratch->addTakeoffItem(item);
+    });
+}
+
+} // namespace
+
+/**
+ * @brief Benchmark suite for takeoff_core.
+ *
+ * Without --project a synthetic project is generated into a temporary
+ * directory first. With --generate only the project is written. Results
+ * are printed as a table; --benchmark_out also writes them as Google
+ * Benchmark JSON for tracking regressions between builds.
+ */
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("takeoff_bench");
+
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks for project loading, quoting, shapes and item edits.");
+    parser.addHelpOption();
+
+    QCommandLineOption generateOption("generate", "Only write a synthetic project to <path>.", "path");
+    QCommandLineOption projectOption("project", "Benchmark an existing project instead of a synthetic one.", "path");
+    QCommandLineOption pagesOption("pages", "Synthetic pages.", "n", "300");
+    QCommandLineOption itemsOption("items-per-page", "Synthetic items per page.", "n", "67");
+    QCommandLineOption verticesOption("mean-vertices", "Mean polyline vertex count.", "n", "6");
+    QCommandLineOption polylinesOption("polyline-fraction", "Share of items that are polylines.", "f", "0.3");
+    QCommandLineOption shapesOption("shapes", "Synthetic shape catalog size.", "n", "2000");
+    QCommandLineOption seedOption("seed", "Random seed.", "n", "1");
+    QCommandLineOption filterOption("benchmark_filter", "Only run benchmarks matching <regex>.", "regex");
+    QCommandLineOption outOption("benchmark_out", "Write results as JSON to <path>.", "path");
+    QCommandLineOption minTimeOption("benchmark_min_time", "Minimum timed seconds per benchmark.", "s", "0.5");
+    QCommandLineOption traceOption("trace", "Write a Chrome trace of the run to <path> "
+                                   "(needs TAKEOFF_ENABLE_TRACING).", "path");
+    parser.addOptions({generateOption, projectOption, pagesOption, itemsOption, verticesOption,
+                       polylinesOption, shapesOption, seedOption, filterOption, outOption, minTimeOption,
+                       traceOption});
+    parser.process(app);
+
+    SyntheticProject::Options options;
+    options.pages = parser.value(pagesOption).toInt();
+    options.itemsPerPage = parser.value(itemsOption).toInt();
+    options.meanVertices = parser.value(verticesOption).toInt();
+    options.polylineFraction = parser.value(polylinesOption).toDouble();
+    options.shapeCount = parser.value(shapesOption).toInt();
+    options.seed = parser.value(seedOption).toUInt();
+
+    SyntheticProject generator;
+    if (parser.isSet(generateOption)) {
+        if (!generator.generate(parser.value(generateOption), options)) {
+            err << "Cannot generate project: " << generator.lastError() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid()) {
+        err << "Cannot create a temporary directory\n";
+        return 1;
+    }
+
+    QString projectPath = parser.value(projectOption);
+    if (projectPath.isEmpty()) {
+        projectPath = workDir.filePath("synthetic" + Project::FILE_EXTENSION);
+        QTextStream(stdout) << QString("Generating %1 pages x %2 items...\n")
+                                   .arg(options.pages).arg(options.itemsPerPage) << Qt::flush;
+        if (!generator.generate(projectPath, options)) {
+            err << "Cannot generate project: " << generator.lastError() << "\n";
+            return 1;
+        }
+    }
+
+    const QString scratchPath = workDir.filePath("scratch" + Project::FILE_EXTENSION);
+    if (!QFile::copy(projectPath, scratchPath)) {
+        err << "Cannot copy " << projectPath << " to " << scratchPath << "\n";
+        return 1;
+    }
+
+    BenchmarkRunner runner;
+    runner.setMinTime(parser.value(minTimeOption).toDouble());
+    if (parser.isSet(filterOption)) {
+        runner.setFilter(QRegularExpression(parser.value(filterOption)));
+    }
+    registerBenchmarks(runner, projectPath, scratchPath, workDir.path());
+    Trace::setEnabled(parser.isSet(traceOption));
+    runner.run();
+    Trace::setEnabled(false);
+
+    if (parser.isSet(traceOption)) {
+        QString error;
+        if (!Trace::isCompiledIn()) {
+            err << "Tracing is not compiled in; rebuild with TAKEOFF_ENABLE_TRACING=ON\n";
+        } else if (!Trace::writeChromeJson(parser.value(traceOption), &error)) {
+            err << error << "\n";
+            return 1;
+        }
+    }
+
+    if (parser.isSet(outOption)) {
+        QString error;
+        if (!runner.writeJson(parser.value(outOption), &error)) {
+            err << error << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
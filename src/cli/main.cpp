@@ -0,0 +1,251 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+#include "Project.h"
+#include "QuoteCalculator.h"
+#include "ParallelFor.h"
+#include "SchemaMigrator.h"
+
+namespace {
+
+enum class OutputFormat {
+    Csv,
+    Xlsx
+};
+
+struct BatchOptions {
+    double pricePerLb = -1.0;   // Negative keeps each project's saved rate
+    QString outputDir;          // Empty writes next to each project
+    OutputFormat format = OutputFormat::Csv;
+    bool migrate = false;       // Upgrade older project files in place
+};
+
+struct BatchResult {
+    QString projectPath;
+    QString outputPath;
+    QString error;
+    bool ok = false;
+    int itemCount = 0;
+    QuoteCalculator::Quote quote;
+    qint64 elapsedMs = 0;
+};
+
+// Expands directories to the project files directly inside them
+QStringList collectProjects(const QStringList& arguments, QTextStream& err)
+{
+    QStringList projects;
+    for (const QString& argument : arguments) {
+        QFileInfo info(argument);
+        if (info.isDir()) {
+            QDir dir(argument);
+            const QStringList names = dir.entryList({"*" + Project::FILE_EXTENSION},
+                                                    QDir::Files, QDir::Name);
+            for (const QString& name : names) {
+                projects.append(dir.filePath(name));
+            }
+        } else if (info.isFile()) {
+            projects.append(info.filePath());
+        } else {
+            err << "Skipping " << argument << ": no such file or directory\n";
+        }
+    }
+    return projects;
+}
+
+QString outputPathFor(const QString& projectPath, const BatchOptions& options)
+{
+    QFileInfo info(projectPath);
+    QString baseName = info.fileName();
+    if (baseName.endsWith(Project::FILE_EXTENSION, Qt::CaseInsensitive)) {
+        baseName.chop(Project::FILE_EXTENSION.size());
+    } else {
+        baseName = info.completeBaseName();
+    }
+
+    const QString suffix = options.format == OutputFormat::Xlsx ? ".quote.xlsx" : ".quote.csv";
+    const QDir dir(options.outputDir.isEmpty() ? info.absolutePath() : options.outputDir);
+    return dir.filePath(baseName + suffix);
+}
+
+// Runs on a pool thread; the project's database connection stays on it
+BatchResult processProject(const QString& projectPath, const BatchOptions& options)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    BatchResult result;
+    result.projectPath = projectPath;
+    result.outputPath = outputPathFor(projectPath, options);
+
+    // Opening a project upgrades its schema in place, which an export
+    // should not do behind the user's back
+    QString error;
+    const int version = ProjectDatabase::fileSchemaVersion(projectPath, &error);
+    if (version < 0) {
+        result.error = error;
+        return result;
+    }
+    if (version > SchemaMigrator::latestVersion()) {
+        result.error = QString("Project uses schema version %1, but this build only supports up to %2")
+                           .arg(version).arg(SchemaMigrator::latestVersion());
+        return result;
+    }
+    if (version < SchemaMigrator::latestVersion() && !options.migrate) {
+        result.error = QString("Project uses schema version %1 and must be upgraded to %2; "
+                               "rerun with --migrate or open it in BlueprintTakeoff")
+                           .arg(version).arg(SchemaMigrator::latestVersion());
+        return result;
+    }
+
+    Project project;
+    if (!project.open(projectPath)) {
+        result.error = project.lastError();
+        return result;
+    }
+
+    const double pricePerLb = options.pricePerLb >= 0.0 ? options.pricePerLb
+                                                        : project.materialPricePerLb();
+    result.quote = QuoteCalculator::calculate(project, pricePerLb);
+    result.itemCount = project.takeoffItems().size();
+    project.close();
+
+    if (options.format == OutputFormat::Xlsx) {
+        result.ok = QuoteCalculator::writeXlsx(result.quote, result.outputPath, &result.error);
+    } else {
+        result.ok = QuoteCalculator::writeCsv(result.quote, result.outputPath, &result.error);
+    }
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
+
+} // namespace
+
+/**
+ * @brief Entry point for the headless batch tool.
+ *
+ * Recomputes the quote of one or many projects without a display, e.g.
+ * overnight on a build server, and writes one quote file per project.
+ * Projects are processed in parallel, each on its own database connection.
+ *
+ * Project files from an older build are not upgraded unless --migrate is
+ * given; they fail with an error instead.
+ *
+ * Exit code is 0 if every project was exported, 1 if any failed and 2 for
+ * invalid arguments.
+ */
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("takeoff_cli");
+    app.setApplicationVersion("1.0.0");
+    app.setOrganizationName("Blueprint Tools");
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Recompute takeoff quotes and export them without the GUI.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("projects",
+        "Project files (*.takeoff.db) or directories containing them.", "<project|dir>...");
+
+    QCommandLineOption priceOption({"p", "price"},
+        "Material rate in $/lb. Defaults to the rate saved in each project.", "rate");
+    QCommandLineOption outputOption({"o", "output-dir"},
+        "Directory for quote files. Defaults to each project's directory.", "dir");
+    QCommandLineOption formatOption({"f", "format"},
+        "Output format: csv or xlsx.", "format", "csv");
+    QCommandLineOption jobsOption({"j", "jobs"},
+        "Number of projects processed at once. Defaults to the number of cores.", "n");
+    QCommandLineOption migrateOption("migrate",
+        "Upgrade projects saved by an older version in place. Without it they are skipped with an error.");
+    parser.addOptions({priceOption, outputOption, formatOption, jobsOption, migrateOption});
+    parser.process(app);
+
+    BatchOptions options;
+    if (parser.isSet(priceOption)) {
+        bool ok = false;
+        options.pricePerLb = parser.value(priceOption).toDouble(&ok);
+        if (!ok || options.pricePerLb < 0.0) {
+            err << "Invalid rate: " << parser.value(priceOption) << "\n";
+            return 2;
+        }
+    }
+
+    const QString format = parser.value(formatOption).toLower();
+    if (format == "xlsx") {
+        if (!QuoteCalculator::hasXlsxSupport()) {
+            err << "XLSX output is not available in this build (configure with -DTAKEOFF_WITH_XLSX=ON); "
+                   "use --format csv\n";
+            return 2;
+        }
+        options.format = OutputFormat::Xlsx;
+    } else if (format != "csv") {
+        err << "Unknown format: " << format << "\n";
+        return 2;
+    }
+
+    options.migrate = parser.isSet(migrateOption);
+
+    if (parser.isSet(outputOption)) {
+        options.outputDir = parser.value(outputOption);
+        if (!QDir().mkpath(options.outputDir)) {
+            err << "Cannot create output directory: " << options.outputDir << "\n";
+            return 2;
+        }
+    }
+
+    int jobs = QThread::idealThreadCount();
+    if (parser.isSet(jobsOption)) {
+        bool ok = false;
+        jobs = parser.value(jobsOption).toInt(&ok);
+        if (!ok || jobs < 1) {
+            err << "Invalid job count: " << parser.value(jobsOption) << "\n";
+            return 2;
+        }
+    }
+
+    const QStringList projects = collectProjects(parser.positionalArguments(), err);
+    if (projects.isEmpty()) {
+        err << "No projects to process.\n";
+        parser.showHelp(2);
+    }
+
+    // parallelFor works on the calling thread plus up to maxThreadCount - 1
+    // pool threads
+    QThreadPool::globalInstance()->setMaxThreadCount(jobs);
+
+    QElapsedTimer timer;
+    timer.start();
+    QVector<BatchResult> results(projects.size());
+    parallelFor(projects.size(), [&](int i) {
+        results[i] = processProject(projects[i], options);
+    });
+
+    int failed = 0;
+    for (const BatchResult& result : results) {
+        if (result.ok) {
+            out << result.projectPath << " -> " << result.outputPath
+                << QString(" (%1 items, %2 lb, $%3, %4 ms)")
+                       .arg(result.itemCount)
+                       .arg(result.quote.totalWeightLb, 0, 'f', 1)
+                       .arg(result.quote.totalCost, 0, 'f', 2)
+                       .arg(result.elapsedMs)
+                << "\n";
+        } else {
+            ++failed;
+            err << result.projectPath << ": " << result.error << "\n";
+        }
+    }
+    out << QString("%1 of %2 projects exported in %3 ms\n")
+               .arg(results.size() - failed).arg(results.size()).arg(timer.elapsed());
+
+    return failed > 0 ? 1 : 0;
+}
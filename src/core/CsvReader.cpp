@@ -0,0 +1,177 @@
+#include "CsvReader.h"
+
+namespace {
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+} // namespace
+
+QString CsvReader::Field::toString() const
+{
+    return QString::fromUtf8(data, size);
+}
+
+double CsvReader::Field::toDouble(bool* ok) const
+{
+    // fromRawData() wraps the mapped bytes without copying them
+    return QByteArray::fromRawData(data, size).toDouble(ok);
+}
+
+CsvReader::CsvReader()
+    : m_mapped(nullptr)
+    , m_pos(nullptr)
+    , m_end(nullptr)
+{
+}
+
+CsvReader::~CsvReader()
+{
+    close();
+}
+
+bool CsvReader::open(const QString& filePath)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_lastError = "Could not open file: " + filePath;
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    if (size > 0) {
+        // Private mapping: in-place unescaping never reaches the file
+        m_mapped = m_file.map(0, size, QFileDevice::MapPrivateOption);
+    }
+
+    if (m_mapped) {
+        m_pos = reinterpret_cast<char*>(m_mapped);
+        m_end = m_pos + size;
+    } else {
+        // Fall back to reading the whole file (e.g. empty or unmappable files)
+        m_buffer = m_file.readAll();
+        m_pos = m_buffer.data();
+        m_end = m_pos + m_buffer.size();
+    }
+
+    // Skip UTF-8 byte order mark
+    if (m_end - m_pos >= 3 &&
+        static_cast<uchar>(m_pos[0]) == 0xEF &&
+        static_cast<uchar>(m_pos[1]) == 0xBB &&
+        static_cast<uchar>(m_pos[2]) == 0xBF) {
+        m_pos += 3;
+    }
+
+    m_fields.reserve(128);
+    m_lastError.clear();
+    return true;
+}
+
+void CsvReader::close()
+{
+    if (m_mapped) {
+        m_file.unmap(m_mapped);
+        m_mapped = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_buffer.clear();
+    m_fields.clear();
+    m_pos = nullptr;
+    m_end = nullptr;
+}
+
+bool CsvReader::readRow()
+{
+    m_fields.resize(0);
+
+    if (!m_pos || m_pos >= m_end) {
+        return false;
+    }
+
+    char* p = m_pos;
+    char* const end = m_end;
+
+    for (;;) {
+        Field field;
+
+        while (p < end && isSpace(*p)) {
+            ++p;
+        }
+
+        if (p < end && *p == '"') {
+            // Quoted field: unescape "" in place, keep embedded separators
+            ++p;
+            char* start = p;
+            char* out = p;
+            while (p < end) {
+                if (*p == '"') {
+                    if (p + 1 < end && p[1] == '"') {
+                        *out++ = '"';
+                        p += 2;
+                        continue;
+                    }
+                    ++p;  // Closing quote
+                    break;
+                }
+                if (out != p) {
+                    *out = *p;
+                }
+                ++out;
+                ++p;
+            }
+            field.data = start;
+            field.size = static_cast<int>(out - start);
+
+            // Ignore anything between the closing quote and the separator
+            while (p < end && *p != ',' && *p != '\n' && *p != '\r') {
+                ++p;
+            }
+        } else {
+            char* start = p;
+            while (p < end && *p != ',' && *p != '\n' && *p != '\r') {
+                ++p;
+            }
+            char* fieldEnd = p;
+            while (fieldEnd > start && isSpace(fieldEnd[-1])) {
+                --fieldEnd;
+            }
+            field.data = start;
+            field.size = static_cast<int>(fieldEnd - start);
+        }
+
+        m_fields.append(field);
+
+        if (p < end && *p == ',') {
+            ++p;
+            continue;
+        }
+
+        // End of record (LF, CRLF, CR or end of file)
+        if (p < end && *p == '\r') {
+            ++p;
+        }
+        if (p < end && *p == '\n') {
+            ++p;
+        }
+        break;
+    }
+
+    m_pos = p;
+    return true;
+}
+
+bool CsvReader::isBlankRow() const
+{
+    return m_fields.size() == 1 && m_fields[0].isEmpty();
+}
+
+QString CsvReader::lastError() const
+{
+    return m_lastError;
+}
@@ -0,0 +1,96 @@
+#ifndef CSVREADER_H
+#define CSVREADER_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+
+/**
+ * @brief Zero-copy RFC 4180 CSV tokenizer over a memory-mapped file.
+ *
+ * Rows are read one at a time; each field is a view into the mapped bytes,
+ * so tokenizing never allocates. Quoted fields are unescaped in place (the
+ * mapping is private/copy-on-write, the file on disk is never modified).
+ * Quoted fields may contain commas, doubled quotes and line breaks.
+ */
+class CsvReader
+{
+public:
+    /**
+     * @brief A single field of the current row.
+     *
+     * Only valid until the next call to readRow() or close().
+     */
+    struct Field {
+        const char* data = nullptr;
+        int size = 0;
+
+        bool isEmpty() const { return size == 0; }
+
+        /**
+         * @brief Decode the field as UTF-8.
+         */
+        QString toString() const;
+
+        /**
+         * @brief Parse the field as a number without allocating.
+         * @param ok Set to false if the field is not a valid number
+         * @return Parsed value, or 0.0 on failure
+         */
+        double toDouble(bool* ok = nullptr) const;
+    };
+
+    CsvReader();
+    ~CsvReader();
+
+    /**
+     * @brief Open and map a CSV file.
+     * @param filePath Path to the CSV file
+     * @return true if successful
+     */
+    bool open(const QString& filePath);
+
+    /**
+     * @brief Unmap and close the file.
+     */
+    void close();
+
+    /**
+     * @brief Advance to the next row.
+     * @return false when the end of the file is reached
+     */
+    bool readRow();
+
+    /**
+     * @brief Check if the current row is blank (a single empty field).
+     */
+    bool isBlankRow() const;
+
+    /**
+     * @brief Number of fields in the current row.
+     */
+    int fieldCount() const { return m_fields.size(); }
+
+    /**
+     * @brief Get a field of the current row.
+     * @param index 0-based column index (must be < fieldCount())
+     */
+    const Field& field(int index) const { return m_fields[index]; }
+
+    /**
+     * @brief Get the last error message.
+     */
+    QString lastError() const;
+
+private:
+    QFile m_file;
+    uchar* m_mapped;
+    QByteArray m_buffer;    // Used when the file cannot be mapped
+    char* m_pos;
+    char* m_end;
+    QVector<Field> m_fields;
+    QString m_lastError;
+};
+
+#endif // CSVREADER_H
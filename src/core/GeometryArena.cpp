@@ -0,0 +1,60 @@
+#include "GeometryArena.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Released space is tolerated up to this many points
+const int MIN_WASTE_POINTS = 4096;
+
+} // namespace
+
+GeometryArena::GeometryArena()
+    : m_released(0)
+{
+}
+
+void GeometryArena::clear()
+{
+    m_points.clear();
+    m_released = 0;
+}
+
+void GeometryArena::reserve(int pointCount)
+{
+    m_points.reserve(pointCount);
+}
+
+int GeometryArena::allocate(int count)
+{
+    const int offset = m_points.size();
+    m_points.resize(offset + count);
+    return offset;
+}
+
+int GeometryArena::append(PointSpan points)
+{
+    const int offset = allocate(points.size);
+    std::copy(points.begin(), points.end(), m_points.begin() + offset);
+    return offset;
+}
+
+bool GeometryArena::isWasteful() const
+{
+    return m_released >= MIN_WASTE_POINTS && m_released * 2 >= m_points.size();
+}
+
+void GeometryArena::compact(QVector<int>& offsets, const QVector<int>& counts)
+{
+    QVector<QPointF> packed;
+    packed.reserve(m_points.size() - m_released);
+    for (int i = 0; i < offsets.size(); ++i) {
+        const QPointF* first = m_points.constData() + offsets[i];
+        offsets[i] = packed.size();
+        packed.resize(offsets[i] + counts[i]);
+        std::copy(first, first + counts[i], packed.begin() + offsets[i]);
+    }
+    m_points = std::move(packed);
+    m_released = 0;
+}
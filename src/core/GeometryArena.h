@@ -0,0 +1,90 @@
+#ifndef GEOMETRYARENA_H
+#define GEOMETRYARENA_H
+
+#include <QPointF>
+#include <QVector>
+
+/**
+ * @brief Read-only view of consecutive points owned by someone else.
+ */
+struct PointSpan {
+    const QPointF* data = nullptr;
+    int size = 0;
+
+    PointSpan() = default;
+    PointSpan(const QPointF* first, int count) : data(first), size(count) {}
+    PointSpan(const QVector<QPointF>& points) : data(points.constData()), size(points.size()) {}
+
+    const QPointF* begin() const { return data; }
+    const QPointF* end() const { return data + size; }
+    const QPointF& operator[](int i) const { return data[i]; }
+    bool isEmpty() const { return size == 0; }
+
+    QVector<QPointF> toVector() const { return QVector<QPointF>(begin(), end()); }
+};
+
+/**
+ * @brief Bump allocator for the points of many polylines.
+ *
+ * All points live in one contiguous buffer, so passes over the geometry
+ * of a whole project read memory in order and need no per-item
+ * allocation. Ranges are handed out at the end of the buffer and never
+ * moved individually; released ranges are only counted as waste until
+ * compact() repacks the live ones.
+ *
+ * Pointers and spans into the arena are invalidated by allocate(),
+ * append() and compact().
+ */
+class GeometryArena
+{
+public:
+    GeometryArena();
+
+    void clear();
+    void reserve(int pointCount);
+
+    /**
+     * @brief Allocate room for points at the end, to be filled through data().
+     * @return Offset of the first point
+     */
+    int allocate(int count);
+
+    /**
+     * @brief Copy points to the end.
+     * @return Offset of the first point
+     */
+    int append(PointSpan points);
+
+    /**
+     * @brief Mark a range as unused. Its space is reclaimed by compact().
+     */
+    void release(int count) { m_released += count; }
+
+    QPointF* data(int offset) { return m_points.data() + offset; }
+    const QPointF* constData() const { return m_points.constData(); }
+    PointSpan span(int offset, int count) const { return PointSpan(m_points.constData() + offset, count); }
+
+    /**
+     * @brief Number of points in the buffer, live or released.
+     */
+    int size() const { return m_points.size(); }
+    int releasedCount() const { return m_released; }
+
+    /**
+     * @brief Check if released space outweighs the live points.
+     */
+    bool isWasteful() const;
+
+    /**
+     * @brief Repack the given live ranges in order and update their offsets.
+     * @param offsets Range offsets, rewritten in place
+     * @param counts Range sizes, same length as offsets
+     */
+    void compact(QVector<int>& offsets, const QVector<int>& counts);
+
+private:
+    QVector<QPointF> m_points;
+    int m_released;
+};
+
+#endif // GEOMETRYARENA_H
@@ -0,0 +1,149 @@
+#include "ImageDiff.h"
+#include "ParallelFor.h"
+#include "RasterOps.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IMAGEDIFF_SSE2
+#endif
+
+const QRgb ImageDiff::ADDED_COLOR = qRgba(0, 90, 230, 200);      // Blue: new ink
+const QRgb ImageDiff::REMOVED_COLOR = qRgba(230, 30, 30, 200);   // Red: erased ink
+
+namespace {
+
+// Compares one row span and writes the changed pixels to the overlay row,
+// leaving the others untouched. Returns false if nothing changed.
+bool diffRow(const uchar* before, const uchar* after, int count, int threshold,
+             QRgb* overlay, int& added, int& removed, int& firstChanged, int& lastChanged)
+{
+    const QRgb addedColor = qPremultiply(ImageDiff::ADDED_COLOR);
+    const QRgb removedColor = qPremultiply(ImageDiff::REMOVED_COLOR);
+    bool any = false;
+
+    auto mark = [&](int x, bool darker) {
+        overlay[x] = darker ? addedColor : removedColor;
+        if (darker) ++added; else ++removed;
+        firstChanged = std::min(firstChanged, x);
+        lastChanged = std::max(lastChanged, x);
+        any = true;
+    };
+
+    int x = 0;
+#ifdef IMAGEDIFF_SSE2
+    // A lane has changed if the saturated difference in either direction
+    // reaches the threshold, i.e. stays non-zero after subtracting t - 1
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(threshold - 1));
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= count; x += 16) {
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(before + x));
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(after + x));
+        __m128i darker = _mm_subs_epu8(_mm_subs_epu8(b, a), limit);
+        __m128i lighter = _mm_subs_epu8(_mm_subs_epu8(a, b), limit);
+        unsigned addedMask = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(darker, zero))) & 0xFFFFu;
+        unsigned removedMask = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(lighter, zero))) & 0xFFFFu;
+        if ((addedMask | removedMask) == 0) {
+            continue;   // Unchanged, the common case
+        }
+        for (unsigned m = addedMask | removedMask; m; m &= m - 1) {
+            int lane = 0;
+            while (!((m >> lane) & 1u)) ++lane;
+            mark(x + lane, (addedMask >> lane) & 1u);
+        }
+    }
+#endif
+    for (; x < count; ++x) {
+        const int difference = static_cast<int>(after[x]) - static_cast<int>(before[x]);
+        if (difference <= -threshold) {
+            mark(x, true);
+        } else if (difference >= threshold) {
+            mark(x, false);
+        }
+    }
+    return any;
+}
+
+} // namespace
+
+QVector<ImageDiff::Tile> ImageDiff::compare(const QImage& before, const QImage& after, const Options& options,
+                                            const std::atomic<bool>* cancelled)
+{
+    if (before.isNull() || after.isNull() || options.tileSize <= 0) {
+        return QVector<Tile>();
+    }
+
+    const QImage grayBefore = RasterOps::toGrayscale(before, cancelled);
+    const QImage grayAfter = RasterOps::toGrayscale(after, cancelled);
+    if (grayBefore.isNull() || grayAfter.isNull() || RasterOps::isCancelled(cancelled)) {
+        return QVector<Tile>();
+    }
+
+    const int width = std::min(grayBefore.width(), grayAfter.width());
+    const int height = std::min(grayBefore.height(), grayAfter.height());
+    const int threshold = std::max(1, std::min(255, options.threshold));
+    const int columns = (width + options.tileSize - 1) / options.tileSize;
+    const int rows = (height + options.tileSize - 1) / options.tileSize;
+
+    // One slot per tile so workers never share a container
+    QVector<Tile> slots(columns * rows);
+    QVector<char> changed(columns * rows, 0);
+    Tile* slotData = slots.data();
+    char* changedData = changed.data();
+
+    parallelFor(columns * rows, [&](int index) {
+        if (RasterOps::isCancelled(cancelled)) return;
+
+        const int x0 = (index % columns) * options.tileSize;
+        const int y0 = (index / columns) * options.tileSize;
+        const QRect rect(x0, y0, std::min(options.tileSize, width - x0), std::min(options.tileSize, height - y0));
+
+        Tile tile;
+        tile.rect = rect;
+        int firstX = rect.width();
+        int lastX = -1;
+        int firstY = -1;
+        int lastY = -1;
+
+        // Rows are diffed into a transparent buffer; the overlay is only
+        // allocated once a tile has a change
+        QVector<QRgb> rowBuffer(rect.width(), 0);
+        for (int r = 0; r < rect.height(); ++r) {
+            const uchar* rowBefore = grayBefore.constScanLine(y0 + r) + x0;
+            const uchar* rowAfter = grayAfter.constScanLine(y0 + r) + x0;
+            if (!diffRow(rowBefore, rowAfter, rect.width(), threshold, rowBuffer.data(),
+                         tile.addedPixels, tile.removedPixels, firstX, lastX)) {
+                continue;
+            }
+
+            if (tile.overlay.isNull()) {
+                tile.overlay = QImage(rect.size(), QImage::Format_ARGB32_Premultiplied);
+                tile.overlay.fill(Qt::transparent);
+            }
+            std::copy(rowBuffer.constBegin(), rowBuffer.constEnd(), reinterpret_cast<QRgb*>(tile.overlay.scanLine(r)));
+            std::fill(rowBuffer.begin(), rowBuffer.end(), 0);
+
+            if (firstY < 0) firstY = r;
+            lastY = r;
+        }
+
+        if (tile.addedPixels + tile.removedPixels >= options.minChangedPixels) {
+            tile.changedBounds = QRect(x0 + firstX, y0 + firstY, lastX - firstX + 1, lastY - firstY + 1);
+            slotData[index] = tile;
+            changedData[index] = 1;
+        }
+    });
+
+    if (RasterOps::isCancelled(cancelled)) {
+        return QVector<Tile>();
+    }
+
+    QVector<Tile> tiles;
+    for (int i = 0; i < slots.size(); ++i) {
+        if (changed[i]) {
+            tiles.append(slots[i]);
+        }
+    }
+    return tiles;
+}
@@ -0,0 +1,55 @@
+#ifndef IMAGEDIFF_H
+#define IMAGEDIFF_H
+
+#include <QImage>
+#include <QRect>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief Per-pixel comparison of two revisions of a sheet.
+ *
+ * Both rasters are converted to grayscale and compared tile by tile on the
+ * global thread pool, 16 pixels at a time with SSE2 where available. A
+ * pixel has changed when its gray level differs by at least the threshold;
+ * ink present only in the newer raster counts as added, ink present only
+ * in the older one as removed.
+ *
+ * Only tiles with changes are returned, each with a transparent overlay
+ * image marking its changed pixels, so a view can show the result as a
+ * handful of static tiles. The rasters are compared where they overlap,
+ * at the same origin; no registration is attempted.
+ */
+class ImageDiff
+{
+public:
+    struct Options {
+        int threshold = 64;         // Gray level difference that counts as a change
+        int tileSize = 256;         // Tile edge in pixels
+        int minChangedPixels = 12;  // Tiles with fewer changes are treated as noise
+    };
+
+    struct Tile {
+        QRect rect;             // Tile area in image pixels
+        QRect changedBounds;    // Bounds of the changed pixels in image pixels
+        QImage overlay;         // Tile-sized ARGB image, transparent where unchanged
+        int addedPixels = 0;
+        int removedPixels = 0;
+    };
+
+    static const QRgb ADDED_COLOR;
+    static const QRgb REMOVED_COLOR;
+
+    /**
+     * @brief Compare an older and a newer raster of the same sheet.
+     * @param before Older revision, any QImage format
+     * @param after Newer revision, any QImage format
+     * @param options Comparison parameters
+     * @param cancelled Optional flag polled between tiles
+     * @return Tiles with changes in row-major order; empty if cancelled
+     */
+    static QVector<Tile> compare(const QImage& before, const QImage& after, const Options& options,
+                                 const std::atomic<bool>* cancelled = nullptr);
+};
+
+#endif // IMAGEDIFF_H
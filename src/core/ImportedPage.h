@@ -0,0 +1,20 @@
+#ifndef IMPORTEDPAGE_H
+#define IMPORTEDPAGE_H
+
+#include <QByteArray>
+#include <QVector>
+
+#include "PdfWord.h"
+#include "../models/Page.h"
+
+/**
+ * @brief A PDF page read by PdfImporter, ready to be stored.
+ */
+struct ImportedPage {
+    Page page;
+    QByteArray thumbnailPng;    // Empty if the page could not be rendered
+    QVector<PdfWord> words;     // Text layer in scene coordinates
+    bool textExtracted = false;
+};
+
+#endif // IMPORTEDPAGE_H
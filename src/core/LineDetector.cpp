@@ -0,0 +1,887 @@
+#include "LineDetector.h"
+#include "MathUtils.h"
+#include "ParallelFor.h"
+#include "RasterOps.h"
+
+#include <QHash>
+#include <QPoint>
+#include <QRect>
+#include <QtMath>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LINEDETECTOR_SSE2
+#endif
+
+namespace {
+
+const int BAND_ROWS = 256;
+const int STRIP_COLUMNS = 512;   // Multiple of 16 so strips stay SIMD aligned
+
+// Oblique lines are searched on square tiles of this size
+const int OBLIQUE_TILE = 512;
+
+// Hough angle resolution: 0.5 degree keeps the walked line within a pixel
+// or two of a drawn line across a whole tile
+const int HOUGH_ANGLES = 360;
+
+// Ink is looked for this many pixels either side of a walked line
+const int WALK_TOLERANCE = 1;
+
+// Edge points this close to a found line are removed so they stop voting
+const int CLEAR_RADIUS = 2;
+
+// Pieces of one line on neighbouring tiles: endpoint distance and angle
+// difference below which they are joined
+const double JOIN_DISTANCE = 3.0;
+const double JOIN_ANGLE_DEGREES = 2.0;
+
+// Grid cell size for finding the longer lines near a shorter one
+const double CONTAINMENT_CELL = 128.0;
+
+// A run of ink pixels along one row (horizontal) or column (vertical)
+struct Run {
+    int fixed;   // Row for horizontal runs, column for vertical runs
+    int start;
+    int end;     // Inclusive
+};
+
+// Appends horizontal ink runs of at least minLength for rows [y0, y1)
+void findHorizontalRuns(const QImage& gray, int y0, int y1, int threshold, int minLength,
+                        QVector<Run>& runs)
+{
+    const int width = gray.width();
+#ifdef LINEDETECTOR_SSE2
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(threshold - 1));
+#endif
+
+    for (int y = y0; y < y1; ++y) {
+        const uchar* row = gray.constScanLine(y);
+        int runStart = -1;
+
+        auto step = [&](int x, bool ink) {
+            if (ink) {
+                if (runStart < 0) runStart = x;
+            } else if (runStart >= 0) {
+                if (x - runStart >= minLength) runs.append({y, runStart, x - 1});
+                runStart = -1;
+            }
+        };
+
+        int x = 0;
+#ifdef LINEDETECTOR_SSE2
+        for (; x + 16 <= width; x += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+            // Unsigned v <= threshold - 1, i.e. v < threshold
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, limit), v)));
+            if (mask == 0 && runStart < 0) {
+                continue;   // Blank paper, the common case
+            }
+            if (mask == 0xFFFF && runStart >= 0) {
+                continue;   // Inside a run
+            }
+            for (int b = 0; b < 16; ++b) {
+                step(x + b, (mask >> b) & 1u);
+            }
+        }
+#endif
+        for (; x < width; ++x) {
+            step(x, row[x] < threshold);
+        }
+        step(width, false);
+    }
+}
+
+// Appends vertical ink runs of at least minLength for columns [x0, x1)
+void findVerticalRuns(const QImage& gray, int x0, int x1, int threshold, int minLength,
+                      QVector<Run>& runs)
+{
+    const int height = gray.height();
+    const int columns = x1 - x0;
+
+    // Current run length per column, saturating at INT16_MAX
+    QVector<qint16> counters(columns + 16, 0);
+    qint16* count = counters.data();
+
+    auto endRun = [&](int c, int y) {
+        if (count[c] >= minLength) {
+            runs.append({x0 + c, y - count[c], y - 1});
+        }
+    };
+
+#ifdef LINEDETECTOR_SSE2
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(threshold - 1));
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i minMinusOne = _mm_set1_epi16(static_cast<short>(minLength - 1));
+#endif
+
+    for (int y = 0; y < height; ++y) {
+        const uchar* row = gray.constScanLine(y) + x0;
+        int c = 0;
+#ifdef LINEDETECTOR_SSE2
+        for (; c + 16 <= columns; c += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + c));
+            __m128i ink = _mm_cmpeq_epi8(_mm_min_epu8(v, limit), v);
+            __m128i inkLo = _mm_unpacklo_epi8(ink, ink);
+            __m128i inkHi = _mm_unpackhi_epi8(ink, ink);
+
+            __m128i* counterPtr = reinterpret_cast<__m128i*>(count + c);
+            __m128i prevLo = _mm_loadu_si128(counterPtr);
+            __m128i prevHi = _mm_loadu_si128(counterPtr + 1);
+
+            // Runs that were long enough and stop on this row
+            __m128i endedLo = _mm_andnot_si128(inkLo, _mm_cmpgt_epi16(prevLo, minMinusOne));
+            __m128i endedHi = _mm_andnot_si128(inkHi, _mm_cmpgt_epi16(prevHi, minMinusOne));
+            unsigned ended = static_cast<unsigned>(_mm_movemask_epi8(_mm_packs_epi16(endedLo, endedHi)));
+            for (; ended; ended &= ended - 1) {
+                int lane = 0;
+                while (!((ended >> lane) & 1u)) ++lane;
+                endRun(c + lane, y);
+            }
+
+            _mm_storeu_si128(counterPtr, _mm_and_si128(_mm_adds_epi16(prevLo, one), inkLo));
+            _mm_storeu_si128(counterPtr + 1, _mm_and_si128(_mm_adds_epi16(prevHi, one), inkHi));
+        }
+#endif
+        for (; c < columns; ++c) {
+            if (row[c] < threshold) {
+                if (count[c] < INT16_MAX) ++count[c];
+            } else {
+                endRun(c, y);
+                count[c] = 0;
+            }
+        }
+    }
+
+    for (int c = 0; c < columns; ++c) {
+        endRun(c, height);
+    }
+}
+
+// Merges runs on adjacent rows/columns into one centerline segment per line.
+// The pixels each line covers are appended to lineAreas.
+QVector<QLineF> mergeRuns(QVector<Run>& runs, bool horizontal, int maxThickness, QVector<QRect>& lineAreas)
+{
+    std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) {
+        return a.fixed != b.fixed ? a.fixed < b.fixed : a.start < b.start;
+    });
+
+    struct Group {
+        int firstFixed;
+        int lastFixed;
+        int start;
+        int end;
+        qint64 fixedSum;
+        int count;
+    };
+
+    QVector<QLineF> segments;
+    QVector<Group> active;
+
+    auto finish = [&](const Group& g) {
+        if (g.lastFixed - g.firstFixed + 1 > maxThickness) {
+            return;
+        }
+        double center = static_cast<double>(g.fixedSum) / g.count + 0.5;
+        if (horizontal) {
+            segments.append(QLineF(g.start, center, g.end + 1, center));
+            lineAreas.append(QRect(g.start, g.firstFixed, g.end - g.start + 1, g.lastFixed - g.firstFixed + 1));
+        } else {
+            segments.append(QLineF(center, g.start, center, g.end + 1));
+            lineAreas.append(QRect(g.firstFixed, g.start, g.lastFixed - g.firstFixed + 1, g.end - g.start + 1));
+        }
+    };
+
+    int currentFixed = INT_MIN;
+    for (const Run& run : runs) {
+        if (run.fixed != currentFixed) {
+            currentFixed = run.fixed;
+            // Groups not continued on the previous row/column are complete
+            for (int i = active.size() - 1; i >= 0; --i) {
+                if (active[i].lastFixed < currentFixed - 1) {
+                    finish(active[i]);
+                    active.remove(i);
+                }
+            }
+        }
+
+        Group* match = nullptr;
+        for (Group& g : active) {
+            if (g.lastFixed != run.fixed - 1) continue;
+            int overlap = std::min(g.end, run.end) - std::max(g.start, run.start) + 1;
+            int shorter = std::min(g.end - g.start, run.end - run.start) + 1;
+            if (overlap * 2 >= shorter) {
+                match = &g;
+                break;
+            }
+        }
+
+        if (match) {
+            match->lastFixed = run.fixed;
+            match->start = std::min(match->start, run.start);
+            match->end = std::max(match->end, run.end);
+            match->fixedSum += run.fixed;
+            match->count += 1;
+        } else {
+            active.append({run.fixed, run.fixed, run.start, run.end, run.fixed, 1});
+        }
+    }
+    for (const Group& g : active) {
+        finish(g);
+    }
+    return segments;
+}
+
+struct HoughTables {
+    float cosines[HOUGH_ANGLES];
+    float sines[HOUGH_ANGLES];
+
+    HoughTables()
+    {
+        for (int n = 0; n < HOUGH_ANGLES; ++n) {
+            double theta = qDegreesToRadians(n * 180.0 / HOUGH_ANGLES);
+            cosines[n] = static_cast<float>(std::cos(theta));
+            sines[n] = static_cast<float>(std::sin(theta));
+        }
+    }
+};
+
+// What a walk along an oblique line finds at a pixel. Ink of a horizontal
+// or vertical line that it crosses or runs along neither ends nor extends
+// the oblique line.
+enum class Trace {
+    Paper,
+    LineArea,
+    Ink
+};
+
+// A line found on one tile; pieces on neighbouring tiles are joined later
+struct Piece {
+    QPointF p1;
+    QPointF p2;
+    double angle;   // Direction in degrees, [0, 180)
+};
+
+// A line walked one pixel per step along its major axis, in 16.16 fixed
+// point along the minor one. Coordinates are tile pixel indexes.
+struct Walk {
+    static const int SHIFT = 16;
+
+    bool xMajor;
+    int x0;
+    int y0;
+    int dx;
+    int dy;
+
+    // Line through (sx, sy) with direction (a, b)
+    Walk(double sx, double sy, double a, double b)
+        : xMajor(std::abs(a) > std::abs(b))
+    {
+        if (xMajor) {
+            x0 = static_cast<int>(std::lround(sx));
+            y0 = static_cast<int>(std::lround((sy + (x0 - sx) * b / a + 0.5) * (1 << SHIFT)));
+            dx = a > 0 ? 1 : -1;
+            dy = static_cast<int>(std::lround(b * (1 << SHIFT) / std::abs(a)));
+        } else {
+            y0 = static_cast<int>(std::lround(sy));
+            x0 = static_cast<int>(std::lround((sx + (y0 - sy) * a / b + 0.5) * (1 << SHIFT)));
+            dy = b > 0 ? 1 : -1;
+            dx = static_cast<int>(std::lround(a * (1 << SHIFT) / std::abs(b)));
+        }
+    }
+
+    QPoint pixelAt(int x, int y) const
+    {
+        return xMajor ? QPoint(x, y >> SHIFT) : QPoint(x >> SHIFT, y);
+    }
+
+    QPoint start() const { return pixelAt(x0, y0); }
+
+    // Pixel p offset by o across the line
+    QPoint across(const QPoint& p, int o) const
+    {
+        return xMajor ? QPoint(p.x(), p.y() + o) : QPoint(p.x() + o, p.y());
+    }
+
+    // The point of the line at the major coordinate of pixel p
+    QPointF exactAt(const QPoint& p) const
+    {
+        if (xMajor) {
+            const int steps = (p.x() - x0) * dx;
+            return QPointF(p.x(), (y0 + steps * static_cast<double>(dy)) / (1 << SHIFT) - 0.5);
+        }
+        const int steps = (p.y() - y0) * dy;
+        return QPointF((x0 + steps * static_cast<double>(dx)) / (1 << SHIFT) - 0.5, p.y());
+    }
+};
+
+// Appends pieces of lines at any angle found in one tile.
+//
+// Ink already explained by a horizontal or vertical line is masked out.
+// The remaining ink is thinned to the centre pixel of every short row run
+// and column run; these centres are the edge map that votes in a
+// progressive probabilistic Hough transform (Matas et al.). Each time a
+// bin reaches the vote threshold, the line is refitted to the edge points
+// along it and walked along the ink in both directions; its edge points
+// are then removed and, if the line is kept, their votes withdrawn.
+void findObliquePieces(const QImage& gray, const QRect& tile, int threshold,
+                       const LineDetector::Options& options, const QVector<QRect>& lineAreas,
+                       QVector<Piece>& pieces)
+{
+    static const HoughTables tables;
+    const int w = tile.width();
+    const int h = tile.height();
+    const int tx0 = tile.left();
+    const int ty0 = tile.top();
+
+    // Ink not explained by a horizontal or vertical line
+    QVector<uchar> residual(w * h, 0);
+    for (int y = 0; y < h; ++y) {
+        const uchar* row = gray.constScanLine(ty0 + y) + tx0;
+        uchar* out = residual.data() + y * w;
+        for (int x = 0; x < w; ++x) {
+            out[x] = row[x] < threshold;
+        }
+    }
+    for (const QRect& area : lineAreas) {
+        const QRect local = area.intersected(tile).translated(-tx0, -ty0);
+        for (int y = local.top(); y <= local.bottom(); ++y) {
+            std::fill(residual.begin() + y * w + local.left(), residual.begin() + y * w + local.right() + 1, 0);
+        }
+    }
+
+    // Edge map: centres of short row runs (steep strokes) and short column
+    // runs (shallow strokes). Long runs are fills.
+    enum : uchar { Empty, Pending, Voted };
+    const int maxCross = 2 * options.maxThickness;
+    QVector<uchar> state(w * h, Empty);
+    QVector<QPoint> points;
+    auto addCentre = [&](int x, int y) {
+        if (state[y * w + x] == Empty) {
+            state[y * w + x] = Pending;
+            points.append(QPoint(x, y));
+        }
+    };
+    for (int y = 0; y < h; ++y) {
+        const uchar* row = residual.constData() + y * w;
+        for (int x = 0; x < w;) {
+            if (!row[x]) { ++x; continue; }
+            int end = x;
+            while (end + 1 < w && row[end + 1]) ++end;
+            if (end - x + 1 <= maxCross) addCentre((x + end) / 2, y);
+            x = end + 1;
+        }
+    }
+    for (int x = 0; x < w; ++x) {
+        for (int y = 0; y < h;) {
+            if (!residual[y * w + x]) { ++y; continue; }
+            int end = y;
+            while (end + 1 < h && residual[(end + 1) * w + x]) ++end;
+            if (end - y + 1 <= maxCross) addCentre(x, (y + end) / 2);
+            y = end + 1;
+        }
+    }
+    if (points.isEmpty()) {
+        return;
+    }
+
+    // Visit edge points in a random but repeatable order
+    std::mt19937 random(static_cast<unsigned>(tx0 * 7919 + ty0));
+    std::shuffle(points.begin(), points.end(), random);
+
+    const int rhoOffset = w + h;
+    const int rhoCount = 2 * (w + h) + 1;
+    QVector<int> accumulator(HOUGH_ANGLES * rhoCount, 0);
+    auto rhoOf = [&](int x, int y, int n) {
+        return static_cast<int>(std::lround(x * tables.cosines[n] + y * tables.sines[n])) + rhoOffset;
+    };
+    auto inTile = [&](const QPoint& p) {
+        return p.x() >= 0 && p.x() < w && p.y() >= 0 && p.y() < h;
+    };
+    auto traceNear = [&](const Walk& walk, const QPoint& p) {
+        Trace trace = Trace::Paper;
+        for (int o = -WALK_TOLERANCE; o <= WALK_TOLERANCE; ++o) {
+            const QPoint q = walk.across(p, o);
+            if (!inTile(q)) continue;
+            if (residual[q.y() * w + q.x()]) {
+                return Trace::Ink;
+            }
+            if (gray.constScanLine(ty0 + q.y())[tx0 + q.x()] < threshold) {
+                trace = Trace::LineArea;
+            }
+        }
+        return trace;
+    };
+
+    // Last inked pixel each way from the start of a walk, bridging gaps of
+    // up to maxGap pixels
+    auto findEnds = [&](const Walk& walk, QPoint ends[2]) {
+        for (int k = 0; k < 2; ++k) {
+            const int dx = k == 0 ? walk.dx : -walk.dx;
+            const int dy = k == 0 ? walk.dy : -walk.dy;
+            ends[k] = walk.start();
+            int gap = 0;
+            for (int x = walk.x0, y = walk.y0;; x += dx, y += dy) {
+                const QPoint p = walk.pixelAt(x, y);
+                if (!inTile(p)) {
+                    break;
+                }
+                const Trace trace = traceNear(walk, p);
+                if (trace == Trace::Ink) {
+                    gap = 0;
+                    ends[k] = p;
+                } else if (trace == Trace::Paper && ++gap > options.maxGap) {
+                    break;
+                }
+            }
+        }
+    };
+
+    // Calls visit(q) for the pixels within CLEAR_RADIUS across the walk,
+    // from its start to each end
+    auto alongWalk = [&](const Walk& walk, const QPoint ends[2], auto visit) {
+        for (int k = 0; k < 2; ++k) {
+            const int dx = k == 0 ? walk.dx : -walk.dx;
+            const int dy = k == 0 ? walk.dy : -walk.dy;
+            for (int x = walk.x0, y = walk.y0;; x += dx, y += dy) {
+                const QPoint p = walk.pixelAt(x, y);
+                for (int o = -CLEAR_RADIUS; o <= CLEAR_RADIUS; ++o) {
+                    const QPoint q = walk.across(p, o);
+                    if (inTile(q)) {
+                        visit(q);
+                    }
+                }
+                if (p == ends[k] || !inTile(p)) {
+                    break;
+                }
+            }
+        }
+    };
+
+    const int voteThreshold = std::max(8, options.minLength / 2);
+    for (const QPoint& point : points) {
+        if (state[point.y() * w + point.x()] != Pending) {
+            continue;
+        }
+        state[point.y() * w + point.x()] = Voted;
+
+        int maxVotes = 0;
+        int maxAngle = 0;
+        for (int n = 0; n < HOUGH_ANGLES; ++n) {
+            int votes = ++accumulator[n * rhoCount + rhoOf(point.x(), point.y(), n)];
+            if (votes > maxVotes) {
+                maxVotes = votes;
+                maxAngle = n;
+            }
+        }
+        if (maxVotes < voteThreshold) {
+            continue;
+        }
+
+        // The Hough angle drifts off a thin line within a few hundred
+        // pixels, so fit the line to the edge points along the part it
+        // does follow and walk again
+        double a = -tables.sines[maxAngle];
+        double b = tables.cosines[maxAngle];
+        Walk walk(point.x(), point.y(), a, b);
+        QPoint ends[2];
+        findEnds(walk, ends);
+
+        double n = 0.0, sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0, sumYY = 0.0;
+        alongWalk(walk, ends, [&](const QPoint& q) {
+            if (state[q.y() * w + q.x()] != Empty) {
+                n += 1.0;
+                sumX += q.x();
+                sumY += q.y();
+                sumXX += static_cast<double>(q.x()) * q.x();
+                sumXY += static_cast<double>(q.x()) * q.y();
+                sumYY += static_cast<double>(q.y()) * q.y();
+            }
+        });
+        if (n >= 2.0) {
+            const double meanX = sumX / n;
+            const double meanY = sumY / n;
+            const double direction = 0.5 * std::atan2(2.0 * (sumXY / n - meanX * meanY),
+                                                      (sumXX / n - meanX * meanX) - (sumYY / n - meanY * meanY));
+            a = std::cos(direction);
+            b = std::sin(direction);
+            const double t = (point.x() - meanX) * a + (point.y() - meanY) * b;
+            walk = Walk(meanX + t * a, meanY + t * b, a, b);
+            findEnds(walk, ends);
+        }
+
+        // Lines cut by the tile edge are kept at any length, they may
+        // continue on the next tile
+        const int length = std::max(std::abs(ends[1].x() - ends[0].x()), std::abs(ends[1].y() - ends[0].y()));
+        auto onTileEdge = [&](const QPoint& p) {
+            return p.x() == 0 || p.x() == w - 1 || p.y() == 0 || p.y() == h - 1;
+        };
+        const bool goodLine = length >= options.minLength ||
+                              (length > 0 && (onTileEdge(ends[0]) || onTileEdge(ends[1])));
+
+        // Remove the line's edge points, withdrawing their votes if the
+        // line is kept
+        alongWalk(walk, ends, [&](const QPoint& q) {
+            uchar& s = state[q.y() * w + q.x()];
+            if (s == Voted && goodLine) {
+                for (int i = 0; i < HOUGH_ANGLES; ++i) {
+                    --accumulator[i * rhoCount + rhoOf(q.x(), q.y(), i)];
+                }
+            }
+            s = Empty;
+        });
+
+        if (goodLine) {
+            const QPointF origin(tx0 + 0.5, ty0 + 0.5);
+            const double angle = std::fmod(qRadiansToDegrees(std::atan2(b, a)) + 360.0, 180.0);
+            pieces.append({origin + walk.exactAt(ends[0]), origin + walk.exactAt(ends[1]), angle});
+        }
+    }
+}
+
+// Joins pieces of one line found on neighbouring tiles
+QVector<QLineF> joinPieces(const QVector<Piece>& pieces)
+{
+    // Union-find over pieces with a nearly touching, nearly parallel end
+    QVector<int> parent(pieces.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto root = [&parent](int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+
+    const double cell = JOIN_DISTANCE + 1.0;
+    auto cellKey = [cell](const QPointF& p, int ox, int oy) {
+        qint64 cx = static_cast<qint64>(std::floor(p.x() / cell)) + ox;
+        qint64 cy = static_cast<qint64>(std::floor(p.y() / cell)) + oy;
+        return (cx << 32) ^ (cy & 0xFFFFFFFF);
+    };
+    QHash<qint64, QVector<int>> endsByCell;
+    for (int i = 0; i < pieces.size(); ++i) {
+        endsByCell[cellKey(pieces[i].p1, 0, 0)].append(i);
+        endsByCell[cellKey(pieces[i].p2, 0, 0)].append(i);
+    }
+
+    auto nearEnd = [](const Piece& piece, const QPointF& p) {
+        return std::min(QLineF(piece.p1, p).length(), QLineF(piece.p2, p).length()) <= JOIN_DISTANCE;
+    };
+    for (int i = 0; i < pieces.size(); ++i) {
+        for (const QPointF& end : {pieces[i].p1, pieces[i].p2}) {
+            for (int oy = -1; oy <= 1; ++oy) {
+                for (int ox = -1; ox <= 1; ++ox) {
+                    auto it = endsByCell.constFind(cellKey(end, ox, oy));
+                    if (it == endsByCell.constEnd()) continue;
+                    for (int j : it.value()) {
+                        if (root(i) == root(j)) continue;
+                        double turn = std::abs(pieces[i].angle - pieces[j].angle);
+                        turn = std::min(turn, 180.0 - turn);
+                        if (turn <= JOIN_ANGLE_DEGREES && nearEnd(pieces[j], end)) {
+                            parent[root(i)] = root(j);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Each group becomes the segment between its two outermost ends along
+    // the direction of its longest piece
+    QHash<int, QVector<int>> groups;
+    for (int i = 0; i < pieces.size(); ++i) {
+        groups[root(i)].append(i);
+    }
+    QVector<QLineF> lines;
+    for (const QVector<int>& group : groups) {
+        int longest = group.first();
+        for (int i : group) {
+            if (QLineF(pieces[i].p1, pieces[i].p2).length() >
+                QLineF(pieces[longest].p1, pieces[longest].p2).length()) {
+                longest = i;
+            }
+        }
+        const QLineF axis(pieces[longest].p1, pieces[longest].p2);
+        const QPointF direction = (axis.p2() - axis.p1()) / axis.length();
+        QPointF first = axis.p1();
+        QPointF last = axis.p2();
+        double minT = QPointF::dotProduct(first, direction);
+        double maxT = QPointF::dotProduct(last, direction);
+        for (int i : group) {
+            for (const QPointF& end : {pieces[i].p1, pieces[i].p2}) {
+                double t = QPointF::dotProduct(end, direction);
+                if (t < minT) { minT = t; first = end; }
+                if (t > maxT) { maxT = t; last = end; }
+            }
+        }
+        lines.append(QLineF(first, last));
+    }
+    return lines;
+}
+
+// Follows the ink past both ends of a line. Picks up the stubs of a line
+// on tiles where too little of it showed to reach the vote threshold.
+// areaTiles holds the areas of the horizontal and vertical lines per tile.
+QLineF extendAlongInk(const QImage& gray, int threshold, int maxGap, const QLineF& line,
+                      const QVector<QVector<QRect>>& areaTiles, int tileColumns)
+{
+    const QPointF unit = (line.p2() - line.p1()) / line.length();
+    const bool xMajor = std::abs(unit.x()) > std::abs(unit.y());
+    const QPointF step = unit / std::max(std::abs(unit.x()), std::abs(unit.y()));
+    const QPointF across = xMajor ? QPointF(0.0, 1.0) : QPointF(1.0, 0.0);
+
+    auto traceNear = [&](const QPointF& p) {
+        Trace trace = Trace::Paper;
+        for (int o = -WALK_TOLERANCE; o <= WALK_TOLERANCE; ++o) {
+            const QPointF q = p + across * o;
+            const int x = static_cast<int>(std::floor(q.x()));
+            const int y = static_cast<int>(std::floor(q.y()));
+            if (x < 0 || x >= gray.width() || y < 0 || y >= gray.height() ||
+                gray.constScanLine(y)[x] >= threshold) {
+                continue;
+            }
+            const QVector<QRect>& areas = areaTiles[(y / OBLIQUE_TILE) * tileColumns + x / OBLIQUE_TILE];
+            const bool inLineArea = std::any_of(areas.begin(), areas.end(),
+                                                [x, y](const QRect& area) { return area.contains(x, y); });
+            if (!inLineArea) {
+                return Trace::Ink;
+            }
+            trace = Trace::LineArea;
+        }
+        return trace;
+    };
+
+    QPointF ends[2] = {line.p1(), line.p2()};
+    for (int k = 0; k < 2; ++k) {
+        const QPointF direction = k == 0 ? -step : step;
+        QPointF p = ends[k];
+        for (int gap = 0; gap <= maxGap;) {
+            p += direction;
+            if (p.x() < 0.0 || p.y() < 0.0 || p.x() >= gray.width() || p.y() >= gray.height()) {
+                break;
+            }
+            const Trace trace = traceNear(p);
+            if (trace == Trace::Ink) {
+                gap = 0;
+                ends[k] = p;
+            } else if (trace == Trace::Paper) {
+                ++gap;
+            }
+        }
+    }
+    return QLineF(ends[0], ends[1]);
+}
+
+// Drops lines that lie along a longer line, such as a stub refitted to
+// text next to the line it belongs to
+QVector<QLineF> dropContainedLines(QVector<QLineF> lines, double distance)
+{
+    std::sort(lines.begin(), lines.end(), [](const QLineF& a, const QLineF& b) {
+        return a.length() > b.length();
+    });
+
+    auto cellKey = [](int cx, int cy) {
+        return (static_cast<qint64>(cx) << 32) ^ static_cast<quint32>(cy);
+    };
+    auto cellOf = [](double v) {
+        return static_cast<int>(std::floor(v / CONTAINMENT_CELL));
+    };
+
+    QVector<QLineF> kept;
+    QHash<qint64, QVector<int>> keptByCell;
+    for (const QLineF& line : lines) {
+        auto alongKept = [&](const QPointF& p) {
+            auto it = keptByCell.constFind(cellKey(cellOf(p.x()), cellOf(p.y())));
+            if (it == keptByCell.constEnd()) {
+                return QVector<int>();
+            }
+            QVector<int> near;
+            for (int k : it.value()) {
+                if (MathUtils::distanceToSegment(p, kept[k].p1(), kept[k].p2()) <= distance) {
+                    near.append(k);
+                }
+            }
+            return near;
+        };
+        const QVector<int> nearFirst = alongKept(line.p1());
+        const QVector<int> nearLast = alongKept(line.p2());
+        const bool contained = std::any_of(nearFirst.begin(), nearFirst.end(), [&](int k) {
+            return nearLast.contains(k);
+        });
+        if (contained) {
+            continue;
+        }
+
+        // Index the line in every cell of its bounding box, grown by the
+        // distance so ends just outside a cell still find it
+        const int index = kept.size();
+        kept.append(line);
+        const QRectF box = QRectF(line.p1(), line.p2()).normalized().adjusted(-distance, -distance, distance, distance);
+        for (int cy = cellOf(box.top()); cy <= cellOf(box.bottom()); ++cy) {
+            for (int cx = cellOf(box.left()); cx <= cellOf(box.right()); ++cx) {
+                keptByCell[cellKey(cx, cy)].append(index);
+            }
+        }
+    }
+    return kept;
+}
+
+} // namespace
+
+int LineDetector::otsuThreshold(const QImage& gray)
+{
+    const int height = gray.height();
+    const int width = gray.width();
+    const int bandCount = (height + BAND_ROWS - 1) / BAND_ROWS;
+
+    QVector<QVector<qint64>> bandHistograms(bandCount, QVector<qint64>(256, 0));
+    parallelFor(bandCount, [&](int band) {
+        qint64* histogram = bandHistograms[band].data();
+        const int y1 = std::min(height, (band + 1) * BAND_ROWS);
+        for (int y = band * BAND_ROWS; y < y1; ++y) {
+            const uchar* row = gray.constScanLine(y);
+            for (int x = 0; x < width; ++x) {
+                ++histogram[row[x]];
+            }
+        }
+    });
+
+    qint64 histogram[256] = {};
+    for (const QVector<qint64>& bandHistogram : bandHistograms) {
+        for (int i = 0; i < 256; ++i) {
+            histogram[i] += bandHistogram[i];
+        }
+    }
+
+    const double total = static_cast<double>(width) * height;
+    double sumAll = 0.0;
+    for (int i = 0; i < 256; ++i) {
+        sumAll += i * static_cast<double>(histogram[i]);
+    }
+
+    double sumBackground = 0.0;
+    double weightBackground = 0.0;
+    double bestVariance = -1.0;
+    int best = 128;
+    for (int t = 0; t < 256; ++t) {
+        weightBackground += histogram[t];
+        if (weightBackground == 0.0) continue;
+        double weightForeground = total - weightBackground;
+        if (weightForeground == 0.0) break;
+
+        sumBackground += t * static_cast<double>(histogram[t]);
+        double meanBackground = sumBackground / weightBackground;
+        double meanForeground = (sumAll - sumBackground) / weightForeground;
+        double variance = weightBackground * weightForeground *
+                          (meanBackground - meanForeground) * (meanBackground - meanForeground);
+        if (variance > bestVariance) {
+            bestVariance = variance;
+            best = t;
+        }
+    }
+    // Pixels <= best are the dark class
+    return best + 1;
+}
+
+QVector<QLineF> LineDetector::detect(const QImage& image, const Options& options,
+                                     const std::atomic<bool>* cancelled)
+{
+    if (image.isNull()) {
+        return QVector<QLineF>();
+    }
+
+    QImage gray = RasterOps::toGrayscale(image, cancelled);
+    if (gray.isNull() || RasterOps::isCancelled(cancelled)) {
+        return QVector<QLineF>();
+    }
+
+    const int threshold = options.threshold >= 0 ? options.threshold : otsuThreshold(gray);
+    if (threshold <= 0 || threshold > 255) {
+        return QVector<QLineF>();
+    }
+
+    const int width = gray.width();
+    const int height = gray.height();
+    const int bandCount = (height + BAND_ROWS - 1) / BAND_ROWS;
+    const int stripCount = (width + STRIP_COLUMNS - 1) / STRIP_COLUMNS;
+
+    // One result list per tile, so workers never share a container
+    QVector<QVector<Run>> horizontalTiles(bandCount);
+    QVector<QVector<Run>> verticalTiles(stripCount);
+
+    parallelFor(bandCount + stripCount, [&](int tile) {
+        if (RasterOps::isCancelled(cancelled)) return;
+        if (tile < bandCount) {
+            findHorizontalRuns(gray, tile * BAND_ROWS, std::min(height, (tile + 1) * BAND_ROWS),
+                               threshold, options.minLength, horizontalTiles[tile]);
+        } else {
+            int strip = tile - bandCount;
+            findVerticalRuns(gray, strip * STRIP_COLUMNS, std::min(width, (strip + 1) * STRIP_COLUMNS),
+                             threshold, options.minLength, verticalTiles[strip]);
+        }
+    });
+    if (RasterOps::isCancelled(cancelled)) {
+        return QVector<QLineF>();
+    }
+
+    QVector<Run> horizontalRuns;
+    for (const QVector<Run>& tile : horizontalTiles) {
+        horizontalRuns += tile;
+    }
+    QVector<Run> verticalRuns;
+    for (const QVector<Run>& tile : verticalTiles) {
+        verticalRuns += tile;
+    }
+
+    QVector<QRect> lineAreas;
+    QVector<QLineF> segments = mergeRuns(horizontalRuns, true, options.maxThickness, lineAreas);
+    segments += mergeRuns(verticalRuns, false, options.maxThickness, lineAreas);
+    if (!options.obliqueLines) {
+        return segments;
+    }
+
+    // Lines at other angles, on square tiles of the ink those lines leave
+    const int tileColumns = (width + OBLIQUE_TILE - 1) / OBLIQUE_TILE;
+    const int tileRows = (height + OBLIQUE_TILE - 1) / OBLIQUE_TILE;
+    QVector<QVector<QRect>> areaTiles(tileColumns * tileRows);
+    for (const QRect& area : lineAreas) {
+        for (int row = area.top() / OBLIQUE_TILE; row <= area.bottom() / OBLIQUE_TILE; ++row) {
+            for (int column = area.left() / OBLIQUE_TILE; column <= area.right() / OBLIQUE_TILE; ++column) {
+                areaTiles[row * tileColumns + column].append(area);
+            }
+        }
+    }
+
+    QVector<QVector<Piece>> pieceTiles(tileColumns * tileRows);
+    parallelFor(pieceTiles.size(), [&](int tile) {
+        if (RasterOps::isCancelled(cancelled)) return;
+        const int x0 = (tile % tileColumns) * OBLIQUE_TILE;
+        const int y0 = (tile / tileColumns) * OBLIQUE_TILE;
+        const QRect rect(x0, y0, std::min(OBLIQUE_TILE, width - x0), std::min(OBLIQUE_TILE, height - y0));
+        findObliquePieces(gray, rect, threshold, options, areaTiles[tile], pieceTiles[tile]);
+    });
+    if (RasterOps::isCancelled(cancelled)) {
+        return QVector<QLineF>();
+    }
+
+    QVector<Piece> pieces;
+    for (const QVector<Piece>& tile : pieceTiles) {
+        pieces += tile;
+    }
+    QVector<QLineF> obliqueLines;
+    for (const QLineF& line : joinPieces(pieces)) {
+        const QLineF extended = extendAlongInk(gray, threshold, options.maxGap, line, areaTiles, tileColumns);
+        if (extended.length() >= options.minLength) {
+            obliqueLines.append(extended);
+        }
+    }
+    segments += dropContainedLines(obliqueLines, options.maxThickness / 2.0);
+    return segments;
+}
@@ -0,0 +1,56 @@
+#ifndef LINEDETECTOR_H
+#define LINEDETECTOR_H
+
+#include <QImage>
+#include <QLineF>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief Finds straight lines in a raster sheet.
+ *
+ * The page is converted to grayscale and binarized with an Otsu threshold.
+ * Dark pixel runs are then collected row by row (horizontal lines) and
+ * column by column (vertical lines) with SSE2 where available. Adjacent
+ * runs are merged into one centerline segment per drawn line; groups
+ * thicker than maxThickness are treated as fills and dropped.
+ *
+ * Lines at other angles (bracing, sloped members, section cuts) are found
+ * in the ink the runs leave over, with a progressive probabilistic Hough
+ * transform on 512 pixel tiles. The centre pixels of short row and column
+ * runs of that ink act as the edge map, so each oblique line is reported
+ * once along its centre rather than as two edges. Pieces of one line on
+ * neighbouring tiles are joined afterwards.
+ *
+ * All passes are split into tiles and run on the global thread pool.
+ * Segment coordinates are image pixels, i.e. scene coordinates of the
+ * page in BlueprintView.
+ */
+class LineDetector
+{
+public:
+    struct Options {
+        int minLength = 40;         // Shortest run reported, in pixels
+        int maxThickness = 8;       // Thicker runs are fills, not lines
+        int threshold = -1;         // Gray level below which a pixel is ink; -1 = Otsu
+        bool obliqueLines = true;   // Also find lines that are not horizontal or vertical
+        int maxGap = 3;             // Ink gap bridged along an oblique line, in pixels
+    };
+
+    /**
+     * @brief Detect line segments in an image.
+     * @param image Any QImage format; transparent areas count as paper
+     * @param options Detection parameters
+     * @param cancelled Optional flag polled between tiles
+     * @return Detected segments, or an empty list if cancelled
+     */
+    static QVector<QLineF> detect(const QImage& image, const Options& options,
+                                  const std::atomic<bool>* cancelled = nullptr);
+
+    /**
+     * @brief Otsu threshold of an 8-bit grayscale image.
+     */
+    static int otsuThreshold(const QImage& gray);
+};
+
+#endif // LINEDETECTOR_H
@@ -1,5 +1,308 @@
 #include "MathUtils.h"
+
+#include <algorithm>
 #include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MATHUTILS_SSE2
+#endif
+
+// AVX kernels are built for that target only and chosen at run time, so
+// the binary still runs on CPUs without it
+#if defined(MATHUTILS_SSE2) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MATHUTILS_AVX
+#define MATHUTILS_AVX_TARGET __attribute__((target("avx")))
+#endif
+
+static_assert(sizeof(QPointF) == 2 * sizeof(double), "Kernels read QPointF as packed x/y doubles");
+
+namespace {
+
+enum class Level { Scalar, Sse2, Avx };
+
+Level detectLevel()
+{
+#ifdef MATHUTILS_AVX
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) {
+        return Level::Avx;
+    }
+#endif
+#ifdef MATHUTILS_SSE2
+    return Level::Sse2;
+#else
+    return Level::Scalar;
+#endif
+}
+
+Level level()
+{
+    static const Level detected = detectLevel();
+    return detected;
+}
+
+const double* coords(const QPointF* points)
+{
+    return reinterpret_cast<const double*>(points);
+}
+
+// ============================================================================
+// Scalar kernels, also used for the tails of the SIMD loops
+// ============================================================================
+
+double polylineLengthScalar(const double* xy, int count)
+{
+    double total = 0.0;
+    for (int i = 1; i < count; ++i) {
+        const double dx = xy[2 * i] - xy[2 * i - 2];
+        const double dy = xy[2 * i + 1] - xy[2 * i - 1];
+        total += std::sqrt(dx * dx + dy * dy);
+    }
+    return total;
+}
+
+void divideScalar(const double* in, double* out, int count, double divisor)
+{
+    for (int i = 0; i < count; ++i) {
+        out[i] = in[i] / divisor;
+    }
+}
+
+// Grows [minXY, maxXY] by the given points
+void boundsScalar(const double* xy, int count, double* minXY, double* maxXY)
+{
+    for (int i = 0; i < count; ++i) {
+        minXY[0] = std::min(minXY[0], xy[2 * i]);
+        minXY[1] = std::min(minXY[1], xy[2 * i + 1]);
+        maxXY[0] = std::max(maxXY[0], xy[2 * i]);
+        maxXY[1] = std::max(maxXY[1], xy[2 * i + 1]);
+    }
+}
+
+double segmentDistanceSquared(double px, double py, double ax, double ay, double bx, double by)
+{
+    const double dx = bx - ax;
+    const double dy = by - ay;
+    const double wx = px - ax;
+    const double wy = py - ay;
+    const double lengthSquared = dx * dx + dy * dy;
+    double t = lengthSquared > 0.0 ? (wx * dx + wy * dy) / lengthSquared : 0.0;
+    t = std::min(1.0, std::max(0.0, t));
+    const double cx = t * dx - wx;
+    const double cy = t * dy - wy;
+    return cx * cx + cy * cy;
+}
+
+double polylineDistanceSquaredScalar(double px, double py, const double* xy, int count)
+{
+    double best = std::numeric_limits<double>::infinity();
+    for (int i = 1; i < count; ++i) {
+        best = std::min(best, segmentDistanceSquared(px, py, xy[2 * i - 2], xy[2 * i - 1],
+                                                     xy[2 * i], xy[2 * i + 1]));
+    }
+    return best;
+}
+
+// ============================================================================
+// SSE2 kernels, two segments or values per step
+// ============================================================================
+
+#ifdef MATHUTILS_SSE2
+
+double polylineLengthSse2(const double* xy, int count)
+{
+    __m128d sum = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 2 < count; i += 2) {
+        const __m128d p0 = _mm_loadu_pd(xy + 2 * i);
+        const __m128d p1 = _mm_loadu_pd(xy + 2 * i + 2);
+        const __m128d p2 = _mm_loadu_pd(xy + 2 * i + 4);
+        const __m128d d0 = _mm_sub_pd(p1, p0);
+        const __m128d d1 = _mm_sub_pd(p2, p1);
+        const __m128d sq0 = _mm_mul_pd(d0, d0);
+        const __m128d sq1 = _mm_mul_pd(d1, d1);
+        // (dx0², dx1²) + (dy0², dy1²)
+        const __m128d squared = _mm_add_pd(_mm_unpacklo_pd(sq0, sq1), _mm_unpackhi_pd(sq0, sq1));
+        sum = _mm_add_pd(sum, _mm_sqrt_pd(squared));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, sum);
+    return lanes[0] + lanes[1] + polylineLengthScalar(xy + 2 * i, count - i);
+}
+
+void divideSse2(const double* in, double* out, int count, double divisor)
+{
+    const __m128d d = _mm_set1_pd(divisor);
+    int i = 0;
+    for (; i + 2 <= count; i += 2) {
+        _mm_storeu_pd(out + i, _mm_div_pd(_mm_loadu_pd(in + i), d));
+    }
+    divideScalar(in + i, out + i, count - i, divisor);
+}
+
+void boundsSse2(const double* xy, int count, double* minXY, double* maxXY)
+{
+    // Points are (x, y) pairs, so one register holds both axes
+    __m128d lo = _mm_loadu_pd(minXY);
+    __m128d hi = _mm_loadu_pd(maxXY);
+    for (int i = 0; i < count; ++i) {
+        const __m128d p = _mm_loadu_pd(xy + 2 * i);
+        lo = _mm_min_pd(lo, p);
+        hi = _mm_max_pd(hi, p);
+    }
+    _mm_storeu_pd(minXY, lo);
+    _mm_storeu_pd(maxXY, hi);
+}
+
+double polylineDistanceSquaredSse2(double px, double py, const double* xy, int count)
+{
+    const __m128d x = _mm_set1_pd(px);
+    const __m128d y = _mm_set1_pd(py);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d best = _mm_set1_pd(std::numeric_limits<double>::infinity());
+
+    int i = 0;
+    for (; i + 2 < count; i += 2) {
+        const __m128d p0 = _mm_loadu_pd(xy + 2 * i);
+        const __m128d p1 = _mm_loadu_pd(xy + 2 * i + 2);
+        const __m128d p2 = _mm_loadu_pd(xy + 2 * i + 4);
+        const __m128d ax = _mm_unpacklo_pd(p0, p1);
+        const __m128d ay = _mm_unpackhi_pd(p0, p1);
+        const __m128d dx = _mm_sub_pd(_mm_unpacklo_pd(p1, p2), ax);
+        const __m128d dy = _mm_sub_pd(_mm_unpackhi_pd(p1, p2), ay);
+        const __m128d wx = _mm_sub_pd(x, ax);
+        const __m128d wy = _mm_sub_pd(y, ay);
+
+        const __m128d dot = _mm_add_pd(_mm_mul_pd(wx, dx), _mm_mul_pd(wy, dy));
+        const __m128d lengthSquared = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+        // min returns its second operand for NaN, so a zero-length
+        // segment clamps to t = 1, its only point
+        const __m128d t = _mm_max_pd(_mm_min_pd(_mm_div_pd(dot, lengthSquared), one), zero);
+
+        const __m128d cx = _mm_sub_pd(_mm_mul_pd(t, dx), wx);
+        const __m128d cy = _mm_sub_pd(_mm_mul_pd(t, dy), wy);
+        best = _mm_min_pd(best, _mm_add_pd(_mm_mul_pd(cx, cx), _mm_mul_pd(cy, cy)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, best);
+    return std::min({lanes[0], lanes[1], polylineDistanceSquaredScalar(px, py, xy + 2 * i, count - i)});
+}
+
+#endif // MATHUTILS_SSE2
+
+// ============================================================================
+// AVX kernels, four segments or values per step
+// ============================================================================
+
+#ifdef MATHUTILS_AVX
+
+MATHUTILS_AVX_TARGET double polylineLengthAvx(const double* xy, int count)
+{
+    __m256d sum = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 4 < count; i += 4) {
+        const __m256d d01 = _mm256_sub_pd(_mm256_loadu_pd(xy + 2 * i + 2), _mm256_loadu_pd(xy + 2 * i));
+        const __m256d d23 = _mm256_sub_pd(_mm256_loadu_pd(xy + 2 * i + 6), _mm256_loadu_pd(xy + 2 * i + 4));
+        // (|d0|², |d2|², |d1|², |d3|²); the order does not matter for a sum
+        const __m256d squared = _mm256_hadd_pd(_mm256_mul_pd(d01, d01), _mm256_mul_pd(d23, d23));
+        sum = _mm256_add_pd(sum, _mm256_sqrt_pd(squared));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + polylineLengthScalar(xy + 2 * i, count - i);
+}
+
+MATHUTILS_AVX_TARGET void divideAvx(const double* in, double* out, int count, double divisor)
+{
+    const __m256d d = _mm256_set1_pd(divisor);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_loadu_pd(in + i), d));
+    }
+    divideScalar(in + i, out + i, count - i, divisor);
+}
+
+MATHUTILS_AVX_TARGET void boundsAvx(const double* xy, int count, double* minXY, double* maxXY)
+{
+    const __m128d startLo = _mm_loadu_pd(minXY);
+    const __m128d startHi = _mm_loadu_pd(maxXY);
+    __m256d lo = _mm256_insertf128_pd(_mm256_castpd128_pd256(startLo), startLo, 1);
+    __m256d hi = _mm256_insertf128_pd(_mm256_castpd128_pd256(startHi), startHi, 1);
+    int i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m256d p = _mm256_loadu_pd(xy + 2 * i);
+        lo = _mm256_min_pd(lo, p);
+        hi = _mm256_max_pd(hi, p);
+    }
+    _mm_storeu_pd(minXY, _mm_min_pd(_mm256_castpd256_pd128(lo), _mm256_extractf128_pd(lo, 1)));
+    _mm_storeu_pd(maxXY, _mm_max_pd(_mm256_castpd256_pd128(hi), _mm256_extractf128_pd(hi, 1)));
+    boundsScalar(xy + 2 * i, count - i, minXY, maxXY);
+}
+
+MATHUTILS_AVX_TARGET double polylineDistanceSquaredAvx(double px, double py, const double* xy, int count)
+{
+    const __m256d x = _mm256_set1_pd(px);
+    const __m256d y = _mm256_set1_pd(py);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    __m256d best = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+
+    int i = 0;
+    for (; i + 4 < count; i += 4) {
+        // Unpacking works within 128-bit halves, so the lanes hold
+        // segments 0, 2, 1, 3; starts and ends line up either way
+        const __m256d a01 = _mm256_loadu_pd(xy + 2 * i);
+        const __m256d a23 = _mm256_loadu_pd(xy + 2 * i + 4);
+        const __m256d b01 = _mm256_loadu_pd(xy + 2 * i + 2);
+        const __m256d b23 = _mm256_loadu_pd(xy + 2 * i + 6);
+        const __m256d ax = _mm256_unpacklo_pd(a01, a23);
+        const __m256d ay = _mm256_unpackhi_pd(a01, a23);
+        const __m256d dx = _mm256_sub_pd(_mm256_unpacklo_pd(b01, b23), ax);
+        const __m256d dy = _mm256_sub_pd(_mm256_unpackhi_pd(b01, b23), ay);
+        const __m256d wx = _mm256_sub_pd(x, ax);
+        const __m256d wy = _mm256_sub_pd(y, ay);
+
+        const __m256d dot = _mm256_add_pd(_mm256_mul_pd(wx, dx), _mm256_mul_pd(wy, dy));
+        const __m256d lengthSquared = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        const __m256d t = _mm256_max_pd(_mm256_min_pd(_mm256_div_pd(dot, lengthSquared), one), zero);
+
+        const __m256d cx = _mm256_sub_pd(_mm256_mul_pd(t, dx), wx);
+        const __m256d cy = _mm256_sub_pd(_mm256_mul_pd(t, dy), wy);
+        best = _mm256_min_pd(best, _mm256_add_pd(_mm256_mul_pd(cx, cx), _mm256_mul_pd(cy, cy)));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, best);
+    return std::min({lanes[0], lanes[1], lanes[2], lanes[3],
+                     polylineDistanceSquaredScalar(px, py, xy + 2 * i, count - i)});
+}
+
+#endif // MATHUTILS_AVX
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+using LengthKernel = double (*)(const double*, int);
+
+LengthKernel lengthKernel()
+{
+    switch (level()) {
+#ifdef MATHUTILS_AVX
+        case Level::Avx: return polylineLengthAvx;
+#endif
+#ifdef MATHUTILS_SSE2
+        case Level::Sse2: return polylineLengthSse2;
+#endif
+        default: return polylineLengthScalar;
+    }
+}
+
+} // namespace
 
 double MathUtils::distance(const QPointF& p1, const QPointF& p2)
 {
@@ -10,14 +313,94 @@ double MathUtils::distance(const QPointF& p1, const QPointF& p2)
 
 double MathUtils::polylineLength(const QVector<QPointF>& points)
 {
-    if (points.size() < 2) {
+    return polylineLength(PointSpan(points));
+}
+
+double MathUtils::polylineLength(PointSpan points)
+{
+    if (points.size < 2) {
         return 0.0;
     }
+    return lengthKernel()(coords(points.data), points.size);
+}
+
+void MathUtils::polylineLengths(const QPointF* points, const int* offsets, const int* counts,
+                                int polylineCount, double* lengths)
+{
+    const LengthKernel kernel = lengthKernel();
+    const double* xy = coords(points);
+    for (int i = 0; i < polylineCount; ++i) {
+        lengths[i] = counts[i] < 2 ? 0.0 : kernel(xy + 2 * offsets[i], counts[i]);
+    }
+}
+
+void MathUtils::pixelsToInches(const double* pixels, double* inches, int count, double pixelsPerInch)
+{
+    switch (level()) {
+#ifdef MATHUTILS_AVX
+        case Level::Avx: divideAvx(pixels, inches, count, pixelsPerInch); return;
+#endif
+#ifdef MATHUTILS_SSE2
+        case Level::Sse2: divideSse2(pixels, inches, count, pixelsPerInch); return;
+#endif
+        default: divideScalar(pixels, inches, count, pixelsPerInch); return;
+    }
+}
+
+QRectF MathUtils::boundingRect(PointSpan points)
+{
+    if (points.isEmpty()) {
+        return QRectF();
+    }
+
+    const double* xy = coords(points.data);
+    double minXY[2] = {xy[0], xy[1]};
+    double maxXY[2] = {xy[0], xy[1]};
+    switch (level()) {
+#ifdef MATHUTILS_AVX
+        case Level::Avx: boundsAvx(xy, points.size, minXY, maxXY); break;
+#endif
+#ifdef MATHUTILS_SSE2
+        case Level::Sse2: boundsSse2(xy, points.size, minXY, maxXY); break;
+#endif
+        default: boundsScalar(xy, points.size, minXY, maxXY); break;
+    }
+    return QRectF(QPointF(minXY[0], minXY[1]), QPointF(maxXY[0], maxXY[1]));
+}
+
+double MathUtils::distanceToSegment(const QPointF& p, const QPointF& a, const QPointF& b)
+{
+    return std::sqrt(segmentDistanceSquared(p.x(), p.y(), a.x(), a.y(), b.x(), b.y()));
+}
+
+double MathUtils::distanceToPolyline(const QPointF& p, PointSpan points)
+{
+    if (points.isEmpty()) {
+        return std::numeric_limits<double>::infinity();
+    }
+    if (points.size == 1) {
+        return distance(p, points[0]);
+    }
 
-    double totalLength = 0.0;
-    for (int i = 1; i < points.size(); ++i) {
-        totalLength += distance(points[i - 1], points[i]);
+    const double* xy = coords(points.data);
+    double best;
+    switch (level()) {
+#ifdef MATHUTILS_AVX
+        case Level::Avx: best = polylineDistanceSquaredAvx(p.x(), p.y(), xy, points.size); break;
+#endif
+#ifdef MATHUTILS_SSE2
+        case Level::Sse2: best = polylineDistanceSquaredSse2(p.x(), p.y(), xy, points.size); break;
+#endif
+        default: best = polylineDistanceSquaredScalar(p.x(), p.y(), xy, points.size); break;
     }
-    return totalLength;
+    return std::sqrt(best);
 }
 
+const char* MathUtils::kernelLevel()
+{
+    switch (level()) {
+        case Level::Avx: return "avx";
+        case Level::Sse2: return "sse2";
+        default: return "scalar";
+    }
+}
@@ -2,10 +2,18 @@
 #define MATHUTILS_H
 
 #include <QPointF>
+#include <QRectF>
 #include <QVector>
 
+#include "GeometryArena.h"
+
 /**
  * @brief Utility class for mathematical operations on points.
+ *
+ * The batch kernels read points as packed x/y doubles, as stored in a
+ * GeometryArena. They use AVX when the CPU has it and SSE2 otherwise;
+ * the choice is made once at run time, and builds for other targets use
+ * the scalar code.
  */
 class MathUtils
 {
@@ -24,7 +32,49 @@ public:
      * @return Total length of all segments
      */
     static double polylineLength(const QVector<QPointF>& points);
+    static double polylineLength(PointSpan points);
+
+    /**
+     * @brief Calculate the lengths of many polylines packed in one buffer.
+     * @param points Shared point buffer
+     * @param offsets First point of each polyline
+     * @param counts Number of points of each polyline
+     * @param polylineCount Number of polylines
+     * @param lengths Receives one length per polyline
+     */
+    static void polylineLengths(const QPointF* points, const int* offsets, const int* counts,
+                                int polylineCount, double* lengths);
+
+    /**
+     * @brief Convert pixel distances to inches.
+     * @param pixels Distances in pixels
+     * @param inches Receives the distances in inches; may equal pixels
+     * @param count Number of values
+     * @param pixelsPerInch Scale, greater than zero
+     */
+    static void pixelsToInches(const double* pixels, double* inches, int count, double pixelsPerInch);
+
+    /**
+     * @brief Smallest rectangle containing all points.
+     * @return Null rectangle for an empty span
+     */
+    static QRectF boundingRect(PointSpan points);
+
+    /**
+     * @brief Distance from a point to the closest point of a segment.
+     */
+    static double distanceToSegment(const QPointF& p, const QPointF& a, const QPointF& b);
+
+    /**
+     * @brief Distance from a point to the closest segment of a polyline.
+     * @return Distance to the only point for a single point, infinity for none
+     */
+    static double distanceToPolyline(const QPointF& p, PointSpan points);
+
+    /**
+     * @brief Instruction set used by the batch kernels: "avx", "sse2" or "scalar".
+     */
+    static const char* kernelLevel();
 };
 
 #endif // MATHUTILS_H
-
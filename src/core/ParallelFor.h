@@ -0,0 +1,85 @@
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace ParallelDetail {
+
+class Task : public QRunnable
+{
+public:
+    explicit Task(std::function<void()> fn)
+        : m_fn(std::move(fn))
+    {
+        setAutoDelete(false);
+    }
+
+    void run() override { m_fn(); }
+
+private:
+    std::function<void()> m_fn;
+};
+
+} // namespace ParallelDetail
+
+/**
+ * @brief Call fn(i) for every i in [0, count) on the global thread pool.
+ *
+ * Indexes are handed out dynamically, so uneven tiles balance themselves.
+ * The calling thread works too and the call returns when every index is
+ * done. Helpers that are still queued once the work runs out are taken
+ * back from the pool, which keeps nested calls from pool threads from
+ * deadlocking on a saturated pool.
+ */
+template <typename Fn>
+void parallelFor(int count, Fn&& fn)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    QThreadPool* pool = QThreadPool::globalInstance();
+    const int helperCount = std::min(count, pool->maxThreadCount()) - 1;
+
+    std::atomic<int> next(0);
+    auto work = [&]() {
+        for (int i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+
+    if (helperCount <= 0) {
+        work();
+        return;
+    }
+
+    QSemaphore finished;
+    std::vector<std::unique_ptr<ParallelDetail::Task>> helpers;
+    helpers.reserve(helperCount);
+    for (int h = 0; h < helperCount; ++h) {
+        helpers.emplace_back(new ParallelDetail::Task([&]() {
+            work();
+            finished.release();
+        }));
+        pool->start(helpers.back().get());
+    }
+
+    work();
+
+    int started = 0;
+    for (const auto& helper : helpers) {
+        if (!pool->tryTake(helper.get())) {
+            ++started;
+        }
+    }
+    finished.acquire(started);
+}
+
+#endif // PARALLELFOR_H
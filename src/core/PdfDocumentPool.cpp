@@ -0,0 +1,199 @@
+#include "PdfDocumentPool.h"
+
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <algorithm>
+
+// ============================================================================
+// Lease
+// ============================================================================
+
+PdfDocumentPool::Lease::Lease(PdfDocumentPool* pool, PdfRenderer* renderer)
+    : m_pool(pool)
+    , m_renderer(renderer)
+{
+}
+
+PdfDocumentPool::Lease::Lease(Lease&& other) noexcept
+    : m_pool(other.m_pool)
+    , m_renderer(other.m_renderer)
+{
+    other.m_pool = nullptr;
+    other.m_renderer = nullptr;
+}
+
+PdfDocumentPool::Lease& PdfDocumentPool::Lease::operator=(Lease&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_pool = other.m_pool;
+        m_renderer = other.m_renderer;
+        other.m_pool = nullptr;
+        other.m_renderer = nullptr;
+    }
+    return *this;
+}
+
+PdfDocumentPool::Lease::~Lease()
+{
+    release();
+}
+
+void PdfDocumentPool::Lease::release()
+{
+    if (m_pool && m_renderer) {
+        m_pool->release(m_renderer);
+    }
+    m_pool = nullptr;
+    m_renderer = nullptr;
+}
+
+// ============================================================================
+// Pool
+// ============================================================================
+
+PdfDocumentPool& PdfDocumentPool::instance()
+{
+    static PdfDocumentPool pool;
+    return pool;
+}
+
+PdfDocumentPool::PdfDocumentPool()
+    : m_clock(0)
+    , m_maxDocuments(DEFAULT_MAX_DOCUMENTS)
+    , m_maxBytes(DEFAULT_MAX_BYTES)
+{
+}
+
+PdfDocumentPool::~PdfDocumentPool() = default;
+
+PdfDocumentPool::Lease PdfDocumentPool::acquire(const QString& path, QString* error)
+{
+    const QFileInfo info(path);
+    const QDateTime modified = info.lastModified();
+    std::vector<std::unique_ptr<PdfRenderer>> evicted;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        for (Entry& entry : m_entries) {
+            if (entry.leased || entry.path != path) {
+                continue;
+            }
+            if (entry.modified != modified) {
+                entry.stale = true;
+                continue;
+            }
+            entry.leased = true;
+            entry.lastUsed = ++m_clock;
+            return Lease(this, entry.renderer.get());
+        }
+        evicted = takeEvicted();
+    }
+    evicted.clear();
+
+    // Parsing can take a while, so other threads keep using the pool meanwhile
+    auto renderer = std::make_unique<PdfRenderer>();
+    if (!renderer->openPdf(path)) {
+        if (error) {
+            *error = renderer->lastError();
+        }
+        return Lease();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    Entry entry;
+    entry.path = path;
+    entry.modified = modified;
+    entry.renderer = std::move(renderer);
+    entry.cost = info.size();
+    entry.lastUsed = ++m_clock;
+    entry.leased = true;
+    PdfRenderer* leased = entry.renderer.get();
+    m_entries.push_back(std::move(entry));
+    return Lease(this, leased);
+}
+
+void PdfDocumentPool::release(PdfRenderer* renderer)
+{
+    std::vector<std::unique_ptr<PdfRenderer>> evicted;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (Entry& entry : m_entries) {
+            if (entry.renderer.get() == renderer) {
+                entry.leased = false;
+                entry.lastUsed = ++m_clock;
+                break;
+            }
+        }
+        evicted = takeEvicted();
+    }
+}
+
+void PdfDocumentPool::setLimits(int maxDocuments, qint64 maxBytes)
+{
+    std::vector<std::unique_ptr<PdfRenderer>> evicted;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_maxDocuments = std::max(0, maxDocuments);
+        m_maxBytes = std::max<qint64>(0, maxBytes);
+        evicted = takeEvicted();
+    }
+}
+
+void PdfDocumentPool::clear()
+{
+    std::vector<std::unique_ptr<PdfRenderer>> evicted;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (Entry& entry : m_entries) {
+            entry.stale = true;
+        }
+        evicted = takeEvicted();
+    }
+}
+
+int PdfDocumentPool::openCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_entries.size());
+}
+
+std::vector<std::unique_ptr<PdfRenderer>> PdfDocumentPool::takeEvicted()
+{
+    std::vector<std::unique_ptr<PdfRenderer>> evicted;
+
+    auto removeAt = [&](size_t index) {
+        evicted.push_back(std::move(m_entries[index].renderer));
+        m_entries.erase(m_entries.begin() + static_cast<std::ptrdiff_t>(index));
+    };
+
+    for (size_t i = m_entries.size(); i-- > 0;) {
+        if (!m_entries[i].leased && m_entries[i].stale) {
+            removeAt(i);
+        }
+    }
+
+    // Leased documents count towards the limits but are never closed, so
+    // stop once only leased ones are left over
+    for (;;) {
+        int idleCount = 0;
+        qint64 totalCost = 0;
+        size_t oldest = m_entries.size();
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            totalCost += m_entries[i].cost;
+            if (m_entries[i].leased) {
+                continue;
+            }
+            ++idleCount;
+            if (oldest == m_entries.size() || m_entries[i].lastUsed < m_entries[oldest].lastUsed) {
+                oldest = i;
+            }
+        }
+        const bool overLimit = static_cast<int>(m_entries.size()) > m_maxDocuments || totalCost > m_maxBytes;
+        if (!overLimit || idleCount == 0) {
+            break;
+        }
+        removeAt(oldest);
+    }
+    return evicted;
+}
@@ -0,0 +1,116 @@
+#ifndef PDFDOCUMENTPOOL_H
+#define PDFDOCUMENTPOOL_H
+
+#include <QDateTime>
+#include <QMutex>
+#include <QString>
+#include <memory>
+#include <vector>
+
+#include "PdfRenderer.h"
+
+/**
+ * @brief Keeps recently used PDF documents open across page switches.
+ *
+ * Opening a PDF parses its cross-reference table and page tree, which for
+ * large drawing sets costs far more than rendering one sheet. The pool
+ * keeps the most recently used documents open, keyed by path, and hands
+ * them out as exclusive leases. A document is never used by two threads
+ * at once: if every open copy of a file is leased, another one is opened,
+ * so several render threads can work on the same set in parallel.
+ *
+ * Idle documents are closed least recently used first once the pool holds
+ * more than maxDocuments or the estimated size of all open documents (their
+ * file sizes) exceeds maxBytes. Documents whose file changed on disk are
+ * reopened.
+ * All methods are thread-safe.
+ */
+class PdfDocumentPool
+{
+public:
+    /**
+     * @brief Exclusive use of an open document, returned to the pool on
+     * destruction.
+     */
+    class Lease
+    {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        bool isValid() const { return m_renderer != nullptr; }
+        PdfRenderer* operator->() const { return m_renderer; }
+        PdfRenderer& renderer() const { return *m_renderer; }
+
+    private:
+        friend class PdfDocumentPool;
+        Lease(PdfDocumentPool* pool, PdfRenderer* renderer);
+        void release();
+
+        PdfDocumentPool* m_pool = nullptr;
+        PdfRenderer* m_renderer = nullptr;
+    };
+
+    static const int DEFAULT_MAX_DOCUMENTS = 8;
+    static const qint64 DEFAULT_MAX_BYTES = 512LL * 1024 * 1024;
+
+    /**
+     * @brief Get the application-wide pool.
+     */
+    static PdfDocumentPool& instance();
+
+    PdfDocumentPool();
+    ~PdfDocumentPool();
+
+    /**
+     * @brief Lease an open document for a PDF file.
+     * @param path Path to the PDF file
+     * @param error Receives the open error if the lease is invalid
+     * @return A lease, invalid if the file could not be opened
+     */
+    Lease acquire(const QString& path, QString* error = nullptr);
+
+    /**
+     * @brief Set the limits for idle documents kept open.
+     */
+    void setLimits(int maxDocuments, qint64 maxBytes);
+
+    /**
+     * @brief Close all idle documents. Leased documents close when returned.
+     */
+    void clear();
+
+    /**
+     * @brief Get the number of documents currently open, leased or idle.
+     */
+    int openCount() const;
+
+private:
+    struct Entry {
+        QString path;
+        QDateTime modified;
+        std::unique_ptr<PdfRenderer> renderer;
+        qint64 cost = 0;
+        quint64 lastUsed = 0;
+        bool leased = false;
+        bool stale = false;   // Close when returned
+    };
+
+    void release(PdfRenderer* renderer);
+
+    // Removes idle entries over the limits; the caller destroys them after
+    // unlocking so documents are never closed under the pool lock
+    std::vector<std::unique_ptr<PdfRenderer>> takeEvicted();
+
+    mutable QMutex m_mutex;
+    std::vector<Entry> m_entries;
+    quint64 m_clock;
+    int m_maxDocuments;
+    qint64 m_maxBytes;
+};
+
+#endif // PDFDOCUMENTPOOL_H
@@ -0,0 +1,159 @@
+#include "PdfImporter.h"
+#include "PdfDocumentPool.h"
+#include "ParallelFor.h"
+#include "RasterOps.h"
+
+#include <QBuffer>
+#include <QMutex>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <algorithm>
+
+namespace {
+
+QByteArray encodePng(const QImage& image)
+{
+    QByteArray png;
+    QBuffer buffer(&png);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, "PNG")) {
+        return QByteArray();
+    }
+    return png;
+}
+
+// Rendered thumbnails waiting for PNG encoding, filled by the pdfium thread
+class EncodeQueue
+{
+public:
+    void push(int index)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_indexes.append(index);
+        m_ready.wakeOne();
+    }
+
+    void finish()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_finished = true;
+        m_ready.wakeAll();
+    }
+
+    // Next index to encode, or -1 once rendering finished and all are taken
+    int pop()
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_next == m_indexes.size() && !m_finished) {
+            m_ready.wait(&m_mutex);
+        }
+        return m_next < m_indexes.size() ? m_indexes[m_next++] : -1;
+    }
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_ready;
+    QVector<int> m_indexes;
+    int m_next = 0;
+    bool m_finished = false;
+};
+
+} // namespace
+
+bool PdfImporter::import(const QString& path, int firstIndex, int lastIndex,
+                         const std::atomic<bool>* cancelled, const ProgressCallback& progress)
+{
+    m_pages.clear();
+    m_cancelled = false;
+    m_lastError.clear();
+
+    PdfDocumentPool::Lease document = PdfDocumentPool::instance().acquire(path, &m_lastError);
+    if (!document.isValid()) {
+        return false;
+    }
+    PdfRenderer& renderer = document.renderer();
+    const int totalPages = renderer.pageCount();
+
+    if (firstIndex < 0 || lastIndex >= totalPages || firstIndex > lastIndex) {
+        m_lastError = QString("Page range %1-%2 is outside the document (%3 pages)")
+            .arg(firstIndex + 1).arg(lastIndex + 1).arg(totalPages);
+        return false;
+    }
+
+    const int count = lastIndex - firstIndex + 1;
+    const int encoders = std::max(1, std::min(count, QThreadPool::globalInstance()->maxThreadCount() - 1));
+
+    QVector<ImportedPage> pages(count);
+    QVector<QImage> thumbnails(count);
+    QString renderError;
+    EncodeQueue queue;
+    std::atomic<int> done(0);
+
+    // Task 0 drives pdfium and the others encode. Tasks are only handed to
+    // threads that are running, so encoders never wait on a renderer that
+    // has not started; if no helper got a slot, the caller encodes last.
+    parallelFor(1 + encoders, [&](int task) {
+        if (task == 0) {
+            for (int i = 0; i < count && !RasterOps::isCancelled(cancelled); ++i) {
+                const int pageIndex = firstIndex + i;
+                const QSizeF size = renderer.pageSize(pageIndex);
+                if (size.isEmpty()) {
+                    renderError = QString("Page %1 has no valid size").arg(pageIndex + 1);
+                    break;
+                }
+
+                ImportedPage& imported = pages[i];
+                imported.page = Page::createPdfPage(path, pageIndex, totalPages);
+                imported.page.setSourceSize(size);
+
+                const double thumbnailDpi = THUMBNAIL_SIZE * 72.0 / std::max(size.width(), size.height());
+                thumbnails[i] = renderer.renderPage(pageIndex, thumbnailDpi);
+
+                imported.words = renderer.extractWords(pageIndex);
+                imported.textExtracted = true;
+                queue.push(i);
+            }
+            queue.finish();
+            return;
+        }
+
+        for (int i = queue.pop(); i >= 0; i = queue.pop()) {
+            pages[i].thumbnailPng = encodePng(thumbnails[i]);
+            thumbnails[i] = QImage();
+
+            const int finished = ++done;
+            if (progress) {
+                progress(finished);
+            }
+        }
+    });
+
+    if (RasterOps::isCancelled(cancelled)) {
+        m_cancelled = true;
+        m_lastError = "Import cancelled";
+        return false;
+    }
+
+    if (!renderError.isEmpty()) {
+        m_lastError = renderError;
+        return false;
+    }
+
+    m_pages = pages;
+    return true;
+}
+
+QVector<ImportedPage> PdfImporter::pages() const
+{
+    return m_pages;
+}
+
+bool PdfImporter::wasCancelled() const
+{
+    return m_cancelled;
+}
+
+QString PdfImporter::lastError() const
+{
+    return m_lastError;
+}
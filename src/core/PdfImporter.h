@@ -0,0 +1,74 @@
+#ifndef PDFIMPORTER_H
+#define PDFIMPORTER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+#include "PdfRenderer.h"
+#include "ImportedPage.h"
+
+/**
+ * @brief Reads a range of PDF pages for import on the global thread pool.
+ *
+ * For every page the size is validated and recorded, a thumbnail is
+ * rendered and the text layer is extracted, so nothing has to be rendered
+ * or indexed after the import.
+ *
+ * QtPdf serializes every pdfium call behind one process-wide mutex, so
+ * rendering from several threads, even on separate documents, runs one
+ * page at a time. The calling thread therefore drives pdfium alone on a
+ * single leased document (page size, thumbnail raster, text and word
+ * boxes) and hands each raster to pool threads for PNG encoding, the only
+ * step that scales with cores. Import time is bounded by the pdfium work
+ * per page.
+ *
+ * Nothing is written to the project: the caller stores the result with
+ * ProjectDatabase::insertImportedPages() once the whole range succeeded.
+ */
+class PdfImporter
+{
+public:
+    /// Longest side of the generated thumbnails, in pixels
+    static const int THUMBNAIL_SIZE = 160;
+
+    /// Called from worker threads with the number of pages done so far
+    using ProgressCallback = std::function<void(int done)>;
+
+    /**
+     * @brief Read pages [firstIndex, lastIndex] of a PDF.
+     * @param path Path to the PDF file
+     * @param firstIndex 0-based first page
+     * @param lastIndex 0-based last page, inclusive
+     * @param cancelled Optional flag polled between pages
+     * @param progress Optional callback; must be thread-safe
+     * @return true if every page was read; false on error or cancellation
+     */
+    bool import(const QString& path, int firstIndex, int lastIndex,
+                const std::atomic<bool>* cancelled = nullptr,
+                const ProgressCallback& progress = ProgressCallback());
+
+    /**
+     * @brief Get the pages read by the last successful import, in order.
+     */
+    QVector<ImportedPage> pages() const;
+
+    /**
+     * @brief Check if the last import stopped because it was cancelled.
+     */
+    bool wasCancelled() const;
+
+    /**
+     * @brief Get the last error message.
+     */
+    QString lastError() const;
+
+private:
+    QVector<ImportedPage> m_pages;
+    bool m_cancelled = false;
+    QString m_lastError;
+};
+
+#endif // PDFIMPORTER_H
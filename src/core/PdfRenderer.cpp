@@ -1,7 +1,10 @@
 #include "PdfRenderer.h"
+#include "Trace.h"
 
 #ifdef HAS_QT_PDF
 #include <QPdfDocument>
+#include <QPdfDocumentRenderOptions>
+#include <QPdfSelection>
 #endif
 
 #include <QSizeF>
@@ -93,6 +96,7 @@ QString PdfRenderer::currentPath() const
 
 QImage PdfRenderer::renderPage(int pageIndex, double dpi) const
 {
+    TAKEOFF_TRACE_SCOPE("PdfRenderer::renderPage");
 #ifdef HAS_QT_PDF
     if (!isOpen()) {
         m_lastError = "No PDF document loaded";
@@ -133,6 +137,101 @@ QImage PdfRenderer::renderPage(int pageIndex, double dpi) const
 #endif
 }
 
+QImage PdfRenderer::renderRegion(int pageIndex, double dpi, const QRect& region) const
+{
+    TAKEOFF_TRACE_SCOPE("PdfRenderer::renderRegion");
+#ifdef HAS_QT_PDF
+    if (!isOpen()) {
+        m_lastError = "No PDF document loaded";
+        return QImage();
+    }
+
+    if (pageIndex < 0 || pageIndex >= m_document->pageCount()) {
+        m_lastError = QString("Invalid page index: %1").arg(pageIndex);
+        return QImage();
+    }
+
+    const QSizeF pageSizePoints = m_document->pagePointSize(pageIndex);
+    const double scale = dpi / 72.0;
+    const QSize pixelSize(
+        static_cast<int>(pageSizePoints.width() * scale),
+        static_cast<int>(pageSizePoints.height() * scale)
+    );
+
+    const QRect clip = region & QRect(QPoint(0, 0), pixelSize);
+    if (clip.isEmpty()) {
+        m_lastError = "Region is outside the page";
+        return QImage();
+    }
+
+    // The page is laid out at the full size and only the clip is rasterized
+    QPdfDocumentRenderOptions options;
+    options.setScaledSize(pixelSize);
+    options.setScaledClipRect(clip);
+    QImage image = m_document->render(pageIndex, clip.size(), options);
+
+    if (image.isNull()) {
+        m_lastError = "Failed to render PDF page";
+        return QImage();
+    }
+
+    m_lastError.clear();
+    return image;
+#else
+    Q_UNUSED(pageIndex);
+    Q_UNUSED(dpi);
+    Q_UNUSED(region);
+    m_lastError = "PDF support is not available";
+    return QImage();
+#endif
+}
+
+QVector<PdfWord> PdfRenderer::extractWords(int pageIndex, double dpi) const
+{
+    TAKEOFF_TRACE_SCOPE("PdfRenderer::extractWords");
+    QVector<PdfWord> words;
+#ifdef HAS_QT_PDF
+    if (!isOpen() || pageIndex < 0 || pageIndex >= m_document->pageCount()) {
+        m_lastError = QString("Invalid page index: %1").arg(pageIndex);
+        return words;
+    }
+
+    const QString text = m_document->getAllText(pageIndex).text();
+    const double scale = dpi / 72.0;
+
+    // Character indexes of getAllText() match getSelectionAtIndex(), so
+    // each whitespace-separated word is located by its index range
+    int start = -1;
+    for (int i = 0; i <= text.size(); ++i) {
+        bool space = i == text.size() || text.at(i).isSpace();
+        if (!space) {
+            if (start < 0) start = i;
+            continue;
+        }
+        if (start < 0) {
+            continue;
+        }
+
+        QPdfSelection selection = m_document->getSelectionAtIndex(pageIndex, start, i - start);
+        QRectF bounds = selection.boundingRectangle();
+        if (selection.isValid() && !bounds.isEmpty()) {
+            PdfWord word;
+            word.text = text.mid(start, i - start);
+            word.rect = QRectF(bounds.x() * scale, bounds.y() * scale,
+                               bounds.width() * scale, bounds.height() * scale);
+            words.append(word);
+        }
+        start = -1;
+    }
+    m_lastError.clear();
+#else
+    Q_UNUSED(pageIndex);
+    Q_UNUSED(dpi);
+    m_lastError = "PDF support is not available";
+#endif
+    return words;
+}
+
 QSizeF PdfRenderer::pageSize(int pageIndex) const
 {
 #ifdef HAS_QT_PDF
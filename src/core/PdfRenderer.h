@@ -3,8 +3,12 @@
 
 #include <QString>
 #include <QImage>
+#include <QRectF>
+#include <QVector>
 #include <memory>
 
+#include "PdfWord.h"
+
 #ifdef HAS_QT_PDF
 class QPdfDocument;
 #endif
@@ -17,6 +21,9 @@ class QPdfDocument;
 class PdfRenderer
 {
 public:
+    /// Resolution pages are rendered at; PDF scene coordinates use this scale
+    static constexpr double DEFAULT_DPI = 150.0;
+
     PdfRenderer();
     ~PdfRenderer();
 
@@ -57,7 +64,27 @@ public:
      * @param dpi Resolution in dots per inch (default 150)
      * @return Rendered image, or null image on error
      */
-    QImage renderPage(int pageIndex, double dpi = 150.0) const;
+    QImage renderPage(int pageIndex, double dpi = DEFAULT_DPI) const;
+
+    /**
+     * @brief Render part of a page.
+     * @param pageIndex 0-based page index
+     * @param dpi Resolution of the whole page the region is cut from
+     * @param region Area to render, in pixels of the page at that resolution
+     * @return Image of region's size, or null image on error
+     *
+     * Only the region is rasterized, so zoomed-in views can be rendered at
+     * high resolution without rendering the whole sheet.
+     */
+    QImage renderRegion(int pageIndex, double dpi, const QRect& region) const;
+
+    /**
+     * @brief Extract the words of a page's text layer with their positions.
+     * @param pageIndex 0-based page index
+     * @param dpi Resolution the word rectangles are scaled to
+     * @return Words in reading order; empty for scanned pages or on error
+     */
+    QVector<PdfWord> extractWords(int pageIndex, double dpi = DEFAULT_DPI) const;
 
     /**
      * @brief Get the size of a page in points.
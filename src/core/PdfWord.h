@@ -0,0 +1,15 @@
+#ifndef PDFWORD_H
+#define PDFWORD_H
+
+#include <QRectF>
+#include <QString>
+
+/**
+ * @brief A word from a PDF page's text layer.
+ */
+struct PdfWord {
+    QString text;
+    QRectF rect;    // Bounds in render pixels at the requested DPI
+};
+
+#endif // PDFWORD_H
@@ -0,0 +1,67 @@
+#include "PointCodec.h"
+
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <cstring>
+
+QByteArray PointCodec::toBlob(const QVector<QPointF>& points)
+{
+    QByteArray blob(static_cast<int>(points.size() * 2 * sizeof(double)), Qt::Uninitialized);
+    double* out = reinterpret_cast<double*>(blob.data());
+    for (const QPointF& pt : points) {
+        *out++ = pt.x();
+        *out++ = pt.y();
+    }
+    return blob;
+}
+
+QVector<QPointF> PointCodec::fromBlob(const QByteArray& blob)
+{
+    QVector<QPointF> points(blobPointCount(blob));
+    fromBlob(blob, points.data());
+    return points;
+}
+
+int PointCodec::blobPointCount(const QByteArray& blob)
+{
+    return static_cast<int>(blob.size() / (2 * sizeof(double)));
+}
+
+void PointCodec::fromBlob(const QByteArray& blob, QPointF* out)
+{
+    const int count = blobPointCount(blob);
+    const char* in = blob.constData();
+    for (int i = 0; i < count; ++i) {
+        double xy[2];
+        std::memcpy(xy, in, sizeof(xy));
+        in += sizeof(xy);
+        out[i] = QPointF(xy[0], xy[1]);
+    }
+}
+
+QString PointCodec::toJson(const QVector<QPointF>& points)
+{
+    QJsonArray arr;
+    for (const QPointF& pt : points) {
+        QJsonObject obj;
+        obj["x"] = pt.x();
+        obj["y"] = pt.y();
+        arr.append(obj);
+    }
+    return QJsonDocument(arr).toJson(QJsonDocument::Compact);
+}
+
+QVector<QPointF> PointCodec::fromJson(const QString& json)
+{
+    QVector<QPointF> points;
+    QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8());
+    if (doc.isArray()) {
+        QJsonArray arr = doc.array();
+        for (const QJsonValue& val : arr) {
+            QJsonObject obj = val.toObject();
+            points.append(QPointF(obj["x"].toDouble(), obj["y"].toDouble()));
+        }
+    }
+    return points;
+}
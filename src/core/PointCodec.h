@@ -0,0 +1,37 @@
+#ifndef POINTCODEC_H
+#define POINTCODEC_H
+
+#include <QByteArray>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Encodes polyline points for storage in the project database.
+ *
+ * The binary form is a packed array of doubles (x0, y0, x1, y1, ...) in
+ * native byte order. The JSON form is the legacy text format and is only
+ * read for files that have not been migrated yet.
+ */
+class PointCodec
+{
+public:
+    static QByteArray toBlob(const QVector<QPointF>& points);
+    static QVector<QPointF> fromBlob(const QByteArray& blob);
+
+    /**
+     * @brief Number of points held by a binary blob.
+     */
+    static int blobPointCount(const QByteArray& blob);
+
+    /**
+     * @brief Decode a binary blob into caller-provided storage.
+     * @param out Room for blobPointCount(blob) points
+     */
+    static void fromBlob(const QByteArray& blob, QPointF* out);
+
+    static QString toJson(const QVector<QPointF>& points);
+    static QVector<QPointF> fromJson(const QString& json);
+};
+
+#endif // POINTCODEC_H
@@ -1,17 +1,307 @@
 #include "ProjectDatabase.h"
 #include "../models/TakeoffItem.h"
+#include "../models/TakeoffItemStore.h"
 #include "../models/Page.h"
+#include "CsvReader.h"
+#include "PointCodec.h"
+#include "PdfWord.h"
+#include "ImportedPage.h"
+#include "Trace.h"
 
 #include <QSqlQuery>
 #include <QSqlError>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
 #include <QFile>
-#include <QTextStream>
+#include <QSet>
+#include <QDateTime>
 #include <QUuid>
 #include <QDebug>
 
+namespace {
+
+// Column lists for each entity. The order here defines the column indexes
+// used by the row mappers below; keep them in sync.
+#define PAGE_COLUMNS "id, type, source_path, pdf_page_index, pdf_total_pages, display_name, " \
+                     "calibration_ppi, calib_pt1_x, calib_pt1_y, calib_pt2_x, calib_pt2_y, " \
+                     "source_width, source_height"
+#define ITEM_COLUMNS "t.id, p.id, t.kind, t.points_blob, t.points, t.length_in, t.qty, t.shape_id, " \
+                     "t.designation, t.notes"
+// Items refer to pages by integer key; joined back to the page UUID on read.
+// Items whose page is gone (NULL key since migration 7) read back with an
+// empty page ID, so they still count as unassigned in whole-project totals.
+#define ITEM_TABLES "takeoff_items t LEFT JOIN pages p ON p.key = t.page_id"
+#define PAGE_ITEM_TABLES "takeoff_items t JOIN pages p ON p.key = t.page_id"
+#define PAGE_KEY_OF_ID "(SELECT key FROM pages WHERE id = ?)"
+#define SHAPE_COLUMNS "id, designation, shape_type, w_lb_per_ft"
+
+const char* const SQL_INSERT_PAGE = "INSERT INTO pages (" PAGE_COLUMNS ", thumbnail) "
+                                    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+const char* const SQL_INSERT_ITEM = "INSERT INTO takeoff_items "
+                                    "(page_id, kind, points_blob, length_in, qty, shape_id, designation, notes) "
+                                    "VALUES (?, ?, ?, ?, ?, ?, ?, ?)";
+
+// Statements that look rows up by key or filter them. They are kept here so
+// that checkQueryPlans() verifies exactly the SQL the methods run.
+const char* const SQL_GET_SETTING = "SELECT value FROM project WHERE key = ?";
+const char* const SQL_GET_PAGE_KEY = "SELECT key FROM pages WHERE id = ?";
+const char* const SQL_DELETE_PAGE_ITEMS = "DELETE FROM takeoff_items WHERE page_id = " PAGE_KEY_OF_ID;
+const char* const SQL_DELETE_PAGE = "DELETE FROM pages WHERE id = ?";
+const char* const SQL_GET_PAGE = "SELECT " PAGE_COLUMNS " FROM pages WHERE id = ?";
+const char* const SQL_GET_ALL_PAGES = "SELECT " PAGE_COLUMNS " FROM pages ORDER BY key";
+const char* const SQL_GET_PAGE_THUMBNAILS = "SELECT id, thumbnail FROM pages WHERE thumbnail IS NOT NULL";
+const char* const SQL_DELETE_ITEM = "DELETE FROM takeoff_items WHERE id = ?";
+const char* const SQL_UPDATE_ITEM_LENGTH = "UPDATE takeoff_items SET length_in = ? WHERE id = ?";
+const char* const SQL_UPDATE_ITEM = "UPDATE takeoff_items SET page_id = ?, kind = ?, points = NULL, points_blob = ?, "
+                                    "length_in = ?, qty = ?, shape_id = ?, designation = ?, notes = ? WHERE id = ?";
+const char* const SQL_UPDATE_PAGE = "UPDATE pages SET type = ?, source_path = ?, pdf_page_index = ?, pdf_total_pages = ?, "
+                                    "display_name = ?, calibration_ppi = ?, calib_pt1_x = ?, calib_pt1_y = ?, "
+                                    "calib_pt2_x = ?, calib_pt2_y = ?, source_width = ?, source_height = ? WHERE id = ?";
+const char* const SQL_GET_ITEM = "SELECT " ITEM_COLUMNS " FROM " ITEM_TABLES " WHERE t.id = ?";
+const char* const SQL_GET_PAGE_ITEMS = "SELECT " ITEM_COLUMNS " FROM " PAGE_ITEM_TABLES " WHERE p.id = ? ORDER BY t.id";
+const char* const SQL_GET_ALL_ITEMS = "SELECT " ITEM_COLUMNS " FROM " ITEM_TABLES " ORDER BY t.id";
+const char* const SQL_DELETE_SHAPE = "DELETE FROM shapes WHERE id = ?";
+const char* const SQL_UPDATE_SHAPE = "UPDATE shapes SET designation = ?, shape_type = ?, w_lb_per_ft = ? WHERE id = ?";
+const char* const SQL_GET_SHAPE = "SELECT " SHAPE_COLUMNS " FROM shapes WHERE id = ?";
+const char* const SQL_GET_SHAPE_BY_DESIGNATION = "SELECT " SHAPE_COLUMNS " FROM shapes WHERE designation = ?";
+const char* const SQL_GET_SHAPE_ID = "SELECT id FROM shapes WHERE designation = ?";
+// Updates an existing designation in place so its ID, and the properties
+// stored under it, are kept
+const char* const SQL_UPSERT_SHAPE = "INSERT INTO shapes (designation, shape_type, w_lb_per_ft) VALUES (?, ?, ?) "
+                                     "ON CONFLICT(designation) DO UPDATE SET "
+                                     "shape_type = excluded.shape_type, w_lb_per_ft = excluded.w_lb_per_ft";
+const char* const SQL_GET_ALL_SHAPES = "SELECT " SHAPE_COLUMNS " FROM shapes ORDER BY designation";
+const char* const SQL_GET_DESIGNATIONS = "SELECT designation FROM shapes ORDER BY designation";
+const char* const SQL_GET_SHAPE_TYPES = "SELECT DISTINCT shape_type FROM shapes ORDER BY shape_type";
+const char* const SQL_COUNT_SHAPES = "SELECT COUNT(*) FROM shapes";
+const char* const SQL_DELETE_PAGE_WORDS = "DELETE FROM page_words WHERE page_id = ?";
+const char* const SQL_DELETE_PAGE_TEXT_STATUS = "DELETE FROM page_text_status WHERE page_id = ?";
+const char* const SQL_GET_INDEXED_PAGES = "SELECT page_id FROM page_text_status";
+const char* const SQL_SEARCH_PAGE_WORDS = "SELECT page_id, text, x, y, w, h FROM page_words "
+                                          "WHERE term >= ? AND term < ? ORDER BY term, page_id LIMIT ?";
+
+QString shapeSearchSql(bool byText, bool byType)
+{
+    QString sql = "SELECT " SHAPE_COLUMNS " FROM shapes WHERE 1=1";
+    if (byText) {
+        sql += " AND designation LIKE ?";
+    }
+    if (byType) {
+        sql += " AND shape_type = ?";
+    }
+    sql += " ORDER BY designation LIMIT ?";
+    return sql;
+}
+
+constexpr int columnCount(const char* columns)
+{
+    int count = 1;
+    for (; *columns; ++columns) {
+        if (*columns == ',') ++count;
+    }
+    return count;
+}
+
+// =========================================================================
+// Row mappers
+//
+// Each mapper decodes one row selected with its column list, reading
+// columns by position. QSqlQuery::value(name) does a linear name lookup
+// per call, which dominated the cost of loading large projects.
+// =========================================================================
+
+struct PageMapper {
+    using Row = Page;
+    enum Column {
+        Id, Type, SourcePath, PdfPageIndex, PdfTotalPages, DisplayName,
+        CalibrationPpi, CalibPt1X, CalibPt1Y, CalibPt2X, CalibPt2Y, SourceWidth, SourceHeight,
+        ColumnCount
+    };
+
+    static Page map(const QSqlQuery& query)
+    {
+        Page page;
+        page.setId(query.value(Id).toString());
+        page.setType(query.value(Type).toString() == "image" ? Page::Image : Page::Pdf);
+        page.setSourcePath(query.value(SourcePath).toString());
+        page.setPdfPageIndex(query.value(PdfPageIndex).toInt());
+        page.setPdfTotalPages(query.value(PdfTotalPages).toInt());
+        page.setDisplayName(query.value(DisplayName).toString());
+        page.setSourceSize(QSizeF(query.value(SourceWidth).toDouble(), query.value(SourceHeight).toDouble()));
+
+        // Restore calibration
+        Calibration cal;
+        cal.setPixelsPerInch(query.value(CalibrationPpi).toDouble());
+        cal.setCalibrationPoints(
+            QPointF(query.value(CalibPt1X).toDouble(), query.value(CalibPt1Y).toDouble()),
+            QPointF(query.value(CalibPt2X).toDouble(), query.value(CalibPt2Y).toDouble())
+        );
+        page.setCalibration(cal);
+        return page;
+    }
+};
+static_assert(columnCount(PAGE_COLUMNS) == PageMapper::ColumnCount, "PAGE_COLUMNS out of sync");
+
+// Binds the values of a page to the leading placeholders of a statement
+// that lists PAGE_COLUMNS, by position so a prepared query can be reused
+void bindPageColumns(QSqlQuery& query, const Page& page)
+{
+    query.bindValue(PageMapper::Id, page.id());
+    query.bindValue(PageMapper::Type, page.type() == Page::Image ? "image" : "pdf");
+    query.bindValue(PageMapper::SourcePath, page.sourcePath());
+    query.bindValue(PageMapper::PdfPageIndex, page.pdfPageIndex());
+    query.bindValue(PageMapper::PdfTotalPages, page.pdfTotalPages());
+    query.bindValue(PageMapper::DisplayName, page.displayName());
+    query.bindValue(PageMapper::CalibrationPpi, page.calibration().pixelsPerInch());
+    query.bindValue(PageMapper::CalibPt1X, page.calibration().calibrationPoint1().x());
+    query.bindValue(PageMapper::CalibPt1Y, page.calibration().calibrationPoint1().y());
+    query.bindValue(PageMapper::CalibPt2X, page.calibration().calibrationPoint2().x());
+    query.bindValue(PageMapper::CalibPt2Y, page.calibration().calibrationPoint2().y());
+    query.bindValue(PageMapper::SourceWidth, page.sourceSize().width());
+    query.bindValue(PageMapper::SourceHeight, page.sourceSize().height());
+}
+
+struct TakeoffItemMapper {
+    using Row = TakeoffItem;
+    enum Column {
+        Id, PageId, Kind, PointsBlob, PointsJson, LengthIn, Qty, ShapeId, Designation, Notes,
+        ColumnCount
+    };
+
+    static TakeoffItem map(const QSqlQuery& query)
+    {
+        TakeoffItem item = mapFields(query);
+
+        // Rows not yet rewritten by the background migration still hold JSON
+        QByteArray blob = query.value(PointsBlob).toByteArray();
+        item.setPoints(!blob.isEmpty() ? PointCodec::fromBlob(blob)
+                                       : PointCodec::fromJson(query.value(PointsJson).toString()));
+        return item;
+    }
+
+    // Everything but the points
+    static TakeoffItem mapFields(const QSqlQuery& query)
+    {
+        TakeoffItem item;
+        item.setId(query.value(Id).toInt());
+        item.setPageId(query.value(PageId).toString());
+        item.setKind(TakeoffItem::kindFromString(query.value(Kind).toString()));
+        item.setLengthInches(query.value(LengthIn).toDouble());
+        item.setQty(query.value(Qty).toInt());
+        item.setShapeId(query.value(ShapeId).toInt());
+        item.setDesignation(query.value(Designation).toString());
+        item.setNotes(query.value(Notes).toString());
+        return item;
+    }
+};
+static_assert(columnCount(ITEM_COLUMNS) == TakeoffItemMapper::ColumnCount, "ITEM_COLUMNS out of sync");
+
+struct ShapeMapper {
+    using Row = ProjectDatabase::Shape;
+    enum Column { Id, Designation, ShapeType, WLbPerFt, ColumnCount };
+
+    static ProjectDatabase::Shape map(const QSqlQuery& query)
+    {
+        ProjectDatabase::Shape shape;
+        shape.id = query.value(Id).toInt();
+        shape.designation = query.value(Designation).toString();
+        shape.shapeType = query.value(ShapeType).toString();
+        shape.wLbPerFt = query.value(WLbPerFt).toDouble();
+        return shape;
+    }
+};
+static_assert(columnCount(SHAPE_COLUMNS) == ShapeMapper::ColumnCount, "SHAPE_COLUMNS out of sync");
+
+// Maps the first row of an executed query, or returns a default row
+template <typename Mapper>
+typename Mapper::Row mapOne(QSqlQuery& query)
+{
+    if (query.next()) {
+        return Mapper::map(query);
+    }
+    return typename Mapper::Row();
+}
+
+// Maps all remaining rows of an executed query
+template <typename Mapper>
+QVector<typename Mapper::Row> mapAll(QSqlQuery& query)
+{
+    QVector<typename Mapper::Row> rows;
+    while (query.next()) {
+        rows.append(Mapper::map(query));
+    }
+    return rows;
+}
+
+// Runs a prepared SQL_GET_PAGE_KEY statement. Items store the page's
+// integer key, so it is looked up first to catch unknown pages instead
+// of writing a NULL key. Returns -1 with the error set if it fails.
+qint64 lookupPageKey(QSqlQuery& lookup, const QString& pageId, QString* error)
+{
+    lookup.bindValue(0, pageId);
+    if (!lookup.exec()) {
+        *error = lookup.lastError().text();
+        return -1;
+    }
+    if (!lookup.next()) {
+        *error = QString("Unknown page: %1").arg(pageId);
+        lookup.finish();
+        return -1;
+    }
+    const qint64 key = lookup.value(0).toLongLong();
+    lookup.finish();
+    return key;
+}
+
+// Binds the values of SQL_INSERT_ITEM by position, so a prepared statement
+// can be reused for many items
+void bindInsertItemValues(QSqlQuery& query, const TakeoffItem& item, qint64 pageKey)
+{
+    query.bindValue(0, pageKey);
+    query.bindValue(1, item.kindString());
+    query.bindValue(2, PointCodec::toBlob(item.points()));
+    query.bindValue(3, item.lengthInches());
+    query.bindValue(4, item.qty());
+    query.bindValue(5, item.shapeId() > 0 ? item.shapeId() : QVariant());
+    query.bindValue(6, item.designation());
+    query.bindValue(7, item.notes());
+}
+
+// Runs prepared SQL_UPSERT_SHAPE and SQL_GET_SHAPE_ID statements.
+// Returns the shape's ID, or -1 with the error set.
+int upsertShape(QSqlQuery& upsert, QSqlQuery& lookup, const QString& designation,
+                const QString& shapeType, double wLbPerFt, QString* error)
+{
+    upsert.bindValue(0, designation);
+    upsert.bindValue(1, shapeType);
+    upsert.bindValue(2, wLbPerFt);
+    if (!upsert.exec()) {
+        *error = upsert.lastError().text();
+        return -1;
+    }
+
+    // lastInsertId() is not set when the row was updated
+    lookup.bindValue(0, designation);
+    if (!lookup.exec() || !lookup.next()) {
+        *error = lookup.lastError().text();
+        return -1;
+    }
+    const int id = lookup.value(0).toInt();
+    lookup.finish();
+    return id;
+}
+
+bool containsLetter(const CsvReader::Field& field)
+{
+    for (int i = 0; i < field.size; ++i) {
+        char c = field.data[i];
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
 ProjectDatabase::ProjectDatabase()
     : m_isOpen(false)
 {
@@ -44,7 +334,12 @@ bool ProjectDatabase::create(const QString& path)
     m_filePath = path;
     m_isOpen = true;
 
-    createSchema();
+    if (!migrateSchema()) {
+        QString error = m_lastError;
+        close();
+        m_lastError = error;
+        return false;
+    }
 
     // Set default project settings
     setProjectSetting("created_at", QDateTime::currentDateTime().toString(Qt::ISODate));
@@ -55,6 +350,7 @@ bool ProjectDatabase::create(const QString& path)
 
 bool ProjectDatabase::open(const QString& path)
 {
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::open");
     close();
 
     if (!QFile::exists(path)) {
@@ -73,19 +369,27 @@ bool ProjectDatabase::open(const QString& path)
     m_filePath = path;
     m_isOpen = true;
 
-    // Ensure schema exists (for older files)
-    createSchema();
+    // Bring older files up to the current schema version
+    if (!migrateSchema()) {
+        QString error = m_lastError;
+        close();
+        m_lastError = error;
+        return false;
+    }
 
     return true;
 }
 
 void ProjectDatabase::close()
 {
+    m_migrator.reset();
+
     if (m_isOpen) {
         m_db.close();
         m_isOpen = false;
         m_filePath.clear();
     }
+    m_db = QSqlDatabase();
     
     if (QSqlDatabase::contains(m_connectionName)) {
         QSqlDatabase::removeDatabase(m_connectionName);
@@ -102,64 +406,78 @@ QString ProjectDatabase::filePath() const
     return m_filePath;
 }
 
-void ProjectDatabase::createSchema()
-{
-    QSqlQuery query(m_db);
-
-    // Project settings table
-    query.exec(R"(
-        CREATE TABLE IF NOT EXISTS project (
-            key TEXT PRIMARY KEY,
-            value TEXT
-        )
-    )");
-
-    // Pages table
-    query.exec(R"(
-        CREATE TABLE IF NOT EXISTS pages (
-            id TEXT PRIMARY KEY,
-            type TEXT,
-            source_path TEXT,
-            pdf_page_index INTEGER,
-            pdf_total_pages INTEGER,
-            display_name TEXT,
-            calibration_ppi REAL,
-            calib_pt1_x REAL,
-            calib_pt1_y REAL,
-            calib_pt2_x REAL,
-            calib_pt2_y REAL
-        )
-    )");
-
-    // Shapes table
-    query.exec(R"(
-        CREATE TABLE IF NOT EXISTS shapes (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            designation TEXT UNIQUE,
-            shape_type TEXT,
-            w_lb_per_ft REAL
-        )
-    )");
-
-    // Takeoff items table
-    query.exec(R"(
-        CREATE TABLE IF NOT EXISTS takeoff_items (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            page_id TEXT REFERENCES pages(id),
-            kind TEXT,
-            points TEXT,
-            length_in REAL,
-            qty INTEGER DEFAULT 1,
-            shape_id INTEGER REFERENCES shapes(id),
-            designation TEXT,
-            notes TEXT
-        )
-    )");
-
-    // Create indexes
-    query.exec("CREATE INDEX IF NOT EXISTS idx_shapes_type ON shapes(shape_type)");
-    query.exec("CREATE INDEX IF NOT EXISTS idx_shapes_designation ON shapes(designation)");
-    query.exec("CREATE INDEX IF NOT EXISTS idx_items_page ON takeoff_items(page_id)");
+bool ProjectDatabase::migrateSchema()
+{
+    m_migrator = std::make_unique<SchemaMigrator>(m_db);
+    if (!m_migrator->migrate()) {
+        m_lastError = m_migrator->lastError();
+        return false;
+    }
+
+    return true;
+}
+
+int ProjectDatabase::schemaVersion() const
+{
+    return m_migrator ? m_migrator->currentVersion() : 0;
+}
+
+int ProjectDatabase::fileSchemaVersion(const QString& path, QString* error)
+{
+    if (!QFile::exists(path)) {
+        if (error) *error = "File does not exist: " + path;
+        return -1;
+    }
+
+    const QString connectionName = QString("ProjectDB_version_%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+    int version = -1;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(path);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+
+        if (db.open()) {
+            QSqlQuery query(db);
+            if (query.exec("PRAGMA user_version") && query.next()) {
+                version = query.value(0).toInt();
+            } else if (error) {
+                *error = query.lastError().text();
+            }
+        } else if (error) {
+            *error = db.lastError().text();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return version;
+}
+
+bool ProjectDatabase::hasPendingMigrationWork() const
+{
+    return m_migrator && m_migrator->hasPendingBackgroundWork();
+}
+
+int ProjectDatabase::pendingMigrationBatches(int batchSize) const
+{
+    if (!m_migrator || batchSize <= 0) return 0;
+
+    const qint64 rows = m_migrator->pendingBackgroundRows();
+    return static_cast<int>((rows + batchSize - 1) / batchSize);
+}
+
+int ProjectDatabase::runMigrationStep(int batchSize)
+{
+    if (!m_isOpen || !m_migrator) return 0;
+
+    int processed = m_migrator->runBackgroundStep(batchSize);
+    if (processed < 0) {
+        m_lastError = m_migrator->lastError();
+    }
+    return processed;
+}
+
+QVector<SchemaMigrator::Record> ProjectDatabase::migrationHistory() const
+{
+    return m_migrator ? m_migrator->history() : QVector<SchemaMigrator::Record>();
 }
 
 // =========================================================================
@@ -171,7 +489,7 @@ QString ProjectDatabase::getProjectSetting(const QString& key, const QString& de
     if (!m_isOpen) return defaultValue;
 
     QSqlQuery query(m_db);
-    query.prepare("SELECT value FROM project WHERE key = ?");
+    query.prepare(SQL_GET_SETTING);
     query.addBindValue(key);
     
     if (query.exec() && query.next()) {
@@ -221,24 +539,9 @@ bool ProjectDatabase::insertPage(const Page& page)
     if (!m_isOpen) return false;
 
     QSqlQuery query(m_db);
-    query.prepare(R"(
-        INSERT INTO pages (id, type, source_path, pdf_page_index, pdf_total_pages, 
-                           display_name, calibration_ppi, calib_pt1_x, calib_pt1_y, 
-                           calib_pt2_x, calib_pt2_y)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-    )");
-    
-    query.addBindValue(page.id());
-    query.addBindValue(page.type() == Page::Image ? "image" : "pdf");
-    query.addBindValue(page.sourcePath());
-    query.addBindValue(page.pdfPageIndex());
-    query.addBindValue(page.pdfTotalPages());
-    query.addBindValue(page.displayName());
-    query.addBindValue(page.calibration().pixelsPerInch());
-    query.addBindValue(page.calibration().calibrationPoint1().x());
-    query.addBindValue(page.calibration().calibrationPoint1().y());
-    query.addBindValue(page.calibration().calibrationPoint2().x());
-    query.addBindValue(page.calibration().calibrationPoint2().y());
+    query.prepare(SQL_INSERT_PAGE);
+    bindPageColumns(query, page);
+    query.bindValue(PageMapper::ColumnCount, QVariant());  // Thumbnail
 
     if (!query.exec()) {
         m_lastError = query.lastError().text();
@@ -252,12 +555,7 @@ bool ProjectDatabase::updatePage(const Page& page)
     if (!m_isOpen) return false;
 
     QSqlQuery query(m_db);
-    query.prepare(R"(
-        UPDATE pages SET type = ?, source_path = ?, pdf_page_index = ?, 
-                         pdf_total_pages = ?, display_name = ?, calibration_ppi = ?,
-                         calib_pt1_x = ?, calib_pt1_y = ?, calib_pt2_x = ?, calib_pt2_y = ?
-        WHERE id = ?
-    )");
+    query.prepare(SQL_UPDATE_PAGE);
     
     query.addBindValue(page.type() == Page::Image ? "image" : "pdf");
     query.addBindValue(page.sourcePath());
@@ -269,6 +567,8 @@ bool ProjectDatabase::updatePage(const Page& page)
     query.addBindValue(page.calibration().calibrationPoint1().y());
     query.addBindValue(page.calibration().calibrationPoint2().x());
     query.addBindValue(page.calibration().calibrationPoint2().y());
+    query.addBindValue(page.sourceSize().width());
+    query.addBindValue(page.sourceSize().height());
     query.addBindValue(page.id());
 
     if (!query.exec()) {
@@ -278,18 +578,53 @@ bool ProjectDatabase::updatePage(const Page& page)
     return true;
 }
 
+bool ProjectDatabase::updatePageCalibration(const Page& page, const QVector<int>& itemIds,
+                                            const QVector<double>& lengthsInches)
+{
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::updatePageCalibration");
+    if (!m_isOpen) return false;
+
+    m_db.transaction();
+
+    if (!updatePage(page)) {
+        m_db.rollback();
+        return false;
+    }
+
+    QSqlQuery query(m_db);
+    query.prepare(SQL_UPDATE_ITEM_LENGTH);
+    for (int i = 0; i < itemIds.size(); ++i) {
+        query.bindValue(0, lengthsInches[i]);
+        query.bindValue(1, itemIds[i]);
+        if (!query.exec()) {
+            m_lastError = query.lastError().text();
+            m_db.rollback();
+            return false;
+        }
+    }
+
+    if (!m_db.commit()) {
+        m_lastError = m_db.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    return true;
+}
+
 bool ProjectDatabase::deletePage(const QString& pageId)
 {
     if (!m_isOpen) return false;
 
-    // First delete all takeoff items for this page
+    // First delete all takeoff items and indexed text for this page
     QSqlQuery query(m_db);
-    query.prepare("DELETE FROM takeoff_items WHERE page_id = ?");
-    query.addBindValue(pageId);
-    query.exec();
+    for (const char* sql : {SQL_DELETE_PAGE_ITEMS, SQL_DELETE_PAGE_WORDS, SQL_DELETE_PAGE_TEXT_STATUS}) {
+        query.prepare(sql);
+        query.addBindValue(pageId);
+        query.exec();
+    }
 
     // Then delete the page
-    query.prepare("DELETE FROM pages WHERE id = ?");
+    query.prepare(SQL_DELETE_PAGE);
     query.addBindValue(pageId);
     
     if (!query.exec()) {
@@ -301,112 +636,95 @@ bool ProjectDatabase::deletePage(const QString& pageId)
 
 Page ProjectDatabase::getPage(const QString& pageId) const
 {
-    Page page;
-    if (!m_isOpen) return page;
+    if (!m_isOpen) return Page();
 
     QSqlQuery query(m_db);
-    query.prepare("SELECT * FROM pages WHERE id = ?");
+    query.setForwardOnly(true);
+    query.prepare(SQL_GET_PAGE);
     query.addBindValue(pageId);
-    
-    if (query.exec() && query.next()) {
-        page.setId(query.value("id").toString());
-        page.setType(query.value("type").toString() == "image" ? Page::Image : Page::Pdf);
-        page.setSourcePath(query.value("source_path").toString());
-        page.setPdfPageIndex(query.value("pdf_page_index").toInt());
-        page.setPdfTotalPages(query.value("pdf_total_pages").toInt());
-        page.setDisplayName(query.value("display_name").toString());
-        
-        // Restore calibration
-        Calibration cal;
-        cal.setPixelsPerInch(query.value("calibration_ppi").toDouble());
-        cal.setCalibrationPoints(
-            QPointF(query.value("calib_pt1_x").toDouble(), query.value("calib_pt1_y").toDouble()),
-            QPointF(query.value("calib_pt2_x").toDouble(), query.value("calib_pt2_y").toDouble())
-        );
-        page.setCalibration(cal);
-    }
-    return page;
+
+    if (!query.exec()) return Page();
+    return mapOne<PageMapper>(query);
 }
 
 QVector<Page> ProjectDatabase::getAllPages() const
 {
-    QVector<Page> pages;
-    if (!m_isOpen) return pages;
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::getAllPages");
+    if (!m_isOpen) return QVector<Page>();
 
     QSqlQuery query(m_db);
-    query.exec("SELECT * FROM pages ORDER BY rowid");
-    
-    while (query.next()) {
-        Page page;
-        page.setId(query.value("id").toString());
-        page.setType(query.value("type").toString() == "image" ? Page::Image : Page::Pdf);
-        page.setSourcePath(query.value("source_path").toString());
-        page.setPdfPageIndex(query.value("pdf_page_index").toInt());
-        page.setPdfTotalPages(query.value("pdf_total_pages").toInt());
-        page.setDisplayName(query.value("display_name").toString());
-        
-        // Restore calibration
-        Calibration cal;
-        cal.setPixelsPerInch(query.value("calibration_ppi").toDouble());
-        cal.setCalibrationPoints(
-            QPointF(query.value("calib_pt1_x").toDouble(), query.value("calib_pt1_y").toDouble()),
-            QPointF(query.value("calib_pt2_x").toDouble(), query.value("calib_pt2_y").toDouble())
-        );
-        page.setCalibration(cal);
-        
-        pages.append(page);
-    }
-    return pages;
+    query.setForwardOnly(true);
+    query.exec(SQL_GET_ALL_PAGES);
+    return mapAll<PageMapper>(query);
 }
 
-// =========================================================================
-// Takeoff Items
-// =========================================================================
-
-QString ProjectDatabase::serializePoints(const QVector<QPointF>& points) const
+bool ProjectDatabase::insertImportedPages(const QVector<ImportedPage>& pages)
 {
-    QJsonArray arr;
-    for (const QPointF& pt : points) {
-        QJsonObject obj;
-        obj["x"] = pt.x();
-        obj["y"] = pt.y();
-        arr.append(obj);
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::insertImportedPages");
+    if (!m_isOpen) return false;
+
+    m_db.transaction();
+
+    QSqlQuery query(m_db);
+    query.prepare(SQL_INSERT_PAGE);
+    for (const ImportedPage& imported : pages) {
+        bindPageColumns(query, imported.page);
+        query.bindValue(PageMapper::ColumnCount,
+                        imported.thumbnailPng.isEmpty() ? QVariant() : QVariant(imported.thumbnailPng));
+        if (!query.exec()) {
+            m_lastError = query.lastError().text();
+            m_db.rollback();
+            return false;
+        }
+    }
+
+    for (const ImportedPage& imported : pages) {
+        if (imported.textExtracted && !writePageText(imported.page.id(), imported.words)) {
+            m_db.rollback();
+            return false;
+        }
+    }
+
+    if (!m_db.commit()) {
+        m_lastError = m_db.lastError().text();
+        m_db.rollback();
+        return false;
     }
-    return QJsonDocument(arr).toJson(QJsonDocument::Compact);
+    return true;
 }
 
-QVector<QPointF> ProjectDatabase::deserializePoints(const QString& json) const
+QHash<QString, QByteArray> ProjectDatabase::getPageThumbnails() const
 {
-    QVector<QPointF> points;
-    QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8());
-    if (doc.isArray()) {
-        QJsonArray arr = doc.array();
-        for (const QJsonValue& val : arr) {
-            QJsonObject obj = val.toObject();
-            points.append(QPointF(obj["x"].toDouble(), obj["y"].toDouble()));
-        }
+    QHash<QString, QByteArray> thumbnails;
+    if (!m_isOpen) return thumbnails;
+
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    query.exec(SQL_GET_PAGE_THUMBNAILS);
+
+    while (query.next()) {
+        thumbnails.insert(query.value(0).toString(), query.value(1).toByteArray());
     }
-    return points;
+    return thumbnails;
 }
 
+// =========================================================================
+// Takeoff Items
+// =========================================================================
+
 int ProjectDatabase::insertTakeoffItem(const TakeoffItem& item)
 {
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::insertTakeoffItem");
     if (!m_isOpen) return -1;
 
+    QSqlQuery lookup(m_db);
+    lookup.prepare(SQL_GET_PAGE_KEY);
+    const qint64 pageKey = lookupPageKey(lookup, item.pageId(), &m_lastError);
+    if (pageKey < 0) return -1;
+
     QSqlQuery query(m_db);
-    query.prepare(R"(
-        INSERT INTO takeoff_items (page_id, kind, points, length_in, qty, shape_id, designation, notes)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?)
-    )");
-    
-    query.addBindValue(item.pageId());
-    query.addBindValue(item.kind() == TakeoffItem::Line ? "Line" : "Polyline");
-    query.addBindValue(serializePoints(item.points()));
-    query.addBindValue(item.lengthInches());
-    query.addBindValue(item.qty());
-    query.addBindValue(item.shapeId() > 0 ? item.shapeId() : QVariant());
-    query.addBindValue(item.designation());
-    query.addBindValue(item.notes());
+    query.prepare(SQL_INSERT_ITEM);
+    bindInsertItemValues(query, item, pageKey);
 
     if (!query.exec()) {
         m_lastError = query.lastError().text();
@@ -416,20 +734,74 @@ int ProjectDatabase::insertTakeoffItem(const TakeoffItem& item)
     return query.lastInsertId().toInt();
 }
 
+bool ProjectDatabase::insertTakeoffItems(QVector<TakeoffItem>& items)
+{
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::insertTakeoffItems");
+    if (!m_isOpen) return false;
+
+    m_db.transaction();
+
+    QSqlQuery lookup(m_db);
+    lookup.prepare(SQL_GET_PAGE_KEY);
+    QSqlQuery query(m_db);
+    query.prepare(SQL_INSERT_ITEM);
+    QHash<QString, qint64> pageKeys;
+    QVector<int> ids;
+    ids.reserve(items.size());
+    for (const TakeoffItem& item : items) {
+        auto key = pageKeys.constFind(item.pageId());
+        if (key == pageKeys.constEnd()) {
+            const qint64 pageKey = lookupPageKey(lookup, item.pageId(), &m_lastError);
+            if (pageKey < 0) {
+                m_db.rollback();
+                return false;
+            }
+            key = pageKeys.insert(item.pageId(), pageKey);
+        }
+
+        bindInsertItemValues(query, item, key.value());
+        if (!query.exec()) {
+            m_lastError = query.lastError().text();
+            m_db.rollback();
+            return false;
+        }
+        ids.append(query.lastInsertId().toInt());
+    }
+
+    if (!m_db.commit()) {
+        m_lastError = m_db.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+
+    // IDs are only handed out once the rows are committed
+    for (int i = 0; i < items.size(); ++i) {
+        items[i].setId(ids[i]);
+    }
+    return true;
+}
+
 bool ProjectDatabase::updateTakeoffItem(const TakeoffItem& item)
 {
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::updateTakeoffItem");
     if (!m_isOpen) return false;
 
+    // An item without a page stays unassigned rather than failing the lookup
+    QVariant pageKey;
+    if (!item.pageId().isEmpty()) {
+        QSqlQuery lookup(m_db);
+        lookup.prepare(SQL_GET_PAGE_KEY);
+        const qint64 key = lookupPageKey(lookup, item.pageId(), &m_lastError);
+        if (key < 0) return false;
+        pageKey = key;
+    }
+
     QSqlQuery query(m_db);
-    query.prepare(R"(
-        UPDATE takeoff_items SET page_id = ?, kind = ?, points = ?, length_in = ?, 
-                                  qty = ?, shape_id = ?, designation = ?, notes = ?
-        WHERE id = ?
-    )");
+    query.prepare(SQL_UPDATE_ITEM);
     
-    query.addBindValue(item.pageId());
-    query.addBindValue(item.kind() == TakeoffItem::Line ? "Line" : "Polyline");
-    query.addBindValue(serializePoints(item.points()));
+    query.addBindValue(pageKey);
+    query.addBindValue(item.kindString());
+    query.addBindValue(PointCodec::toBlob(item.points()));
     query.addBindValue(item.lengthInches());
     query.addBindValue(item.qty());
     query.addBindValue(item.shapeId() > 0 ? item.shapeId() : QVariant());
@@ -446,10 +818,11 @@ bool ProjectDatabase::updateTakeoffItem(const TakeoffItem& item)
 
 bool ProjectDatabase::deleteTakeoffItem(int itemId)
 {
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::deleteTakeoffItem");
     if (!m_isOpen) return false;
 
     QSqlQuery query(m_db);
-    query.prepare("DELETE FROM takeoff_items WHERE id = ?");
+    query.prepare(SQL_DELETE_ITEM);
     query.addBindValue(itemId);
     
     if (!query.exec()) {
@@ -461,76 +834,67 @@ bool ProjectDatabase::deleteTakeoffItem(int itemId)
 
 TakeoffItem ProjectDatabase::getTakeoffItem(int itemId) const
 {
-    TakeoffItem item;
-    if (!m_isOpen) return item;
+    if (!m_isOpen) return TakeoffItem();
 
     QSqlQuery query(m_db);
-    query.prepare("SELECT * FROM takeoff_items WHERE id = ?");
+    query.setForwardOnly(true);
+    query.prepare(SQL_GET_ITEM);
     query.addBindValue(itemId);
-    
-    if (query.exec() && query.next()) {
-        item.setId(query.value("id").toInt());
-        item.setPageId(query.value("page_id").toString());
-        item.setKind(query.value("kind").toString() == "Line" ? TakeoffItem::Line : TakeoffItem::Polyline);
-        item.setPoints(deserializePoints(query.value("points").toString()));
-        item.setLengthInches(query.value("length_in").toDouble());
-        item.setQty(query.value("qty").toInt());
-        item.setShapeId(query.value("shape_id").toInt());
-        item.setDesignation(query.value("designation").toString());
-        item.setNotes(query.value("notes").toString());
-    }
-    return item;
+
+    if (!query.exec()) return TakeoffItem();
+    return mapOne<TakeoffItemMapper>(query);
 }
 
 QVector<TakeoffItem> ProjectDatabase::getTakeoffItemsForPage(const QString& pageId) const
 {
-    QVector<TakeoffItem> items;
-    if (!m_isOpen) return items;
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::getTakeoffItemsForPage");
+    if (!m_isOpen) return QVector<TakeoffItem>();
 
     QSqlQuery query(m_db);
-    query.prepare("SELECT * FROM takeoff_items WHERE page_id = ? ORDER BY id");
+    query.setForwardOnly(true);
+    query.prepare(SQL_GET_PAGE_ITEMS);
     query.addBindValue(pageId);
-    
-    if (query.exec()) {
-        while (query.next()) {
-            TakeoffItem item;
-            item.setId(query.value("id").toInt());
-            item.setPageId(query.value("page_id").toString());
-            item.setKind(query.value("kind").toString() == "Line" ? TakeoffItem::Line : TakeoffItem::Polyline);
-            item.setPoints(deserializePoints(query.value("points").toString()));
-            item.setLengthInches(query.value("length_in").toDouble());
-            item.setQty(query.value("qty").toInt());
-            item.setShapeId(query.value("shape_id").toInt());
-            item.setDesignation(query.value("designation").toString());
-            item.setNotes(query.value("notes").toString());
-            items.append(item);
-        }
-    }
-    return items;
+
+    if (!query.exec()) return QVector<TakeoffItem>();
+    return mapAll<TakeoffItemMapper>(query);
 }
 
 QVector<TakeoffItem> ProjectDatabase::getAllTakeoffItems() const
 {
-    QVector<TakeoffItem> items;
-    if (!m_isOpen) return items;
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::getAllTakeoffItems");
+    if (!m_isOpen) return QVector<TakeoffItem>();
 
     QSqlQuery query(m_db);
-    query.exec("SELECT * FROM takeoff_items ORDER BY id");
-    
+    query.setForwardOnly(true);
+    query.exec(SQL_GET_ALL_ITEMS);
+    return mapAll<TakeoffItemMapper>(query);
+}
+
+bool ProjectDatabase::loadTakeoffItems(TakeoffItemStore& store) const
+{
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::loadTakeoffItems");
+    store.clear();
+    if (!m_isOpen) return false;
+
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    if (!query.exec(SQL_GET_ALL_ITEMS)) {
+        m_lastError = query.lastError().text();
+        return false;
+    }
+
     while (query.next()) {
-        TakeoffItem item;
-        item.setId(query.value("id").toInt());
-        item.setPageId(query.value("page_id").toString());
-        item.setKind(query.value("kind").toString() == "Line" ? TakeoffItem::Line : TakeoffItem::Polyline);
-        item.setPoints(deserializePoints(query.value("points").toString()));
-        item.setLengthInches(query.value("length_in").toDouble());
-        item.setQty(query.value("qty").toInt());
-        item.setShapeId(query.value("shape_id").toInt());
-        item.setDesignation(query.value("designation").toString());
-        item.setNotes(query.value("notes").toString());
-        items.append(item);
+        const TakeoffItem fields = TakeoffItemMapper::mapFields(query);
+        const QByteArray blob = query.value(TakeoffItemMapper::PointsBlob).toByteArray();
+        if (!blob.isEmpty()) {
+            PointCodec::fromBlob(blob, store.appendWithPoints(fields, PointCodec::blobPointCount(blob)));
+        } else {
+            TakeoffItem item = fields;
+            item.setPoints(PointCodec::fromJson(query.value(TakeoffItemMapper::PointsJson).toString()));
+            store.append(item);
+        }
     }
-    return items;
+    return true;
 }
 
 // =========================================================================
@@ -541,17 +905,11 @@ int ProjectDatabase::insertShape(const QString& designation, const QString& shap
 {
     if (!m_isOpen) return -1;
 
-    QSqlQuery query(m_db);
-    query.prepare("INSERT OR REPLACE INTO shapes (designation, shape_type, w_lb_per_ft) VALUES (?, ?, ?)");
-    query.addBindValue(designation);
-    query.addBindValue(shapeType);
-    query.addBindValue(wLbPerFt);
-
-    if (!query.exec()) {
-        m_lastError = query.lastError().text();
-        return -1;
-    }
-    return query.lastInsertId().toInt();
+    QSqlQuery upsert(m_db);
+    QSqlQuery lookup(m_db);
+    upsert.prepare(SQL_UPSERT_SHAPE);
+    lookup.prepare(SQL_GET_SHAPE_ID);
+    return upsertShape(upsert, lookup, designation, shapeType, wLbPerFt, &m_lastError);
 }
 
 bool ProjectDatabase::updateShape(int shapeId, const QString& designation, const QString& shapeType, double wLbPerFt)
@@ -559,7 +917,7 @@ bool ProjectDatabase::updateShape(int shapeId, const QString& designation, const
     if (!m_isOpen) return false;
 
     QSqlQuery query(m_db);
-    query.prepare("UPDATE shapes SET designation = ?, shape_type = ?, w_lb_per_ft = ? WHERE id = ?");
+    query.prepare(SQL_UPDATE_SHAPE);
     query.addBindValue(designation);
     query.addBindValue(shapeType);
     query.addBindValue(wLbPerFt);
@@ -577,7 +935,7 @@ bool ProjectDatabase::deleteShape(int shapeId)
     if (!m_isOpen) return false;
 
     QSqlQuery query(m_db);
-    query.prepare("DELETE FROM shapes WHERE id = ?");
+    query.prepare(SQL_DELETE_SHAPE);
     query.addBindValue(shapeId);
 
     if (!query.exec()) {
@@ -589,95 +947,65 @@ bool ProjectDatabase::deleteShape(int shapeId)
 
 ProjectDatabase::Shape ProjectDatabase::getShape(int shapeId) const
 {
-    Shape shape;
-    if (!m_isOpen || shapeId <= 0) return shape;
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::getShape");
+    if (!m_isOpen || shapeId <= 0) return Shape();
 
     QSqlQuery query(m_db);
-    query.prepare("SELECT * FROM shapes WHERE id = ?");
+    query.setForwardOnly(true);
+    query.prepare(SQL_GET_SHAPE);
     query.addBindValue(shapeId);
-    
-    if (query.exec() && query.next()) {
-        shape.id = query.value("id").toInt();
-        shape.designation = query.value("designation").toString();
-        shape.shapeType = query.value("shape_type").toString();
-        shape.wLbPerFt = query.value("w_lb_per_ft").toDouble();
-    }
-    return shape;
+
+    if (!query.exec()) return Shape();
+    return mapOne<ShapeMapper>(query);
 }
 
 ProjectDatabase::Shape ProjectDatabase::getShapeByDesignation(const QString& designation) const
 {
-    Shape shape;
-    if (!m_isOpen || designation.isEmpty()) return shape;
+    if (!m_isOpen || designation.isEmpty()) return Shape();
 
     QSqlQuery query(m_db);
-    query.prepare("SELECT * FROM shapes WHERE designation = ?");
+    query.setForwardOnly(true);
+    query.prepare(SQL_GET_SHAPE_BY_DESIGNATION);
     query.addBindValue(designation);
-    
-    if (query.exec() && query.next()) {
-        shape.id = query.value("id").toInt();
-        shape.designation = query.value("designation").toString();
-        shape.shapeType = query.value("shape_type").toString();
-        shape.wLbPerFt = query.value("w_lb_per_ft").toDouble();
-    }
-    return shape;
+
+    if (!query.exec()) return Shape();
+    return mapOne<ShapeMapper>(query);
 }
 
 QVector<ProjectDatabase::Shape> ProjectDatabase::getAllShapes() const
 {
-    QVector<Shape> shapes;
-    if (!m_isOpen) return shapes;
+    if (!m_isOpen) return QVector<Shape>();
 
     QSqlQuery query(m_db);
-    query.exec("SELECT * FROM shapes ORDER BY designation");
-    
-    while (query.next()) {
-        Shape shape;
-        shape.id = query.value("id").toInt();
-        shape.designation = query.value("designation").toString();
-        shape.shapeType = query.value("shape_type").toString();
-        shape.wLbPerFt = query.value("w_lb_per_ft").toDouble();
-        shapes.append(shape);
-    }
-    return shapes;
+    query.setForwardOnly(true);
+    query.exec(SQL_GET_ALL_SHAPES);
+    return mapAll<ShapeMapper>(query);
 }
 
 QVector<ProjectDatabase::Shape> ProjectDatabase::searchShapes(const QString& searchText, const QString& typeFilter, int limit) const
 {
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::searchShapes");
     QVector<Shape> shapes;
     if (!m_isOpen) return shapes;
 
-    QString sql = "SELECT * FROM shapes WHERE 1=1";
     QVector<QString> params;
-
     if (!searchText.isEmpty()) {
-        sql += " AND designation LIKE ?";
         params.append("%" + searchText + "%");
     }
     if (!typeFilter.isEmpty()) {
-        sql += " AND shape_type = ?";
         params.append(typeFilter);
     }
-    sql += " ORDER BY designation LIMIT ?";
 
     QSqlQuery query(m_db);
-    query.prepare(sql);
+    query.setForwardOnly(true);
+    query.prepare(shapeSearchSql(!searchText.isEmpty(), !typeFilter.isEmpty()));
     for (const QString& p : params) {
         query.addBindValue(p);
     }
     query.addBindValue(limit);
 
-    if (query.exec()) {
-        while (query.next()) {
-            Shape shape;
-            shape.id = query.value("id").toInt();
-            shape.designation = query.value("designation").toString();
-            shape.shapeType = query.value("shape_type").toString();
-            shape.wLbPerFt = query.value("w_lb_per_ft").toDouble();
-            shapes.append(shape);
-        }
-    }
-    return shapes;
+    if (!query.exec()) return shapes;
+    return mapAll<ShapeMapper>(query);
 }
 
 QStringList ProjectDatabase::getAllDesignations() const
@@ -686,7 +1014,7 @@ QStringList ProjectDatabase::getAllDesignations() const
     if (!m_isOpen) return designations;
 
     QSqlQuery query(m_db);
-    query.exec("SELECT designation FROM shapes ORDER BY designation");
+    query.exec(SQL_GET_DESIGNATIONS);
     
     while (query.next()) {
         designations.append(query.value(0).toString());
@@ -700,7 +1028,7 @@ QStringList ProjectDatabase::getShapeTypes() const
     if (!m_isOpen) return types;
 
     QSqlQuery query(m_db);
-    query.exec("SELECT DISTINCT shape_type FROM shapes ORDER BY shape_type");
+    query.exec(SQL_GET_SHAPE_TYPES);
     
     while (query.next()) {
         types.append(query.value(0).toString());
@@ -713,7 +1041,7 @@ int ProjectDatabase::getShapeCount() const
     if (!m_isOpen) return 0;
 
     QSqlQuery query(m_db);
-    query.exec("SELECT COUNT(*) FROM shapes");
+    query.exec(SQL_COUNT_SHAPES);
     if (query.next()) {
         return query.value(0).toInt();
     }
@@ -730,34 +1058,83 @@ void ProjectDatabase::clearShapes()
     if (!m_isOpen) return;
     QSqlQuery query(m_db);
     query.exec("DELETE FROM shapes");
+    query.exec("DELETE FROM shape_properties");
+}
+
+ShapeProperties ProjectDatabase::loadShapeProperties() const
+{
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::loadShapeProperties");
+    ShapeProperties properties;
+    if (!m_isOpen) return properties;
+
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    query.exec("SELECT name, data FROM shape_properties ORDER BY position");
+
+    while (query.next()) {
+        int index = properties.addProperty(query.value(0).toString());
+        properties.setColumnFromBlob(index, query.value(1).toByteArray());
+    }
+    return properties;
+}
+
+bool ProjectDatabase::saveShapeProperties(const ShapeProperties& properties)
+{
+    if (!m_isOpen) return false;
+
+    m_db.transaction();
+
+    QSqlQuery query(m_db);
+    query.exec("DELETE FROM shape_properties");
+
+    query.prepare("INSERT INTO shape_properties (name, position, data) VALUES (?, ?, ?)");
+    const QStringList names = properties.propertyNames();
+    for (int i = 0; i < names.size(); ++i) {
+        query.bindValue(0, names[i]);
+        query.bindValue(1, i);
+        query.bindValue(2, properties.columnToBlob(i));
+        if (!query.exec()) {
+            m_lastError = query.lastError().text();
+            m_db.rollback();
+            return false;
+        }
+    }
+
+    return m_db.commit();
 }
 
 int ProjectDatabase::importShapesFromCsv(const QString& filePath)
 {
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::importShapesFromCsv");
     if (!m_isOpen) return -1;
 
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        m_lastError = "Could not open file: " + filePath;
+    CsvReader reader;
+    if (!reader.open(filePath)) {
+        m_lastError = reader.lastError();
         return -1;
     }
 
-    QTextStream in(&file);
-    QString headerLine = in.readLine();
-    if (headerLine.isEmpty()) {
+    if (!reader.readRow() || reader.isBlankRow()) {
         m_lastError = "Empty CSV file";
         return -1;
     }
 
     // Parse header to find column indices
-    QStringList headers = headerLine.split(',');
     int desigCol = -1, typeCol = -1, weightCol = -1;
 
-    for (int i = 0; i < headers.size(); ++i) {
-        QString h = headers[i].trimmed().toUpper();
-        if (h.contains("AISC") && h.contains("LABEL")) desigCol = i;
-        else if (h == "TYPE" || h == "SHAPE_TYPE") typeCol = i;
-        else if (h == "W" || h == "W(LB/FT)" || h.contains("WEIGHT") || h.contains("LB/FT")) weightCol = i;
+    // The AISC v16 database repeats its headers for the SI section; the
+    // first occurrence of each is the US customary one
+    bool labelFound = false;
+    for (int i = 0; i < reader.fieldCount(); ++i) {
+        QString h = reader.field(i).toString().trimmed().toUpper();
+        if (h.contains("AISC") && h.contains("LABEL")) {
+            if (!labelFound) desigCol = i;
+            labelFound = true;
+        } else if ((h == "TYPE" || h == "SHAPE_TYPE") && typeCol < 0) {
+            typeCol = i;
+        } else if ((h == "W" || h == "W(LB/FT)" || h.contains("WEIGHT") || h.contains("LB/FT")) && weightCol < 0) {
+            weightCol = i;
+        }
         // Fallback: first column is often the designation
         if (desigCol == -1 && i == 0) desigCol = i;
     }
@@ -767,53 +1144,321 @@ int ProjectDatabase::importShapesFromCsv(const QString& filePath)
         return -1;
     }
 
-    // Start transaction for performance
+    // Every other column is a candidate numeric property; columns holding
+    // text (e.g. EDI nomenclature, T/F flags) are dropped after the scan
+    ShapeProperties properties = loadShapeProperties();
+    QVector<int> propertyForColumn(reader.fieldCount(), -1);
+    QVector<QString> columnNames(reader.fieldCount());
+    QVector<bool> columnIsText(reader.fieldCount(), false);
+    QSet<QString> seenNames;
+    for (int i = 0; i < reader.fieldCount(); ++i) {
+        QString name = reader.field(i).toString().trimmed();
+        // Repeated names are the SI columns; keep them apart from the US ones
+        if (seenNames.contains(name)) {
+            name += "_SI";
+        }
+        if (seenNames.contains(name)) {
+            continue;
+        }
+        seenNames.insert(name);
+        columnNames[i] = name;
+        if (i != desigCol && i != typeCol && !name.isEmpty()) {
+            propertyForColumn[i] = properties.addProperty(name);
+        }
+    }
+
+    // Single transaction and prepared statements reused for every row
     m_db.transaction();
 
+    QSqlQuery query(m_db);
+    QSqlQuery lookup(m_db);
+    if (!query.prepare(SQL_UPSERT_SHAPE) || !lookup.prepare(SQL_GET_SHAPE_ID)) {
+        m_lastError = query.lastError().isValid() ? query.lastError().text() : lookup.lastError().text();
+        m_db.rollback();
+        return -1;
+    }
+
     int imported = 0;
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        if (line.trimmed().isEmpty()) continue;
+    while (reader.readRow()) {
+        if (reader.isBlankRow() || reader.fieldCount() <= desigCol) continue;
 
-        QStringList fields = line.split(',');
-        if (fields.size() <= desigCol) continue;
+        const CsvReader::Field& desigField = reader.field(desigCol);
+        if (desigField.isEmpty()) continue;
 
-        QString designation = fields[desigCol].trimmed();
-        if (designation.isEmpty()) continue;
+        QString designation = desigField.toString();
 
         QString shapeType;
-        if (typeCol >= 0 && typeCol < fields.size()) {
-            shapeType = fields[typeCol].trimmed();
+        if (typeCol >= 0 && typeCol < reader.fieldCount()) {
+            shapeType = reader.field(typeCol).toString();
         } else {
-            // Derive type from designation prefix
-            if (designation.startsWith("W")) shapeType = "W";
-            else if (designation.startsWith("HSS")) shapeType = "HSS";
-            else if (designation.startsWith("C")) shapeType = "C";
-            else if (designation.startsWith("L")) shapeType = "L";
-            else if (designation.startsWith("WT")) shapeType = "WT";
-            else if (designation.startsWith("MC")) shapeType = "MC";
-            else if (designation.startsWith("PIPE")) shapeType = "PIPE";
-            else if (designation.startsWith("ST")) shapeType = "ST";
-            else if (designation.startsWith("HP")) shapeType = "HP";
-            else shapeType = "OTHER";
+            shapeType = shapeTypeFromDesignation(designation);
         }
 
         double weight = 0.0;
-        if (weightCol >= 0 && weightCol < fields.size()) {
-            weight = fields[weightCol].trimmed().toDouble();
+        if (weightCol >= 0 && weightCol < reader.fieldCount()) {
+            // Non-numeric placeholders (e.g. "-") leave the weight at 0
+            weight = reader.field(weightCol).toDouble();
         }
 
-        if (insertShape(designation, shapeType, weight) > 0) {
-            imported++;
+        const int shapeId = upsertShape(query, lookup, designation, shapeType, weight, &m_lastError);
+        if (shapeId < 0) {
+            continue;
+        }
+        imported++;
+
+        properties.reserveShapeId(shapeId);
+        const int columns = qMin(reader.fieldCount(), propertyForColumn.size());
+        for (int i = 0; i < columns; ++i) {
+            int property = propertyForColumn[i];
+            if (property < 0 || columnIsText[i]) continue;
+
+            const CsvReader::Field& field = reader.field(i);
+            bool ok = false;
+            double value = field.toDouble(&ok);
+            if (ok) {
+                properties.setValue(shapeId, property, value);
+            } else if (containsLetter(field)) {
+                // Dashes and blanks mean "not applicable"; letters mean text
+                columnIsText[i] = true;
+            }
         }
     }
 
     m_db.commit();
-    file.close();
+
+    // Rebuild without text columns, keeping previously stored properties
+    ShapeProperties numeric;
+    const QStringList names = properties.propertyNames();
+    for (int p = 0; p < names.size(); ++p) {
+        int column = columnNames.indexOf(names[p]);
+        if (column >= 0 && columnIsText[column]) continue;
+        int index = numeric.addProperty(names[p]);
+        numeric.setColumnFromBlob(index, properties.columnToBlob(p));
+    }
+    saveShapeProperties(numeric);
 
     return imported;
 }
 
+QString ProjectDatabase::shapeTypeFromDesignation(const QString& designation)
+{
+    // Longer prefixes first so that e.g. WT is not classified as W
+    if (designation.startsWith("HSS")) return "HSS";
+    if (designation.startsWith("PIPE")) return "PIPE";
+    if (designation.startsWith("WT")) return "WT";
+    if (designation.startsWith("MC")) return "MC";
+    if (designation.startsWith("ST")) return "ST";
+    if (designation.startsWith("HP")) return "HP";
+    if (designation.startsWith("W")) return "W";
+    if (designation.startsWith("C")) return "C";
+    if (designation.startsWith("L")) return "L";
+    return "OTHER";
+}
+
+// =========================================================================
+// Page Text Index
+// =========================================================================
+
+bool ProjectDatabase::replacePageText(const QString& pageId, const QVector<PdfWord>& words)
+{
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::replacePageText");
+    if (!m_isOpen) return false;
+
+    m_db.transaction();
+    if (!writePageText(pageId, words)) {
+        m_db.rollback();
+        return false;
+    }
+    return m_db.commit();
+}
+
+bool ProjectDatabase::writePageText(const QString& pageId, const QVector<PdfWord>& words)
+{
+    QSqlQuery query(m_db);
+    for (const char* sql : {SQL_DELETE_PAGE_WORDS, SQL_DELETE_PAGE_TEXT_STATUS}) {
+        query.prepare(sql);
+        query.addBindValue(pageId);
+        if (!query.exec()) {
+            m_lastError = query.lastError().text();
+            return false;
+        }
+    }
+
+    int wordCount = 0;
+    query.prepare("INSERT INTO page_words (term, page_id, text, x, y, w, h) VALUES (?, ?, ?, ?, ?, ?, ?)");
+    for (const PdfWord& word : words) {
+        QString term = normalizeTerm(word.text);
+        if (term.isEmpty()) {
+            continue;
+        }
+        query.bindValue(0, term);
+        query.bindValue(1, pageId);
+        query.bindValue(2, word.text);
+        query.bindValue(3, word.rect.x());
+        query.bindValue(4, word.rect.y());
+        query.bindValue(5, word.rect.width());
+        query.bindValue(6, word.rect.height());
+        if (!query.exec()) {
+            m_lastError = query.lastError().text();
+            return false;
+        }
+        ++wordCount;
+    }
+
+    query.prepare("INSERT INTO page_text_status (page_id, word_count) VALUES (?, ?)");
+    query.addBindValue(pageId);
+    query.addBindValue(wordCount);
+    if (!query.exec()) {
+        m_lastError = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QStringList ProjectDatabase::getIndexedPageIds() const
+{
+    QStringList pageIds;
+    if (!m_isOpen) return pageIds;
+
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    query.exec(SQL_GET_INDEXED_PAGES);
+
+    while (query.next()) {
+        pageIds.append(query.value(0).toString());
+    }
+    return pageIds;
+}
+
+QVector<ProjectDatabase::TextHit> ProjectDatabase::searchPageText(const QString& text, int limit) const
+{
+    TAKEOFF_TRACE_SCOPE("ProjectDatabase::searchPageText");
+    QVector<TextHit> hits;
+    if (!m_isOpen) return hits;
+
+    const QString prefix = normalizeTerm(text);
+    if (prefix.isEmpty()) return hits;
+
+    // Prefix match as a range on the term index: [prefix, prefix with its
+    // last character incremented)
+    QString upperBound = prefix;
+    upperBound[upperBound.size() - 1] = QChar(upperBound.at(upperBound.size() - 1).unicode() + 1);
+
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    query.prepare(SQL_SEARCH_PAGE_WORDS);
+    query.addBindValue(prefix);
+    query.addBindValue(upperBound);
+    query.addBindValue(limit);
+
+    if (!query.exec()) {
+        m_lastError = query.lastError().text();
+        return hits;
+    }
+
+    while (query.next()) {
+        TextHit hit;
+        hit.pageId = query.value(0).toString();
+        hit.text = query.value(1).toString();
+        hit.rect = QRectF(query.value(2).toDouble(), query.value(3).toDouble(),
+                          query.value(4).toDouble(), query.value(5).toDouble());
+        hits.append(hit);
+    }
+    return hits;
+}
+
+QString ProjectDatabase::normalizeTerm(const QString& word)
+{
+    // Callouts are matched case-insensitively and without the punctuation
+    // that often surrounds them on a sheet, e.g. "(W12X26)," -> "W12X26"
+    int begin = 0;
+    int end = word.size();
+    while (begin < end && !word.at(begin).isLetterOrNumber()) ++begin;
+    while (end > begin && !word.at(end - 1).isLetterOrNumber()) --end;
+    return word.mid(begin, end - begin).toUpper();
+}
+
+// =========================================================================
+// Query Plans
+// =========================================================================
+
+QStringList ProjectDatabase::checkQueryPlans() const
+{
+    QStringList problems;
+    if (!m_isOpen) return problems;
+
+    struct Statement {
+        const char* name;
+        QString sql;
+        bool fullScanExpected;  // Loads every row anyway
+    };
+
+    const QVector<Statement> statements = {
+        {"getProjectSetting", SQL_GET_SETTING, false},
+        {"insertPage", SQL_INSERT_PAGE, false},
+        {"updatePage", SQL_UPDATE_PAGE, false},
+        {"insertTakeoffItem", SQL_INSERT_ITEM, false},
+        {"insertTakeoffItem (page key)", SQL_GET_PAGE_KEY, false},
+        {"updateTakeoffItem", SQL_UPDATE_ITEM, false},
+        {"deletePage (items)", SQL_DELETE_PAGE_ITEMS, false},
+        {"deletePage", SQL_DELETE_PAGE, false},
+        {"getPage", SQL_GET_PAGE, false},
+        {"getAllPages", SQL_GET_ALL_PAGES, true},
+        {"getPageThumbnails", SQL_GET_PAGE_THUMBNAILS, true},
+        {"deleteTakeoffItem", SQL_DELETE_ITEM, false},
+        {"updatePageCalibration (lengths)", SQL_UPDATE_ITEM_LENGTH, false},
+        {"getTakeoffItem", SQL_GET_ITEM, false},
+        {"getTakeoffItemsForPage", SQL_GET_PAGE_ITEMS, false},
+        {"getAllTakeoffItems", SQL_GET_ALL_ITEMS, true},
+        {"updateShape", SQL_UPDATE_SHAPE, false},
+        {"deleteShape", SQL_DELETE_SHAPE, false},
+        {"getShape", SQL_GET_SHAPE, false},
+        {"getShapeByDesignation", SQL_GET_SHAPE_BY_DESIGNATION, false},
+        {"importShapesFromCsv", SQL_UPSERT_SHAPE, false},
+        {"importShapesFromCsv (id)", SQL_GET_SHAPE_ID, false},
+        {"getAllShapes", SQL_GET_ALL_SHAPES, true},
+        {"searchShapes", shapeSearchSql(false, false), true},
+        {"searchShapes (text)", shapeSearchSql(true, false), true},
+        {"searchShapes (type)", shapeSearchSql(false, true), false},
+        {"searchShapes (text, type)", shapeSearchSql(true, true), false},
+        {"getAllDesignations", SQL_GET_DESIGNATIONS, true},
+        {"getShapeTypes", SQL_GET_SHAPE_TYPES, true},
+        {"getShapeCount", SQL_COUNT_SHAPES, true},
+        {"deletePage (words)", SQL_DELETE_PAGE_WORDS, false},
+        {"deletePage (text status)", SQL_DELETE_PAGE_TEXT_STATUS, false},
+        {"getIndexedPageIds", SQL_GET_INDEXED_PAGES, true},
+        {"searchPageText", SQL_SEARCH_PAGE_WORDS, false}
+    };
+
+    for (const Statement& statement : statements) {
+        QSqlQuery query(m_db);
+        if (!query.prepare("EXPLAIN QUERY PLAN " + statement.sql)) {
+            problems.append(QString("%1: %2").arg(statement.name, query.lastError().text()));
+            continue;
+        }
+        // Placeholders are bound to NULL; the plan does not depend on values
+        for (int i = statement.sql.count('?'); i > 0; --i) {
+            query.addBindValue(QVariant());
+        }
+        if (!query.exec()) {
+            problems.append(QString("%1: %2").arg(statement.name, query.lastError().text()));
+            continue;
+        }
+
+        while (query.next()) {
+            QString detail = query.value(3).toString();
+            // A full table scan reads "SCAN <table>" (no index); sorting
+            // without an index shows up as a temporary B-tree.
+            bool tableScan = detail.startsWith("SCAN") && !detail.contains("USING");
+            bool tempSort = detail.contains("TEMP B-TREE");
+            if ((tableScan && !statement.fullScanExpected) || tempSort) {
+                problems.append(QString("%1: %2").arg(statement.name, detail));
+            }
+        }
+    }
+    return problems;
+}
+
 QString ProjectDatabase::lastError() const
 {
     return m_lastError;
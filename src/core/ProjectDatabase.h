@@ -1,15 +1,26 @@
 #ifndef PROJECTDATABASE_H
 #define PROJECTDATABASE_H
 
+#include <QByteArray>
+#include <QHash>
 #include <QString>
 #include <QVector>
+#include <QStringList>
 #include <QPointF>
+#include <QRectF>
 #include <QSqlDatabase>
+#include <memory>
+
+#include "ShapeProperties.h"
+#include "SchemaMigrator.h"
 
 // Forward declarations
 class TakeoffItem;
+class TakeoffItemStore;
 class Page;
 struct ShapeRow;
+struct PdfWord;
+struct ImportedPage;
 
 /**
  * @brief Manages SQLite database for project persistence.
@@ -52,6 +63,52 @@ public:
      */
     QString filePath() const;
 
+    // =========================================================================
+    // Schema Migrations
+    // =========================================================================
+
+    /**
+     * @brief Get the schema version of the open file.
+     */
+    int schemaVersion() const;
+
+    /**
+     * @brief Read the schema version of a file without opening it.
+     *
+     * The file is opened read-only and never migrated, so callers can
+     * refuse to touch files that open() would upgrade in place.
+     * @param path Path to the .takeoff.db file
+     * @param error Receives the reason if the version cannot be read
+     * @return PRAGMA user_version of the file, or -1 on error
+     */
+    static int fileSchemaVersion(const QString& path, QString* error = nullptr);
+
+    /**
+     * @brief Check if incremental data migrations are still pending.
+     *
+     * Schema changes are applied on open; large data rewrites are deferred
+     * and run in batches through runMigrationStep().
+     */
+    bool hasPendingMigrationWork() const;
+
+    /**
+     * @brief Number of runMigrationStep() calls still needed.
+     * @param batchSize Rows rewritten per step
+     */
+    int pendingMigrationBatches(int batchSize = 500) const;
+
+    /**
+     * @brief Run one batch of pending data migration work.
+     * @param batchSize Maximum rows to rewrite
+     * @return Rows processed, or -1 on error
+     */
+    int runMigrationStep(int batchSize = 500);
+
+    /**
+     * @brief Get applied migrations with their recorded timings.
+     */
+    QVector<SchemaMigrator::Record> migrationHistory() const;
+
     // =========================================================================
     // Project Settings
     // =========================================================================
@@ -71,21 +128,73 @@ public:
 
     bool insertPage(const Page& page);
     bool updatePage(const Page& page);
+
+    /**
+     * @brief Store a page's calibration and its items' new lengths in one transaction.
+     * @param page Page holding the new calibration
+     * @param itemIds Items whose length changes
+     * @param lengthsInches New length of each item, same order as itemIds
+     * @return true if everything was stored; on failure nothing is
+     */
+    bool updatePageCalibration(const Page& page, const QVector<int>& itemIds,
+                               const QVector<double>& lengthsInches);
+
     bool deletePage(const QString& pageId);
     Page getPage(const QString& pageId) const;
     QVector<Page> getAllPages() const;
 
+    /**
+     * @brief Insert pages prepared by PdfImporter.
+     *
+     * Pages, thumbnails and extracted text are written in one transaction,
+     * so a failed import leaves the project unchanged.
+     * @return true if successful
+     */
+    bool insertImportedPages(const QVector<ImportedPage>& pages);
+
+    /**
+     * @brief Get the stored PNG thumbnails, keyed by page ID.
+     */
+    QHash<QString, QByteArray> getPageThumbnails() const;
+
     // =========================================================================
     // Takeoff Items
     // =========================================================================
 
+    // Inserting or updating fails, with lastError() set, if the item's
+    // page does not exist
     int insertTakeoffItem(const TakeoffItem& item);  // Returns new ID
+
+    /**
+     * @brief Insert many items in one transaction with one prepared statement.
+     * @param items Items to insert; their IDs are set on success
+     * @return true if all items were stored; on failure, including an
+     *         unknown page, none are
+     */
+    bool insertTakeoffItems(QVector<TakeoffItem>& items);
+
     bool updateTakeoffItem(const TakeoffItem& item);
     bool deleteTakeoffItem(int itemId);
     TakeoffItem getTakeoffItem(int itemId) const;
     QVector<TakeoffItem> getTakeoffItemsForPage(const QString& pageId) const;
+
+    /**
+     * @brief Get every item in ID order.
+     *
+     * Includes items whose page was lost before page keys were enforced;
+     * they have an empty page ID.
+     */
     QVector<TakeoffItem> getAllTakeoffItems() const;
 
+    /**
+     * @brief Load every item straight into a columnar store.
+     *
+     * Point blobs are decoded into the store's geometry arena without an
+     * intermediate vector per item.
+     * @return false if the query failed; the store is left empty
+     */
+    bool loadTakeoffItems(TakeoffItemStore& store) const;
+
     // =========================================================================
     // Shapes (AISC database)
     // =========================================================================
@@ -111,24 +220,89 @@ public:
     bool hasShapes() const;
     void clearShapes();
 
+    // =========================================================================
+    // Page Text Index
+    // =========================================================================
+
+    struct TextHit {
+        QString pageId;
+        QString text;   // The word as printed
+        QRectF rect;    // Scene coordinates on the page
+    };
+
+    /**
+     * @brief Replace the indexed text of a page.
+     *
+     * Words are stored under a normalized term (upper case, surrounding
+     * punctuation removed) in an index ordered by term, so lookups are a
+     * single range scan. The page is marked as indexed even if it has no
+     * words.
+     * @return true if successful
+     */
+    bool replacePageText(const QString& pageId, const QVector<PdfWord>& words);
+
+    /**
+     * @brief Get the IDs of pages whose text has been indexed.
+     */
+    QStringList getIndexedPageIds() const;
+
+    /**
+     * @brief Find words starting with a query.
+     * @param text Query, normalized like the indexed terms
+     * @param limit Maximum hits
+     * @return Hits ordered by term, then page
+     */
+    QVector<TextHit> searchPageText(const QString& text, int limit = 200) const;
+
     /**
      * @brief Import shapes from CSV file.
+     * 
+     * The file is memory-mapped and tokenized in place (RFC 4180 quoting),
+     * and all rows are inserted in one transaction with a single prepared
+     * statement.
      * @param filePath Path to CSV file
      * @return Number of shapes imported, or -1 on error
      */
     int importShapesFromCsv(const QString& filePath);
 
+    /**
+     * @brief Load the numeric AISC properties of all shapes.
+     *
+     * Every numeric column of the imported CSV is kept as a packed column
+     * indexed by shape ID.
+     */
+    ShapeProperties loadShapeProperties() const;
+
+    /**
+     * @brief Replace the stored shape properties.
+     * @return true if successful
+     */
+    bool saveShapeProperties(const ShapeProperties& properties);
+
+    /**
+     * @brief Check the query plans of all indexed statements.
+     *
+     * Runs EXPLAIN QUERY PLAN for every lookup, filter and ordered query
+     * issued by this class. A statement is reported if it falls back to a
+     * full table scan (unless it reads every row by design) or sorts
+     * through a temporary B-tree. Run by the unit tests, not on open.
+     * @return One entry per problem, empty if all plans are indexed
+     */
+    QStringList checkQueryPlans() const;
+
     /**
      * @brief Get the last error message.
      */
     QString lastError() const;
 
 private:
-    void createSchema();
-    QString serializePoints(const QVector<QPointF>& points) const;
-    QVector<QPointF> deserializePoints(const QString& json) const;
+    bool migrateSchema();
+    static QString shapeTypeFromDesignation(const QString& designation);
+    bool writePageText(const QString& pageId, const QVector<PdfWord>& words);
+    static QString normalizeTerm(const QString& word);
 
     QSqlDatabase m_db;
+    std::unique_ptr<SchemaMigrator> m_migrator;
     QString m_connectionName;
     QString m_filePath;
     mutable QString m_lastError;
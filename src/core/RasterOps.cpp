@@ -0,0 +1,107 @@
+#include "RasterOps.h"
+#include "ParallelFor.h"
+
+#include <QPainter>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RASTEROPS_SSE2
+#endif
+
+namespace {
+
+const int BAND_ROWS = 256;
+
+} // namespace
+
+QImage RasterOps::toGrayscale(const QImage& image, const std::atomic<bool>* cancelled)
+{
+    if (image.format() == QImage::Format_Grayscale8) {
+        return image;
+    }
+
+    const int width = image.width();
+    const int height = image.height();
+    QImage gray(width, height, QImage::Format_Grayscale8);
+    if (gray.isNull()) {
+        return gray;
+    }
+
+    // Take raw pointers up front so worker threads never touch QImage's
+    // detach logic on the shared destination
+    uchar* bits = gray.bits();
+    const qsizetype bytesPerLine = gray.bytesPerLine();
+    const bool hasAlpha = image.hasAlphaChannel();
+
+    const int bandCount = (height + BAND_ROWS - 1) / BAND_ROWS;
+    parallelFor(bandCount, [&](int band) {
+        if (isCancelled(cancelled)) return;
+        const int y0 = band * BAND_ROWS;
+        const int rows = std::min(BAND_ROWS, height - y0);
+
+        QImage part = image.copy(0, y0, width, rows);
+        if (hasAlpha) {
+            // Composite onto white so transparent areas read as paper
+            QImage opaque(part.size(), QImage::Format_RGB32);
+            opaque.fill(Qt::white);
+            QPainter painter(&opaque);
+            painter.drawImage(0, 0, part);
+            painter.end();
+            part = opaque;
+        }
+        part = part.convertToFormat(QImage::Format_Grayscale8);
+
+        for (int r = 0; r < rows; ++r) {
+            std::memcpy(bits + (y0 + r) * bytesPerLine, part.constScanLine(r), width);
+        }
+    });
+    return gray;
+}
+
+QImage RasterOps::downsample2x(const QImage& gray)
+{
+    const int width = gray.width() / 2;
+    const int height = gray.height() / 2;
+    QImage half(width, height, QImage::Format_Grayscale8);
+    if (half.isNull()) {
+        return half;
+    }
+
+    uchar* bits = half.bits();
+    const qsizetype bytesPerLine = half.bytesPerLine();
+
+    const int bandCount = (height + BAND_ROWS - 1) / BAND_ROWS;
+    parallelFor(bandCount, [&](int band) {
+        const int y1 = std::min(height, (band + 1) * BAND_ROWS);
+        for (int y = band * BAND_ROWS; y < y1; ++y) {
+            const uchar* top = gray.constScanLine(2 * y);
+            const uchar* bottom = gray.constScanLine(2 * y + 1);
+            uchar* out = bits + y * bytesPerLine;
+
+            int x = 0;
+#ifdef RASTEROPS_SSE2
+            // Average vertically, then average even/odd byte pairs. Both
+            // steps round, which is within one gray level of the exact mean.
+            const __m128i evenMask = _mm_set1_epi16(0x00FF);
+            for (; x + 16 <= width; x += 16) {
+                __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + 2 * x));
+                __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + 2 * x + 16));
+                __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + 2 * x));
+                __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + 2 * x + 16));
+                __m128i v0 = _mm_avg_epu8(a0, b0);
+                __m128i v1 = _mm_avg_epu8(a1, b1);
+                __m128i even = _mm_packus_epi16(_mm_and_si128(v0, evenMask), _mm_and_si128(v1, evenMask));
+                __m128i odd = _mm_packus_epi16(_mm_srli_epi16(v0, 8), _mm_srli_epi16(v1, 8));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_avg_epu8(even, odd));
+            }
+#endif
+            for (; x < width; ++x) {
+                int sum = top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1];
+                out[x] = static_cast<uchar>((sum + 2) / 4);
+            }
+        }
+    });
+    return half;
+}
@@ -0,0 +1,35 @@
+#ifndef RASTEROPS_H
+#define RASTEROPS_H
+
+#include <QImage>
+#include <atomic>
+
+/**
+ * @brief Shared grayscale raster helpers for the sheet analysis passes.
+ *
+ * All functions work band by band on the global thread pool.
+ */
+class RasterOps
+{
+public:
+    /**
+     * @brief Convert any image to Format_Grayscale8.
+     * @param image Source image; transparent areas are composited onto white
+     * @param cancelled Optional flag polled between bands
+     */
+    static QImage toGrayscale(const QImage& image, const std::atomic<bool>* cancelled = nullptr);
+
+    /**
+     * @brief Halve a grayscale image with a 2x2 box filter.
+     *
+     * Odd trailing rows and columns are dropped.
+     */
+    static QImage downsample2x(const QImage& gray);
+
+    static bool isCancelled(const std::atomic<bool>* cancelled)
+    {
+        return cancelled && cancelled->load(std::memory_order_relaxed);
+    }
+};
+
+#endif // RASTEROPS_H
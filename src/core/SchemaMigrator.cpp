@@ -0,0 +1,485 @@
+#include "SchemaMigrator.h"
+#include "PointCodec.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QPair>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+bool execAll(QSqlQuery& query, const QStringList& statements)
+{
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Converts legacy JSON point text to packed binary, one batch at a time
+int convertPointsToBlob(QSqlDatabase& db, qint64& cursor, int batchSize)
+{
+    QSqlQuery select(db);
+    select.setForwardOnly(true);
+    select.prepare(R"(
+        SELECT id, points FROM takeoff_items
+        WHERE id > ? AND points IS NOT NULL
+        ORDER BY id LIMIT ?
+    )");
+    select.addBindValue(cursor);
+    select.addBindValue(batchSize);
+    if (!select.exec()) {
+        return -1;
+    }
+
+    QVector<QPair<qint64, QByteArray>> rows;
+    while (select.next()) {
+        rows.append(qMakePair(select.value(0).toLongLong(),
+                              PointCodec::toBlob(PointCodec::fromJson(select.value(1).toString()))));
+    }
+    select.finish();
+
+    if (rows.isEmpty()) {
+        return 0;
+    }
+
+    db.transaction();
+    QSqlQuery update(db);
+    update.prepare("UPDATE takeoff_items SET points_blob = ?, points = NULL WHERE id = ?");
+    for (const auto& row : rows) {
+        update.bindValue(0, row.second);
+        update.bindValue(1, row.first);
+        if (!update.exec()) {
+            db.rollback();
+            return -1;
+        }
+    }
+    db.commit();
+
+    cursor = rows.last().first;
+    return rows.size();
+}
+
+qint64 countJsonPoints(QSqlDatabase& db, qint64 cursor)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT COUNT(*) FROM takeoff_items WHERE id > ? AND points IS NOT NULL");
+    query.addBindValue(cursor);
+    if (!query.exec() || !query.next()) {
+        return 0;
+    }
+    return query.value(0).toLongLong();
+}
+
+} // namespace
+
+SchemaMigrator::SchemaMigrator(const QSqlDatabase& db)
+    : m_db(db)
+{
+}
+
+const QVector<SchemaMigrator::Migration>& SchemaMigrator::migrations()
+{
+    // Append new migrations at the end; never edit a released one.
+    static const QVector<Migration> list = {
+        {
+            1, "Initial schema",
+            [](QSqlQuery& query) {
+                return execAll(query, {
+                    R"(CREATE TABLE IF NOT EXISTS project (
+                        key TEXT PRIMARY KEY,
+                        value TEXT
+                    ))",
+                    R"(CREATE TABLE IF NOT EXISTS pages (
+                        id TEXT PRIMARY KEY,
+                        type TEXT,
+                        source_path TEXT,
+                        pdf_page_index INTEGER,
+                        pdf_total_pages INTEGER,
+                        display_name TEXT,
+                        calibration_ppi REAL,
+                        calib_pt1_x REAL,
+                        calib_pt1_y REAL,
+                        calib_pt2_x REAL,
+                        calib_pt2_y REAL
+                    ))",
+                    R"(CREATE TABLE IF NOT EXISTS shapes (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        designation TEXT UNIQUE,
+                        shape_type TEXT,
+                        w_lb_per_ft REAL
+                    ))",
+                    R"(CREATE TABLE IF NOT EXISTS takeoff_items (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        page_id TEXT REFERENCES pages(id),
+                        kind TEXT,
+                        points TEXT,
+                        length_in REAL,
+                        qty INTEGER DEFAULT 1,
+                        shape_id INTEGER REFERENCES shapes(id),
+                        designation TEXT,
+                        notes TEXT
+                    ))",
+                    "CREATE INDEX IF NOT EXISTS idx_shapes_type ON shapes(shape_type)",
+                    "CREATE INDEX IF NOT EXISTS idx_shapes_designation ON shapes(designation)",
+                    "CREATE INDEX IF NOT EXISTS idx_items_page ON takeoff_items(page_id)"
+                });
+            },
+            nullptr
+        },
+        {
+            2, "Shape property columns",
+            [](QSqlQuery& query) {
+                return execAll(query, {
+                    R"(CREATE TABLE IF NOT EXISTS shape_properties (
+                        name TEXT PRIMARY KEY,
+                        position INTEGER,
+                        data BLOB
+                    ))"
+                });
+            },
+            nullptr
+        },
+        {
+            3, "Binary point storage",
+            [](QSqlQuery& query) {
+                return execAll(query, {
+                    "ALTER TABLE takeoff_items ADD COLUMN points_blob BLOB"
+                });
+            },
+            convertPointsToBlob,
+            countJsonPoints
+        },
+        {
+            4, "Covering shape indexes",
+            [](QSqlQuery& query) {
+                return execAll(query, {
+                    // designation is UNIQUE, so its autoindex already serves
+                    // equality lookups; these two cover the ordered searches
+                    "DROP INDEX IF EXISTS idx_shapes_designation",
+                    "DROP INDEX IF EXISTS idx_shapes_type",
+                    "CREATE INDEX IF NOT EXISTS idx_shapes_designation_cover "
+                        "ON shapes(designation, shape_type, w_lb_per_ft)",
+                    "CREATE INDEX IF NOT EXISTS idx_shapes_type_designation "
+                        "ON shapes(shape_type, designation, w_lb_per_ft)"
+                });
+            },
+            nullptr
+        },
+        {
+            5, "Page text index",
+            [](QSqlQuery& query) {
+                return execAll(query, {
+                    // One row per word occurrence; term is the normalized
+                    // word, text is as printed, the rect is in scene units
+                    R"(CREATE TABLE IF NOT EXISTS page_words (
+                        term TEXT NOT NULL,
+                        page_id TEXT NOT NULL REFERENCES pages(id),
+                        text TEXT,
+                        x REAL,
+                        y REAL,
+                        w REAL,
+                        h REAL
+                    ))",
+                    "CREATE INDEX IF NOT EXISTS idx_page_words_term ON page_words(term, page_id)",
+                    "CREATE INDEX IF NOT EXISTS idx_page_words_page ON page_words(page_id)",
+                    // Pages whose text layer has been extracted, including
+                    // pages without any text, so they are not extracted again
+                    R"(CREATE TABLE IF NOT EXISTS page_text_status (
+                        page_id TEXT PRIMARY KEY REFERENCES pages(id),
+                        word_count INTEGER
+                    ))"
+                });
+            },
+            nullptr
+        },
+        {
+            6, "Page sizes and thumbnails",
+            [](QSqlQuery& query) {
+                return execAll(query, {
+                    // Source size in PDF points or image pixels, 0 if unknown
+                    "ALTER TABLE pages ADD COLUMN source_width REAL DEFAULT 0",
+                    "ALTER TABLE pages ADD COLUMN source_height REAL DEFAULT 0",
+                    // PNG preview for the page list
+                    "ALTER TABLE pages ADD COLUMN thumbnail BLOB"
+                });
+            },
+            nullptr
+        },
+        {
+            7, "Integer page keys",
+            [](QSqlQuery& query) {
+                return execAll(query, {
+                    // Pages keep their UUID for the application but get an
+                    // integer key, which items now refer to instead of the
+                    // 38-character UUID text. The old rowid becomes the key,
+                    // so page order is unchanged.
+                    R"(CREATE TABLE pages_v7 (
+                        key INTEGER PRIMARY KEY,
+                        id TEXT NOT NULL UNIQUE,
+                        type TEXT,
+                        source_path TEXT,
+                        pdf_page_index INTEGER,
+                        pdf_total_pages INTEGER,
+                        display_name TEXT,
+                        calibration_ppi REAL,
+                        calib_pt1_x REAL,
+                        calib_pt1_y REAL,
+                        calib_pt2_x REAL,
+                        calib_pt2_y REAL,
+                        source_width REAL DEFAULT 0,
+                        source_height REAL DEFAULT 0,
+                        thumbnail BLOB
+                    ))",
+                    R"(INSERT INTO pages_v7
+                        SELECT rowid, id, type, source_path, pdf_page_index, pdf_total_pages,
+                               display_name, calibration_ppi, calib_pt1_x, calib_pt1_y,
+                               calib_pt2_x, calib_pt2_y, source_width, source_height, thumbnail
+                        FROM pages)",
+                    R"(CREATE TABLE takeoff_items_v7 (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        page_id INTEGER REFERENCES pages(key),
+                        kind TEXT,
+                        points TEXT,
+                        length_in REAL,
+                        qty INTEGER DEFAULT 1,
+                        shape_id INTEGER REFERENCES shapes(id),
+                        designation TEXT,
+                        notes TEXT,
+                        points_blob BLOB
+                    ))",
+                    // LEFT JOIN so items without a matching page are
+                    // carried over with a NULL key rather than dropped
+                    R"(INSERT INTO takeoff_items_v7
+                        SELECT t.id, p.key, t.kind, t.points, t.length_in, t.qty,
+                               t.shape_id, t.designation, t.notes, t.points_blob
+                        FROM takeoff_items t LEFT JOIN pages_v7 p ON p.id = t.page_id)",
+                    // Carry the ID counter over so IDs of deleted items are
+                    // not handed out again
+                    "DELETE FROM sqlite_sequence WHERE name = 'takeoff_items_v7'",
+                    "INSERT INTO sqlite_sequence (name, seq) "
+                        "SELECT 'takeoff_items_v7', seq FROM sqlite_sequence WHERE name = 'takeoff_items'",
+                    "DROP TABLE takeoff_items",
+                    "DROP TABLE pages",
+                    "ALTER TABLE pages_v7 RENAME TO pages",
+                    "ALTER TABLE takeoff_items_v7 RENAME TO takeoff_items",
+                    "CREATE INDEX IF NOT EXISTS idx_items_page ON takeoff_items(page_id)"
+                });
+            },
+            nullptr
+        }
+    };
+    return list;
+}
+
+const SchemaMigrator::Migration* SchemaMigrator::findMigration(int version)
+{
+    for (const Migration& migration : migrations()) {
+        if (migration.version == version) {
+            return &migration;
+        }
+    }
+    return nullptr;
+}
+
+int SchemaMigrator::latestVersion()
+{
+    return migrations().isEmpty() ? 0 : migrations().last().version;
+}
+
+int SchemaMigrator::currentVersion() const
+{
+    QSqlQuery query(m_db);
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+bool SchemaMigrator::migrate()
+{
+    QSqlQuery query(m_db);
+    query.exec(R"(
+        CREATE TABLE IF NOT EXISTS schema_migrations (
+            version INTEGER PRIMARY KEY,
+            description TEXT,
+            applied_at TEXT,
+            duration_ms REAL,
+            background_done INTEGER DEFAULT 1,
+            background_ms REAL DEFAULT 0
+        )
+    )");
+
+    int current = currentVersion();
+    if (current > latestVersion()) {
+        m_lastError = QString("Project file uses schema version %1, but this version "
+                              "of the application only supports up to %2.")
+                          .arg(current).arg(latestVersion());
+        return false;
+    }
+
+    for (const Migration& migration : migrations()) {
+        if (migration.version > current && !applyMigration(migration)) {
+            return false;
+        }
+    }
+
+    loadPendingBackgroundWork();
+    return true;
+}
+
+bool SchemaMigrator::applyMigration(const Migration& migration)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!m_db.transaction()) {
+        m_lastError = m_db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(m_db);
+    if (!migration.apply(query) ||
+        !query.exec(QString("PRAGMA user_version = %1").arg(migration.version))) {
+        m_lastError = QString("Schema migration %1 (%2) failed: %3")
+                          .arg(migration.version)
+                          .arg(migration.description, query.lastError().text());
+        m_db.rollback();
+        return false;
+    }
+
+    double durationMs = timer.nsecsElapsed() / 1.0e6;
+
+    query.prepare(R"(
+        INSERT OR REPLACE INTO schema_migrations
+            (version, description, applied_at, duration_ms, background_done, background_ms)
+        VALUES (?, ?, ?, ?, ?, 0)
+    )");
+    query.addBindValue(migration.version);
+    query.addBindValue(migration.description);
+    query.addBindValue(QDateTime::currentDateTime().toString(Qt::ISODate));
+    query.addBindValue(durationMs);
+    query.addBindValue(migration.backgroundStep ? 0 : 1);
+    if (!query.exec()) {
+        m_lastError = query.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+
+    if (!m_db.commit()) {
+        m_lastError = m_db.lastError().text();
+        return false;
+    }
+
+    qInfo().noquote() << QString("Applied schema migration %1 (%2) in %3 ms")
+                             .arg(migration.version)
+                             .arg(migration.description)
+                             .arg(durationMs, 0, 'f', 2);
+    return true;
+}
+
+void SchemaMigrator::loadPendingBackgroundWork()
+{
+    m_pending.clear();
+
+    QSqlQuery query(m_db);
+    query.exec("SELECT version, background_ms FROM schema_migrations "
+               "WHERE background_done = 0 ORDER BY version");
+    while (query.next()) {
+        const Migration* migration = findMigration(query.value(0).toInt());
+        if (migration && migration->backgroundStep) {
+            BackgroundState state;
+            state.version = migration->version;
+            state.elapsedMs = query.value(1).toDouble();
+            if (migration->backgroundRemaining) {
+                state.remainingRows = migration->backgroundRemaining(m_db, state.cursor);
+            }
+            m_pending.append(state);
+        }
+    }
+}
+
+bool SchemaMigrator::hasPendingBackgroundWork() const
+{
+    return !m_pending.isEmpty();
+}
+
+qint64 SchemaMigrator::pendingBackgroundRows() const
+{
+    qint64 rows = 0;
+    for (const BackgroundState& state : m_pending) {
+        rows += state.remainingRows;
+    }
+    return rows;
+}
+
+int SchemaMigrator::runBackgroundStep(int batchSize)
+{
+    if (m_pending.isEmpty()) {
+        return 0;
+    }
+
+    BackgroundState& state = m_pending.first();
+    const Migration* migration = findMigration(state.version);
+
+    QElapsedTimer timer;
+    timer.start();
+    int processed = migration->backgroundStep(m_db, state.cursor, batchSize);
+    state.elapsedMs += timer.nsecsElapsed() / 1.0e6;
+    if (processed > 0) {
+        state.remainingRows = std::max<qint64>(0, state.remainingRows - processed);
+    }
+
+    if (processed < 0) {
+        m_lastError = QString("Background migration %1 (%2) failed: %3")
+                          .arg(migration->version)
+                          .arg(migration->description, m_db.lastError().text());
+        return -1;
+    }
+
+    QSqlQuery query(m_db);
+    query.prepare("UPDATE schema_migrations SET background_ms = ?, background_done = ? WHERE version = ?");
+    query.addBindValue(state.elapsedMs);
+    query.addBindValue(processed == 0 ? 1 : 0);
+    query.addBindValue(state.version);
+    query.exec();
+
+    if (processed == 0) {
+        qInfo().noquote() << QString("Finished background migration %1 (%2) in %3 ms")
+                                 .arg(migration->version)
+                                 .arg(migration->description)
+                                 .arg(state.elapsedMs, 0, 'f', 2);
+        m_pending.removeFirst();
+    }
+    return processed;
+}
+
+QVector<SchemaMigrator::Record> SchemaMigrator::history() const
+{
+    QVector<Record> records;
+
+    QSqlQuery query(m_db);
+    query.exec("SELECT version, description, applied_at, duration_ms, background_done, background_ms "
+               "FROM schema_migrations ORDER BY version");
+    while (query.next()) {
+        Record record;
+        record.version = query.value(0).toInt();
+        record.description = query.value(1).toString();
+        record.appliedAt = query.value(2).toString();
+        record.durationMs = query.value(3).toDouble();
+        record.backgroundDone = query.value(4).toInt() != 0;
+        record.backgroundMs = query.value(5).toDouble();
+        records.append(record);
+    }
+    return records;
+}
+
+QString SchemaMigrator::lastError() const
+{
+    return m_lastError;
+}
@@ -0,0 +1,117 @@
+#ifndef SCHEMAMIGRATOR_H
+#define SCHEMAMIGRATOR_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+class QSqlQuery;
+
+/**
+ * @brief Applies ordered schema migrations to a .takeoff.db file.
+ *
+ * The schema version is tracked in SQLite's PRAGMA user_version. Each
+ * pending migration runs in its own transaction together with the version
+ * bump, so a failed migration leaves the file at the previous version.
+ *
+ * Migrations that rewrite large amounts of data can register a background
+ * step. The schema change is applied immediately; the data rewrite is then
+ * run in small batches (see runBackgroundStep()) while the project is open.
+ *
+ * Timing for every migration is recorded in the schema_migrations table.
+ */
+class SchemaMigrator
+{
+public:
+    struct Migration {
+        int version = 0;
+        QString description;
+
+        /// Schema change, executed inside the migration transaction
+        std::function<bool(QSqlQuery&)> apply;
+
+        /**
+         * Optional incremental data rewrite. Processes up to batchSize rows
+         * with rowid > cursor and advances the cursor. Returns the number of
+         * rows processed, 0 when finished, or -1 on error.
+         */
+        std::function<int(QSqlDatabase&, qint64& cursor, int batchSize)> backgroundStep;
+
+        /// Rows the background step still has to rewrite beyond cursor
+        std::function<qint64(QSqlDatabase&, qint64 cursor)> backgroundRemaining;
+    };
+
+    struct Record {
+        int version = 0;
+        QString description;
+        QString appliedAt;
+        double durationMs = 0.0;
+        bool backgroundDone = true;
+        double backgroundMs = 0.0;
+    };
+
+    explicit SchemaMigrator(const QSqlDatabase& db);
+
+    /**
+     * @brief Highest schema version known to this build.
+     */
+    static int latestVersion();
+
+    /**
+     * @brief Schema version of the open file (PRAGMA user_version).
+     */
+    int currentVersion() const;
+
+    /**
+     * @brief Apply all pending migrations.
+     * @return false if a migration failed or the file is from a newer build
+     */
+    bool migrate();
+
+    /**
+     * @brief Check if any background data rewrites are still pending.
+     */
+    bool hasPendingBackgroundWork() const;
+
+    /**
+     * @brief Rows still to be rewritten by pending background steps.
+     *
+     * Counted once when the file is opened and decremented as batches
+     * complete, so it is cheap enough to poll.
+     */
+    qint64 pendingBackgroundRows() const;
+
+    /**
+     * @brief Run one batch of the oldest pending background rewrite.
+     * @param batchSize Maximum rows to process
+     * @return Rows processed, or -1 on error
+     */
+    int runBackgroundStep(int batchSize);
+
+    /**
+     * @brief Get the recorded migration history, oldest first.
+     */
+    QVector<Record> history() const;
+
+    QString lastError() const;
+
+private:
+    static const QVector<Migration>& migrations();
+    static const Migration* findMigration(int version);
+    bool applyMigration(const Migration& migration);
+    void loadPendingBackgroundWork();
+
+    struct BackgroundState {
+        int version = 0;
+        qint64 cursor = 0;
+        qint64 remainingRows = 0;
+        double elapsedMs = 0.0;
+    };
+
+    QSqlDatabase m_db;
+    QVector<BackgroundState> m_pending;
+    QString m_lastError;
+};
+
+#endif // SCHEMAMIGRATOR_H
@@ -0,0 +1,158 @@
+#include "ShapeProperties.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const double MISSING = std::numeric_limits<double>::quiet_NaN();
+
+} // namespace
+
+ShapeProperties::ShapeProperties()
+    : m_rowCount(0)
+{
+}
+
+void ShapeProperties::clear()
+{
+    m_names.clear();
+    m_indexByName.clear();
+    m_columns.clear();
+    m_rowCount = 0;
+}
+
+bool ShapeProperties::isEmpty() const
+{
+    return m_columns.isEmpty();
+}
+
+int ShapeProperties::propertyCount() const
+{
+    return m_columns.size();
+}
+
+int ShapeProperties::rowCount() const
+{
+    return m_rowCount;
+}
+
+QStringList ShapeProperties::propertyNames() const
+{
+    return m_names;
+}
+
+int ShapeProperties::propertyIndex(const QString& name) const
+{
+    return m_indexByName.value(name, -1);
+}
+
+int ShapeProperties::addProperty(const QString& name)
+{
+    int existing = propertyIndex(name);
+    if (existing >= 0) {
+        return existing;
+    }
+
+    int index = m_columns.size();
+    m_names.append(name);
+    m_indexByName.insert(name, index);
+    m_columns.append(QVector<double>(m_rowCount, MISSING));
+    return index;
+}
+
+void ShapeProperties::reserveShapeId(int shapeId)
+{
+    if (shapeId < m_rowCount) {
+        return;
+    }
+
+    // Reserve geometrically so importing in ID order stays linear, but only
+    // size the columns up to this ID so rowCount() is exact
+    int newRowCount = shapeId + 1;
+    for (QVector<double>& column : m_columns) {
+        if (column.capacity() < newRowCount) {
+            column.reserve(qMax(newRowCount, m_rowCount + m_rowCount / 2));
+        }
+        column.resize(newRowCount);
+        std::fill(column.begin() + m_rowCount, column.end(), MISSING);
+    }
+    m_rowCount = newRowCount;
+}
+
+void ShapeProperties::setValue(int shapeId, int property, double value)
+{
+    if (shapeId < 0 || property < 0 || property >= m_columns.size()) {
+        return;
+    }
+    reserveShapeId(shapeId);
+    m_columns[property][shapeId] = value;
+}
+
+double ShapeProperties::value(int shapeId, int property) const
+{
+    if (shapeId < 0 || shapeId >= m_rowCount || property < 0 || property >= m_columns.size()) {
+        return MISSING;
+    }
+    return m_columns[property][shapeId];
+}
+
+double ShapeProperties::value(int shapeId, const QString& name) const
+{
+    return value(shapeId, propertyIndex(name));
+}
+
+const QVector<double>& ShapeProperties::column(int property) const
+{
+    static const QVector<double> empty;
+    if (property < 0 || property >= m_columns.size()) {
+        return empty;
+    }
+    return m_columns[property];
+}
+
+double ShapeProperties::weightedSum(int property, const int* shapeIds, const double* weights, int count) const
+{
+    if (property < 0 || property >= m_columns.size()) {
+        return 0.0;
+    }
+
+    const double* values = m_columns[property].constData();
+    const unsigned rows = static_cast<unsigned>(m_rowCount);
+    double sum = 0.0;
+    for (int i = 0; i < count; ++i) {
+        // Unsigned compare rejects negative IDs (unassigned items) as well
+        if (static_cast<unsigned>(shapeIds[i]) < rows) {
+            double v = values[shapeIds[i]];
+            if (!std::isnan(v)) {
+                sum += v * weights[i];
+            }
+        }
+    }
+    return sum;
+}
+
+QByteArray ShapeProperties::columnToBlob(int property) const
+{
+    if (property < 0 || property >= m_columns.size()) {
+        return QByteArray();
+    }
+    const QVector<double>& column = m_columns[property];
+    return QByteArray(reinterpret_cast<const char*>(column.constData()),
+                      static_cast<int>(column.size() * sizeof(double)));
+}
+
+void ShapeProperties::setColumnFromBlob(int property, const QByteArray& blob)
+{
+    if (property < 0 || property >= m_columns.size()) {
+        return;
+    }
+
+    int rows = static_cast<int>(blob.size() / sizeof(double));
+    reserveShapeId(rows - 1);
+
+    QVector<double>& column = m_columns[property];
+    std::memcpy(column.data(), blob.constData(), rows * sizeof(double));
+}
@@ -0,0 +1,95 @@
+#ifndef SHAPEPROPERTIES_H
+#define SHAPEPROPERTIES_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+
+/**
+ * @brief Columnar store for numeric AISC shape properties.
+ *
+ * Each property (A, d, bf, tw, Ix, ...) is a contiguous array of doubles
+ * indexed directly by shape ID, so aggregate queries over many shapes are
+ * tight scans over one array instead of per-row lookups. Missing values
+ * are stored as NaN.
+ */
+class ShapeProperties
+{
+public:
+    ShapeProperties();
+
+    /**
+     * @brief Remove all properties and values.
+     */
+    void clear();
+
+    bool isEmpty() const;
+
+    /**
+     * @brief Number of property columns.
+     */
+    int propertyCount() const;
+
+    /**
+     * @brief Number of rows in every column (highest shape ID + 1).
+     */
+    int rowCount() const;
+
+    QStringList propertyNames() const;
+
+    /**
+     * @brief Get the column index of a property.
+     * @return Column index, or -1 if not present
+     */
+    int propertyIndex(const QString& name) const;
+
+    /**
+     * @brief Add a property column (no-op if it already exists).
+     * @return Column index
+     */
+    int addProperty(const QString& name);
+
+    /**
+     * @brief Grow every column so it can hold the given shape ID.
+     *
+     * New rows are missing values. Does nothing if the ID already fits.
+     */
+    void reserveShapeId(int shapeId);
+
+    void setValue(int shapeId, int property, double value);
+
+    /**
+     * @brief Get a property value.
+     * @return Value, or NaN if missing
+     */
+    double value(int shapeId, int property) const;
+    double value(int shapeId, const QString& name) const;
+
+    /**
+     * @brief Raw column data, rowCount() values indexed by shape ID.
+     */
+    const QVector<double>& column(int property) const;
+
+    /**
+     * @brief Sum of property[shapeIds[i]] * weights[i] over all i.
+     *
+     * Entries with an invalid shape ID or a missing value are skipped.
+     * For example, with per-foot properties and weights in feet this gives
+     * the project-wide total of that property.
+     */
+    double weightedSum(int property, const int* shapeIds, const double* weights, int count) const;
+
+    // Serialization of a single column (native-endian packed doubles)
+    QByteArray columnToBlob(int property) const;
+    void setColumnFromBlob(int property, const QByteArray& blob);
+
+private:
+    QStringList m_names;
+    QHash<QString, int> m_indexByName;
+    QVector<QVector<double>> m_columns;
+    int m_rowCount;
+};
+
+#endif // SHAPEPROPERTIES_H
@@ -0,0 +1,367 @@
+#include "SnapEngine.h"
+
+#include <QPair>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Grid dimensions are capped so a sheet full of tiny segments cannot
+// allocate an unbounded number of cells
+const int MAX_GRID_DIMENSION = 2048;
+
+// Intersections are only searched among this many segments near the cursor
+const int MAX_INTERSECTION_CANDIDATES = 64;
+
+// Overlay cell size in scene units. Measurements are few and sparse, so a
+// fixed size keeps the overlay independent of the sheet grid.
+const double OVERLAY_CELL_SIZE = 128.0;
+
+// Calls visit(cx, cy) for every grid cell a segment crosses
+// (Amanatides-Woo). Cells are counted from origin and are not clamped.
+template <typename Visit>
+void walkCells(const QLineF& seg, const QPointF& origin, double cellSize, Visit visit)
+{
+    double x0 = (seg.x1() - origin.x()) / cellSize;
+    double y0 = (seg.y1() - origin.y()) / cellSize;
+    double dx = (seg.x2() - seg.x1()) / cellSize;
+    double dy = (seg.y2() - seg.y1()) / cellSize;
+
+    int cx = static_cast<int>(std::floor(x0));
+    int cy = static_cast<int>(std::floor(y0));
+    int endX = static_cast<int>(std::floor(x0 + dx));
+    int endY = static_cast<int>(std::floor(y0 + dy));
+    int stepX = dx > 0 ? 1 : -1;
+    int stepY = dy > 0 ? 1 : -1;
+
+    const double inf = std::numeric_limits<double>::infinity();
+    double tMaxX = dx != 0.0 ? ((stepX > 0 ? cx + 1 : cx) - x0) / dx : inf;
+    double tMaxY = dy != 0.0 ? ((stepY > 0 ? cy + 1 : cy) - y0) / dy : inf;
+    double tDeltaX = dx != 0.0 ? std::abs(1.0 / dx) : inf;
+    double tDeltaY = dy != 0.0 ? std::abs(1.0 / dy) : inf;
+
+    visit(cx, cy);
+    int steps = std::abs(endX - cx) + std::abs(endY - cy);
+    for (int s = 0; s < steps; ++s) {
+        if (tMaxX < tMaxY) {
+            cx += stepX;
+            tMaxX += tDeltaX;
+        } else {
+            cy += stepY;
+            tMaxY += tDeltaY;
+        }
+        visit(cx, cy);
+    }
+}
+
+// Builds compressed cell lists from (cell, value) pairs with a counting sort
+void buildCellLists(const QVector<QPair<int, int>>& pairs, int cellCount,
+                    QVector<int>& start, QVector<int>& entries)
+{
+    start.fill(0, cellCount + 1);
+    for (const auto& pair : pairs) {
+        ++start[pair.first + 1];
+    }
+    for (int i = 0; i < cellCount; ++i) {
+        start[i + 1] += start[i];
+    }
+
+    entries.resize(pairs.size());
+    QVector<int> fill = start;
+    for (const auto& pair : pairs) {
+        entries[fill[pair.first]++] = pair.second;
+    }
+}
+
+} // namespace
+
+SnapEngine::SnapEngine()
+    : m_cellSize(1.0)
+    , m_columns(0)
+    , m_rows(0)
+    , m_overlaySegmentCount(0)
+    , m_overlayMinX(std::numeric_limits<int>::max())
+    , m_overlayMinY(std::numeric_limits<int>::max())
+    , m_overlayMaxX(std::numeric_limits<int>::min())
+    , m_overlayMaxY(std::numeric_limits<int>::min())
+    , m_currentStamp(0)
+{
+}
+
+void SnapEngine::clear()
+{
+    clearOverlay();
+    setSegments(QVector<QLineF>());
+}
+
+int SnapEngine::segmentCount() const
+{
+    return m_segments.size() + m_overlaySegmentCount;
+}
+
+bool SnapEngine::isEmpty() const
+{
+    return segmentCount() == 0;
+}
+
+int SnapEngine::cellX(double x) const
+{
+    int cx = static_cast<int>(std::floor((x - m_bounds.left()) / m_cellSize));
+    return qBound(0, cx, m_columns - 1);
+}
+
+int SnapEngine::cellY(double y) const
+{
+    int cy = static_cast<int>(std::floor((y - m_bounds.top()) / m_cellSize));
+    return qBound(0, cy, m_rows - 1);
+}
+
+void SnapEngine::setSegments(const QVector<QLineF>& segments)
+{
+    m_segments.clear();
+    m_bounds = QRectF();
+    m_columns = 0;
+    m_rows = 0;
+    m_segmentCellStart.clear();
+    m_segmentCellEntries.clear();
+    m_pointCellStart.clear();
+    m_pointCellEntries.clear();
+    m_points.clear();
+    m_pointKinds.clear();
+    m_visitStamp.clear();
+    m_currentStamp = 0;
+    if (segments.isEmpty()) {
+        return;
+    }
+    m_segments = segments;
+
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxY = std::numeric_limits<double>::lowest();
+    for (const QLineF& seg : m_segments) {
+        minX = std::min({minX, seg.x1(), seg.x2()});
+        minY = std::min({minY, seg.y1(), seg.y2()});
+        maxX = std::max({maxX, seg.x1(), seg.x2()});
+        maxY = std::max({maxY, seg.y1(), seg.y2()});
+    }
+    m_bounds = QRectF(QPointF(minX, minY), QPointF(maxX, maxY)).adjusted(-1.0, -1.0, 1.0, 1.0);
+
+    // Aim for a few segments per cell on an evenly filled sheet
+    double area = m_bounds.width() * m_bounds.height();
+    m_cellSize = std::max(1.0, 2.0 * std::sqrt(area / m_segments.size()));
+    m_cellSize = std::max({m_cellSize,
+                           m_bounds.width() / MAX_GRID_DIMENSION,
+                           m_bounds.height() / MAX_GRID_DIMENSION});
+    m_columns = std::max(1, static_cast<int>(std::ceil(m_bounds.width() / m_cellSize)));
+    m_rows = std::max(1, static_cast<int>(std::ceil(m_bounds.height() / m_cellSize)));
+    const int cellCount = m_columns * m_rows;
+
+    // Walk each segment through the grid cells it crosses
+    QVector<QPair<int, int>> segmentPairs;
+    segmentPairs.reserve(m_segments.size() * 2);
+    for (int i = 0; i < m_segments.size(); ++i) {
+        walkCells(m_segments[i], m_bounds.topLeft(), m_cellSize, [&](int cx, int cy) {
+            segmentPairs.append(qMakePair(cellIndex(qBound(0, cx, m_columns - 1),
+                                                    qBound(0, cy, m_rows - 1)), i));
+        });
+    }
+    buildCellLists(segmentPairs, cellCount, m_segmentCellStart, m_segmentCellEntries);
+
+    m_points.reserve(m_segments.size() * 3);
+    m_pointKinds.reserve(m_segments.size() * 3);
+    for (const QLineF& seg : m_segments) {
+        m_points.append(seg.p1());
+        m_pointKinds.append(Kind::Endpoint);
+        m_points.append(seg.p2());
+        m_pointKinds.append(Kind::Endpoint);
+        m_points.append(seg.center());
+        m_pointKinds.append(Kind::Midpoint);
+    }
+
+    QVector<QPair<int, int>> pointPairs;
+    pointPairs.reserve(m_points.size());
+    for (int i = 0; i < m_points.size(); ++i) {
+        pointPairs.append(qMakePair(cellIndex(cellX(m_points[i].x()), cellY(m_points[i].y())), i));
+    }
+    buildCellLists(pointPairs, cellCount, m_pointCellStart, m_pointCellEntries);
+
+    m_visitStamp.fill(0, m_segments.size());
+}
+
+void SnapEngine::addSegments(int key, const QVector<QLineF>& segments)
+{
+    removeSegments(key);
+    if (segments.isEmpty()) {
+        return;
+    }
+    m_overlayGroups.insert(key, segments);
+    m_overlaySegmentCount += segments.size();
+
+    for (const QLineF& seg : segments) {
+        walkCells(seg, QPointF(), OVERLAY_CELL_SIZE, [&](int cx, int cy) {
+            m_overlayCells[overlayCellKey(cx, cy)].append(OverlayEntry{key, seg});
+            m_overlayMinX = std::min(m_overlayMinX, cx);
+            m_overlayMinY = std::min(m_overlayMinY, cy);
+            m_overlayMaxX = std::max(m_overlayMaxX, cx);
+            m_overlayMaxY = std::max(m_overlayMaxY, cy);
+        });
+    }
+}
+
+void SnapEngine::removeSegments(int key)
+{
+    auto group = m_overlayGroups.find(key);
+    if (group == m_overlayGroups.end()) {
+        return;
+    }
+
+    for (const QLineF& seg : group.value()) {
+        walkCells(seg, QPointF(), OVERLAY_CELL_SIZE, [&](int cx, int cy) {
+            auto cell = m_overlayCells.find(overlayCellKey(cx, cy));
+            if (cell == m_overlayCells.end()) {
+                return;
+            }
+            QVector<OverlayEntry>& entries = cell.value();
+            entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                         [key](const OverlayEntry& entry) { return entry.key == key; }),
+                          entries.end());
+            if (entries.isEmpty()) {
+                m_overlayCells.erase(cell);
+            }
+        });
+    }
+    m_overlaySegmentCount -= group.value().size();
+    m_overlayGroups.erase(group);
+    if (m_overlayGroups.isEmpty()) {
+        clearOverlay();
+    }
+}
+
+void SnapEngine::clearOverlay()
+{
+    m_overlayGroups.clear();
+    m_overlayCells.clear();
+    m_overlaySegmentCount = 0;
+    m_overlayMinX = std::numeric_limits<int>::max();
+    m_overlayMinY = std::numeric_limits<int>::max();
+    m_overlayMaxX = std::numeric_limits<int>::min();
+    m_overlayMaxY = std::numeric_limits<int>::min();
+}
+
+SnapEngine::Result SnapEngine::snap(const QPointF& pos, double tolerance) const
+{
+    Result best;
+    if (isEmpty() || tolerance <= 0.0) {
+        return best;
+    }
+
+    QRectF box(pos.x() - tolerance, pos.y() - tolerance, tolerance * 2, tolerance * 2);
+    best.distance = tolerance;
+    auto consider = [&](Kind kind, const QPointF& pt) {
+        double d = std::hypot(pt.x() - pos.x(), pt.y() - pos.y());
+        bool closer = d < best.distance;
+        bool preferred = d == best.distance && best.kind == Kind::Midpoint && kind != Kind::Midpoint;
+        if (closer || preferred || (d <= tolerance && best.kind == Kind::None)) {
+            best.kind = kind;
+            best.point = pt;
+            best.distance = d;
+        }
+    };
+    auto crossesBox = [&](const QLineF& seg) {
+        QRectF segBounds = QRectF(seg.p1(), seg.p2()).normalized();
+        return segBounds.right() >= box.left() && segBounds.left() <= box.right() &&
+               segBounds.bottom() >= box.top() && segBounds.top() <= box.bottom();
+    };
+
+    QLineF candidates[MAX_INTERSECTION_CANDIDATES];
+    int candidateCount = 0;
+
+    if (!m_segments.isEmpty() && box.intersects(m_bounds)) {
+        const int x0 = cellX(box.left());
+        const int x1 = cellX(box.right());
+        const int y0 = cellY(box.top());
+        const int y1 = cellY(box.bottom());
+
+        // Endpoints and midpoints
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                int cell = cellIndex(cx, cy);
+                for (int e = m_pointCellStart[cell]; e < m_pointCellStart[cell + 1]; ++e) {
+                    int p = m_pointCellEntries[e];
+                    consider(m_pointKinds[p], m_points[p]);
+                }
+            }
+        }
+
+        // Collect distinct segments passing through the tolerance box
+        if (++m_currentStamp == 0) {
+            m_visitStamp.fill(0);
+            m_currentStamp = 1;
+        }
+        for (int cy = y0; cy <= y1 && candidateCount < MAX_INTERSECTION_CANDIDATES; ++cy) {
+            for (int cx = x0; cx <= x1 && candidateCount < MAX_INTERSECTION_CANDIDATES; ++cx) {
+                int cell = cellIndex(cx, cy);
+                for (int e = m_segmentCellStart[cell]; e < m_segmentCellStart[cell + 1]; ++e) {
+                    int s = m_segmentCellEntries[e];
+                    if (m_visitStamp[s] == m_currentStamp) {
+                        continue;
+                    }
+                    m_visitStamp[s] = m_currentStamp;
+                    if (!crossesBox(m_segments[s])) {
+                        continue;
+                    }
+                    candidates[candidateCount++] = m_segments[s];
+                    if (candidateCount == MAX_INTERSECTION_CANDIDATES) {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Overlay segments in the cells under the tolerance box. A segment is
+    // listed in every cell it crosses, so candidates are deduplicated; the
+    // overlay is small enough for a linear check.
+    if (m_overlaySegmentCount > 0) {
+        const int x0 = static_cast<int>(std::max<double>(m_overlayMinX, std::floor(box.left() / OVERLAY_CELL_SIZE)));
+        const int x1 = static_cast<int>(std::min<double>(m_overlayMaxX, std::floor(box.right() / OVERLAY_CELL_SIZE)));
+        const int y0 = static_cast<int>(std::max<double>(m_overlayMinY, std::floor(box.top() / OVERLAY_CELL_SIZE)));
+        const int y1 = static_cast<int>(std::min<double>(m_overlayMaxY, std::floor(box.bottom() / OVERLAY_CELL_SIZE)));
+        const int overlayStart = candidateCount;
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                auto cell = m_overlayCells.constFind(overlayCellKey(cx, cy));
+                if (cell == m_overlayCells.constEnd()) {
+                    continue;
+                }
+                for (const OverlayEntry& entry : cell.value()) {
+                    const QLineF& seg = entry.segment;
+                    consider(Kind::Endpoint, seg.p1());
+                    consider(Kind::Endpoint, seg.p2());
+                    consider(Kind::Midpoint, seg.center());
+                    if (candidateCount == MAX_INTERSECTION_CANDIDATES || !crossesBox(seg)) {
+                        continue;
+                    }
+                    QLineF* end = candidates + candidateCount;
+                    if (std::find(candidates + overlayStart, end, seg) == end) {
+                        candidates[candidateCount++] = seg;
+                    }
+                }
+            }
+        }
+    }
+
+    // Intersections between those segments
+    for (int i = 0; i < candidateCount; ++i) {
+        for (int j = i + 1; j < candidateCount; ++j) {
+            QPointF crossing;
+            if (candidates[i].intersects(candidates[j], &crossing) == QLineF::BoundedIntersection) {
+                consider(Kind::Intersection, crossing);
+            }
+        }
+    }
+
+    return best;
+}
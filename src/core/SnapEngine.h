@@ -0,0 +1,135 @@
+#ifndef SNAPENGINE_H
+#define SNAPENGINE_H
+
+#include <QHash>
+#include <QLineF>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+/**
+ * @brief Nearest-feature snapping over a sheet's line segments.
+ *
+ * Segments are bucketed into a uniform grid sized so each cell holds a
+ * handful of them. Endpoints and midpoints are indexed up front;
+ * intersections are computed at query time between the few segments that
+ * pass near the cursor, so building stays linear in the segment count and
+ * a query only touches the cells inside the tolerance box.
+ *
+ * The sheet's segments are indexed once per page with setSegments().
+ * Measurement segments change while the user draws, so they live in a
+ * separate sparse overlay grid keyed by measurement that is updated one
+ * group at a time and searched alongside the sheet grid.
+ *
+ * Queries are not thread-safe (they share a visit stamp buffer).
+ */
+class SnapEngine
+{
+public:
+    enum class Kind {
+        None,
+        Endpoint,
+        Midpoint,
+        Intersection
+    };
+
+    struct Result {
+        Kind kind = Kind::None;
+        QPointF point;
+        double distance = 0.0;
+
+        bool isValid() const { return kind != Kind::None; }
+    };
+
+    SnapEngine();
+
+    /**
+     * @brief Remove all sheet and overlay segments.
+     */
+    void clear();
+
+    /**
+     * @brief Replace the sheet segments and rebuild their grid.
+     *
+     * Overlay segments are kept.
+     */
+    void setSegments(const QVector<QLineF>& segments);
+
+    /**
+     * @brief Index a group of overlay segments under a key.
+     *
+     * Replaces any group already stored under the key. Only the overlay
+     * cells the segments cross are touched.
+     */
+    void addSegments(int key, const QVector<QLineF>& segments);
+
+    /**
+     * @brief Remove the overlay segments stored under a key.
+     */
+    void removeSegments(int key);
+
+    /**
+     * @brief Remove all overlay segments, keeping the sheet grid.
+     */
+    void clearOverlay();
+
+    int segmentCount() const;
+    bool isEmpty() const;
+
+    /**
+     * @brief Find the nearest snap feature to a point.
+     * @param pos Query position in scene coordinates
+     * @param tolerance Search radius in scene units
+     * @return The closest feature within tolerance, or an invalid result.
+     *
+     * Endpoints and intersections win over a midpoint at the same distance.
+     */
+    Result snap(const QPointF& pos, double tolerance) const;
+
+private:
+    int cellIndex(int cx, int cy) const { return cy * m_columns + cx; }
+    int cellX(double x) const;
+    int cellY(double y) const;
+
+    struct OverlayEntry {
+        int key;
+        QLineF segment;
+    };
+
+    static quint64 overlayCellKey(int cx, int cy)
+    {
+        return (static_cast<quint64>(static_cast<quint32>(cx)) << 32) | static_cast<quint32>(cy);
+    }
+    void removeOverlayEntries(int key, const QVector<QLineF>& segments);
+
+    QVector<QLineF> m_segments;
+    QRectF m_bounds;
+    double m_cellSize;
+    int m_columns;
+    int m_rows;
+
+    // Compressed cell lists: entries of cell i are [start[i], start[i + 1])
+    QVector<int> m_segmentCellStart;
+    QVector<int> m_segmentCellEntries;
+
+    // Endpoints and midpoints of every segment
+    QVector<int> m_pointCellStart;
+    QVector<int> m_pointCellEntries;
+    QVector<QPointF> m_points;
+    QVector<Kind> m_pointKinds;
+
+    // Overlay segments by key, and the sparse cells they cross. The cell
+    // range seen so far bounds the cells a query has to look up.
+    QHash<int, QVector<QLineF>> m_overlayGroups;
+    QHash<quint64, QVector<OverlayEntry>> m_overlayCells;
+    int m_overlaySegmentCount;
+    int m_overlayMinX;
+    int m_overlayMinY;
+    int m_overlayMaxX;
+    int m_overlayMaxY;
+
+    mutable QVector<quint32> m_visitStamp;
+    mutable quint32 m_currentStamp;
+};
+
+#endif // SNAPENGINE_H
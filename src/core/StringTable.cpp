@@ -0,0 +1,24 @@
+#include "StringTable.h"
+
+int StringTable::intern(const QString& text)
+{
+    auto it = m_keys.constFind(text);
+    if (it != m_keys.constEnd()) {
+        return it.value();
+    }
+    const int key = m_strings.size();
+    m_strings.append(text);
+    m_keys.insert(text, key);
+    return key;
+}
+
+int StringTable::find(const QString& text) const
+{
+    return m_keys.value(text, -1);
+}
+
+void StringTable::clear()
+{
+    m_strings.clear();
+    m_keys.clear();
+}
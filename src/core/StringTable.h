@@ -0,0 +1,43 @@
+#ifndef STRINGTABLE_H
+#define STRINGTABLE_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Interns strings as dense integer keys.
+ *
+ * Keys are handed out in order of first use starting at 0 and stay valid
+ * until clear(), so columns of keys can be compared and used as array
+ * indexes instead of comparing the strings themselves.
+ */
+class StringTable
+{
+public:
+    /**
+     * @brief Get the key of a string, adding it if it is new.
+     */
+    int intern(const QString& text);
+
+    /**
+     * @brief Get the key of a string without adding it.
+     * @return Key, or -1 if the string was never interned
+     */
+    int find(const QString& text) const;
+
+    /**
+     * @brief Get the string of a key. The key must be valid.
+     */
+    const QString& string(int key) const { return m_strings[key]; }
+
+    int size() const { return m_strings.size(); }
+
+    void clear();
+
+private:
+    QVector<QString> m_strings;
+    QHash<QString, int> m_keys;
+};
+
+#endif // STRINGTABLE_H
@@ -0,0 +1,442 @@
+#include "TemplateMatcher.h"
+#include "ParallelFor.h"
+#include "RasterOps.h"
+
+#include <QHash>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEMPLATEMATCHER_SSE2
+#endif
+
+namespace {
+
+// The coarse search runs on the deepest level where the template's
+// shorter side is still at least this many pixels
+const int COARSE_MIN_SIDE = 12;
+
+// Templates smaller than this cannot be matched meaningfully
+const int MIN_TEMPLATE_SIDE = 4;
+
+// Coarse levels blur detail, so candidates are kept below the final threshold
+const double COARSE_MARGIN = 0.15;
+const double MIN_COARSE_THRESHOLD = 0.3;
+
+// Refinement search radius per pyramid level, in pixels of that level
+const int REFINE_RADIUS = 2;
+
+// Windows with a smaller gray-level standard deviation are blank paper
+const double MIN_WINDOW_STDDEV = 4.0;
+
+const int BAND_ROWS = 32;
+const int MAX_CANDIDATES_PER_VARIANT = 4096;
+
+// Zero-mean template at one pyramid level
+struct TemplateLevel {
+    int width = 0;
+    int height = 0;
+    QVector<qint16> values;   // Pixel minus the rounded mean, row-major
+    double meanFraction = 0.0; // Mean minus the rounded mean
+    double norm = 0.0;        // sqrt(sum((t - mean)^2))
+};
+
+struct Variant {
+    int rotation = 0;
+    double scale = 1.0;
+    int coarseLevel = 0;
+    QVector<TemplateLevel> levels;
+};
+
+struct Candidate {
+    int x;         // Top-left in pixels of the current level
+    int y;
+    double score;
+    int tag = 0;   // Caller-defined, carried through suppression
+};
+
+// Rotates a grayscale image clockwise by a multiple of 90 degrees
+QImage rotateGray(const QImage& gray, int quarterTurns)
+{
+    quarterTurns = ((quarterTurns % 4) + 4) % 4;
+    if (quarterTurns == 0) {
+        return gray;
+    }
+    const int w = gray.width();
+    const int h = gray.height();
+    const bool swap = quarterTurns % 2 == 1;
+    QImage rotated(swap ? h : w, swap ? w : h, QImage::Format_Grayscale8);
+    for (int y = 0; y < h; ++y) {
+        const uchar* row = gray.constScanLine(y);
+        for (int x = 0; x < w; ++x) {
+            int rx, ry;
+            switch (quarterTurns) {
+            case 1: rx = h - 1 - y; ry = x; break;
+            case 2: rx = w - 1 - x; ry = h - 1 - y; break;
+            default: rx = y; ry = w - 1 - x; break;
+            }
+            rotated.scanLine(ry)[rx] = row[x];
+        }
+    }
+    return rotated;
+}
+
+TemplateLevel makeTemplateLevel(const QImage& gray)
+{
+    TemplateLevel level;
+    level.width = gray.width();
+    level.height = gray.height();
+    const int n = level.width * level.height;
+    if (n == 0) {
+        return level;
+    }
+
+    qint64 sum = 0;
+    for (int y = 0; y < level.height; ++y) {
+        const uchar* row = gray.constScanLine(y);
+        for (int x = 0; x < level.width; ++x) {
+            sum += row[x];
+        }
+    }
+    const double mean = static_cast<double>(sum) / n;
+    const int roundedMean = static_cast<int>(std::lround(mean));
+    level.meanFraction = mean - roundedMean;
+
+    level.values.resize(n);
+    double squares = 0.0;
+    for (int y = 0; y < level.height; ++y) {
+        const uchar* row = gray.constScanLine(y);
+        for (int x = 0; x < level.width; ++x) {
+            level.values[y * level.width + x] = static_cast<qint16>(row[x] - roundedMean);
+            double d = row[x] - mean;
+            squares += d * d;
+        }
+    }
+    level.norm = std::sqrt(squares);
+    return level;
+}
+
+// sum(page * t) over the template window at (x, y)
+qint64 correlate(const QImage& page, int x, int y, const TemplateLevel& t)
+{
+    qint64 total = 0;
+    const qint16* values = t.values.constData();
+    for (int r = 0; r < t.height; ++r) {
+        const uchar* row = page.constScanLine(y + r) + x;
+        const qint16* trow = values + r * t.width;
+        int c = 0;
+#ifdef TEMPLATEMATCHER_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        __m128i acc = _mm_setzero_si128();
+        for (; c + 8 <= t.width; c += 8) {
+            __m128i p = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + c)), zero);
+            __m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i*>(trow + c));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(p, q));
+        }
+        alignas(16) qint32 lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        total += static_cast<qint64>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+#endif
+        qint32 tail = 0;
+        for (; c < t.width; ++c) {
+            tail += row[c] * trow[c];
+        }
+        total += tail;
+    }
+    return total;
+}
+
+// Window sum and sum of squares computed directly, for sparse evaluations
+void windowStats(const QImage& page, int x, int y, int w, int h, qint64& sum, qint64& squares)
+{
+    sum = 0;
+    squares = 0;
+    for (int r = 0; r < h; ++r) {
+        const uchar* row = page.constScanLine(y + r) + x;
+        qint32 rowSum = 0;
+        qint32 rowSquares = 0;
+        for (int c = 0; c < w; ++c) {
+            rowSum += row[c];
+            rowSquares += row[c] * row[c];
+        }
+        sum += rowSum;
+        squares += rowSquares;
+    }
+}
+
+double nccScore(qint64 correlation, qint64 sum, qint64 squares, const TemplateLevel& t)
+{
+    const double n = static_cast<double>(t.width) * t.height;
+    const double variance = static_cast<double>(squares) - static_cast<double>(sum) * sum / n;
+    if (variance < MIN_WINDOW_STDDEV * MIN_WINDOW_STDDEV * n || t.norm <= 0.0) {
+        return -1.0;
+    }
+    double numerator = static_cast<double>(correlation) - sum * t.meanFraction;
+    return numerator / (std::sqrt(variance) * t.norm);
+}
+
+// Greedy suppression: keep the best candidate, drop others whose top-left
+// lies within radius of a kept one. Uses a hash grid so the cost stays
+// linear in the candidate count.
+QVector<Candidate> suppress(QVector<Candidate> candidates, double radius, int limit)
+{
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.score > b.score;
+    });
+
+    const double cell = std::max(1.0, radius);
+    auto key = [](int cx, int cy) { return (static_cast<qint64>(cx) << 32) ^ static_cast<quint32>(cy); };
+    QHash<qint64, QVector<int>> grid;
+    QVector<Candidate> kept;
+
+    for (const Candidate& c : candidates) {
+        const int cx = static_cast<int>(std::floor(c.x / cell));
+        const int cy = static_cast<int>(std::floor(c.y / cell));
+        bool blocked = false;
+        for (int dy = -1; dy <= 1 && !blocked; ++dy) {
+            for (int dx = -1; dx <= 1 && !blocked; ++dx) {
+                auto it = grid.constFind(key(cx + dx, cy + dy));
+                if (it == grid.constEnd()) continue;
+                for (int k : *it) {
+                    double ddx = kept[k].x - c.x;
+                    double ddy = kept[k].y - c.y;
+                    if (ddx * ddx + ddy * ddy < radius * radius) {
+                        blocked = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (blocked) continue;
+
+        grid[key(cx, cy)].append(kept.size());
+        kept.append(c);
+        if (kept.size() >= limit) break;
+    }
+    return kept;
+}
+
+// Exhaustive NCC over rows [y0, y1) of one level, using a band-local
+// integral image to reject flat windows before correlating
+void coarseSearchBand(const QImage& page, const TemplateLevel& t, int y0, int y1,
+                      double threshold, QVector<Candidate>& out)
+{
+    const int xCount = page.width() - t.width + 1;
+    const int stride = page.width() + 1;
+    const int rows = y1 - y0 + t.height;
+
+    QVector<qint64> sums(static_cast<qsizetype>(rows + 1) * stride, 0);
+    QVector<qint64> squares(static_cast<qsizetype>(rows + 1) * stride, 0);
+    for (int r = 0; r < rows; ++r) {
+        const uchar* row = page.constScanLine(y0 + r);
+        qint64 rowSum = 0;
+        qint64 rowSquares = 0;
+        qint64* s = sums.data() + (r + 1) * stride;
+        qint64* q = squares.data() + (r + 1) * stride;
+        const qint64* sAbove = s - stride;
+        const qint64* qAbove = q - stride;
+        for (int x = 0; x < page.width(); ++x) {
+            rowSum += row[x];
+            rowSquares += row[x] * row[x];
+            s[x + 1] = sAbove[x + 1] + rowSum;
+            q[x + 1] = qAbove[x + 1] + rowSquares;
+        }
+    }
+
+    auto boxSum = [&](const QVector<qint64>& table, int x, int r) {
+        const qint64* top = table.constData() + r * stride;
+        const qint64* bottom = table.constData() + (r + t.height) * stride;
+        return bottom[x + t.width] - bottom[x] - top[x + t.width] + top[x];
+    };
+
+    const double n = static_cast<double>(t.width) * t.height;
+    const double flatLimit = MIN_WINDOW_STDDEV * MIN_WINDOW_STDDEV * n * n;
+    for (int y = y0; y < y1; ++y) {
+        for (int x = 0; x < xCount; ++x) {
+            qint64 sum = boxSum(sums, x, y - y0);
+            qint64 sq = boxSum(squares, x, y - y0);
+            if (static_cast<double>(sq) * n - static_cast<double>(sum) * sum < flatLimit) {
+                continue;   // Blank paper
+            }
+            double score = nccScore(correlate(page, x, y, t), sum, sq, t);
+            if (score >= threshold) {
+                out.append({x, y, score, 0});
+            }
+        }
+    }
+}
+
+// Best score within +-radius of a candidate on one level
+Candidate refine(const QImage& page, const TemplateLevel& t, const Candidate& c, int radius)
+{
+    Candidate best{c.x, c.y, -2.0, c.tag};
+    const int maxX = page.width() - t.width;
+    const int maxY = page.height() - t.height;
+    for (int y = std::max(0, c.y - radius); y <= std::min(maxY, c.y + radius); ++y) {
+        for (int x = std::max(0, c.x - radius); x <= std::min(maxX, c.x + radius); ++x) {
+            qint64 sum, squares;
+            windowStats(page, x, y, t.width, t.height, sum, squares);
+            double score = nccScore(correlate(page, x, y, t), sum, squares, t);
+            if (score > best.score) {
+                best = {x, y, score, c.tag};
+            }
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+QVector<TemplateMatcher::Match> TemplateMatcher::findMatches(const QImage& image, const QImage& templ,
+                                                             const Options& options,
+                                                             const std::atomic<bool>* cancelled)
+{
+    QVector<Match> matches;
+    if (image.isNull() || templ.isNull()) {
+        return matches;
+    }
+
+    const QImage page = RasterOps::toGrayscale(image, cancelled);
+    const QImage symbol = RasterOps::toGrayscale(templ);
+    if (page.isNull() || symbol.isNull() || RasterOps::isCancelled(cancelled)) {
+        return matches;
+    }
+
+    // Build every rotated and scaled variant with its own template pyramid
+    QVector<Variant> variants;
+    int deepestLevel = 0;
+    const QVector<double> scales = options.scales.isEmpty() ? QVector<double>{1.0} : options.scales;
+    for (double scale : scales) {
+        QImage scaled = symbol;
+        if (scale != 1.0 && scale > 0.0) {
+            QSize size(std::max(1, static_cast<int>(std::lround(symbol.width() * scale))),
+                       std::max(1, static_cast<int>(std::lround(symbol.height() * scale))));
+            scaled = RasterOps::toGrayscale(symbol.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+        }
+        if (std::min(scaled.width(), scaled.height()) < MIN_TEMPLATE_SIDE ||
+            scaled.width() > page.width() || scaled.height() > page.height()) {
+            continue;
+        }
+
+        const int turns = options.rotations ? 4 : 1;
+        for (int turn = 0; turn < turns; ++turn) {
+            Variant variant;
+            variant.rotation = turn * 90;
+            variant.scale = scale;
+
+            QImage level = rotateGray(scaled, turn);
+            variant.levels.append(makeTemplateLevel(level));
+            while (std::min(level.width(), level.height()) / 2 >= COARSE_MIN_SIDE) {
+                level = RasterOps::downsample2x(level);
+                variant.levels.append(makeTemplateLevel(level));
+            }
+            if (variant.levels.first().norm <= 0.0) {
+                return matches;   // A blank selection matches nothing
+            }
+            variant.coarseLevel = variant.levels.size() - 1;
+            deepestLevel = std::max(deepestLevel, variant.coarseLevel);
+            variants.append(variant);
+        }
+    }
+    if (variants.isEmpty()) {
+        return matches;
+    }
+
+    QVector<QImage> pyramid;
+    pyramid.append(page);
+    for (int l = 1; l <= deepestLevel; ++l) {
+        pyramid.append(RasterOps::downsample2x(pyramid.last()));
+    }
+
+    const double coarseThreshold = std::max(MIN_COARSE_THRESHOLD, options.threshold - COARSE_MARGIN);
+
+    // Coarse pass: one tile per (variant, row band) at the variant's coarse level
+    struct Tile {
+        int variant;
+        int y0;
+        int y1;
+    };
+    QVector<Tile> tiles;
+    for (int v = 0; v < variants.size(); ++v) {
+        const Variant& variant = variants[v];
+        const TemplateLevel& t = variant.levels[variant.coarseLevel];
+        const int yCount = pyramid[variant.coarseLevel].height() - t.height + 1;
+        for (int y = 0; y < yCount; y += BAND_ROWS) {
+            tiles.append({v, y, std::min(yCount, y + BAND_ROWS)});
+        }
+    }
+
+    QVector<QVector<Candidate>> tileCandidates(tiles.size());
+    parallelFor(tiles.size(), [&](int i) {
+        if (RasterOps::isCancelled(cancelled)) return;
+        const Tile& tile = tiles[i];
+        const Variant& variant = variants[tile.variant];
+        coarseSearchBand(pyramid[variant.coarseLevel], variant.levels[variant.coarseLevel],
+                         tile.y0, tile.y1, coarseThreshold, tileCandidates[i]);
+    });
+    if (RasterOps::isCancelled(cancelled)) {
+        return matches;
+    }
+
+    QVector<QVector<Candidate>> variantCandidates(variants.size());
+    for (int i = 0; i < tiles.size(); ++i) {
+        variantCandidates[tiles[i].variant] += tileCandidates[i];
+    }
+
+    // Refinement pass: walk each surviving candidate down to full resolution
+    struct Job {
+        int variant;
+        Candidate candidate;
+    };
+    QVector<Job> jobs;
+    for (int v = 0; v < variants.size(); ++v) {
+        const TemplateLevel& t = variants[v].levels[variants[v].coarseLevel];
+        double radius = 0.5 * std::min(t.width, t.height);
+        for (const Candidate& c : suppress(variantCandidates[v], radius, MAX_CANDIDATES_PER_VARIANT)) {
+            jobs.append({v, c});
+        }
+    }
+
+    QVector<Candidate> refined(jobs.size());
+    parallelFor(jobs.size(), [&](int i) {
+        if (RasterOps::isCancelled(cancelled)) return;
+        const Variant& variant = variants[jobs[i].variant];
+        Candidate c = jobs[i].candidate;
+        for (int l = variant.coarseLevel - 1; l >= 0; --l) {
+            c.x *= 2;
+            c.y *= 2;
+            c = refine(pyramid[l], variant.levels[l], c, REFINE_RADIUS);
+        }
+        refined[i] = c;
+    });
+    if (RasterOps::isCancelled(cancelled)) {
+        return matches;
+    }
+
+    // Final suppression across variants, measured between match centers
+    QVector<Candidate> centers;
+    double minSide = std::numeric_limits<double>::max();
+    for (int i = 0; i < jobs.size(); ++i) {
+        if (refined[i].score < options.threshold) continue;
+        const TemplateLevel& t = variants[jobs[i].variant].levels.first();
+        minSide = std::min<double>(minSide, std::min(t.width, t.height));
+        centers.append({refined[i].x + t.width / 2, refined[i].y + t.height / 2, refined[i].score, i});
+    }
+    if (centers.isEmpty()) {
+        return matches;
+    }
+
+    for (const Candidate& c : suppress(centers, 0.5 * minSide, centers.size())) {
+        const Variant& variant = variants[jobs[c.tag].variant];
+        const TemplateLevel& t = variant.levels.first();
+        Match match;
+        match.rect = QRectF(refined[c.tag].x, refined[c.tag].y, t.width, t.height);
+        match.score = c.score;
+        match.rotation = variant.rotation;
+        match.scale = variant.scale;
+        matches.append(match);
+    }
+    return matches;
+}
@@ -0,0 +1,55 @@
+#ifndef TEMPLATEMATCHER_H
+#define TEMPLATEMATCHER_H
+
+#include <QImage>
+#include <QRectF>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief Finds repeated copies of a symbol on a raster sheet.
+ *
+ * Matching uses zero-mean normalized cross-correlation (NCC), which is
+ * insensitive to overall line darkness. The template is expanded into
+ * rotated (0/90/180/270 degrees) and scaled variants. Each variant is
+ * searched exhaustively on a coarse pyramid level where it is only a few
+ * pixels across; surviving candidates are then refined level by level in
+ * a small window down to full resolution.
+ *
+ * Window statistics come from per-band integral images so blank paper is
+ * rejected before any correlation work; the correlation itself uses SSE2
+ * 16-bit multiply-add where available. Bands and candidates are spread
+ * over the global thread pool.
+ */
+class TemplateMatcher
+{
+public:
+    struct Options {
+        double threshold = 0.8;          // Minimum NCC score of a reported match
+        bool rotations = true;           // Also try 90, 180 and 270 degrees
+        QVector<double> scales = {1.0};  // Template scale factors to try
+    };
+
+    struct Match {
+        QRectF rect;          // Matched area in image pixels
+        double score = 0.0;   // NCC in [-1, 1]
+        int rotation = 0;     // Degrees
+        double scale = 1.0;
+
+        QPointF center() const { return rect.center(); }
+    };
+
+    /**
+     * @brief Find all non-overlapping occurrences of a template.
+     * @param image Sheet to search; any QImage format
+     * @param templ Symbol cut from a sheet; any QImage format
+     * @param options Matching parameters
+     * @param cancelled Optional flag polled between tiles
+     * @return Matches sorted by descending score, or empty if cancelled
+     */
+    static QVector<Match> findMatches(const QImage& image, const QImage& templ,
+                                      const Options& options,
+                                      const std::atomic<bool>* cancelled = nullptr);
+};
+
+#endif // TEMPLATEMATCHER_H
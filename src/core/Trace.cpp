@@ -0,0 +1,234 @@
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QThread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+
+struct Event {
+    const char* name;
+    qint64 startNs;
+    qint64 durationNs;
+    int threadId;
+};
+
+// Written only by the thread holding it; `written` counts all events ever
+// recorded, so the newest event is at (written - 1) % EVENTS_PER_THREAD.
+// A finished thread's buffer goes back to the free list and is handed to
+// the next new thread, which keeps appending to the same ring; events
+// carry their own thread id so older ones are still attributed correctly.
+struct ThreadBuffer {
+    int threadId = 0;
+    std::atomic<quint64> written{0};
+    std::unique_ptr<Event[]> events{new Event[Trace::EVENTS_PER_THREAD]};
+};
+
+struct Registry {
+    QMutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<ThreadBuffer*> freeBuffers;
+    QStringList threadNames;            // Indexed by thread id - 1
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+// Returns the calling thread's buffer to the free list when the thread ends
+struct BufferLease {
+    ThreadBuffer* buffer = nullptr;
+
+    ~BufferLease()
+    {
+        if (buffer) {
+            Registry& reg = registry();
+            QMutexLocker locker(&reg.mutex);
+            reg.freeBuffers.push_back(buffer);
+        }
+    }
+};
+
+std::atomic<bool> g_enabled(false);
+thread_local BufferLease t_lease;
+
+qint64 nowNs()
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch).count();
+}
+
+// Claims a buffer for the calling thread on its first event, reusing one
+// left by a finished thread when possible
+ThreadBuffer* threadBuffer()
+{
+    if (t_lease.buffer) {
+        return t_lease.buffer;
+    }
+
+    QThread* thread = QThread::currentThread();
+    const QCoreApplication* app = QCoreApplication::instance();
+    QString threadName = thread->objectName();
+
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    const int threadId = reg.threadNames.size() + 1;
+    if (threadName.isEmpty()) {
+        threadName = app && app->thread() == thread
+            ? QString("Main") : QString("Worker %1").arg(threadId);
+    }
+    reg.threadNames.append(threadName);
+
+    ThreadBuffer* buffer = nullptr;
+    if (!reg.freeBuffers.empty()) {
+        buffer = reg.freeBuffers.back();
+        reg.freeBuffers.pop_back();
+    } else {
+        reg.buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = reg.buffers.back().get();
+    }
+    buffer->threadId = threadId;
+    t_lease.buffer = buffer;
+    return buffer;
+}
+
+void record(const char* name, qint64 startNs, qint64 durationNs)
+{
+    ThreadBuffer* buffer = threadBuffer();
+    const quint64 index = buffer->written.load(std::memory_order_relaxed);
+    buffer->events[index % Trace::EVENTS_PER_THREAD] = {name, startNs, durationNs, buffer->threadId};
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+QByteArray jsonString(const QString& text)
+{
+    QByteArray out = "\"";
+    for (QChar c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c.toLatin1();
+        } else if (c.unicode() < 0x20) {
+            out += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0')).toLatin1();
+        } else {
+            out += QString(c).toUtf8();
+        }
+    }
+    out += '"';
+    return out;
+}
+
+} // namespace
+
+namespace Trace {
+
+Scope::Scope(const char* name)
+    : m_name(g_enabled.load(std::memory_order_relaxed) ? name : nullptr)
+    , m_startNs(m_name ? nowNs() : 0)
+{
+}
+
+Scope::~Scope()
+{
+    if (m_name) {
+        record(m_name, m_startNs, nowNs() - m_startNs);
+    }
+}
+
+void setEnabled(bool enabled)
+{
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool isEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+bool isCompiledIn()
+{
+#ifdef TAKEOFF_ENABLE_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void clear()
+{
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (const auto& buffer : reg.buffers) {
+        buffer->written.store(0, std::memory_order_release);
+    }
+}
+
+bool writeChromeJson(const QString& filePath, QString* error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) {
+            *error = QString("Cannot open file for writing: %1").arg(file.errorString());
+        }
+        return false;
+    }
+
+    // Timestamps are in microseconds, as the format expects
+    QByteArray json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto append = [&](const QByteArray& event) {
+        if (!first) {
+            json += ",\n";
+        }
+        json += event;
+        first = false;
+    };
+
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (int i = 0; i < reg.threadNames.size(); ++i) {
+        append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" +
+               QByteArray::number(i + 1) + ",\"args\":{\"name\":" +
+               jsonString(reg.threadNames[i]) + "}}");
+    }
+
+    for (const auto& buffer : reg.buffers) {
+        const quint64 written = buffer->written.load(std::memory_order_acquire);
+        const quint64 begin = written > static_cast<quint64>(EVENTS_PER_THREAD)
+            ? written - EVENTS_PER_THREAD : 0;
+        for (quint64 i = begin; i < written; ++i) {
+            const Event& event = buffer->events[i % EVENTS_PER_THREAD];
+            append("{\"name\":" + jsonString(QString::fromUtf8(event.name)) +
+                   ",\"cat\":\"takeoff\",\"ph\":\"X\",\"pid\":1,\"tid\":" +
+                   QByteArray::number(event.threadId) +
+                   ",\"ts\":" + QByteArray::number(event.startNs / 1000.0, 'f', 3) +
+                   ",\"dur\":" + QByteArray::number(event.durationNs / 1000.0, 'f', 3) + "}");
+        }
+
+        if (json.size() > (1 << 20)) {
+            file.write(json);
+            json.clear();
+        }
+    }
+    locker.unlock();
+
+    json += "\n]}\n";
+    if (file.write(json) < 0 || !file.flush()) {
+        if (error) {
+            *error = QString("Cannot write file: %1").arg(file.errorString());
+        }
+        return false;
+    }
+    return true;
+}
+
+} // namespace Trace
@@ -0,0 +1,88 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+
+/**
+ * @brief Scoped timers recorded into per-thread ring buffers.
+ *
+ * Build with TAKEOFF_ENABLE_TRACING to compile the TAKEOFF_TRACE_SCOPE
+ * markers in; otherwise they expand to nothing and cost nothing. Even when
+ * compiled in, nothing is recorded until setEnabled(true).
+ *
+ * Each thread appends to its own fixed-size ring buffer, so recording
+ * takes no lock and allocates nothing; a thread registers its buffer once,
+ * on its first event. When a buffer is full the oldest events are
+ * overwritten. A finished thread's buffer is handed to the next new
+ * thread, so memory is bounded by the peak number of tracing threads;
+ * its events are still exported until the new owner overwrites them.
+ *
+ * Scope names must be string literals (or otherwise outlive the trace),
+ * because only the pointer is stored.
+ */
+namespace Trace {
+
+/// Events kept per thread
+const int EVENTS_PER_THREAD = 16384;
+
+/**
+ * @brief Times the enclosing scope.
+ */
+class Scope
+{
+public:
+    explicit Scope(const char* name);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_startNs;
+};
+
+/**
+ * @brief Start or stop recording. Off by default.
+ */
+void setEnabled(bool enabled);
+bool isEnabled();
+
+/**
+ * @brief Check whether the markers are compiled into this build.
+ */
+bool isCompiledIn();
+
+/**
+ * @brief Drop all recorded events.
+ *
+ * Must not race with recording; disable tracing first.
+ */
+void clear();
+
+/**
+ * @brief Write the recorded events in the Chrome trace event format.
+ *
+ * The file opens in chrome://tracing or https://ui.perfetto.dev. Events
+ * recorded while the file is written may be missing or torn; disable
+ * tracing first for an exact snapshot.
+ * @param filePath Path of the .json file
+ * @param error Set to a description on failure
+ * @return true if successful
+ */
+bool writeChromeJson(const QString& filePath, QString* error = nullptr);
+
+} // namespace Trace
+
+#define TAKEOFF_TRACE_CONCAT_INNER(a, b) a##b
+#define TAKEOFF_TRACE_CONCAT(a, b) TAKEOFF_TRACE_CONCAT_INNER(a, b)
+
+#ifdef TAKEOFF_ENABLE_TRACING
+#define TAKEOFF_TRACE_SCOPE(name) \
+    Trace::Scope TAKEOFF_TRACE_CONCAT(takeoffTraceScope_, __LINE__)(name)
+#else
+#define TAKEOFF_TRACE_SCOPE(name) \
+    do {} while (false)
+#endif
+
+#endif // TRACE_H
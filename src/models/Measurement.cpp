@@ -198,9 +198,9 @@ void Measurement::setShapeLabel(const QString& label)
 
 QString Measurement::displayString() const
 {
-    QString base = QString("%1: %2 in")
-        .arg(typeString())
-        .arg(m_lengthInches, 0, 'f', 2);
+    QString base = m_type == MeasurementType::Count
+        ? QString("%1: %2 ea").arg(typeString()).arg(m_points.size())
+        : QString("%1: %2 in").arg(typeString()).arg(m_lengthInches, 0, 'f', 2);
     
     if (!m_name.isEmpty()) {
         return QString("%1 - %2").arg(m_name, base);
@@ -219,6 +219,8 @@ QString Measurement::typeString() const
             return "Line";
         case MeasurementType::Polyline:
             return "Polyline";
+        case MeasurementType::Count:
+            return "Count";
         default:
             return "Unknown";
     }
@@ -229,6 +231,9 @@ MeasurementType Measurement::typeFromString(const QString& str)
     if (str == "Polyline") {
         return MeasurementType::Polyline;
     }
+    if (str == "Count") {
+        return MeasurementType::Count;
+    }
     return MeasurementType::Line;  // Default
 }
 
@@ -13,7 +13,8 @@
 enum class MeasurementType
 {
     Line,       // Simple two-point line
-    Polyline    // Multi-point connected line
+    Polyline,   // Multi-point connected line
+    Count       // Counted symbols, one point per symbol
 };
 
 /**
@@ -104,7 +105,7 @@ public:
 
     /**
      * @brief Get a display string for the measurement.
-     * @return String like "Line: 24.50 in" or "Polyline: 48.25 in"
+     * @return String like "Line: 24.50 in", "Polyline: 48.25 in" or "Count: 12 ea"
      */
     QString displayString() const;
 
@@ -9,6 +9,7 @@ Page::Page()
     , m_pdfPageIndex(0)
     , m_pdfTotalPages(0)
     , m_displayName()
+    , m_sourceSize()
     , m_calibration()
 {
 }
@@ -65,6 +66,11 @@ QString Page::displayName() const
     return m_displayName;
 }
 
+QSizeF Page::sourceSize() const
+{
+    return m_sourceSize;
+}
+
 const Calibration& Page::calibration() const
 {
     return m_calibration;
@@ -109,6 +115,11 @@ void Page::setDisplayName(const QString& name)
     m_displayName = name;
 }
 
+void Page::setSourceSize(const QSizeF& size)
+{
+    m_sourceSize = size;
+}
+
 void Page::setCalibration(const Calibration& calibration)
 {
     m_calibration = calibration;
@@ -165,6 +176,10 @@ QJsonObject Page::toJson() const
     json["pdfPageIndex"] = m_pdfPageIndex;
     json["pdfTotalPages"] = m_pdfTotalPages;
     json["displayName"] = m_displayName;
+    if (!m_sourceSize.isEmpty()) {
+        json["sourceWidth"] = m_sourceSize.width();
+        json["sourceHeight"] = m_sourceSize.height();
+    }
     json["calibration"] = m_calibration.toJson();
     return json;
 }
@@ -181,6 +196,7 @@ Page Page::fromJson(const QJsonObject& json)
     page.m_pdfPageIndex = json["pdfPageIndex"].toInt(0);
     page.m_pdfTotalPages = json["pdfTotalPages"].toInt(0);
     page.m_displayName = json["displayName"].toString();
+    page.m_sourceSize = QSizeF(json["sourceWidth"].toDouble(0.0), json["sourceHeight"].toDouble(0.0));
     
     if (json.contains("calibration")) {
         page.m_calibration.fromJson(json["calibration"].toObject());
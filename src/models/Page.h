@@ -3,6 +3,7 @@
 
 #include <QString>
 #include <QJsonObject>
+#include <QSizeF>
 #include <QUuid>
 
 #include "Calibration.h"
@@ -49,6 +50,7 @@ public:
     int pdfPageIndex() const;
     int pdfTotalPages() const;
     QString displayName() const;
+    QSizeF sourceSize() const;  // PDF points or image pixels; empty if unknown
     const Calibration& calibration() const;
     Calibration& calibration();
 
@@ -59,6 +61,7 @@ public:
     void setPdfPageIndex(int index);
     void setPdfTotalPages(int total);
     void setDisplayName(const QString& name);
+    void setSourceSize(const QSizeF& size);
     void setCalibration(const Calibration& calibration);
 
     /**
@@ -100,6 +103,7 @@ private:
     int m_pdfPageIndex;
     int m_pdfTotalPages;
     QString m_displayName;
+    QSizeF m_sourceSize;
     Calibration m_calibration;
 };
 
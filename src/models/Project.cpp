@@ -1,4 +1,9 @@
 #include "Project.h"
+#include "../core/ImportedPage.h"
+#include "../core/MathUtils.h"
+#include "../core/Trace.h"
+
+#include <QSet>
 
 const QString Project::FILE_EXTENSION = ".takeoff.db";
 const QString Project::FILE_FILTER = "Takeoff Project (*.takeoff.db);;All Files (*)";
@@ -28,6 +33,7 @@ bool Project::create(const QString& filePath)
 
     m_pages.clear();
     m_takeoffItems.clear();
+    m_shapeProperties.clear();
     return true;
 }
 
@@ -42,6 +48,7 @@ bool Project::open(const QString& filePath)
 
     reloadPages();
     reloadTakeoffItems();
+    m_shapeProperties = m_db->loadShapeProperties();
     return true;
 }
 
@@ -52,6 +59,7 @@ void Project::close()
     }
     m_pages.clear();
     m_takeoffItems.clear();
+    m_shapeProperties.clear();
 }
 
 bool Project::isOpen() const
@@ -106,6 +114,24 @@ void Project::addPage(const Page& page)
     }
 }
 
+bool Project::addImportedPages(const QVector<ImportedPage>& pages)
+{
+    if (!m_db->insertImportedPages(pages)) {
+        m_lastError = m_db->lastError();
+        return false;
+    }
+    m_pages.reserve(m_pages.size() + pages.size());
+    for (const ImportedPage& imported : pages) {
+        m_pages.append(imported.page);
+    }
+    return true;
+}
+
+QHash<QString, QByteArray> Project::pageThumbnails() const
+{
+    return m_db->getPageThumbnails();
+}
+
 void Project::removePage(const QString& pageId)
 {
     if (m_db->deletePage(pageId)) {
@@ -117,11 +143,7 @@ void Project::removePage(const QString& pageId)
             }
         }
         // Remove associated items from cache
-        for (int i = m_takeoffItems.size() - 1; i >= 0; --i) {
-            if (m_takeoffItems[i].pageId() == pageId) {
-                m_takeoffItems.removeAt(i);
-            }
-        }
+        m_takeoffItems.removePage(pageId);
     } else {
         m_lastError = m_db->lastError();
     }
@@ -197,7 +219,7 @@ void Project::reloadPages()
 // Takeoff Items
 // ============================================================================
 
-const QVector<TakeoffItem>& Project::takeoffItems() const
+const TakeoffItemStore& Project::takeoffItems() const
 {
     return m_takeoffItems;
 }
@@ -205,14 +227,25 @@ const QVector<TakeoffItem>& Project::takeoffItems() const
 QVector<TakeoffItem> Project::takeoffItemsForPage(const QString& pageId) const
 {
     QVector<TakeoffItem> result;
-    for (const TakeoffItem& item : m_takeoffItems) {
-        if (item.pageId() == pageId) {
-            result.append(item);
+    const int key = m_takeoffItems.pageIds().find(pageId);
+    if (key < 0) {
+        return result;
+    }
+
+    const int* pageKeys = m_takeoffItems.pageKeyData();
+    for (int row = 0; row < m_takeoffItems.size(); ++row) {
+        if (pageKeys[row] == key) {
+            result.append(m_takeoffItems.item(row));
         }
     }
     return result;
 }
 
+int Project::takeoffItemCountForPage(const QString& pageId) const
+{
+    return m_takeoffItems.countForPage(pageId);
+}
+
 int Project::addTakeoffItem(TakeoffItem& item)
 {
     int newId = m_db->insertTakeoffItem(item);
@@ -225,16 +258,22 @@ int Project::addTakeoffItem(TakeoffItem& item)
     return -1;
 }
 
+bool Project::addTakeoffItems(QVector<TakeoffItem>& items)
+{
+    if (!m_db->insertTakeoffItems(items)) {
+        m_lastError = m_db->lastError();
+        return false;
+    }
+    for (const TakeoffItem& item : items) {
+        m_takeoffItems.append(item);
+    }
+    return true;
+}
+
 void Project::updateTakeoffItem(const TakeoffItem& item)
 {
     if (m_db->updateTakeoffItem(item)) {
-        // Update in-memory cache
-        for (int i = 0; i < m_takeoffItems.size(); ++i) {
-            if (m_takeoffItems[i].id() == item.id()) {
-                m_takeoffItems[i] = item;
-                break;
-            }
-        }
+        m_takeoffItems.update(item);
     } else {
         m_lastError = m_db->lastError();
     }
@@ -243,40 +282,97 @@ void Project::updateTakeoffItem(const TakeoffItem& item)
 void Project::removeTakeoffItem(int id)
 {
     if (m_db->deleteTakeoffItem(id)) {
-        for (int i = m_takeoffItems.size() - 1; i >= 0; --i) {
-            if (m_takeoffItems[i].id() == id) {
-                m_takeoffItems.removeAt(i);
-                break;
-            }
-        }
+        m_takeoffItems.remove(id);
     } else {
         m_lastError = m_db->lastError();
     }
 }
 
-TakeoffItem* Project::findTakeoffItem(int id)
+bool Project::hasTakeoffItem(int id) const
 {
-    for (int i = 0; i < m_takeoffItems.size(); ++i) {
-        if (m_takeoffItems[i].id() == id) {
-            return &m_takeoffItems[i];
-        }
-    }
-    return nullptr;
+    return m_takeoffItems.rowOf(id) >= 0;
 }
 
-const TakeoffItem* Project::findTakeoffItem(int id) const
+TakeoffItem Project::takeoffItem(int id) const
 {
-    for (int i = 0; i < m_takeoffItems.size(); ++i) {
-        if (m_takeoffItems[i].id() == id) {
-            return &m_takeoffItems[i];
+    const int row = m_takeoffItems.rowOf(id);
+    return row >= 0 ? m_takeoffItems.item(row) : TakeoffItem();
+}
+
+void Project::reloadTakeoffItems()
+{
+    m_db->loadTakeoffItems(m_takeoffItems);
+}
+
+// ============================================================================
+// Recalibration
+// ============================================================================
+
+Project::ItemLengths Project::measureItemLengths(const QString& pageId, double pixelsPerInch) const
+{
+    TAKEOFF_TRACE_SCOPE("Project::measureItemLengths");
+    ItemLengths result;
+    const int key = m_takeoffItems.pageIds().find(pageId);
+    if (key < 0 || pixelsPerInch <= 0.0) {
+        return result;
+    }
+
+    // Gather the page's measured items, then measure them all at once
+    QVector<int> offsets;
+    QVector<int> counts;
+    const int* pageKeys = m_takeoffItems.pageKeyData();
+    const quint8* kinds = m_takeoffItems.kindData();
+    const int* ids = m_takeoffItems.idData();
+    for (int row = 0; row < m_takeoffItems.size(); ++row) {
+        if (pageKeys[row] == key && kinds[row] != TakeoffItem::Count) {
+            result.itemIds.append(ids[row]);
+            offsets.append(m_takeoffItems.pointOffsetData()[row]);
+            counts.append(m_takeoffItems.pointCountData()[row]);
         }
     }
-    return nullptr;
+
+    const int count = result.itemIds.size();
+    result.lengthsInches.resize(count);
+    double* lengths = result.lengthsInches.data();
+    MathUtils::polylineLengths(m_takeoffItems.pointData(), offsets.constData(), counts.constData(),
+                               count, lengths);
+    MathUtils::pixelsToInches(lengths, lengths, count, pixelsPerInch);
+    return result;
 }
 
-void Project::reloadTakeoffItems()
+bool Project::applyCalibration(const QString& pageId, const Calibration& calibration,
+                               const ItemLengths& lengths, ItemLengths* previous)
 {
-    m_takeoffItems = m_db->getAllTakeoffItems();
+    TAKEOFF_TRACE_SCOPE("Project::applyCalibration");
+    Page* page = findPage(pageId);
+    if (!page) {
+        m_lastError = "Page not found: " + pageId;
+        return false;
+    }
+
+    Page updated = *page;
+    updated.calibration() = calibration;
+    if (!m_db->updatePageCalibration(updated, lengths.itemIds, lengths.lengthsInches)) {
+        m_lastError = m_db->lastError();
+        return false;
+    }
+    *page = updated;
+
+    if (previous) {
+        previous->itemIds = lengths.itemIds;
+        previous->lengthsInches.resize(lengths.itemIds.size());
+    }
+    for (int i = 0; i < lengths.itemIds.size(); ++i) {
+        const int row = m_takeoffItems.rowOf(lengths.itemIds[i]);
+        if (row < 0) {
+            continue;
+        }
+        if (previous) {
+            previous->lengthsInches[i] = m_takeoffItems.lengthInchesData()[row];
+        }
+        m_takeoffItems.setLengthInches(row, lengths.lengthsInches[i]);
+    }
+    return true;
 }
 
 // ============================================================================
@@ -322,7 +418,81 @@ ProjectDatabase::Shape Project::getShapeByDesignation(const QString& designation
 
 int Project::importShapesFromCsv(const QString& csvPath)
 {
-    return m_db->importShapesFromCsv(csvPath);
+    int count = m_db->importShapesFromCsv(csvPath);
+    if (count < 0) {
+        m_lastError = m_db->lastError();
+    }
+    m_shapeProperties = m_db->loadShapeProperties();
+    return count;
+}
+
+const ShapeProperties& Project::shapeProperties() const
+{
+    return m_shapeProperties;
+}
+
+double Project::sumShapePropertyPerFoot(const QString& propertyName, const QString& pageId) const
+{
+    int property = m_shapeProperties.propertyIndex(propertyName);
+    if (property < 0) {
+        return 0.0;
+    }
+
+    int pageKey = -1;
+    if (!pageId.isEmpty()) {
+        pageKey = m_takeoffItems.pageIds().find(pageId);
+        if (pageKey < 0) {
+            return 0.0;
+        }
+    }
+
+    // Items on other pages get a zero weight, which keeps the loop free of
+    // branches and lets the shape ID column be passed as is
+    const int rows = m_takeoffItems.size();
+    const double* lengthsIn = m_takeoffItems.lengthInchesData();
+    const int* qtys = m_takeoffItems.qtyData();
+    const int* pageKeys = m_takeoffItems.pageKeyData();
+    QVector<double> lengthsFt(rows);
+    double* out = lengthsFt.data();
+    for (int row = 0; row < rows; ++row) {
+        const double onPage = (pageKey < 0 || pageKeys[row] == pageKey) ? 1.0 : 0.0;
+        out[row] = lengthsIn[row] * qtys[row] * onPage / 12.0;
+    }
+
+    return m_shapeProperties.weightedSum(property, m_takeoffItems.shapeIdData(),
+                                         lengthsFt.constData(), rows);
+}
+
+// ============================================================================
+// Text Search
+// ============================================================================
+
+bool Project::setPageText(const QString& pageId, const QVector<PdfWord>& words)
+{
+    if (!m_db->replacePageText(pageId, words)) {
+        m_lastError = m_db->lastError();
+        return false;
+    }
+    return true;
+}
+
+QStringList Project::pagesMissingText() const
+{
+    const QStringList indexed = m_db->getIndexedPageIds();
+    const QSet<QString> indexedSet(indexed.begin(), indexed.end());
+
+    QStringList missing;
+    for (const Page& page : m_pages) {
+        if (page.type() == Page::Pdf && !indexedSet.contains(page.id())) {
+            missing.append(page.id());
+        }
+    }
+    return missing;
+}
+
+QVector<ProjectDatabase::TextHit> Project::searchText(const QString& text, int limit) const
+{
+    return m_db->searchPageText(text, limit);
 }
 
 // ============================================================================
@@ -6,6 +6,7 @@
 #include <memory>
 
 #include "TakeoffItem.h"
+#include "TakeoffItemStore.h"
 #include "Calibration.h"
 #include "Page.h"
 #include "../core/ProjectDatabase.h"
@@ -83,6 +84,18 @@ public:
     const QVector<Page>& pages() const;
 
     void addPage(const Page& page);
+
+    /**
+     * @brief Add pages read by PdfImporter in one transaction.
+     * @return true if all pages were stored; on failure none are
+     */
+    bool addImportedPages(const QVector<ImportedPage>& pages);
+
+    /**
+     * @brief Get the stored PNG thumbnails, keyed by page ID.
+     */
+    QHash<QString, QByteArray> pageThumbnails() const;
+
     void removePage(const QString& pageId);
     void updatePage(const Page& page);
 
@@ -103,19 +116,34 @@ public:
     // Takeoff Items
     // ========================================================================
 
-    const QVector<TakeoffItem>& takeoffItems() const;
+    /**
+     * @brief Get all items, stored by column.
+     */
+    const TakeoffItemStore& takeoffItems() const;
 
     /**
      * @brief Get items for a specific page.
      */
     QVector<TakeoffItem> takeoffItemsForPage(const QString& pageId) const;
 
+    /**
+     * @brief Count the items on a page.
+     */
+    int takeoffItemCountForPage(const QString& pageId) const;
+
     /**
      * @brief Add a takeoff item. ID is assigned by database.
      * @return The assigned ID
      */
     int addTakeoffItem(TakeoffItem& item);
 
+    /**
+     * @brief Add many takeoff items in one transaction.
+     * @param items Items to add; IDs are assigned by the database
+     * @return true if all items were added; on failure none are
+     */
+    bool addTakeoffItems(QVector<TakeoffItem>& items);
+
     /**
      * @brief Update an existing takeoff item.
      */
@@ -127,16 +155,54 @@ public:
     void removeTakeoffItem(int id);
 
     /**
-     * @brief Find a takeoff item by ID.
+     * @brief Check if an item with the given ID exists.
+     */
+    bool hasTakeoffItem(int id) const;
+
+    /**
+     * @brief Get a copy of a takeoff item by ID.
+     * @return The item, or an item with ID -1 if not found
+     *
+     * Change the copy and pass it to updateTakeoffItem() to store it.
      */
-    TakeoffItem* findTakeoffItem(int id);
-    const TakeoffItem* findTakeoffItem(int id) const;
+    TakeoffItem takeoffItem(int id) const;
 
     /**
      * @brief Reload items from database.
      */
     void reloadTakeoffItems();
 
+    // ========================================================================
+    // Recalibration
+    // ========================================================================
+
+    /**
+     * @brief Lengths of a set of items, in matching order.
+     */
+    struct ItemLengths {
+        QVector<int> itemIds;
+        QVector<double> lengthsInches;
+    };
+
+    /**
+     * @brief Recompute the lengths of a page's items from their stored geometry.
+     *
+     * Lines and polylines are measured in one batch pass over the geometry
+     * arena. Count items have no length and are left out.
+     * @param pixelsPerInch Scale to convert with
+     */
+    ItemLengths measureItemLengths(const QString& pageId, double pixelsPerInch) const;
+
+    /**
+     * @brief Give a page a new calibration and set the lengths of its items.
+     *
+     * Both are written in one transaction.
+     * @param previous If given, receives the lengths the items had before
+     * @return false if the change could not be stored; nothing is changed then
+     */
+    bool applyCalibration(const QString& pageId, const Calibration& calibration,
+                          const ItemLengths& lengths, ItemLengths* previous = nullptr);
+
     // ========================================================================
     // Shapes
     // ========================================================================
@@ -184,6 +250,43 @@ public:
      */
     int importShapesFromCsv(const QString& csvPath);
 
+    /**
+     * @brief Get the numeric AISC properties of all shapes (columnar).
+     */
+    const ShapeProperties& shapeProperties() const;
+
+    /**
+     * @brief Sum a per-foot shape property over all assigned items.
+     *
+     * Each item contributes property(shape) * total length in feet, e.g. a
+     * per-foot surface area column yields the total paint area.
+     * @param propertyName AISC column name
+     * @param pageId Optional page filter
+     * @return Total, or 0 if the property is not available
+     */
+    double sumShapePropertyPerFoot(const QString& propertyName,
+                                   const QString& pageId = QString()) const;
+
+    // ========================================================================
+    // Text Search
+    // ========================================================================
+
+    /**
+     * @brief Store the extracted text layer of a page.
+     * @return true if successful
+     */
+    bool setPageText(const QString& pageId, const QVector<PdfWord>& words);
+
+    /**
+     * @brief Get the IDs of PDF pages whose text has not been indexed yet.
+     */
+    QStringList pagesMissingText() const;
+
+    /**
+     * @brief Find words on any page starting with the given text.
+     */
+    QVector<ProjectDatabase::TextHit> searchText(const QString& text, int limit = 200) const;
+
     // ========================================================================
     // Error Handling
     // ========================================================================
@@ -193,7 +296,8 @@ public:
 private:
     std::unique_ptr<ProjectDatabase> m_db;
     QVector<Page> m_pages;
-    QVector<TakeoffItem> m_takeoffItems;
+    TakeoffItemStore m_takeoffItems;
+    ShapeProperties m_shapeProperties;
     mutable QString m_lastError;
 };
 
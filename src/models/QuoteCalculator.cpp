@@ -0,0 +1,255 @@
+#include "QuoteCalculator.h"
+#include "Project.h"
+#include "Trace.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+
+#ifdef HAS_QXLSX
+#include "xlsxdocument.h"
+#include "xlsxformat.h"
+#endif
+
+const QString QuoteCalculator::UNASSIGNED = "(Unassigned)";
+
+namespace {
+
+// Empty weights and costs print as "-", as in the quote table
+QString formatOptional(double value, int decimals)
+{
+    return value > 0 ? QString::number(value, 'f', decimals) : QString("-");
+}
+
+void sumTotals(QuoteCalculator::Quote& quote)
+{
+    quote.totalQty = 0;
+    quote.totalWeightLb = 0.0;
+    quote.totalCost = 0.0;
+    for (const QuoteCalculator::Line& line : quote.lines) {
+        quote.totalQty += line.qty;
+        quote.totalWeightLb += line.totalWeightLb;
+        quote.totalCost += line.totalCost;
+    }
+}
+
+QString escapeCsv(QString text)
+{
+    if (text.contains(',') || text.contains('"') || text.contains('\n')) {
+        text = "\"" + text.replace("\"", "\"\"") + "\"";
+    }
+    return text;
+}
+
+} // namespace
+
+QuoteCalculator::Quote QuoteCalculator::calculate(const Project& project, double pricePerLb,
+                                                  const QString& pageFilter)
+{
+    TAKEOFF_TRACE_SCOPE("QuoteCalculator::calculate");
+    Quote quote;
+    quote.pricePerLb = pricePerLb;
+
+    const TakeoffItemStore& items = project.takeoffItems();
+    int pageKey = -1;
+    if (!pageFilter.isEmpty()) {
+        pageKey = items.pageIds().find(pageFilter);
+        if (pageKey < 0) {
+            return quote;
+        }
+    }
+
+    // Accumulate per designation key in flat arrays
+    const int groupCount = items.designations().size();
+    QVector<int> qtys(groupCount, 0);
+    QVector<double> lengthsFt(groupCount, 0.0);
+    QVector<int> firstRows(groupCount, -1);
+
+    const int rows = items.size();
+    const int* pageKeys = items.pageKeyData();
+    const int* designationKeys = items.designationKeyData();
+    const int* itemQtys = items.qtyData();
+    const double* lengthsIn = items.lengthInchesData();
+    for (int row = 0; row < rows; ++row) {
+        if (pageKey >= 0 && pageKeys[row] != pageKey) {
+            continue;
+        }
+        const int group = designationKeys[row];
+        if (firstRows[group] < 0) {
+            firstRows[group] = row;
+        }
+        qtys[group] += itemQtys[row];
+        lengthsFt[group] += lengthsIn[row] * itemQtys[row] / 12.0;
+    }
+
+    for (int group = 0; group < groupCount; ++group) {
+        if (firstRows[group] < 0) {
+            continue;
+        }
+        const QString& designation = items.designations().string(group);
+        Line line;
+        line.designation = designation.isEmpty() ? UNASSIGNED : designation;
+        line.qty = qtys[group];
+        line.totalLengthFt = lengthsFt[group];
+
+        // Weight per foot comes from the first item's shape
+        const int shapeId = items.shapeIdData()[firstRows[group]];
+        if (shapeId > 0) {
+            line.wLbPerFt = project.getShape(shapeId).wLbPerFt;
+        }
+        if (line.wLbPerFt > 0) {
+            line.totalWeightLb = line.totalLengthFt * line.wLbPerFt;
+            line.totalCost = line.totalWeightLb * pricePerLb;
+        }
+        quote.lines.append(line);
+    }
+
+    std::sort(quote.lines.begin(), quote.lines.end(), [](const Line& a, const Line& b) {
+        return a.designation < b.designation;
+    });
+    sumTotals(quote);
+    return quote;
+}
+
+bool QuoteCalculator::applyLengthChanges(Quote& quote, const Project& project, const QString& pageFilter,
+                                         const QVector<int>& itemIds, const QVector<double>& oldLengthsInches,
+                                         const QVector<double>& newLengthsInches, QVector<int>* changedLines)
+{
+    TAKEOFF_TRACE_SCOPE("QuoteCalculator::applyLengthChanges");
+    const TakeoffItemStore& items = project.takeoffItems();
+    const int pageKey = pageFilter.isEmpty() ? -1 : items.pageIds().find(pageFilter);
+
+    QVector<bool> changed(quote.lines.size(), false);
+    for (int i = 0; i < itemIds.size(); ++i) {
+        const int row = items.rowOf(itemIds[i]);
+        if (row < 0) {
+            return false;
+        }
+        if (!pageFilter.isEmpty() && items.pageKeyData()[row] != pageKey) {
+            continue;
+        }
+
+        const TakeoffItemView item = items.at(row);
+        const QString designation = item.designation().isEmpty() ? UNASSIGNED : item.designation();
+        auto line = std::lower_bound(quote.lines.begin(), quote.lines.end(), designation,
+                                     [](const Line& l, const QString& d) { return l.designation < d; });
+        if (line == quote.lines.end() || line->designation != designation) {
+            return false;
+        }
+        line->totalLengthFt += (newLengthsInches[i] - oldLengthsInches[i]) * item.qty() / 12.0;
+        changed[line - quote.lines.begin()] = true;
+    }
+
+    for (int index = 0; index < quote.lines.size(); ++index) {
+        if (!changed[index]) {
+            continue;
+        }
+        Line& line = quote.lines[index];
+        if (line.wLbPerFt > 0) {
+            line.totalWeightLb = line.totalLengthFt * line.wLbPerFt;
+            line.totalCost = line.totalWeightLb * quote.pricePerLb;
+        }
+        if (changedLines) {
+            changedLines->append(index);
+        }
+    }
+    sumTotals(quote);
+    return true;
+}
+
+bool QuoteCalculator::writeCsv(const Quote& quote, const QString& filePath, QString* error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (error) {
+            *error = QString("Cannot open file for writing: %1").arg(file.errorString());
+        }
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "Designation,Qty,Total (ft),lb/ft,Weight (lb),$/lb,Cost ($)\n";
+    for (const Line& line : quote.lines) {
+        out << escapeCsv(line.designation) << ','
+            << line.qty << ','
+            << QString::number(line.totalLengthFt, 'f', 2) << ','
+            << formatOptional(line.wLbPerFt, 2) << ','
+            << formatOptional(line.totalWeightLb, 1) << ','
+            << QString::number(quote.pricePerLb, 'f', 2) << ','
+            << formatOptional(line.totalCost, 2) << '\n';
+    }
+
+    out << "\n";
+    out << "Material Rate:,$" << QString::number(quote.pricePerLb, 'f', 2) << "/lb\n";
+    out << "Items: " << quote.totalQty << "\n";
+    out << "Total Weight: " << QString::number(quote.totalWeightLb, 'f', 1) << " lb\n";
+    out << "Total Cost: $" << QString::number(quote.totalCost, 'f', 2) << "\n";
+
+    out.flush();
+    if (file.error() != QFileDevice::NoError) {
+        if (error) {
+            *error = QString("Cannot write file: %1").arg(file.errorString());
+        }
+        return false;
+    }
+    return true;
+}
+
+bool QuoteCalculator::writeXlsx(const Quote& quote, const QString& filePath, QString* error)
+{
+#ifdef HAS_QXLSX
+    QXlsx::Document xlsx;
+    QXlsx::Format header;
+    header.setFontBold(true);
+
+    const QStringList columns = {
+        "Designation", "Qty", "Total (ft)", "lb/ft", "Weight (lb)", "$/lb", "Cost ($)"
+    };
+    for (int col = 0; col < columns.size(); ++col) {
+        xlsx.write(1, col + 1, columns[col], header);
+    }
+
+    // Numbers stay numeric so the sheet can be summed and re-priced
+    int row = 2;
+    for (const Line& line : quote.lines) {
+        xlsx.write(row, 1, line.designation);
+        xlsx.write(row, 2, line.qty);
+        xlsx.write(row, 3, line.totalLengthFt);
+        xlsx.write(row, 4, line.wLbPerFt);
+        xlsx.write(row, 5, line.totalWeightLb);
+        xlsx.write(row, 6, quote.pricePerLb);
+        xlsx.write(row, 7, line.totalCost);
+        ++row;
+    }
+
+    ++row;
+    xlsx.write(row, 1, "Total", header);
+    xlsx.write(row, 2, quote.totalQty, header);
+    xlsx.write(row, 5, quote.totalWeightLb, header);
+    xlsx.write(row, 7, quote.totalCost, header);
+
+    if (!xlsx.saveAs(filePath)) {
+        if (error) {
+            *error = QString("Cannot write workbook: %1").arg(filePath);
+        }
+        return false;
+    }
+    return true;
+#else
+    Q_UNUSED(quote);
+    Q_UNUSED(filePath);
+    if (error) {
+        *error = "XLSX export is not available in this build";
+    }
+    return false;
+#endif
+}
+
+bool QuoteCalculator::hasXlsxSupport()
+{
+#ifdef HAS_QXLSX
+    return true;
+#else
+    return false;
+#endif
+}
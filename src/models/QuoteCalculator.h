@@ -0,0 +1,85 @@
+#ifndef QUOTECALCULATOR_H
+#define QUOTECALCULATOR_H
+
+#include <QString>
+#include <QVector>
+
+class Project;
+
+/**
+ * @brief Groups takeoff items by designation and prices them by weight.
+ *
+ * Shared by the quote dock and the command-line batch tool so both produce
+ * the same totals. Weight per foot comes from the assigned AISC shape;
+ * items without a shape count toward quantity and length only.
+ */
+class QuoteCalculator
+{
+public:
+    /// Designation shown for items without one
+    static const QString UNASSIGNED;
+
+    struct Line {
+        QString designation;
+        int qty = 0;
+        double totalLengthFt = 0.0;
+        double wLbPerFt = 0.0;
+        double totalWeightLb = 0.0;
+        double totalCost = 0.0;
+    };
+
+    struct Quote {
+        QVector<Line> lines;   // Sorted by designation
+        double pricePerLb = 0.0;
+        int totalQty = 0;
+        double totalWeightLb = 0.0;
+        double totalCost = 0.0;
+    };
+
+    /**
+     * @brief Compute the quote for a project.
+     * @param project Open project
+     * @param pricePerLb Material rate
+     * @param pageFilter Optional page ID; empty includes all pages
+     */
+    static Quote calculate(const Project& project, double pricePerLb,
+                           const QString& pageFilter = QString());
+
+    /**
+     * @brief Update a quote for items whose length changed.
+     *
+     * Only the lines of the changed items are touched, then the totals are
+     * summed again. Quantities and designations must not have changed.
+     * @param quote Quote from calculate() with the same page filter
+     * @param itemIds Changed items, already updated in the project
+     * @param oldLengthsInches Length of each item before the change
+     * @param newLengthsInches Length of each item after the change
+     * @param changedLines If given, receives the indexes of the updated lines
+     * @return false if an item has no line in the quote; recalculate then
+     */
+    static bool applyLengthChanges(Quote& quote, const Project& project, const QString& pageFilter,
+                                   const QVector<int>& itemIds, const QVector<double>& oldLengthsInches,
+                                   const QVector<double>& newLengthsInches,
+                                   QVector<int>* changedLines = nullptr);
+
+    /**
+     * @brief Write a quote as CSV: one row per designation, then totals.
+     * @param error Set to a description on failure
+     * @return true if successful
+     */
+    static bool writeCsv(const Quote& quote, const QString& filePath, QString* error = nullptr);
+
+    /**
+     * @brief Write a quote as an Excel workbook.
+     *
+     * Only available when built with QXlsx (HAS_QXLSX); otherwise fails.
+     */
+    static bool writeXlsx(const Quote& quote, const QString& filePath, QString* error = nullptr);
+
+    /**
+     * @brief Check whether writeXlsx() is available in this build.
+     */
+    static bool hasXlsxSupport();
+};
+
+#endif // QUOTECALCULATOR_H
@@ -38,6 +38,11 @@ QString TakeoffItem::displayString() const
         result += QString(" - %1").arg(m_designation);
     }
     
+    if (m_kind == Count) {
+        result += QString(" (%1 ea)").arg(m_qty);
+        return result;
+    }
+
     result += QString(" (%.2f ft").arg(lengthFeet());
     
     if (m_qty > 1) {
@@ -54,7 +59,15 @@ QString TakeoffItem::kindString() const
     switch (m_kind) {
         case Line: return "Line";
         case Polyline: return "Polyline";
+        case Count: return "Count";
         default: return "Unknown";
     }
 }
 
+TakeoffItem::Kind TakeoffItem::kindFromString(const QString& str)
+{
+    if (str == "Polyline") return Polyline;
+    if (str == "Count") return Count;
+    return Line;
+}
+
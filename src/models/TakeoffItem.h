@@ -16,7 +16,8 @@ class TakeoffItem
 public:
     enum Kind {
         Line,
-        Polyline
+        Polyline,
+        Count       // Counted symbols; points are the symbol centers
     };
 
     TakeoffItem();
@@ -33,7 +34,7 @@ public:
     Kind kind() const { return m_kind; }
     void setKind(Kind kind) { m_kind = kind; }
 
-    QVector<QPointF> points() const { return m_points; }
+    const QVector<QPointF>& points() const { return m_points; }
     void setPoints(const QVector<QPointF>& points) { m_points = points; }
 
     double lengthInches() const { return m_lengthInches; }
@@ -68,6 +69,7 @@ public:
     // Display helpers
     QString displayString() const;
     QString kindString() const;
+    static Kind kindFromString(const QString& str);
 
     // Check if material is assigned
     bool hasMaterial() const { return m_shapeId > 0 && !m_designation.isEmpty(); }
@@ -0,0 +1,270 @@
+#include "TakeoffItemStore.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Moves the rows flagged in keep to the front, preserving their order
+template <typename T>
+void keepRows(QVector<T>& column, const QVector<bool>& keep)
+{
+    int kept = 0;
+    for (int row = 0; row < column.size(); ++row) {
+        if (keep[row]) {
+            if (kept != row) {
+                column[kept] = std::move(column[row]);
+            }
+            ++kept;
+        }
+    }
+    column.resize(kept);
+}
+
+} // namespace
+
+// ============================================================================
+// TakeoffItemView
+// ============================================================================
+
+TakeoffItem TakeoffItemView::toItem() const
+{
+    return m_store->item(m_row);
+}
+
+// ============================================================================
+// TakeoffItemStore
+// ============================================================================
+
+TakeoffItemStore::TakeoffItemStore()
+{
+}
+
+void TakeoffItemStore::clear()
+{
+    m_ids.clear();
+    m_pageKeys.clear();
+    m_kinds.clear();
+    m_lengthsInches.clear();
+    m_qtys.clear();
+    m_shapeIds.clear();
+    m_designationKeys.clear();
+    m_notes.clear();
+    m_pointOffsets.clear();
+    m_pointCounts.clear();
+    m_geometry.clear();
+    m_rowById.clear();
+    m_pageIds.clear();
+    m_designations.clear();
+}
+
+void TakeoffItemStore::assign(const QVector<TakeoffItem>& items)
+{
+    clear();
+
+    int pointCount = 0;
+    for (const TakeoffItem& item : items) {
+        pointCount += item.points().size();
+    }
+    reserve(items.size(), pointCount);
+
+    for (const TakeoffItem& item : items) {
+        append(item);
+    }
+}
+
+void TakeoffItemStore::append(const TakeoffItem& item)
+{
+    appendRow(item);
+    setRowPoints(m_ids.size() - 1, item.points());
+}
+
+QPointF* TakeoffItemStore::appendWithPoints(const TakeoffItem& item, int pointCount)
+{
+    appendRow(item);
+    const int row = m_ids.size() - 1;
+    m_pointOffsets[row] = m_geometry.allocate(pointCount);
+    m_pointCounts[row] = pointCount;
+    return m_geometry.data(m_pointOffsets[row]);
+}
+
+void TakeoffItemStore::reserve(int itemCount, int pointCount)
+{
+    m_ids.reserve(itemCount);
+    m_pageKeys.reserve(itemCount);
+    m_kinds.reserve(itemCount);
+    m_lengthsInches.reserve(itemCount);
+    m_qtys.reserve(itemCount);
+    m_shapeIds.reserve(itemCount);
+    m_designationKeys.reserve(itemCount);
+    m_notes.reserve(itemCount);
+    m_pointOffsets.reserve(itemCount);
+    m_pointCounts.reserve(itemCount);
+    m_geometry.reserve(pointCount);
+    m_rowById.reserve(itemCount);
+}
+
+bool TakeoffItemStore::update(const TakeoffItem& item)
+{
+    const int row = rowOf(item.id());
+    if (row < 0) {
+        return false;
+    }
+    setRow(row, item);
+    compactPointsIfWasteful();
+    return true;
+}
+
+bool TakeoffItemStore::remove(int id)
+{
+    const int row = rowOf(id);
+    if (row < 0) {
+        return false;
+    }
+
+    m_geometry.release(m_pointCounts[row]);
+    m_ids.remove(row);
+    m_pageKeys.remove(row);
+    m_kinds.remove(row);
+    m_lengthsInches.remove(row);
+    m_qtys.remove(row);
+    m_shapeIds.remove(row);
+    m_designationKeys.remove(row);
+    m_notes.remove(row);
+    m_pointOffsets.remove(row);
+    m_pointCounts.remove(row);
+
+    m_rowById.remove(id);
+    reindexFrom(row);
+    compactPointsIfWasteful();
+    return true;
+}
+
+int TakeoffItemStore::removePage(const QString& pageId)
+{
+    const int key = m_pageIds.find(pageId);
+    if (key < 0) {
+        return 0;
+    }
+
+    QVector<bool> keep(size());
+    int removed = 0;
+    for (int row = 0; row < size(); ++row) {
+        keep[row] = m_pageKeys[row] != key;
+        if (!keep[row]) {
+            m_geometry.release(m_pointCounts[row]);
+            ++removed;
+        }
+    }
+    if (removed == 0) {
+        return 0;
+    }
+
+    keepRows(m_ids, keep);
+    keepRows(m_pageKeys, keep);
+    keepRows(m_kinds, keep);
+    keepRows(m_lengthsInches, keep);
+    keepRows(m_qtys, keep);
+    keepRows(m_shapeIds, keep);
+    keepRows(m_designationKeys, keep);
+    keepRows(m_notes, keep);
+    keepRows(m_pointOffsets, keep);
+    keepRows(m_pointCounts, keep);
+
+    m_rowById.clear();
+    reindexFrom(0);
+    compactPointsIfWasteful();
+    return removed;
+}
+
+TakeoffItem TakeoffItemStore::item(int row) const
+{
+    const TakeoffItemView view = at(row);
+    TakeoffItem item(view.kind(), view.points().toVector(), view.lengthInches());
+    item.setId(view.id());
+    item.setPageId(view.pageId());
+    item.setQty(view.qty());
+    item.setShapeId(view.shapeId());
+    item.setDesignation(view.designation());
+    item.setNotes(view.notes());
+    return item;
+}
+
+int TakeoffItemStore::countForPage(const QString& pageId) const
+{
+    const int key = m_pageIds.find(pageId);
+    if (key < 0) {
+        return 0;
+    }
+    const int* pageKeys = m_pageKeys.constData();
+    const int rows = size();
+    int count = 0;
+    for (int row = 0; row < rows; ++row) {
+        count += pageKeys[row] == key;
+    }
+    return count;
+}
+
+void TakeoffItemStore::appendRow(const TakeoffItem& item)
+{
+    const int row = m_ids.size();
+    m_ids.append(item.id());
+    m_pageKeys.append(0);
+    m_kinds.append(0);
+    m_lengthsInches.append(0.0);
+    m_qtys.append(1);
+    m_shapeIds.append(-1);
+    m_designationKeys.append(0);
+    m_notes.append(QString());
+    m_pointOffsets.append(m_geometry.size());
+    m_pointCounts.append(0);
+
+    setRowFields(row, item);
+    m_rowById.insert(item.id(), row);
+}
+
+void TakeoffItemStore::setRow(int row, const TakeoffItem& item)
+{
+    setRowFields(row, item);
+    setRowPoints(row, item.points());
+}
+
+void TakeoffItemStore::setRowFields(int row, const TakeoffItem& item)
+{
+    m_ids[row] = item.id();
+    m_pageKeys[row] = m_pageIds.intern(item.pageId());
+    m_kinds[row] = static_cast<quint8>(item.kind());
+    m_lengthsInches[row] = item.lengthInches();
+    m_qtys[row] = item.qty();
+    m_shapeIds[row] = item.shapeId();
+    m_designationKeys[row] = m_designations.intern(item.designation());
+    m_notes[row] = item.notes();
+}
+
+void TakeoffItemStore::setRowPoints(int row, PointSpan points)
+{
+    const int oldCount = m_pointCounts[row];
+    if (points.size <= oldCount) {
+        // Shrinking or same size: reuse the row's range
+        std::copy(points.begin(), points.end(), m_geometry.data(m_pointOffsets[row]));
+        m_geometry.release(oldCount - points.size);
+    } else {
+        m_geometry.release(oldCount);
+        m_pointOffsets[row] = m_geometry.append(points);
+    }
+    m_pointCounts[row] = points.size;
+}
+
+void TakeoffItemStore::reindexFrom(int row)
+{
+    for (int r = row; r < m_ids.size(); ++r) {
+        m_rowById.insert(m_ids[r], r);
+    }
+}
+
+void TakeoffItemStore::compactPointsIfWasteful()
+{
+    if (m_geometry.isWasteful()) {
+        m_geometry.compact(m_pointOffsets, m_pointCounts);
+    }
+}
@@ -0,0 +1,242 @@
+#ifndef TAKEOFFITEMSTORE_H
+#define TAKEOFFITEMSTORE_H
+
+#include <QHash>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+#include "TakeoffItem.h"
+#include "../core/GeometryArena.h"
+#include "../core/StringTable.h"
+
+class TakeoffItemStore;
+
+/**
+ * @brief Read-only view of one item in a TakeoffItemStore.
+ *
+ * Offers the getters of TakeoffItem without copying the row; toItem()
+ * makes an editable copy. A view is invalidated by any change to the store.
+ */
+class TakeoffItemView
+{
+public:
+    TakeoffItemView(const TakeoffItemStore* store, int row)
+        : m_store(store)
+        , m_row(row)
+    {
+    }
+
+    int row() const { return m_row; }
+
+    int id() const;
+    QString pageId() const;
+    int pageKey() const;
+    TakeoffItem::Kind kind() const;
+
+    // Geometry, packed with the points of all other items
+    PointSpan points() const;
+
+    double lengthInches() const;
+    double lengthFeet() const { return lengthInches() / 12.0; }
+    int qty() const;
+    int shapeId() const;
+    QString designation() const;
+    int designationKey() const;
+    QString notes() const;
+
+    double totalLengthFeet() const { return lengthFeet() * qty(); }
+    double totalLengthInches() const { return lengthInches() * qty(); }
+    bool hasMaterial() const { return shapeId() > 0 && !designation().isEmpty(); }
+
+    /**
+     * @brief Copy the item out of the store.
+     */
+    TakeoffItem toItem() const;
+
+private:
+    const TakeoffItemStore* m_store;
+    int m_row;
+};
+
+/**
+ * @brief Columnar in-memory store of a project's takeoff items.
+ *
+ * Each field is a contiguous array indexed by row, so totals and per-page
+ * filters scan plain ints and doubles instead of visiting one heap object
+ * per item. Page IDs and designations are interned to integer keys. The
+ * points of all items share one GeometryArena addressed by offset and
+ * count; space left by removed or reshaped items is reclaimed once it
+ * outweighs the live points.
+ *
+ * Rows keep insertion order. Item IDs are looked up through a hash.
+ */
+class TakeoffItemStore
+{
+public:
+    class const_iterator
+    {
+    public:
+        const_iterator(const TakeoffItemStore* store, int row) : m_store(store), m_row(row) {}
+        TakeoffItemView operator*() const { return TakeoffItemView(m_store, m_row); }
+        const_iterator& operator++() { ++m_row; return *this; }
+        bool operator==(const const_iterator& other) const { return m_row == other.m_row; }
+        bool operator!=(const const_iterator& other) const { return m_row != other.m_row; }
+
+    private:
+        const TakeoffItemStore* m_store;
+        int m_row;
+    };
+
+    TakeoffItemStore();
+
+    void clear();
+
+    /**
+     * @brief Replace the contents with the given items, in order.
+     */
+    void assign(const QVector<TakeoffItem>& items);
+
+    void append(const TakeoffItem& item);
+
+    /**
+     * @brief Append an item and leave room for its points.
+     * @param item Item fields; its own points are ignored
+     * @param pointCount Number of points to make room for
+     * @return Where to write the points. Valid until the store changes.
+     *
+     * Lets the load path decode stored geometry straight into the arena.
+     */
+    QPointF* appendWithPoints(const TakeoffItem& item, int pointCount);
+
+    /**
+     * @brief Reserve room for the given number of items and points.
+     */
+    void reserve(int itemCount, int pointCount);
+
+    /**
+     * @brief Overwrite the item with the same ID.
+     * @return false if no item has that ID
+     */
+    bool update(const TakeoffItem& item);
+
+    /**
+     * @brief Overwrite the length of one row.
+     */
+    void setLengthInches(int row, double lengthInches) { m_lengthsInches[row] = lengthInches; }
+
+    /**
+     * @brief Remove the item with the given ID.
+     * @return false if no item has that ID
+     */
+    bool remove(int id);
+
+    /**
+     * @brief Remove every item on a page.
+     * @return Number of items removed
+     */
+    int removePage(const QString& pageId);
+
+    int size() const { return m_ids.size(); }
+    bool isEmpty() const { return m_ids.isEmpty(); }
+
+    /**
+     * @brief Get the row of an item.
+     * @return Row, or -1 if no item has that ID
+     */
+    int rowOf(int id) const { return m_rowById.value(id, -1); }
+
+    TakeoffItemView at(int row) const { return TakeoffItemView(this, row); }
+    TakeoffItemView operator[](int row) const { return at(row); }
+
+    /**
+     * @brief Copy a row out as an editable item.
+     */
+    TakeoffItem item(int row) const;
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    // Columns, one entry per row
+    const int* idData() const { return m_ids.constData(); }
+    const int* pageKeyData() const { return m_pageKeys.constData(); }
+    const quint8* kindData() const { return m_kinds.constData(); }
+    const double* lengthInchesData() const { return m_lengthsInches.constData(); }
+    const int* qtyData() const { return m_qtys.constData(); }
+    const int* shapeIdData() const { return m_shapeIds.constData(); }
+    const int* designationKeyData() const { return m_designationKeys.constData(); }
+
+    // Row r's points start at pointData() + pointOffsetData()[r]
+    const QPointF* pointData() const { return m_geometry.constData(); }
+    const int* pointOffsetData() const { return m_pointOffsets.constData(); }
+    const int* pointCountData() const { return m_pointCounts.constData(); }
+
+    // Keys used by pageKeyData() and designationKeyData()
+    const StringTable& pageIds() const { return m_pageIds; }
+    const StringTable& designations() const { return m_designations; }
+
+    /**
+     * @brief Count the items on a page.
+     */
+    int countForPage(const QString& pageId) const;
+
+private:
+    friend class TakeoffItemView;
+
+    void setRow(int row, const TakeoffItem& item);
+    void setRowFields(int row, const TakeoffItem& item);
+    void setRowPoints(int row, PointSpan points);
+    void appendRow(const TakeoffItem& item);
+    void reindexFrom(int row);
+    void compactPointsIfWasteful();
+
+    QVector<int> m_ids;
+    QVector<int> m_pageKeys;
+    QVector<quint8> m_kinds;
+    QVector<double> m_lengthsInches;
+    QVector<int> m_qtys;
+    QVector<int> m_shapeIds;
+    QVector<int> m_designationKeys;
+    QVector<QString> m_notes;
+
+    // Row r owns points [offset[r], offset[r] + count[r]) of the arena
+    QVector<int> m_pointOffsets;
+    QVector<int> m_pointCounts;
+    GeometryArena m_geometry;
+
+    QHash<int, int> m_rowById;
+    StringTable m_pageIds;
+    StringTable m_designations;
+};
+
+// ============================================================================
+// TakeoffItemView
+// ============================================================================
+
+inline int TakeoffItemView::id() const { return m_store->m_ids[m_row]; }
+inline int TakeoffItemView::pageKey() const { return m_store->m_pageKeys[m_row]; }
+inline QString TakeoffItemView::pageId() const { return m_store->m_pageIds.string(pageKey()); }
+
+inline TakeoffItem::Kind TakeoffItemView::kind() const
+{
+    return static_cast<TakeoffItem::Kind>(m_store->m_kinds[m_row]);
+}
+
+inline PointSpan TakeoffItemView::points() const
+{
+    return m_store->m_geometry.span(m_store->m_pointOffsets[m_row], m_store->m_pointCounts[m_row]);
+}
+
+inline double TakeoffItemView::lengthInches() const { return m_store->m_lengthsInches[m_row]; }
+inline int TakeoffItemView::qty() const { return m_store->m_qtys[m_row]; }
+inline int TakeoffItemView::shapeId() const { return m_store->m_shapeIds[m_row]; }
+inline int TakeoffItemView::designationKey() const { return m_store->m_designationKeys[m_row]; }
+
+inline QString TakeoffItemView::designation() const
+{
+    return m_store->m_designations.string(designationKey());
+}
+
+inline QString TakeoffItemView::notes() const { return m_store->m_notes[m_row]; }
+
+#endif // TAKEOFFITEMSTORE_H
@@ -0,0 +1,118 @@
+#include <QFile>
+#include <QTemporaryDir>
+#include <gtest/gtest.h>
+
+#include "CsvReader.h"
+
+namespace {
+
+class CsvReaderTest : public ::testing::Test
+{
+protected:
+    // Writes the bytes to a file and opens it
+    void openCsv(const QByteArray& contents)
+    {
+        ASSERT_TRUE(m_dir.isValid());
+        const QString path = m_dir.filePath("test.csv");
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(contents);
+        file.close();
+        ASSERT_TRUE(m_reader.open(path)) << m_reader.lastError().toStdString();
+    }
+
+    // Reads the next row as strings
+    QStringList nextRow()
+    {
+        QStringList fields;
+        if (m_reader.readRow()) {
+            for (int i = 0; i < m_reader.fieldCount(); ++i) {
+                fields.append(m_reader.field(i).toString());
+            }
+        }
+        return fields;
+    }
+
+    QTemporaryDir m_dir;
+    CsvReader m_reader;
+};
+
+} // namespace
+
+TEST_F(CsvReaderTest, SplitsPlainFields)
+{
+    openCsv("a,b,c\n1,2,3\n");
+    EXPECT_EQ(nextRow(), QStringList({"a", "b", "c"}));
+    EXPECT_EQ(nextRow(), QStringList({"1", "2", "3"}));
+    EXPECT_FALSE(m_reader.readRow());
+}
+
+TEST_F(CsvReaderTest, KeepsSeparatorsInsideQuotes)
+{
+    openCsv("\"W12X26, modified\",\"line\nbreak\",x\n");
+    EXPECT_EQ(nextRow(), QStringList({"W12X26, modified", "line\nbreak", "x"}));
+    EXPECT_FALSE(m_reader.readRow());
+}
+
+TEST_F(CsvReaderTest, UnescapesDoubledQuotes)
+{
+    openCsv("\"say \"\"hi\"\"\",\"\"\"\"\n");
+    EXPECT_EQ(nextRow(), QStringList({"say \"hi\"", "\""}));
+}
+
+TEST_F(CsvReaderTest, HandlesEmptyFieldsAndLineEndings)
+{
+    openCsv("a,,c\r\n,\rlast");
+    EXPECT_EQ(nextRow(), QStringList({"a", "", "c"}));
+    EXPECT_EQ(nextRow(), QStringList({"", ""}));
+    EXPECT_EQ(nextRow(), QStringList({"last"}));
+    EXPECT_FALSE(m_reader.readRow());
+}
+
+TEST_F(CsvReaderTest, TrimsUnquotedFieldsOnly)
+{
+    openCsv("  a  , \" b \" ,c\n");
+    EXPECT_EQ(nextRow(), QStringList({"a", " b ", "c"}));
+}
+
+TEST_F(CsvReaderTest, ReportsBlankRows)
+{
+    openCsv("a\n\nb\n");
+    ASSERT_TRUE(m_reader.readRow());
+    EXPECT_FALSE(m_reader.isBlankRow());
+    ASSERT_TRUE(m_reader.readRow());
+    EXPECT_TRUE(m_reader.isBlankRow());
+    ASSERT_TRUE(m_reader.readRow());
+    EXPECT_EQ(m_reader.field(0).toString(), "b");
+}
+
+TEST_F(CsvReaderTest, SkipsByteOrderMark)
+{
+    openCsv("\xEF\xBB\xBFType,W\n");
+    EXPECT_EQ(nextRow(), QStringList({"Type", "W"}));
+}
+
+TEST_F(CsvReaderTest, ParsesNumbers)
+{
+    openCsv("26.5,abc,\n");
+    ASSERT_TRUE(m_reader.readRow());
+    bool ok = false;
+    EXPECT_DOUBLE_EQ(m_reader.field(0).toDouble(&ok), 26.5);
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(m_reader.field(1).toDouble(&ok), 0.0);
+    EXPECT_FALSE(ok);
+    EXPECT_TRUE(m_reader.field(2).isEmpty());
+}
+
+TEST_F(CsvReaderTest, ReadsEmptyFile)
+{
+    openCsv("");
+    EXPECT_FALSE(m_reader.readRow());
+}
+
+TEST(CsvReader, FailsOnMissingFile)
+{
+    CsvReader reader;
+    EXPECT_FALSE(reader.open("/nonexistent/shapes.csv"));
+    EXPECT_FALSE(reader.lastError().isEmpty());
+}
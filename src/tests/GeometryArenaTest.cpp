@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include "GeometryArena.h"
+
+namespace {
+
+QVector<QPointF> line(double y, int count)
+{
+    QVector<QPointF> points;
+    for (int i = 0; i < count; ++i) {
+        points.append(QPointF(i, y));
+    }
+    return points;
+}
+
+} // namespace
+
+TEST(GeometryArena, AppendsRangesBackToBack)
+{
+    GeometryArena arena;
+    const QVector<QPointF> a = line(1.0, 3);
+    const QVector<QPointF> b = line(2.0, 2);
+    EXPECT_EQ(arena.append(a), 0);
+    EXPECT_EQ(arena.append(b), 3);
+    EXPECT_EQ(arena.size(), 5);
+    EXPECT_EQ(arena.span(0, 3).toVector(), a);
+    EXPECT_EQ(arena.span(3, 2).toVector(), b);
+}
+
+TEST(GeometryArena, AllocateLeavesRoomToFill)
+{
+    GeometryArena arena;
+    arena.append(line(0.0, 2));
+    const int offset = arena.allocate(2);
+    EXPECT_EQ(offset, 2);
+    arena.data(offset)[0] = QPointF(7, 8);
+    arena.data(offset)[1] = QPointF(9, 10);
+    EXPECT_EQ(arena.span(offset, 2).toVector(), QVector<QPointF>({QPointF(7, 8), QPointF(9, 10)}));
+}
+
+TEST(GeometryArena, SmallWasteIsTolerated)
+{
+    GeometryArena arena;
+    arena.append(line(0.0, 10));
+    arena.release(10);
+    EXPECT_EQ(arena.releasedCount(), 10);
+    EXPECT_FALSE(arena.isWasteful());
+}
+
+TEST(GeometryArena, CompactRepacksLiveRanges)
+{
+    GeometryArena arena;
+    const QVector<QPointF> dead = line(0.0, 5000);
+    const QVector<QPointF> first = line(1.0, 3);
+    const QVector<QPointF> second = line(2.0, 4);
+
+    QVector<int> offsets;
+    arena.append(dead);
+    offsets.append(arena.append(first));
+    arena.append(dead);
+    offsets.append(arena.append(second));
+    arena.release(2 * dead.size());
+    ASSERT_TRUE(arena.isWasteful());
+
+    const QVector<int> counts = {first.size(), second.size()};
+    arena.compact(offsets, counts);
+    EXPECT_EQ(offsets, QVector<int>({0, 3}));
+    EXPECT_EQ(arena.size(), 7);
+    EXPECT_EQ(arena.releasedCount(), 0);
+    EXPECT_FALSE(arena.isWasteful());
+    EXPECT_EQ(arena.span(offsets[0], counts[0]).toVector(), first);
+    EXPECT_EQ(arena.span(offsets[1], counts[1]).toVector(), second);
+}
+
+TEST(GeometryArena, ClearForgetsEverything)
+{
+    GeometryArena arena;
+    arena.append(line(0.0, 4));
+    arena.release(4);
+    arena.clear();
+    EXPECT_EQ(arena.size(), 0);
+    EXPECT_EQ(arena.releasedCount(), 0);
+}
+
+TEST(PointSpan, ViewsVectorWithoutCopy)
+{
+    const QVector<QPointF> points = line(3.0, 4);
+    const PointSpan span(points);
+    EXPECT_EQ(span.data, points.constData());
+    EXPECT_EQ(span.size, 4);
+    EXPECT_EQ(span[2], QPointF(2, 3.0));
+    EXPECT_TRUE(PointSpan().isEmpty());
+}
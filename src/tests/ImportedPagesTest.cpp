@@ -0,0 +1,87 @@
+#include <QTemporaryDir>
+#include <gtest/gtest.h>
+
+#include "ImportedPage.h"
+#include "Project.h"
+#include "ProjectDatabase.h"
+
+namespace {
+
+// A page as PdfImporter hands it over: sized, thumbnailed and text-extracted
+ImportedPage importedPage(int pageIndex, const QString& word)
+{
+    ImportedPage imported;
+    imported.page = Page::createPdfPage("set.pdf", pageIndex, 10);
+    imported.page.setSourceSize(QSizeF(2592.0, 1728.0));
+    imported.thumbnailPng = QByteArray("\x89PNG page ") + QByteArray::number(pageIndex);
+    imported.words = {PdfWord{word, QRectF(100.0, 200.0, 80.0, 20.0)}};
+    imported.textExtracted = true;
+    return imported;
+}
+
+class ImportedPagesTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(m_dir.isValid());
+        ASSERT_TRUE(m_db.create(m_dir.filePath("import" + Project::FILE_EXTENSION))) << m_db.lastError().toStdString();
+    }
+
+    QTemporaryDir m_dir;
+    ProjectDatabase m_db;
+};
+
+} // namespace
+
+TEST_F(ImportedPagesTest, StoresPagesThumbnailsAndWords)
+{
+    const QVector<ImportedPage> pages = {importedPage(0, "W12X26"), importedPage(1, "HSS6X6"),
+                                         importedPage(2, "C10X15")};
+    ASSERT_TRUE(m_db.insertImportedPages(pages)) << m_db.lastError().toStdString();
+
+    const QVector<Page> stored = m_db.getAllPages();
+    ASSERT_EQ(stored.size(), 3);
+    const QHash<QString, QByteArray> thumbnails = m_db.getPageThumbnails();
+    for (const ImportedPage& imported : pages) {
+        EXPECT_EQ(thumbnails.value(imported.page.id()), imported.thumbnailPng);
+    }
+    EXPECT_EQ(m_db.getIndexedPageIds().size(), 3);
+
+    const QVector<ProjectDatabase::TextHit> hits = m_db.searchPageText("HSS6");
+    ASSERT_EQ(hits.size(), 1);
+    EXPECT_EQ(hits[0].pageId, pages[1].page.id());
+}
+
+TEST_F(ImportedPagesTest, FailedImportStoresNothing)
+{
+    const ImportedPage existing = importedPage(0, "W12X26");
+    ASSERT_TRUE(m_db.insertImportedPages({existing})) << m_db.lastError().toStdString();
+
+    // The last page repeats an existing ID, so its insert fails after the
+    // first two pages of the batch were written
+    const QVector<ImportedPage> pages = {importedPage(1, "HSS6X6"), importedPage(2, "C10X15"), existing};
+    EXPECT_FALSE(m_db.insertImportedPages(pages));
+    EXPECT_FALSE(m_db.lastError().isEmpty());
+
+    const QVector<Page> stored = m_db.getAllPages();
+    ASSERT_EQ(stored.size(), 1);
+    EXPECT_EQ(stored[0].id(), existing.page.id());
+    EXPECT_EQ(m_db.getPageThumbnails().size(), 1);
+    EXPECT_EQ(m_db.getIndexedPageIds(), QStringList{existing.page.id()});
+    EXPECT_TRUE(m_db.searchPageText("HSS6").isEmpty());
+    EXPECT_TRUE(m_db.searchPageText("C10").isEmpty());
+
+    // The project is still usable after the rollback
+    EXPECT_TRUE(m_db.insertImportedPages(pages.mid(0, 2))) << m_db.lastError().toStdString();
+    EXPECT_EQ(m_db.getAllPages().size(), 3);
+}
+
+TEST_F(ImportedPagesTest, CancelledImportHasNothingToStore)
+{
+    // A cancelled PdfImporter returns no pages; storing them is a no-op
+    EXPECT_TRUE(m_db.insertImportedPages(QVector<ImportedPage>()));
+    EXPECT_TRUE(m_db.getAllPages().isEmpty());
+    EXPECT_TRUE(m_db.getPageThumbnails().isEmpty());
+    EXPECT_TRUE(m_db.getIndexedPageIds().isEmpty());
+}
@@ -0,0 +1,104 @@
+#include <QImage>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+
+#include "LineDetector.h"
+
+namespace {
+
+// Paints a black stroke of the given width onto a white grayscale sheet
+void drawLine(QImage& sheet, const QLineF& line, double width)
+{
+    const int x0 = std::max(0, static_cast<int>(std::min(line.x1(), line.x2()) - width));
+    const int x1 = std::min(sheet.width() - 1, static_cast<int>(std::max(line.x1(), line.x2()) + width));
+    const int y0 = std::max(0, static_cast<int>(std::min(line.y1(), line.y2()) - width));
+    const int y1 = std::min(sheet.height() - 1, static_cast<int>(std::max(line.y1(), line.y2()) + width));
+    const double dx = line.dx() / line.length();
+    const double dy = line.dy() / line.length();
+    for (int y = y0; y <= y1; ++y) {
+        uchar* row = sheet.scanLine(y);
+        for (int x = x0; x <= x1; ++x) {
+            const double px = x + 0.5 - line.x1();
+            const double py = y + 0.5 - line.y1();
+            const double along = px * dx + py * dy;
+            const double across = std::abs(px * dy - py * dx);
+            if (along >= 0.0 && along <= line.length() && across <= width / 2.0) {
+                row[x] = 0;
+            }
+        }
+    }
+}
+
+QImage blankSheet(int width, int height)
+{
+    QImage sheet(width, height, QImage::Format_Grayscale8);
+    sheet.fill(255);
+    return sheet;
+}
+
+// Number of detected segments whose ends both lie near the expected ends
+int countMatches(const QVector<QLineF>& segments, const QLineF& expected, double tolerance)
+{
+    auto near = [tolerance](const QPointF& a, const QPointF& b) {
+        return QLineF(a, b).length() <= tolerance;
+    };
+    return static_cast<int>(std::count_if(segments.begin(), segments.end(), [&](const QLineF& s) {
+        return (near(s.p1(), expected.p1()) && near(s.p2(), expected.p2())) ||
+               (near(s.p1(), expected.p2()) && near(s.p2(), expected.p1()));
+    }));
+}
+
+} // namespace
+
+TEST(LineDetector, FindsHorizontalAndVerticalLines)
+{
+    QImage sheet = blankSheet(1200, 900);
+    const QLineF horizontal(100, 200.5, 1000, 200.5);
+    const QLineF vertical(600.5, 100, 600.5, 800);
+    drawLine(sheet, horizontal, 3.0);
+    drawLine(sheet, vertical, 3.0);
+
+    const QVector<QLineF> segments = LineDetector::detect(sheet, LineDetector::Options());
+    EXPECT_EQ(segments.size(), 2);
+    EXPECT_EQ(countMatches(segments, horizontal, 2.0), 1);
+    EXPECT_EQ(countMatches(segments, vertical, 2.0), 1);
+}
+
+TEST(LineDetector, FindsObliqueLinesAcrossTiles)
+{
+    // Long enough to cross several 512 pixel tiles, at a shallow, a
+    // diagonal and a steep angle, plus an X brace whose members cross
+    QImage sheet = blankSheet(2000, 1500);
+    const QVector<QLineF> lines = {
+        QLineF(60, 1400, 1900, 900),     // About 15 degrees
+        QLineF(100, 100, 1300, 1300),    // 45 degrees
+        QLineF(1700, 80, 1500, 1200),    // About 80 degrees
+        QLineF(1400, 200, 1800, 600),
+        QLineF(1400, 600, 1800, 200),
+    };
+    for (const QLineF& line : lines) {
+        drawLine(sheet, line, 3.0);
+    }
+
+    const QVector<QLineF> segments = LineDetector::detect(sheet, LineDetector::Options());
+    for (const QLineF& line : lines) {
+        EXPECT_EQ(countMatches(segments, line, 4.0), 1)
+            << "line from (" << line.x1() << ", " << line.y1() << ") to (" << line.x2() << ", " << line.y2() << ")";
+    }
+
+    // Tile edges and crossings split the lines; the pieces are joined again
+    EXPECT_EQ(segments.size(), lines.size());
+}
+
+TEST(LineDetector, ObliqueLinesCanBeTurnedOff)
+{
+    QImage sheet = blankSheet(800, 800);
+    drawLine(sheet, QLineF(50, 50, 750, 700), 3.0);
+
+    LineDetector::Options options;
+    options.obliqueLines = false;
+    EXPECT_TRUE(LineDetector::detect(sheet, options).isEmpty());
+    options.obliqueLines = true;
+    EXPECT_EQ(LineDetector::detect(sheet, options).size(), 1);
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "MathUtils.h"
+
+namespace {
+
+// Plain loops with the formulas of the scalar fallback. The batch kernels
+// run the AVX or SSE2 code on x86, so they are checked against these.
+
+double referenceLength(const QVector<QPointF>& points, int offset, int count)
+{
+    double total = 0.0;
+    for (int i = offset + 1; i < offset + count; ++i) {
+        total += std::hypot(points[i].x() - points[i - 1].x(), points[i].y() - points[i - 1].y());
+    }
+    return total;
+}
+
+double referenceSegmentDistance(const QPointF& p, const QPointF& a, const QPointF& b)
+{
+    const double dx = b.x() - a.x();
+    const double dy = b.y() - a.y();
+    const double lengthSquared = dx * dx + dy * dy;
+    double t = lengthSquared > 0.0 ? ((p.x() - a.x()) * dx + (p.y() - a.y()) * dy) / lengthSquared : 0.0;
+    t = std::min(1.0, std::max(0.0, t));
+    return std::hypot(a.x() + t * dx - p.x(), a.y() + t * dy - p.y());
+}
+
+QVector<QPointF> randomPoints(int count, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> coordinate(-5000.0, 5000.0);
+    QVector<QPointF> points;
+    points.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        points.append(QPointF(coordinate(random), coordinate(random)));
+    }
+    return points;
+}
+
+// Sizes around the vector widths, so every remainder path runs
+const int SIZES[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 15, 16, 17, 31, 33, 1000, 1003};
+
+} // namespace
+
+TEST(MathUtils, ReportsKernelLevel)
+{
+    const std::string level = MathUtils::kernelLevel();
+    EXPECT_TRUE(level == "avx" || level == "sse2" || level == "scalar") << level;
+    RecordProperty("kernel_level", level);
+}
+
+TEST(MathUtils, PolylineLengthMatchesReference)
+{
+    for (int size : SIZES) {
+        const QVector<QPointF> points = randomPoints(size, 1 + size);
+        const double expected = referenceLength(points, 0, size);
+        EXPECT_NEAR(MathUtils::polylineLength(points), expected, 1e-9 * std::max(1.0, expected))
+            << "size " << size;
+    }
+}
+
+TEST(MathUtils, PolylineLengthsMatchReference)
+{
+    // Polylines start at odd and even offsets of one shared buffer
+    const QVector<QPointF> points = randomPoints(4000, 7);
+    QVector<int> offsets;
+    QVector<int> counts;
+    int offset = 0;
+    for (int size : SIZES) {
+        offsets.append(offset);
+        counts.append(size);
+        offset += size + 1;
+    }
+    ASSERT_LE(offset, points.size());
+
+    QVector<double> lengths(offsets.size(), -1.0);
+    MathUtils::polylineLengths(points.constData(), offsets.constData(), counts.constData(),
+                               offsets.size(), lengths.data());
+    for (int i = 0; i < offsets.size(); ++i) {
+        const double expected = referenceLength(points, offsets[i], counts[i]);
+        EXPECT_NEAR(lengths[i], expected, 1e-9 * std::max(1.0, expected)) << "polyline " << i;
+    }
+}
+
+TEST(MathUtils, PixelsToInchesIsExact)
+{
+    for (int size : SIZES) {
+        QVector<double> pixels;
+        for (int i = 0; i < size; ++i) {
+            pixels.append(0.37 * i - 12.0);
+        }
+        QVector<double> inches(size);
+        MathUtils::pixelsToInches(pixels.constData(), inches.data(), size, 150.0);
+        for (int i = 0; i < size; ++i) {
+            EXPECT_EQ(inches[i], pixels[i] / 150.0) << "size " << size << " index " << i;
+        }
+
+        // In place
+        MathUtils::pixelsToInches(pixels.constData(), pixels.data(), size, 150.0);
+        EXPECT_EQ(pixels, inches);
+    }
+}
+
+TEST(MathUtils, BoundingRectMatchesReference)
+{
+    EXPECT_TRUE(MathUtils::boundingRect(PointSpan()).isNull());
+    for (int size : SIZES) {
+        if (size == 0) {
+            continue;
+        }
+        const QVector<QPointF> points = randomPoints(size, 100 + size);
+        double minX = points[0].x();
+        double minY = points[0].y();
+        double maxX = minX;
+        double maxY = minY;
+        for (const QPointF& point : points) {
+            minX = std::min(minX, point.x());
+            minY = std::min(minY, point.y());
+            maxX = std::max(maxX, point.x());
+            maxY = std::max(maxY, point.y());
+        }
+
+        const QRectF rect = MathUtils::boundingRect(points);
+        EXPECT_EQ(rect.left(), minX) << "size " << size;
+        EXPECT_EQ(rect.top(), minY) << "size " << size;
+        EXPECT_EQ(rect.right(), maxX) << "size " << size;
+        EXPECT_EQ(rect.bottom(), maxY) << "size " << size;
+    }
+}
+
+TEST(MathUtils, DistanceToPolylineMatchesReference)
+{
+    const QPointF probe(123.0, -456.0);
+    EXPECT_EQ(MathUtils::distanceToPolyline(probe, PointSpan()), std::numeric_limits<double>::infinity());
+
+    for (int size : SIZES) {
+        if (size == 0) {
+            continue;
+        }
+        const QVector<QPointF> points = randomPoints(size, 200 + size);
+        double expected = MathUtils::distance(probe, points[0]);
+        for (int i = 1; i < size; ++i) {
+            expected = std::min(expected, referenceSegmentDistance(probe, points[i - 1], points[i]));
+        }
+        EXPECT_NEAR(MathUtils::distanceToPolyline(probe, points), expected, 1e-9 * std::max(1.0, expected))
+            << "size " << size;
+    }
+}
+
+TEST(MathUtils, DistanceToDegenerateSegment)
+{
+    EXPECT_DOUBLE_EQ(MathUtils::distanceToSegment(QPointF(3, 4), QPointF(0, 0), QPointF(0, 0)), 5.0);
+    EXPECT_DOUBLE_EQ(MathUtils::distanceToSegment(QPointF(5, 2), QPointF(0, 0), QPointF(10, 0)), 2.0);
+    EXPECT_DOUBLE_EQ(MathUtils::distanceToSegment(QPointF(-3, 4), QPointF(0, 0), QPointF(10, 0)), 5.0);
+}
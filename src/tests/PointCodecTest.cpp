@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <limits>
+
+#include "PointCodec.h"
+
+namespace {
+
+QVector<QPointF> samplePoints()
+{
+    return {
+        QPointF(0.0, 0.0),
+        QPointF(1234.5, -678.25),
+        QPointF(0.1, 1.0 / 3.0),
+        QPointF(std::numeric_limits<double>::max(), std::numeric_limits<double>::denorm_min())
+    };
+}
+
+} // namespace
+
+TEST(PointCodec, BlobRoundTripIsExact)
+{
+    const QVector<QPointF> points = samplePoints();
+    const QByteArray blob = PointCodec::toBlob(points);
+    EXPECT_EQ(blob.size(), points.size() * 2 * static_cast<int>(sizeof(double)));
+    EXPECT_EQ(PointCodec::blobPointCount(blob), points.size());
+
+    const QVector<QPointF> decoded = PointCodec::fromBlob(blob);
+    ASSERT_EQ(decoded.size(), points.size());
+    for (int i = 0; i < points.size(); ++i) {
+        EXPECT_EQ(decoded[i].x(), points[i].x());
+        EXPECT_EQ(decoded[i].y(), points[i].y());
+    }
+}
+
+TEST(PointCodec, DecodesIntoCallerStorage)
+{
+    const QVector<QPointF> points = samplePoints();
+    const QByteArray blob = PointCodec::toBlob(points);
+
+    // One spare slot on each side must stay untouched
+    QVector<QPointF> out(points.size() + 2, QPointF(-1.0, -1.0));
+    PointCodec::fromBlob(blob, out.data() + 1);
+    EXPECT_EQ(out.first(), QPointF(-1.0, -1.0));
+    EXPECT_EQ(out.last(), QPointF(-1.0, -1.0));
+    for (int i = 0; i < points.size(); ++i) {
+        EXPECT_EQ(out[i + 1].x(), points[i].x());
+        EXPECT_EQ(out[i + 1].y(), points[i].y());
+    }
+}
+
+TEST(PointCodec, EmptyBlob)
+{
+    EXPECT_TRUE(PointCodec::toBlob({}).isEmpty());
+    EXPECT_TRUE(PointCodec::fromBlob(QByteArray()).isEmpty());
+    EXPECT_EQ(PointCodec::blobPointCount(QByteArray()), 0);
+}
+
+TEST(PointCodec, JsonRoundTrip)
+{
+    const QVector<QPointF> points = {QPointF(10.0, 20.5), QPointF(-3.25, 400.0)};
+    const QVector<QPointF> decoded = PointCodec::fromJson(PointCodec::toJson(points));
+    EXPECT_EQ(decoded, points);
+}
+
+TEST(PointCodec, ReadsLegacyJson)
+{
+    const QVector<QPointF> decoded = PointCodec::fromJson(R"([{"x":1,"y":2},{"x":3.5,"y":-4}])");
+    EXPECT_EQ(decoded, QVector<QPointF>({QPointF(1.0, 2.0), QPointF(3.5, -4.0)}));
+}
+
+TEST(PointCodec, InvalidJsonGivesNoPoints)
+{
+    EXPECT_TRUE(PointCodec::fromJson("not json").isEmpty());
+    EXPECT_TRUE(PointCodec::fromJson("{\"x\":1}").isEmpty());
+    EXPECT_TRUE(PointCodec::fromJson(QString()).isEmpty());
+}
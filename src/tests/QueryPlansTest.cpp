@@ -0,0 +1,59 @@
+#include <QTemporaryDir>
+#include <gtest/gtest.h>
+
+#include "Project.h"
+#include "ProjectDatabase.h"
+
+namespace {
+
+void expectIndexedPlans(const ProjectDatabase& db)
+{
+    const QStringList problems = db.checkQueryPlans();
+    for (const QString& problem : problems) {
+        ADD_FAILURE() << "Query plan regression: " << problem.toStdString();
+    }
+}
+
+} // namespace
+
+// Every keyed or filtered statement of ProjectDatabase must be served by an
+// index; see ProjectDatabase::checkQueryPlans()
+
+TEST(QueryPlans, NewProjectIsIndexed)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    ProjectDatabase db;
+    ASSERT_TRUE(db.create(dir.filePath("plans" + Project::FILE_EXTENSION))) << db.lastError().toStdString();
+    expectIndexedPlans(db);
+}
+
+TEST(QueryPlans, ReopenedProjectWithRowsIsIndexed)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString path = dir.filePath("plans" + Project::FILE_EXTENSION);
+
+    {
+        Project project;
+        ASSERT_TRUE(project.create(path)) << project.lastError().toStdString();
+        const int shapeId = project.database()->insertShape("W12X26", "W", 26.0);
+        for (int p = 0; p < 3; ++p) {
+            const Page page = Page::createImagePage(QString("s-%1.png").arg(p));
+            project.addPage(page);
+            for (int i = 0; i < 10; ++i) {
+                TakeoffItem item(TakeoffItem::Line, {QPointF(0, i), QPointF(100, i)}, 32.0);
+                item.setPageId(page.id());
+                item.setShapeId(shapeId);
+                item.setDesignation("W12X26");
+                ASSERT_GT(project.addTakeoffItem(item), 0) << project.lastError().toStdString();
+            }
+        }
+        project.close();
+    }
+
+    ProjectDatabase db;
+    ASSERT_TRUE(db.open(path)) << db.lastError().toStdString();
+    expectIndexedPlans(db);
+}
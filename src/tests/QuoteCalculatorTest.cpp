@@ -0,0 +1,175 @@
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <gtest/gtest.h>
+
+#include "Project.h"
+#include "QuoteCalculator.h"
+
+namespace {
+
+class QuoteCalculatorTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(m_dir.isValid());
+        ASSERT_TRUE(m_project.create(m_dir.filePath("quote" + Project::FILE_EXTENSION)))
+            << m_project.lastError().toStdString();
+
+        m_w12 = m_project.database()->insertShape("W12X26", "W", 26.0);
+        m_hss = m_project.database()->insertShape("HSS6X6X1/4", "HSS", 18.0);
+        ASSERT_GT(m_w12, 0);
+        ASSERT_GT(m_hss, 0);
+
+        const Page first = Page::createImagePage("s-101.png");
+        const Page second = Page::createImagePage("s-102.png");
+        m_project.addPage(first);
+        m_project.addPage(second);
+        ASSERT_EQ(m_project.pages().size(), 2);
+        m_firstPage = first.id();
+        m_secondPage = second.id();
+    }
+
+    int addItem(const QString& pageId, double lengthInches, int qty, int shapeId, const QString& designation)
+    {
+        TakeoffItem item(TakeoffItem::Line, {QPointF(0, 0), QPointF(lengthInches, 0)}, lengthInches);
+        item.setPageId(pageId);
+        item.setQty(qty);
+        item.setShapeId(shapeId);
+        item.setDesignation(designation);
+        const int id = m_project.addTakeoffItem(item);
+        EXPECT_GT(id, 0) << m_project.lastError().toStdString();
+        return id;
+    }
+
+    // Compares two quotes line by line
+    static void expectSameQuote(const QuoteCalculator::Quote& actual, const QuoteCalculator::Quote& expected)
+    {
+        ASSERT_EQ(actual.lines.size(), expected.lines.size());
+        for (int i = 0; i < actual.lines.size(); ++i) {
+            EXPECT_EQ(actual.lines[i].designation, expected.lines[i].designation);
+            EXPECT_EQ(actual.lines[i].qty, expected.lines[i].qty);
+            EXPECT_NEAR(actual.lines[i].totalLengthFt, expected.lines[i].totalLengthFt, 1e-9);
+            EXPECT_NEAR(actual.lines[i].totalWeightLb, expected.lines[i].totalWeightLb, 1e-9);
+            EXPECT_NEAR(actual.lines[i].totalCost, expected.lines[i].totalCost, 1e-9);
+        }
+        EXPECT_EQ(actual.totalQty, expected.totalQty);
+        EXPECT_NEAR(actual.totalWeightLb, expected.totalWeightLb, 1e-9);
+        EXPECT_NEAR(actual.totalCost, expected.totalCost, 1e-9);
+    }
+
+    QTemporaryDir m_dir;
+    Project m_project;
+    int m_w12 = -1;
+    int m_hss = -1;
+    QString m_firstPage;
+    QString m_secondPage;
+};
+
+} // namespace
+
+TEST_F(QuoteCalculatorTest, GroupsAndPricesByDesignation)
+{
+    addItem(m_firstPage, 120.0, 1, m_w12, "W12X26");     // 10 ft
+    addItem(m_secondPage, 60.0, 2, m_w12, "W12X26");     // 2 x 5 ft
+    addItem(m_firstPage, 240.0, 1, m_hss, "HSS6X6X1/4"); // 20 ft
+    addItem(m_firstPage, 36.0, 3, -1, QString());        // 3 x 3 ft, no shape
+
+    const QuoteCalculator::Quote quote = QuoteCalculator::calculate(m_project, 0.5);
+    ASSERT_EQ(quote.lines.size(), 3);
+
+    // Sorted by designation; "(" sorts before letters
+    const QuoteCalculator::Line& unassigned = quote.lines[0];
+    EXPECT_EQ(unassigned.designation, QuoteCalculator::UNASSIGNED);
+    EXPECT_EQ(unassigned.qty, 3);
+    EXPECT_DOUBLE_EQ(unassigned.totalLengthFt, 9.0);
+    EXPECT_EQ(unassigned.totalWeightLb, 0.0);
+    EXPECT_EQ(unassigned.totalCost, 0.0);
+
+    const QuoteCalculator::Line& hss = quote.lines[1];
+    EXPECT_EQ(hss.designation, "HSS6X6X1/4");
+    EXPECT_DOUBLE_EQ(hss.totalWeightLb, 20.0 * 18.0);
+
+    const QuoteCalculator::Line& w12 = quote.lines[2];
+    EXPECT_EQ(w12.designation, "W12X26");
+    EXPECT_EQ(w12.qty, 3);
+    EXPECT_DOUBLE_EQ(w12.totalLengthFt, 20.0);
+    EXPECT_DOUBLE_EQ(w12.wLbPerFt, 26.0);
+    EXPECT_DOUBLE_EQ(w12.totalWeightLb, 520.0);
+    EXPECT_DOUBLE_EQ(w12.totalCost, 260.0);
+
+    EXPECT_EQ(quote.totalQty, 7);
+    EXPECT_DOUBLE_EQ(quote.totalWeightLb, 520.0 + 360.0);
+    EXPECT_DOUBLE_EQ(quote.totalCost, 0.5 * (520.0 + 360.0));
+}
+
+TEST_F(QuoteCalculatorTest, FiltersByPage)
+{
+    addItem(m_firstPage, 120.0, 1, m_w12, "W12X26");
+    addItem(m_secondPage, 60.0, 2, m_w12, "W12X26");
+    addItem(m_secondPage, 240.0, 1, m_hss, "HSS6X6X1/4");
+
+    const QuoteCalculator::Quote quote = QuoteCalculator::calculate(m_project, 1.0, m_firstPage);
+    ASSERT_EQ(quote.lines.size(), 1);
+    EXPECT_EQ(quote.lines[0].designation, "W12X26");
+    EXPECT_EQ(quote.lines[0].qty, 1);
+    EXPECT_DOUBLE_EQ(quote.lines[0].totalLengthFt, 10.0);
+
+    EXPECT_TRUE(QuoteCalculator::calculate(m_project, 1.0, "{no-such-page}").lines.isEmpty());
+}
+
+TEST_F(QuoteCalculatorTest, LengthChangesMatchFullRecalculation)
+{
+    const int a = addItem(m_firstPage, 120.0, 1, m_w12, "W12X26");
+    const int b = addItem(m_firstPage, 60.0, 2, m_hss, "HSS6X6X1/4");
+    addItem(m_secondPage, 90.0, 1, m_w12, "W12X26");
+
+    for (const QString& filter : {QString(), m_firstPage}) {
+        QuoteCalculator::Quote quote = QuoteCalculator::calculate(m_project, 0.75, filter);
+
+        const QVector<int> ids = {a, b};
+        QVector<double> oldLengths;
+        QVector<double> newLengths;
+        for (int id : ids) {
+            TakeoffItem item = m_project.takeoffItem(id);
+            oldLengths.append(item.lengthInches());
+            newLengths.append(item.lengthInches() * 1.5);
+            item.setLengthInches(newLengths.last());
+            m_project.updateTakeoffItem(item);
+        }
+
+        QVector<int> changedLines;
+        ASSERT_TRUE(QuoteCalculator::applyLengthChanges(quote, m_project, filter, ids,
+                                                        oldLengths, newLengths, &changedLines));
+        EXPECT_EQ(changedLines.size(), 2);
+        expectSameQuote(quote, QuoteCalculator::calculate(m_project, 0.75, filter));
+    }
+}
+
+TEST_F(QuoteCalculatorTest, LengthChangeWithoutLineAsksForRecalculation)
+{
+    const int a = addItem(m_firstPage, 120.0, 1, m_w12, "W12X26");
+    QuoteCalculator::Quote quote;   // Stale: has no lines
+    EXPECT_FALSE(QuoteCalculator::applyLengthChanges(quote, m_project, QString(), {a}, {120.0}, {240.0}));
+}
+
+TEST_F(QuoteCalculatorTest, WritesCsv)
+{
+    addItem(m_firstPage, 120.0, 1, m_w12, "W12X26");
+    addItem(m_firstPage, 36.0, 1, -1, QString());
+    const QuoteCalculator::Quote quote = QuoteCalculator::calculate(m_project, 0.5);
+
+    const QString path = m_dir.filePath("quote.csv");
+    QString error;
+    ASSERT_TRUE(QuoteCalculator::writeCsv(quote, path, &error)) << error.toStdString();
+
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    const QStringList lines = QString::fromUtf8(file.readAll()).split('\n');
+    ASSERT_GE(lines.size(), 3);
+    EXPECT_EQ(lines[0], "Designation,Qty,Total (ft),lb/ft,Weight (lb),$/lb,Cost ($)");
+    EXPECT_EQ(lines[1], "(Unassigned),1,3.00,-,-,0.50,-");
+    EXPECT_EQ(lines[2], "W12X26,1,10.00,26.00,260.0,0.50,130.00");
+    EXPECT_TRUE(lines.contains("Total Cost: $130.00"));
+}
@@ -0,0 +1,225 @@
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QUuid>
+#include <gtest/gtest.h>
+
+#include "PointCodec.h"
+#include "ProjectDatabase.h"
+#include "SchemaMigrator.h"
+#include "TakeoffItem.h"
+
+namespace {
+
+class SchemaMigratorTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(m_dir.isValid());
+        m_connectionName = QUuid::createUuid().toString();
+        m_db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+        m_db.setDatabaseName(m_dir.filePath("test.takeoff.db"));
+        ASSERT_TRUE(m_db.open()) << m_db.lastError().text().toStdString();
+    }
+
+    void TearDown() override
+    {
+        m_db.close();
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+
+    void exec(const QString& sql)
+    {
+        QSqlQuery query(m_db);
+        ASSERT_TRUE(query.exec(sql)) << query.lastError().text().toStdString();
+    }
+
+    qint64 scalar(const QString& sql)
+    {
+        QSqlQuery query(m_db);
+        if (!query.exec(sql) || !query.next()) {
+            ADD_FAILURE() << sql.toStdString() << ": " << query.lastError().text().toStdString();
+            return -1;
+        }
+        return query.value(0).toLongLong();
+    }
+
+    // Pages and items as they were at version 6, with items 11 and 12 whose
+    // page is missing and a deleted item 13
+    void createVersion6Items()
+    {
+        exec(R"(CREATE TABLE pages (
+            id TEXT PRIMARY KEY, type TEXT, source_path TEXT, pdf_page_index INTEGER,
+            pdf_total_pages INTEGER, display_name TEXT, calibration_ppi REAL,
+            calib_pt1_x REAL, calib_pt1_y REAL, calib_pt2_x REAL, calib_pt2_y REAL,
+            source_width REAL DEFAULT 0, source_height REAL DEFAULT 0, thumbnail BLOB
+        ))");
+        exec(R"(CREATE TABLE takeoff_items (
+            id INTEGER PRIMARY KEY AUTOINCREMENT, page_id TEXT REFERENCES pages(id),
+            kind TEXT, points TEXT, length_in REAL, qty INTEGER DEFAULT 1,
+            shape_id INTEGER, designation TEXT, notes TEXT, points_blob BLOB
+        ))");
+        exec("INSERT INTO pages (id, display_name) VALUES ('{a}', 'S-101')");
+        exec("INSERT INTO pages (id, display_name) VALUES ('{b}', 'S-102')");
+        exec("INSERT INTO takeoff_items (id, page_id, kind) VALUES (10, '{b}', 'Line')");
+        exec("INSERT INTO takeoff_items (id, page_id, kind) VALUES (11, NULL, 'Line')");
+        exec("INSERT INTO takeoff_items (id, page_id, kind) VALUES (12, '{gone}', 'Line')");
+        exec("INSERT INTO takeoff_items (id, page_id, kind) VALUES (13, '{a}', 'Line')");
+        exec("DELETE FROM takeoff_items WHERE id = 13");
+        exec("PRAGMA user_version = 6");
+    }
+
+    QTemporaryDir m_dir;
+    QString m_connectionName;
+    QSqlDatabase m_db;
+};
+
+} // namespace
+
+TEST_F(SchemaMigratorTest, MigratesNewFileToLatest)
+{
+    SchemaMigrator migrator(m_db);
+    EXPECT_EQ(migrator.currentVersion(), 0);
+    ASSERT_TRUE(migrator.migrate()) << migrator.lastError().toStdString();
+    EXPECT_EQ(migrator.currentVersion(), SchemaMigrator::latestVersion());
+
+    // Background rewrites have nothing to do in a new file and finish at once
+    EXPECT_EQ(migrator.pendingBackgroundRows(), 0);
+    while (migrator.hasPendingBackgroundWork()) {
+        ASSERT_EQ(migrator.runBackgroundStep(100), 0);
+    }
+
+    const QVector<SchemaMigrator::Record> history = migrator.history();
+    ASSERT_EQ(history.size(), SchemaMigrator::latestVersion());
+    for (int i = 0; i < history.size(); ++i) {
+        EXPECT_EQ(history[i].version, i + 1);
+        EXPECT_FALSE(history[i].description.isEmpty());
+    }
+}
+
+TEST_F(SchemaMigratorTest, MigratingTwiceChangesNothing)
+{
+    ASSERT_TRUE(SchemaMigrator(m_db).migrate());
+    SchemaMigrator again(m_db);
+    ASSERT_TRUE(again.migrate()) << again.lastError().toStdString();
+    EXPECT_EQ(again.currentVersion(), SchemaMigrator::latestVersion());
+    EXPECT_EQ(again.history().size(), SchemaMigrator::latestVersion());
+}
+
+TEST_F(SchemaMigratorTest, RefusesNewerFiles)
+{
+    exec(QString("PRAGMA user_version = %1").arg(SchemaMigrator::latestVersion() + 1));
+    SchemaMigrator migrator(m_db);
+    EXPECT_FALSE(migrator.migrate());
+    EXPECT_FALSE(migrator.lastError().isEmpty());
+    EXPECT_EQ(migrator.currentVersion(), SchemaMigrator::latestVersion() + 1);
+}
+
+TEST_F(SchemaMigratorTest, FileVersionIsReadWithoutMigrating)
+{
+    exec("PRAGMA user_version = 6");
+    const QString path = m_dir.filePath("test.takeoff.db");
+
+    QString error;
+    EXPECT_EQ(ProjectDatabase::fileSchemaVersion(path, &error), 6) << error.toStdString();
+    EXPECT_EQ(scalar("PRAGMA user_version"), 6);
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM sqlite_master WHERE name = 'schema_migrations'"), 0);
+
+    const QString missing = m_dir.filePath("missing.takeoff.db");
+    EXPECT_EQ(ProjectDatabase::fileSchemaVersion(missing, &error), -1);
+    EXPECT_FALSE(error.isEmpty());
+    EXPECT_FALSE(QFile::exists(missing));
+}
+
+TEST_F(SchemaMigratorTest, ConvertsJsonPointsInBackground)
+{
+    ASSERT_TRUE(SchemaMigrator(m_db).migrate());
+
+    // Rows as a file upgraded to version 3 still holds them, with the
+    // conversion not yet finished
+    const QVector<QPointF> points = {QPointF(1.5, 2.0), QPointF(300.25, -4.0), QPointF(7.0, 8.0)};
+    exec("INSERT INTO pages (key, id) VALUES (1, '{page}')");
+    for (int i = 0; i < 5; ++i) {
+        exec(QString("INSERT INTO takeoff_items (page_id, kind, points) VALUES (1, 'Polyline', '%1')")
+                 .arg(PointCodec::toJson(points)));
+    }
+    exec("UPDATE schema_migrations SET background_done = 0 WHERE version = 3");
+
+    SchemaMigrator migrator(m_db);
+    ASSERT_TRUE(migrator.migrate());
+    ASSERT_TRUE(migrator.hasPendingBackgroundWork());
+    EXPECT_EQ(migrator.pendingBackgroundRows(), 5);
+
+    EXPECT_EQ(migrator.runBackgroundStep(2), 2);
+    EXPECT_EQ(migrator.pendingBackgroundRows(), 3);
+    EXPECT_EQ(migrator.runBackgroundStep(2), 2);
+    EXPECT_EQ(migrator.runBackgroundStep(2), 1);
+    EXPECT_EQ(migrator.pendingBackgroundRows(), 0);
+    EXPECT_EQ(migrator.runBackgroundStep(2), 0);
+    EXPECT_FALSE(migrator.hasPendingBackgroundWork());
+
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM takeoff_items WHERE points IS NOT NULL"), 0);
+    QSqlQuery query(m_db);
+    ASSERT_TRUE(query.exec("SELECT points_blob FROM takeoff_items"));
+    int rows = 0;
+    while (query.next()) {
+        EXPECT_EQ(PointCodec::fromBlob(query.value(0).toByteArray()), points);
+        ++rows;
+    }
+    EXPECT_EQ(rows, 5);
+
+    // Finished work is recorded and not resumed on the next open
+    SchemaMigrator reopened(m_db);
+    ASSERT_TRUE(reopened.migrate());
+    EXPECT_FALSE(reopened.hasPendingBackgroundWork());
+}
+
+TEST_F(SchemaMigratorTest, IntegerPageKeysKeepOrphanItems)
+{
+    createVersion6Items();
+
+    SchemaMigrator migrator(m_db);
+    ASSERT_TRUE(migrator.migrate()) << migrator.lastError().toStdString();
+    ASSERT_EQ(migrator.currentVersion(), 7);
+
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM takeoff_items"), 3);
+    EXPECT_EQ(scalar("SELECT page_id FROM takeoff_items WHERE id = 10"),
+              scalar("SELECT key FROM pages WHERE id = '{b}'"));
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM takeoff_items WHERE id IN (11, 12) AND page_id IS NULL"), 2);
+
+    // Deleted item IDs are not handed out again
+    exec("INSERT INTO takeoff_items (kind) VALUES ('Line')");
+    EXPECT_EQ(scalar("SELECT MAX(id) FROM takeoff_items"), 14);
+}
+
+TEST_F(SchemaMigratorTest, OrphanItemsReadBackUnassigned)
+{
+    createVersion6Items();
+    ASSERT_TRUE(SchemaMigrator(m_db).migrate());
+
+    ProjectDatabase db;
+    ASSERT_TRUE(db.open(m_dir.filePath("test.takeoff.db"))) << db.lastError().toStdString();
+
+    const QVector<TakeoffItem> items = db.getAllTakeoffItems();
+    ASSERT_EQ(items.size(), 3);
+    EXPECT_EQ(items[0].id(), 10);
+    EXPECT_EQ(items[0].pageId(), "{b}");
+    EXPECT_EQ(items[1].id(), 11);
+    EXPECT_TRUE(items[1].pageId().isEmpty());
+    EXPECT_EQ(items[2].id(), 12);
+    EXPECT_TRUE(items[2].pageId().isEmpty());
+    EXPECT_EQ(db.getTakeoffItemsForPage("{b}").size(), 1);
+
+    // Editing an orphan keeps it without a page
+    TakeoffItem orphan = db.getTakeoffItem(12);
+    ASSERT_EQ(orphan.id(), 12);
+    orphan.setQty(4);
+    ASSERT_TRUE(db.updateTakeoffItem(orphan)) << db.lastError().toStdString();
+    EXPECT_EQ(db.getTakeoffItem(12).qty(), 4);
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM takeoff_items WHERE id = 12 AND page_id IS NULL"), 1);
+    db.close();
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <cmath>
+
+#include "ShapeProperties.h"
+
+TEST(ShapeProperties, RowCountIsHighestIdPlusOne)
+{
+    ShapeProperties properties;
+    const int weight = properties.addProperty("W");
+    EXPECT_EQ(properties.rowCount(), 0);
+
+    // Importing in ID order grows the columns one shape at a time
+    for (int id = 1; id <= 100; ++id) {
+        properties.setValue(id, weight, id * 2.0);
+        ASSERT_EQ(properties.rowCount(), id + 1);
+    }
+    EXPECT_EQ(properties.column(weight).size(), 101);
+
+    // A property added later gets the same rows, all missing
+    const int depth = properties.addProperty("d");
+    EXPECT_EQ(properties.column(depth).size(), 101);
+    EXPECT_TRUE(std::isnan(properties.value(100, depth)));
+
+    properties.setValue(250, depth, 12.2);
+    EXPECT_EQ(properties.rowCount(), 251);
+    EXPECT_TRUE(std::isnan(properties.value(150, weight)));
+    EXPECT_EQ(properties.value(250, "d"), 12.2);
+    EXPECT_TRUE(std::isnan(properties.value(251, depth)));
+}
+
+TEST(ShapeProperties, ColumnBlobHoldsExactRows)
+{
+    ShapeProperties source;
+    const int weight = source.addProperty("W");
+    source.setValue(3, weight, 26.0);
+    source.setValue(7, weight, 18.0);
+
+    const QByteArray blob = source.columnToBlob(weight);
+    EXPECT_EQ(blob.size(), static_cast<int>(8 * sizeof(double)));
+
+    ShapeProperties loaded;
+    const int loadedWeight = loaded.addProperty("W");
+    loaded.setColumnFromBlob(loadedWeight, blob);
+    EXPECT_EQ(loaded.rowCount(), 8);
+    EXPECT_EQ(loaded.value(3, loadedWeight), 26.0);
+    EXPECT_EQ(loaded.value(7, loadedWeight), 18.0);
+    EXPECT_TRUE(std::isnan(loaded.value(5, loadedWeight)));
+}
+
+TEST(ShapeProperties, WeightedSumSkipsMissingAndUnassigned)
+{
+    ShapeProperties properties;
+    const int weight = properties.addProperty("W");
+    properties.setValue(1, weight, 26.0);
+    properties.setValue(4, weight, 18.0);
+
+    const int ids[] = {1, 4, 2, -1, 99};
+    const double feet[] = {10.0, 2.0, 5.0, 3.0, 7.0};
+    EXPECT_DOUBLE_EQ(properties.weightedSum(weight, ids, feet, 5), 260.0 + 36.0);
+}
@@ -0,0 +1,120 @@
+#include <QElapsedTimer>
+#include <gtest/gtest.h>
+#include <random>
+
+#include "SnapEngine.h"
+
+namespace {
+
+// Short segments scattered over a sheet the size of a 36 x 24 in drawing
+// rendered at 300 dpi
+QVector<QLineF> randomSegments(int count, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> x(0.0, 10800.0);
+    std::uniform_real_distribution<double> y(0.0, 7200.0);
+    std::uniform_real_distribution<double> offset(-150.0, 150.0);
+    QVector<QLineF> segments;
+    segments.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const QPointF start(x(random), y(random));
+        segments.append(QLineF(start, start + QPointF(offset(random), offset(random))));
+    }
+    return segments;
+}
+
+} // namespace
+
+TEST(SnapEngine, FindsEndpointsMidpointsAndIntersections)
+{
+    SnapEngine engine;
+    engine.setSegments({QLineF(0, 0, 100, 0), QLineF(50, -50, 50, 50), QLineF(200, 20, 200, 80)});
+    EXPECT_EQ(engine.segmentCount(), 3);
+
+    SnapEngine::Result endpoint = engine.snap(QPointF(98, 1), 5.0);
+    EXPECT_EQ(endpoint.kind, SnapEngine::Kind::Endpoint);
+    EXPECT_EQ(endpoint.point, QPointF(100, 0));
+
+    // The crossing of the first two segments is also the midpoint of both
+    SnapEngine::Result crossing = engine.snap(QPointF(51, 1), 5.0);
+    EXPECT_EQ(crossing.kind, SnapEngine::Kind::Intersection);
+    EXPECT_EQ(crossing.point, QPointF(50, 0));
+
+    SnapEngine::Result midpoint = engine.snap(QPointF(201, 51), 5.0);
+    EXPECT_EQ(midpoint.kind, SnapEngine::Kind::Midpoint);
+    EXPECT_EQ(midpoint.point, QPointF(200, 50));
+
+    EXPECT_FALSE(engine.snap(QPointF(75, 30), 5.0).isValid());
+}
+
+TEST(SnapEngine, OverlaySegmentsAreAddedAndRemoved)
+{
+    SnapEngine engine;
+    engine.setSegments({QLineF(0, 0, 1000, 0)});
+
+    // A measurement crossing the sheet line
+    engine.addSegments(7, {QLineF(300, -200, 300, 200), QLineF(300, 200, 600, 200)});
+    EXPECT_EQ(engine.segmentCount(), 3);
+    EXPECT_EQ(engine.snap(QPointF(599, 198), 5.0).point, QPointF(600, 200));
+    SnapEngine::Result crossing = engine.snap(QPointF(302, 2), 5.0);
+    EXPECT_EQ(crossing.kind, SnapEngine::Kind::Intersection);
+    EXPECT_EQ(crossing.point, QPointF(300, 0));
+
+    // Replacing the sheet segments keeps the overlay
+    engine.setSegments({QLineF(0, 10, 1000, 10)});
+    EXPECT_EQ(engine.snap(QPointF(599, 198), 5.0).point, QPointF(600, 200));
+
+    // Replacing a group drops its old segments
+    engine.addSegments(7, {QLineF(-500, -500, -400, -500)});
+    EXPECT_EQ(engine.segmentCount(), 2);
+    EXPECT_FALSE(engine.snap(QPointF(599, 198), 5.0).isValid());
+    EXPECT_EQ(engine.snap(QPointF(-401, -499), 5.0).point, QPointF(-400, -500));
+
+    engine.removeSegments(7);
+    engine.removeSegments(8);
+    EXPECT_EQ(engine.segmentCount(), 1);
+    EXPECT_FALSE(engine.snap(QPointF(-401, -499), 5.0).isValid());
+    EXPECT_EQ(engine.snap(QPointF(999, 11), 5.0).point, QPointF(1000, 10));
+
+    engine.clear();
+    EXPECT_TRUE(engine.isEmpty());
+}
+
+TEST(SnapEngine, QueriesStayUnderAMillisecondAt100kSegments)
+{
+    const int queries = 2000;
+    SnapEngine engine;
+    engine.setSegments(randomSegments(100000, 1));
+    for (int id = 0; id < 500; ++id) {
+        engine.addSegments(id, randomSegments(4, 100 + id));
+    }
+
+    std::mt19937 random(2);
+    std::uniform_real_distribution<double> x(0.0, 10800.0);
+    std::uniform_real_distribution<double> y(0.0, 7200.0);
+    QVector<QPointF> positions;
+    for (int i = 0; i < queries; ++i) {
+        positions.append(QPointF(x(random), y(random)));
+    }
+
+    // Tolerance of 10 screen pixels with the sheet zoomed out to a third
+    int hits = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (const QPointF& pos : positions) {
+        hits += engine.snap(pos, 30.0).isValid() ? 1 : 0;
+    }
+    const double queryMs = timer.nsecsElapsed() / 1e6 / queries;
+    EXPECT_GT(hits, 0);
+    EXPECT_LT(queryMs, 1.0);
+    RecordProperty("query_us", static_cast<int>(queryMs * 1000.0));
+
+    // Drawing or deleting a measurement only touches the overlay
+    timer.restart();
+    for (int id = 0; id < queries; ++id) {
+        engine.addSegments(1000 + id, randomSegments(4, 10000 + id));
+        engine.removeSegments(1000 + id);
+    }
+    EXPECT_LT(timer.nsecsElapsed() / 1e6 / queries, 1.0);
+    EXPECT_EQ(engine.segmentCount(), 100000 + 500 * 4);
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "StringTable.h"
+
+TEST(StringTable, HandsOutDenseKeysInOrder)
+{
+    StringTable table;
+    EXPECT_EQ(table.intern("W12X26"), 0);
+    EXPECT_EQ(table.intern("HSS6X6X1/4"), 1);
+    EXPECT_EQ(table.intern(QString()), 2);
+    EXPECT_EQ(table.size(), 3);
+}
+
+TEST(StringTable, ReusesKeys)
+{
+    StringTable table;
+    const int key = table.intern("W12X26");
+    table.intern("C10X15.3");
+    EXPECT_EQ(table.intern(QString("W12") + "X26"), key);
+    EXPECT_EQ(table.size(), 2);
+    EXPECT_EQ(table.string(key), "W12X26");
+}
+
+TEST(StringTable, FindDoesNotAdd)
+{
+    StringTable table;
+    table.intern("a");
+    EXPECT_EQ(table.find("a"), 0);
+    EXPECT_EQ(table.find("b"), -1);
+    EXPECT_EQ(table.size(), 1);
+}
+
+TEST(StringTable, TreatsNullAsEmpty)
+{
+    // Both mean "no designation" and must share one key
+    StringTable table;
+    EXPECT_EQ(table.intern(QString()), table.intern(QString("")));
+}
+
+TEST(StringTable, ClearRestartsKeys)
+{
+    StringTable table;
+    table.intern("a");
+    table.intern("b");
+    table.clear();
+    EXPECT_EQ(table.size(), 0);
+    EXPECT_EQ(table.find("a"), -1);
+    EXPECT_EQ(table.intern("b"), 0);
+}
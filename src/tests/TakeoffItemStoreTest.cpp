@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include "TakeoffItemStore.h"
+
+namespace {
+
+TakeoffItem makeItem(int id, const QString& pageId, int pointCount, const QString& designation = QString())
+{
+    QVector<QPointF> points;
+    for (int i = 0; i < pointCount; ++i) {
+        points.append(QPointF(id * 10.0 + i, i));
+    }
+    TakeoffItem item(pointCount > 2 ? TakeoffItem::Polyline : TakeoffItem::Line, points, 12.0 * id);
+    item.setId(id);
+    item.setPageId(pageId);
+    item.setDesignation(designation);
+    if (!designation.isEmpty()) {
+        item.setShapeId(100 + id);
+    }
+    return item;
+}
+
+// Compares every field the store keeps
+void expectSameItem(const TakeoffItem& actual, const TakeoffItem& expected)
+{
+    EXPECT_EQ(actual.id(), expected.id());
+    EXPECT_EQ(actual.pageId(), expected.pageId());
+    EXPECT_EQ(actual.kind(), expected.kind());
+    EXPECT_EQ(actual.points(), expected.points());
+    EXPECT_EQ(actual.lengthInches(), expected.lengthInches());
+    EXPECT_EQ(actual.qty(), expected.qty());
+    EXPECT_EQ(actual.shapeId(), expected.shapeId());
+    EXPECT_EQ(actual.designation(), expected.designation());
+    EXPECT_EQ(actual.notes(), expected.notes());
+}
+
+} // namespace
+
+TEST(TakeoffItemStore, RoundTripsItems)
+{
+    TakeoffItem item = makeItem(7, "page-a", 4, "W12X26");
+    item.setQty(3);
+    item.setNotes("Grid B");
+
+    TakeoffItemStore store;
+    store.append(item);
+    ASSERT_EQ(store.size(), 1);
+    expectSameItem(store.item(0), item);
+    expectSameItem(store.at(0).toItem(), item);
+
+    const TakeoffItemView view = store.at(0);
+    EXPECT_EQ(view.totalLengthInches(), 12.0 * 7 * 3);
+    EXPECT_TRUE(view.hasMaterial());
+    EXPECT_EQ(view.points().size, 4);
+}
+
+TEST(TakeoffItemStore, AssignKeepsOrderAndIndexesIds)
+{
+    const QVector<TakeoffItem> items = {
+        makeItem(30, "page-a", 2), makeItem(10, "page-b", 3), makeItem(20, "page-a", 5)
+    };
+    TakeoffItemStore store;
+    store.assign(items);
+    ASSERT_EQ(store.size(), 3);
+
+    int row = 0;
+    for (const TakeoffItemView view : store) {
+        EXPECT_EQ(view.id(), items[row].id());
+        EXPECT_EQ(store.rowOf(view.id()), row);
+        ++row;
+    }
+    EXPECT_EQ(row, 3);
+    EXPECT_EQ(store.rowOf(99), -1);
+}
+
+TEST(TakeoffItemStore, InternsPagesAndDesignations)
+{
+    TakeoffItemStore store;
+    store.append(makeItem(1, "page-a", 2, "W12X26"));
+    store.append(makeItem(2, "page-b", 2, "W12X26"));
+    store.append(makeItem(3, "page-a", 2, "C10X15.3"));
+
+    EXPECT_EQ(store.pageIds().size(), 2);
+    EXPECT_EQ(store.designations().size(), 2);
+    EXPECT_EQ(store.pageKeyData()[0], store.pageKeyData()[2]);
+    EXPECT_EQ(store.designationKeyData()[0], store.designationKeyData()[1]);
+    EXPECT_EQ(store.countForPage("page-a"), 2);
+    EXPECT_EQ(store.countForPage("page-b"), 1);
+    EXPECT_EQ(store.countForPage("page-c"), 0);
+}
+
+TEST(TakeoffItemStore, UpdateGrowsAndShrinksPoints)
+{
+    TakeoffItemStore store;
+    store.append(makeItem(1, "page-a", 3));
+    store.append(makeItem(2, "page-a", 2));
+
+    TakeoffItem grown = makeItem(1, "page-b", 8, "HSS6X6X1/4");
+    grown.setQty(2);
+    ASSERT_TRUE(store.update(grown));
+    expectSameItem(store.item(0), grown);
+
+    const TakeoffItem shrunk = makeItem(1, "page-b", 2);
+    ASSERT_TRUE(store.update(shrunk));
+    expectSameItem(store.item(0), shrunk);
+
+    // The neighbour is untouched
+    expectSameItem(store.item(1), makeItem(2, "page-a", 2));
+    EXPECT_FALSE(store.update(makeItem(3, "page-a", 2)));
+}
+
+TEST(TakeoffItemStore, RemoveReindexesLaterRows)
+{
+    TakeoffItemStore store;
+    for (int id = 1; id <= 4; ++id) {
+        store.append(makeItem(id, "page-a", id + 1));
+    }
+    ASSERT_TRUE(store.remove(2));
+    EXPECT_FALSE(store.remove(2));
+    ASSERT_EQ(store.size(), 3);
+    EXPECT_EQ(store.rowOf(2), -1);
+    EXPECT_EQ(store.rowOf(3), 1);
+    EXPECT_EQ(store.rowOf(4), 2);
+    expectSameItem(store.item(1), makeItem(3, "page-a", 4));
+    expectSameItem(store.item(2), makeItem(4, "page-a", 5));
+}
+
+TEST(TakeoffItemStore, RemovePageKeepsOtherPages)
+{
+    TakeoffItemStore store;
+    store.append(makeItem(1, "page-a", 2));
+    store.append(makeItem(2, "page-b", 3));
+    store.append(makeItem(3, "page-a", 4));
+    store.append(makeItem(4, "page-b", 5));
+
+    EXPECT_EQ(store.removePage("page-a"), 2);
+    EXPECT_EQ(store.removePage("page-c"), 0);
+    ASSERT_EQ(store.size(), 2);
+    expectSameItem(store.item(0), makeItem(2, "page-b", 3));
+    expectSameItem(store.item(1), makeItem(4, "page-b", 5));
+    EXPECT_EQ(store.rowOf(4), 1);
+}
+
+TEST(TakeoffItemStore, GeometrySurvivesCompaction)
+{
+    // Enough churn that released points outweigh live ones and the arena
+    // is repacked at least once
+    TakeoffItemStore store;
+    for (int id = 1; id <= 200; ++id) {
+        store.append(makeItem(id, "page-a", 50));
+    }
+    for (int id = 1; id <= 200; id += 2) {
+        ASSERT_TRUE(store.remove(id));
+    }
+    for (int id = 2; id <= 200; id += 4) {
+        ASSERT_TRUE(store.update(makeItem(id, "page-a", 60)));
+    }
+
+    ASSERT_EQ(store.size(), 100);
+    for (int row = 0; row < store.size(); ++row) {
+        const int id = store.at(row).id();
+        expectSameItem(store.item(row), makeItem(id, "page-a", id % 4 == 2 ? 60 : 50));
+    }
+}
+
+TEST(TakeoffItemStore, AppendWithPointsDecodesInPlace)
+{
+    TakeoffItemStore store;
+    const TakeoffItem expected = makeItem(5, "page-a", 3);
+    TakeoffItem fields = expected;
+    fields.setPoints({});
+
+    QPointF* out = store.appendWithPoints(fields, 3);
+    for (int i = 0; i < 3; ++i) {
+        out[i] = expected.points()[i];
+    }
+    expectSameItem(store.item(0), expected);
+}
+
+TEST(TakeoffItemStore, SetLengthInchesTouchesOneRow)
+{
+    TakeoffItemStore store;
+    store.append(makeItem(1, "page-a", 2));
+    store.append(makeItem(2, "page-a", 2));
+    store.setLengthInches(1, 99.5);
+    EXPECT_EQ(store.at(0).lengthInches(), 12.0);
+    EXPECT_EQ(store.at(1).lengthInches(), 99.5);
+}
@@ -0,0 +1,15 @@
+#include <QCoreApplication>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Unit tests for takeoff_core.
+ *
+ * A QCoreApplication is created first so the SQLite driver can be loaded
+ * by the database tests.
+ */
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
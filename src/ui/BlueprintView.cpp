@@ -1,14 +1,25 @@
 #include "BlueprintView.h"
 #include "MathUtils.h"
+#include "Trace.h"
 
 #include <QWheelEvent>
 #include <QMouseEvent>
+#include <QResizeEvent>
 #include <QKeyEvent>
+#include <QPaintEvent>
 #include <QInputDialog>
 #include <QGraphicsEllipseItem>
+#include <QGraphicsRectItem>
 #include <QPen>
 #include <QBrush>
 #include <QScrollBar>
+#include <QPainter>
+#include <QScreen>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFontDatabase>
+#include <QFontMetrics>
+#include <algorithm>
 #include <cmath>
 
 // Color constants
@@ -16,17 +27,56 @@ const QColor BlueprintView::TEMP_COLOR(255, 165, 0);        // Orange for tempor
 const QColor BlueprintView::MEASUREMENT_COLOR(0, 150, 0);   // Green for completed
 const QColor BlueprintView::HIGHLIGHT_COLOR(255, 0, 0);     // Red for highlighted
 const QColor BlueprintView::POINT_COLOR(0, 100, 255);       // Blue for points
+const QColor BlueprintView::SNAP_COLOR(255, 0, 255);        // Magenta for snap marker
+const QColor BlueprintView::SEARCH_HIT_COLOR(255, 200, 0);  // Amber for search hits
+const QColor BlueprintView::FLAG_COLOR(255, 110, 0);        // Dark orange for changed items
+
+// Snap search radius in screen pixels, independent of zoom
+const double BlueprintView::SNAP_TOLERANCE_PX = 10.0;
+
+// Quiet time after zooming or panning before sharper tiles are requested
+const int BlueprintView::DETAIL_DELAY_MS = 120;
+
+// Tiles held at once (512 px tiles are 1 MB each); offscreen ones go first
+const int BlueprintView::MAX_DETAIL_TILES = 96;
+
+// Performance HUD refresh interval
+const int BlueprintView::HUD_INTERVAL_MS = 500;
+
+namespace {
+
+quint64 detailTileKey(int level, const QPoint& cell)
+{
+    return (static_cast<quint64>(level) << 48) |
+           (static_cast<quint64>(static_cast<quint32>(cell.y()) & 0xFFFFFF) << 24) |
+           (static_cast<quint64>(static_cast<quint32>(cell.x()) & 0xFFFFFF));
+}
+
+} // namespace
 
 BlueprintView::BlueprintView(QWidget* parent)
     : QGraphicsView(parent)
     , m_scene(nullptr)
     , m_imageItem(nullptr)
+    , m_showsPreview(false)
+    , m_detailLevel(-1)
+    , m_detailTimer(nullptr)
+    , m_compareMode(CompareMode::Overlay)
+    , m_compareItem(nullptr)
     , m_currentTool(Tool::None)
-    , m_tempStartPoint(nullptr)
-    , m_rubberBand(nullptr)
+    , m_committedLengthPx(0.0)
+    , m_pendingLiveInches(0.0)
+    , m_liveMeasurementTimer(nullptr)
+    , m_hasCursorPos(false)
     , m_highlightedMeasurementId(-1)
     , m_isPanning(false)
     , m_nextMeasurementId(1)
+    , m_snapEnabled(true)
+    , m_hudVisible(false)
+    , m_hudTimer(nullptr)
+    , m_frameMs(0.0)
+    , m_hudItemCount(0)
+    , m_hudVisibleTiles(0)
 {
     setupScene();
     setMouseTracking(true);
@@ -36,6 +86,23 @@ BlueprintView::BlueprintView(QWidget* parent)
     setResizeAnchor(QGraphicsView::AnchorUnderMouse);
     setDragMode(QGraphicsView::NoDrag);
     setFocusPolicy(Qt::StrongFocus);
+
+    // Live length updates are coalesced to at most one per display frame
+    m_liveMeasurementTimer = new QTimer(this);
+    m_liveMeasurementTimer->setSingleShot(true);
+    connect(m_liveMeasurementTimer, &QTimer::timeout, this, [this]() {
+        emit liveMeasurementChanged(m_pendingLiveInches);
+    });
+    updateLiveMeasurementInterval();
+
+    m_detailTimer = new QTimer(this);
+    m_detailTimer->setSingleShot(true);
+    m_detailTimer->setInterval(DETAIL_DELAY_MS);
+    connect(m_detailTimer, &QTimer::timeout, this, &BlueprintView::detailRequested);
+
+    m_hudTimer = new QTimer(this);
+    m_hudTimer->setInterval(HUD_INTERVAL_MS);
+    connect(m_hudTimer, &QTimer::timeout, this, &BlueprintView::refreshHud);
 }
 
 BlueprintView::~BlueprintView()
@@ -57,7 +124,7 @@ bool BlueprintView::loadImage(const QString& filePath)
         return false;
     }
 
-    displayPixmap(pixmap);
+    displayPixmap(pixmap, pixmap.size());
     return true;
 }
 
@@ -72,27 +139,230 @@ bool BlueprintView::loadFromImage(const QImage& image)
         return false;
     }
 
-    displayPixmap(pixmap);
+    displayPixmap(pixmap, pixmap.size());
     return true;
 }
 
-void BlueprintView::displayPixmap(const QPixmap& pixmap)
+bool BlueprintView::loadPreview(const QImage& preview, const QSizeF& sceneSize)
+{
+    if (preview.isNull() || sceneSize.isEmpty()) {
+        return false;
+    }
+
+    QPixmap pixmap = QPixmap::fromImage(preview);
+    if (pixmap.isNull()) {
+        return false;
+    }
+
+    displayPixmap(pixmap, sceneSize);
+    m_showsPreview = true;
+    scheduleDetailUpdate();
+    return true;
+}
+
+void BlueprintView::setDetailTile(int level, const QPoint& cell, const QRectF& sceneRect, const QImage& image)
+{
+    if (!m_showsPreview || image.isNull() || sceneRect.isEmpty()) {
+        return;
+    }
+
+    if (level != m_detailLevel) {
+        clearDetailTiles();
+        m_detailLevel = level;
+    }
+
+    const quint64 key = detailTileKey(level, cell);
+    if (QGraphicsPixmapItem* old = m_detailTiles.take(key)) {
+        m_scene->removeItem(old);
+        delete old;
+    }
+
+    // Keep memory bounded by dropping tiles that scrolled out of view
+    if (m_detailTiles.size() >= MAX_DETAIL_TILES) {
+        const QRectF visible = visibleSceneRect();
+        for (auto it = m_detailTiles.begin(); it != m_detailTiles.end();) {
+            if (!it.value()->sceneBoundingRect().intersects(visible)) {
+                m_scene->removeItem(it.value());
+                delete it.value();
+                it = m_detailTiles.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    QGraphicsPixmapItem* tile = m_scene->addPixmap(QPixmap::fromImage(image));
+    tile->setTransformationMode(Qt::SmoothTransformation);
+    tile->setPos(sceneRect.topLeft());
+    tile->setTransform(QTransform::fromScale(sceneRect.width() / image.width(),
+                                             sceneRect.height() / image.height()));
+    tile->setZValue(1);  // Over the preview, under measurements
+    m_detailTiles.insert(key, tile);
+}
+
+bool BlueprintView::hasDetailTile(int level, const QPoint& cell) const
+{
+    return level == m_detailLevel && m_detailTiles.contains(detailTileKey(level, cell));
+}
+
+QRectF BlueprintView::visibleSceneRect() const
+{
+    return mapToScene(viewport()->rect()).boundingRect() & sceneRect();
+}
+
+double BlueprintView::devicePixelsPerSceneUnit() const
+{
+    return std::abs(transform().m11()) * devicePixelRatioF();
+}
+
+void BlueprintView::startComparison(const QImage& other, CompareMode mode)
+{
+    endComparison();
+    if (!m_imageItem || other.isNull()) {
+        return;
+    }
+
+    m_compareMode = mode;
+    m_compareItem = m_scene->addPixmap(QPixmap::fromImage(other));
+    m_compareItem->setTransformationMode(Qt::SmoothTransformation);
+
+    const QRectF pageRect = m_imageItem->sceneBoundingRect();
+    if (mode == CompareMode::Overlay) {
+        m_compareItem->setOpacity(0.35);
+        m_compareItem->setZValue(1.5);  // Over the page and its tiles
+    } else {
+        // A small gutter keeps the sheet borders apart
+        m_compareItem->setPos(pageRect.width() * 1.02, 0.0);
+        m_compareItem->setZValue(0);
+        m_scene->setSceneRect(pageRect.united(m_compareItem->sceneBoundingRect()));
+    }
+}
+
+void BlueprintView::setComparisonTiles(const QVector<ImageDiff::Tile>& tiles)
+{
+    for (QGraphicsItem* item : m_compareTiles) {
+        m_scene->removeItem(item);
+        delete item;
+    }
+    m_compareTiles.clear();
+    if (!m_compareItem) {
+        return;
+    }
+
+    // Tiles are static pixmaps, so panning a compared sheet costs nothing
+    QVector<QPointF> origins = {QPointF(0.0, 0.0)};
+    if (m_compareMode == CompareMode::SideBySide) {
+        origins.append(m_compareItem->pos());
+    }
+    for (const ImageDiff::Tile& tile : tiles) {
+        const QPixmap pixmap = QPixmap::fromImage(tile.overlay);
+        for (const QPointF& origin : origins) {
+            QGraphicsPixmapItem* item = m_scene->addPixmap(pixmap);
+            item->setPos(origin + QPointF(tile.rect.topLeft()));
+            item->setZValue(2);  // Under measurements
+            m_compareTiles.append(item);
+        }
+    }
+}
+
+void BlueprintView::setFlaggedMeasurements(const QVector<int>& measurementIds)
+{
+    clearFlags();
+
+    QPen pen(FLAG_COLOR, 2, Qt::DashLine);
+    pen.setCosmetic(true);
+    for (int id : measurementIds) {
+        auto it = m_measurementGraphics.constFind(id);
+        if (it == m_measurementGraphics.constEnd() || it.value().isEmpty()) {
+            continue;
+        }
+        QRectF bounds;
+        for (QGraphicsItem* item : it.value()) {
+            bounds |= item->sceneBoundingRect();
+        }
+        QGraphicsRectItem* outline = m_scene->addRect(bounds.adjusted(-6, -6, 6, 6), pen);
+        outline->setZValue(52);
+        m_flagItems.insert(id, outline);
+    }
+}
+
+void BlueprintView::endComparison()
+{
+    clearFlags();
+    for (QGraphicsItem* item : m_compareTiles) {
+        m_scene->removeItem(item);
+        delete item;
+    }
+    m_compareTiles.clear();
+
+    if (m_compareItem) {
+        m_scene->removeItem(m_compareItem);
+        delete m_compareItem;
+        m_compareItem = nullptr;
+        if (m_imageItem) {
+            m_scene->setSceneRect(m_imageItem->sceneBoundingRect());
+        }
+    }
+}
+
+bool BlueprintView::isComparing() const
+{
+    return m_compareItem != nullptr;
+}
+
+void BlueprintView::clearFlags()
+{
+    for (QGraphicsItem* item : m_flagItems) {
+        m_scene->removeItem(item);
+        delete item;
+    }
+    m_flagItems.clear();
+}
+
+void BlueprintView::clearDetailTiles()
+{
+    for (QGraphicsPixmapItem* tile : m_detailTiles) {
+        m_scene->removeItem(tile);
+        delete tile;
+    }
+    m_detailTiles.clear();
+    m_detailLevel = -1;
+}
+
+void BlueprintView::scheduleDetailUpdate()
+{
+    if (m_showsPreview) {
+        m_detailTimer->start();
+    }
+}
+
+void BlueprintView::displayPixmap(const QPixmap& pixmap, const QSizeF& sceneSize)
 {
     // Clear existing content
     m_scene->clear();
+    m_compareItem = nullptr;
+    m_compareTiles.clear();
+    m_flagItems.clear();
+    m_detailTiles.clear();
+    m_detailLevel = -1;
+    m_showsPreview = false;
+    m_detailTimer->stop();
     m_measurementGraphics.clear();
-    m_tempLines.clear();
-    m_tempStartPoint = nullptr;
-    m_rubberBand = nullptr;
-    m_tempPoints.clear();
+    m_hasCursorPos = false;
+    clearTempPoints();
+    m_snapEngine.clear();
+    m_currentSnap = SnapEngine::Result();
+    m_searchHit = QRectF();
 
-    // Add the image
+    // Add the image, stretched over the page if it is a preview
     m_imageItem = m_scene->addPixmap(pixmap);
     m_imageItem->setZValue(0);  // Image at bottom
     m_imageItem->setTransformationMode(Qt::SmoothTransformation);  // High quality when zoomed
+    m_imageItem->setTransform(QTransform::fromScale(sceneSize.width() / pixmap.width(),
+                                                    sceneSize.height() / pixmap.height()));
 
     // Fit the view to the image
-    m_scene->setSceneRect(pixmap.rect());
+    m_scene->setSceneRect(QRectF(QPointF(0.0, 0.0), sceneSize));
     fitInView(m_imageItem, Qt::KeepAspectRatio);
 }
 
@@ -105,13 +375,21 @@ void BlueprintView::clearImage()
 {
     m_scene->clear();
     m_imageItem = nullptr;
+    m_compareItem = nullptr;
+    m_compareTiles.clear();
+    m_flagItems.clear();
+    m_detailTiles.clear();
+    m_detailLevel = -1;
+    m_showsPreview = false;
+    m_detailTimer->stop();
     m_measurementGraphics.clear();
-    m_tempLines.clear();
-    m_tempStartPoint = nullptr;
-    m_rubberBand = nullptr;
-    m_tempPoints.clear();
+    m_hasCursorPos = false;
+    clearTempPoints();
     m_calibration.reset();
     m_nextMeasurementId = 1;
+    m_snapEngine.clear();
+    m_currentSnap = SnapEngine::Result();
+    m_searchHit = QRectF();
 }
 
 void BlueprintView::setTool(Tool tool)
@@ -120,6 +398,9 @@ void BlueprintView::setTool(Tool tool)
         cancelCurrentTool();
     }
     m_currentTool = tool;
+    if (tool == Tool::None) {
+        updateSnapMarker(SnapEngine::Result());
+    }
     
     // Update cursor
     if (tool == Tool::None) {
@@ -151,7 +432,12 @@ void BlueprintView::setCalibration(const Calibration& calibration)
 
 void BlueprintView::addMeasurement(const Measurement& measurement)
 {
-    createMeasurementGraphics(measurement);
+    createMeasurementGraphics(measurement.id(), measurement.type(), measurement.points());
+}
+
+void BlueprintView::addMeasurement(int measurementId, MeasurementType type, PointSpan points)
+{
+    createMeasurementGraphics(measurementId, type, points);
 }
 
 void BlueprintView::removeMeasurement(int measurementId)
@@ -163,6 +449,11 @@ void BlueprintView::removeMeasurement(int measurementId)
             delete item;
         }
         m_measurementGraphics.remove(measurementId);
+        m_snapEngine.removeSegments(measurementId);
+        if (QGraphicsItem* flag = m_flagItems.take(measurementId)) {
+            m_scene->removeItem(flag);
+            delete flag;
+        }
         
         // Clear highlight if this was the highlighted measurement
         if (m_highlightedMeasurementId == measurementId) {
@@ -211,7 +502,9 @@ void BlueprintView::clearMeasurements()
         }
     }
     m_measurementGraphics.clear();
+    clearFlags();
     m_highlightedMeasurementId = -1;
+    m_snapEngine.clearOverlay();
 }
 
 void BlueprintView::setNextMeasurementId(int nextId)
@@ -219,6 +512,142 @@ void BlueprintView::setNextMeasurementId(int nextId)
     m_nextMeasurementId = nextId;
 }
 
+void BlueprintView::setSnapEnabled(bool enabled)
+{
+    m_snapEnabled = enabled;
+    if (!enabled) {
+        updateSnapMarker(SnapEngine::Result());
+    }
+}
+
+bool BlueprintView::isSnapEnabled() const
+{
+    return m_snapEnabled;
+}
+
+void BlueprintView::setSheetSegments(const QVector<QLineF>& segments)
+{
+    m_snapEngine.setSegments(segments);
+}
+
+void BlueprintView::showSearchHit(const QRectF& sceneRect)
+{
+    if (!m_imageItem || sceneRect.isNull()) {
+        return;
+    }
+    m_searchHit = sceneRect;
+
+    // Frame the word with enough of the drawing around it to read the
+    // callout in context
+    QRectF frame(0.0, 0.0, qMax(sceneRect.width() * 8.0, 600.0), qMax(sceneRect.height() * 8.0, 400.0));
+    frame.moveCenter(sceneRect.center());
+    fitInView(frame, Qt::KeepAspectRatio);
+    viewport()->update();
+    scheduleDetailUpdate();
+}
+
+void BlueprintView::setHudVisible(bool visible)
+{
+    if (visible == m_hudVisible) {
+        return;
+    }
+    m_hudVisible = visible;
+    if (visible) {
+        m_frameMs = 0.0;
+        refreshHud();
+        m_hudTimer->start();
+    } else {
+        m_hudTimer->stop();
+        viewport()->update(m_hudRect);
+        m_hudRect = QRect();
+    }
+}
+
+bool BlueprintView::isHudVisible() const
+{
+    return m_hudVisible;
+}
+
+void BlueprintView::setHudStats(const HudStats& stats)
+{
+    m_hudStats = stats;
+}
+
+QPointF BlueprintView::snapScenePos(const QPoint& viewPos)
+{
+    QPointF scenePos = mapToScene(viewPos);
+    if (!m_snapEnabled || m_currentTool == Tool::None) {
+        updateSnapMarker(SnapEngine::Result());
+        return scenePos;
+    }
+
+    // Tolerance is fixed in screen pixels, so convert it to scene units
+    double tolerance = SNAP_TOLERANCE_PX / std::abs(transform().m11());
+    SnapEngine::Result snap = m_snapEngine.snap(scenePos, tolerance);
+    updateSnapMarker(snap);
+    return snap.isValid() ? snap.point : scenePos;
+}
+
+QRect BlueprintView::snapMarkerRect(const QPointF& scenePos) const
+{
+    const int half = static_cast<int>(SNAP_TOLERANCE_PX);
+    QPoint center = mapFromScene(scenePos);
+    return QRect(center.x() - half, center.y() - half, half * 2 + 1, half * 2 + 1);
+}
+
+void BlueprintView::updateSnapMarker(const SnapEngine::Result& snap)
+{
+    if (snap.kind == m_currentSnap.kind && snap.point == m_currentSnap.point) {
+        return;
+    }
+
+    // Repaint only the old and new marker areas
+    if (m_currentSnap.isValid()) {
+        viewport()->update(snapMarkerRect(m_currentSnap.point));
+    }
+    if (snap.isValid()) {
+        viewport()->update(snapMarkerRect(snap.point));
+    }
+    m_currentSnap = snap;
+}
+
+void BlueprintView::paintEvent(QPaintEvent* event)
+{
+    TAKEOFF_TRACE_SCOPE("BlueprintView::paintEvent");
+    QElapsedTimer frame;
+    frame.start();
+    QGraphicsView::paintEvent(event);
+
+    // Repaints of the HUD alone would drag the average down
+    if (m_hudVisible && !m_hudRect.contains(event->rect())) {
+        const double ms = frame.nsecsElapsed() / 1.0e6;
+        m_frameMs = m_frameMs > 0.0 ? m_frameMs * 0.9 + ms * 0.1 : ms;
+    }
+}
+
+void BlueprintView::drawForeground(QPainter* painter, const QRectF& rect)
+{
+    TAKEOFF_TRACE_SCOPE("BlueprintView::drawForeground");
+    Q_UNUSED(rect);
+    if (m_tempPoints.isEmpty() && !m_currentSnap.isValid() && m_searchHit.isNull() && !m_hudVisible) {
+        return;
+    }
+
+    // In-progress tool state lives outside the scene so cursor tracking
+    // never touches the scene index. It is drawn in device pixels so it
+    // keeps its size at any zoom.
+    painter->save();
+    painter->resetTransform();
+    painter->setRenderHint(QPainter::Antialiasing);
+    drawSearchHit(painter);
+    drawToolOverlay(painter);
+    drawSnapMarker(painter);
+    if (m_hudVisible) {
+        drawHud(painter);
+    }
+    painter->restore();
+}
+
 void BlueprintView::wheelEvent(QWheelEvent* event)
 {
     // Zoom in/out with mouse wheel
@@ -229,6 +658,7 @@ void BlueprintView::wheelEvent(QWheelEvent* event)
     } else {
         scale(1.0 / zoomFactor, 1.0 / zoomFactor);
     }
+    scheduleDetailUpdate();
     
     event->accept();
 }
@@ -246,23 +676,16 @@ void BlueprintView::mousePressEvent(QMouseEvent* event)
     }
 
     if (event->button() == Qt::LeftButton && m_currentTool != Tool::None) {
-        QPointF scenePos = mapToScene(event->pos());
+        QPointF scenePos = snapScenePos(event->pos());
         
-        // Add point to temporary points
+        // Add point to temporary points, keeping the committed length current
+        if (!m_tempPoints.isEmpty()) {
+            m_committedLengthPx += MathUtils::distance(m_tempPoints.last(), scenePos);
+        }
         m_tempPoints.append(scenePos);
 
-        // Create visual point marker
-        if (m_tempPoints.size() == 1) {
-            // First point - create start marker
-            const double pointRadius = 4.0;
-            m_tempStartPoint = m_scene->addEllipse(
-                scenePos.x() - pointRadius, scenePos.y() - pointRadius,
-                pointRadius * 2, pointRadius * 2,
-                QPen(TEMP_COLOR, 2),
-                QBrush(POINT_COLOR)
-            );
-            m_tempStartPoint->setZValue(100);
-        }
+        // Repaint the overlay with the new point and segment
+        viewport()->update();
 
         // For line tool, check if we have 2 points
         if (m_currentTool == Tool::Line && m_tempPoints.size() == 2) {
@@ -272,17 +695,9 @@ void BlueprintView::mousePressEvent(QMouseEvent* event)
         else if (m_currentTool == Tool::Calibrate && m_tempPoints.size() == 2) {
             finishCalibration();
         }
-        // For polyline, add line segment
-        else if (m_currentTool == Tool::Polyline && m_tempPoints.size() >= 2) {
-            // Add a permanent temp line for this segment
-            QPointF p1 = m_tempPoints[m_tempPoints.size() - 2];
-            QPointF p2 = m_tempPoints[m_tempPoints.size() - 1];
-            QGraphicsLineItem* line = m_scene->addLine(
-                p1.x(), p1.y(), p2.x(), p2.y(),
-                QPen(TEMP_COLOR, 2)
-            );
-            line->setZValue(99);
-            m_tempLines.append(line);
+        // For count, the two points are opposite corners of the symbol box
+        else if (m_currentTool == Tool::Count && m_tempPoints.size() == 2) {
+            finishCountSelection();
         }
 
         event->accept();
@@ -306,18 +721,22 @@ void BlueprintView::mouseMoveEvent(QMouseEvent* event)
         return;
     }
 
+    // Track the snap target even before the first click
+    QPointF scenePos = snapScenePos(event->pos());
+
     // Update rubber band line if we have at least one point
     if (m_currentTool != Tool::None && !m_tempPoints.isEmpty()) {
-        QPointF scenePos = mapToScene(event->pos());
         updateTempDrawing(scenePos);
         
-        // Emit live measurement
-        double lengthPixels = calculateCurrentLength();
-        if (m_tempPoints.size() >= 1) {
-            lengthPixels += MathUtils::distance(m_tempPoints.last(), scenePos);
+        // Only the segment under the cursor changes between events. A count
+        // selection box has no length.
+        if (m_currentTool != Tool::Count) {
+            double lengthPixels = m_committedLengthPx + MathUtils::distance(m_tempPoints.last(), scenePos);
+            m_pendingLiveInches = lengthPixels / m_calibration.pixelsPerInch();
+            if (!m_liveMeasurementTimer->isActive()) {
+                m_liveMeasurementTimer->start();
+            }
         }
-        double lengthInches = lengthPixels / m_calibration.pixelsPerInch();
-        emit liveMeasurementChanged(lengthInches);
     }
 
     QGraphicsView::mouseMoveEvent(event);
@@ -352,6 +771,10 @@ void BlueprintView::mouseDoubleClickEvent(QMouseEvent* event)
 void BlueprintView::keyPressEvent(QKeyEvent* event)
 {
     if (event->key() == Qt::Key_Escape) {
+        if (!m_searchHit.isNull()) {
+            m_searchHit = QRectF();
+            viewport()->update();
+        }
         cancelCurrentTool();
         emit toolCancelled();
         event->accept();
@@ -364,8 +787,8 @@ void BlueprintView::keyPressEvent(QKeyEvent* event)
 void BlueprintView::cancelCurrentTool()
 {
     clearTempDrawing();
-    m_tempPoints.clear();
-    emit liveMeasurementChanged(0.0);
+    clearTempPoints();
+    resetLiveMeasurement();
 }
 
 void BlueprintView::updateTempDrawing(const QPointF& currentPos)
@@ -374,43 +797,181 @@ void BlueprintView::updateTempDrawing(const QPointF& currentPos)
         return;
     }
 
-    // Update or create rubber band line from last point to mouse
-    QPointF lastPoint = m_tempPoints.last();
-    
-    if (!m_rubberBand) {
-        m_rubberBand = m_scene->addLine(
-            lastPoint.x(), lastPoint.y(),
-            currentPos.x(), currentPos.y(),
-            QPen(TEMP_COLOR, 2, Qt::DashLine)
-        );
-        m_rubberBand->setZValue(100);
-    } else {
-        m_rubberBand->setLine(lastPoint.x(), lastPoint.y(), currentPos.x(), currentPos.y());
-    }
+    // Only the rubber band moves, so repaint its old and new extents
+    QRect before = rubberBandRect();
+    m_cursorScenePos = currentPos;
+    m_hasCursorPos = true;
+    viewport()->update(before);
+    viewport()->update(rubberBandRect());
 }
 
 void BlueprintView::clearTempDrawing()
 {
-    // Remove rubber band
-    if (m_rubberBand) {
-        m_scene->removeItem(m_rubberBand);
-        delete m_rubberBand;
-        m_rubberBand = nullptr;
+    m_hasCursorPos = false;
+    viewport()->update();
+}
+
+QRect BlueprintView::rubberBandRect() const
+{
+    if (m_tempPoints.isEmpty() || !m_hasCursorPos) {
+        return QRect();
     }
+    const QTransform t = viewportTransform();
+    QRectF band = QRectF(t.map(m_tempPoints.last()), t.map(m_cursorScenePos)).normalized();
+    // Pad for pen width, antialiasing and the start marker
+    return band.toAlignedRect().adjusted(-6, -6, 6, 6);
+}
 
-    // Remove start point marker
-    if (m_tempStartPoint) {
-        m_scene->removeItem(m_tempStartPoint);
-        delete m_tempStartPoint;
-        m_tempStartPoint = nullptr;
+void BlueprintView::drawToolOverlay(QPainter* painter) const
+{
+    if (m_tempPoints.isEmpty()) {
+        return;
     }
 
-    // Remove temp lines
-    for (QGraphicsLineItem* line : m_tempLines) {
-        m_scene->removeItem(line);
-        delete line;
+    const QTransform t = viewportTransform();
+    QPen pen(TEMP_COLOR, 2);
+    pen.setCosmetic(true);
+
+    // Count selection box from the first corner to the cursor
+    if (m_currentTool == Tool::Count) {
+        if (m_hasCursorPos) {
+            QPen dashed = pen;
+            dashed.setStyle(Qt::DashLine);
+            painter->setPen(dashed);
+            painter->setBrush(Qt::NoBrush);
+            painter->drawRect(QRectF(t.map(m_tempPoints.first()), t.map(m_cursorScenePos)).normalized());
+        }
+        return;
+    }
+
+    // Committed segments
+    if (m_tempPoints.size() >= 2) {
+        QPolygonF committed;
+        committed.reserve(m_tempPoints.size());
+        for (const QPointF& pt : m_tempPoints) {
+            committed.append(t.map(pt));
+        }
+        painter->setPen(pen);
+        painter->drawPolyline(committed);
+    }
+
+    // Rubber band from the last point to the cursor
+    if (m_hasCursorPos) {
+        QPen dashed = pen;
+        dashed.setStyle(Qt::DashLine);
+        painter->setPen(dashed);
+        painter->drawLine(t.map(m_tempPoints.last()), t.map(m_cursorScenePos));
+    }
+
+    // Start point marker
+    const double pointRadius = 4.0;
+    painter->setPen(pen);
+    painter->setBrush(POINT_COLOR);
+    painter->drawEllipse(t.map(m_tempPoints.first()), pointRadius, pointRadius);
+}
+
+void BlueprintView::drawSearchHit(QPainter* painter) const
+{
+    if (m_searchHit.isNull()) {
+        return;
+    }
+
+    QRectF r = viewportTransform().mapRect(m_searchHit).adjusted(-3, -3, 3, 3);
+    QColor fill = SEARCH_HIT_COLOR;
+    fill.setAlpha(80);
+    QPen pen(SEARCH_HIT_COLOR, 2);
+    pen.setCosmetic(true);
+    painter->setPen(pen);
+    painter->setBrush(fill);
+    painter->drawRect(r);
+}
+
+void BlueprintView::drawSnapMarker(QPainter* painter) const
+{
+    if (!m_currentSnap.isValid()) {
+        return;
+    }
+
+    QPen pen(SNAP_COLOR, 2);
+    pen.setCosmetic(true);
+    painter->setPen(pen);
+    painter->setBrush(Qt::NoBrush);
+
+    QPoint c = mapFromScene(m_currentSnap.point);
+    const int r = 6;
+    switch (m_currentSnap.kind) {
+    case SnapEngine::Kind::Endpoint:
+        painter->drawRect(c.x() - r, c.y() - r, r * 2, r * 2);
+        break;
+    case SnapEngine::Kind::Midpoint: {
+        QPolygon triangle;
+        triangle << QPoint(c.x(), c.y() - r) << QPoint(c.x() + r, c.y() + r) << QPoint(c.x() - r, c.y() + r);
+        painter->drawPolygon(triangle);
+        break;
+    }
+    case SnapEngine::Kind::Intersection:
+        painter->drawLine(c.x() - r, c.y() - r, c.x() + r, c.y() + r);
+        painter->drawLine(c.x() - r, c.y() + r, c.x() + r, c.y() - r);
+        break;
+    case SnapEngine::Kind::None:
+        break;
+    }
+}
+
+void BlueprintView::refreshHud()
+{
+    emit hudRefreshRequested();
+
+    m_hudItemCount = m_scene->items().size();
+    m_hudVisibleTiles = 0;
+    const QRectF visible = visibleSceneRect();
+    for (const QGraphicsPixmapItem* tile : m_detailTiles) {
+        if (tile->sceneBoundingRect().intersects(visible)) {
+            ++m_hudVisibleTiles;
+        }
+    }
+    viewport()->update(m_hudRect.isNull() ? viewport()->rect() : m_hudRect);
+}
+
+void BlueprintView::drawHud(QPainter* painter)
+{
+    const QString hitRate = m_hudStats.tileLookups > 0
+        ? QString("%1%").arg(100.0 * m_hudStats.tileHits / m_hudStats.tileLookups, 0, 'f', 1)
+        : QString("-");
+    const QStringList lines = {
+        QString("Frame    %1 ms").arg(m_frameMs, 0, 'f', 2),
+        QString("Items    %1").arg(m_hudItemCount),
+        QString("Tiles    %1 visible").arg(m_hudVisibleTiles),
+        QString("Cache    %1 hits").arg(hitRate),
+        QString("Render   %1 tiles pending").arg(m_hudStats.pendingTiles),
+        QString("Threads  %1 / %2 busy").arg(m_hudStats.busyThreads).arg(m_hudStats.maxThreads),
+        QString("Database %1 batches queued").arg(m_hudStats.migrationBatches)
+    };
+
+    QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    painter->setFont(font);
+    const QFontMetrics metrics(font);
+    int textWidth = 0;
+    for (const QString& line : lines) {
+        textWidth = std::max(textWidth, metrics.horizontalAdvance(line));
+    }
+
+    const int margin = 8;
+    const int padding = 6;
+    m_hudRect = QRect(margin, margin, textWidth + padding * 2,
+                      metrics.lineSpacing() * lines.size() + padding * 2);
+
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(QColor(0, 0, 0, 170));
+    painter->drawRect(m_hudRect);
+
+    painter->setPen(Qt::white);
+    int y = m_hudRect.top() + padding + metrics.ascent();
+    for (const QString& line : lines) {
+        painter->drawText(m_hudRect.left() + padding, y, line);
+        y += metrics.lineSpacing();
     }
-    m_tempLines.clear();
 }
 
 void BlueprintView::finishCalibration()
@@ -439,7 +1000,7 @@ void BlueprintView::finishCalibration()
 
     // Clean up
     clearTempDrawing();
-    m_tempPoints.clear();
+    clearTempPoints();
     setTool(Tool::None);
 }
 
@@ -456,10 +1017,10 @@ void BlueprintView::finishLineMeasurement()
     
     // Clean up temp drawing (MainWindow will create permanent graphics)
     clearTempDrawing();
-    m_tempPoints.clear();
+    clearTempPoints();
 
     emit measurementCompleted(measurement);
-    emit liveMeasurementChanged(0.0);
+    resetLiveMeasurement();
 }
 
 void BlueprintView::finishPolylineMeasurement()
@@ -475,22 +1036,38 @@ void BlueprintView::finishPolylineMeasurement()
     
     // Clean up temp drawing (MainWindow will create permanent graphics)
     clearTempDrawing();
-    m_tempPoints.clear();
+    clearTempPoints();
 
     emit measurementCompleted(measurement);
-    emit liveMeasurementChanged(0.0);
+    resetLiveMeasurement();
+}
+
+void BlueprintView::finishCountSelection()
+{
+    if (m_tempPoints.size() != 2) {
+        return;
+    }
+
+    QRectF rect = QRectF(m_tempPoints[0], m_tempPoints[1]).normalized();
+
+    clearTempDrawing();
+    clearTempPoints();
+
+    emit countTemplateSelected(rect);
 }
 
-void BlueprintView::createMeasurementGraphics(const Measurement& measurement)
+void BlueprintView::createMeasurementGraphics(int measurementId, MeasurementType type, PointSpan points)
 {
     QVector<QGraphicsItem*> items;
-    const QVector<QPointF>& points = measurement.points();
     
+    // Counted symbols are unconnected points, marked larger so they stand
+    // out over the symbols themselves
+    const bool isCount = type == MeasurementType::Count;
     QPen linePen(MEASUREMENT_COLOR, 2);
-    const double pointRadius = 3.0;
+    const double pointRadius = isCount ? 8.0 : 3.0;
 
     // Draw lines between points
-    for (int i = 1; i < points.size(); ++i) {
+    for (int i = 1; i < points.size && !isCount; ++i) {
         QGraphicsLineItem* line = m_scene->addLine(
             points[i-1].x(), points[i-1].y(),
             points[i].x(), points[i].y(),
@@ -512,10 +1089,58 @@ void BlueprintView::createMeasurementGraphics(const Measurement& measurement)
         items.append(ellipse);
     }
 
-    m_measurementGraphics[measurement.id()] = items;
+    m_measurementGraphics[measurementId] = items;
+
+    QVector<QLineF> segments;
+    for (int i = 1; i < points.size && !isCount; ++i) {
+        segments.append(QLineF(points[i - 1], points[i]));
+    }
+    m_snapEngine.addSegments(measurementId, segments);
+}
+
+void BlueprintView::clearTempPoints()
+{
+    m_tempPoints.clear();
+    m_committedLengthPx = 0.0;
+}
+
+void BlueprintView::resetLiveMeasurement()
+{
+    // Drop any pending coalesced value so it cannot overwrite the reset
+    m_liveMeasurementTimer->stop();
+    emit liveMeasurementChanged(0.0);
+}
+
+void BlueprintView::updateLiveMeasurementInterval()
+{
+    double refreshRate = screen() ? screen()->refreshRate() : 60.0;
+    if (refreshRate <= 0.0) {
+        refreshRate = 60.0;
+    }
+    m_liveMeasurementTimer->setInterval(qMax(1, qRound(1000.0 / refreshRate)));
+}
+
+void BlueprintView::showEvent(QShowEvent* event)
+{
+    // The window may have moved to a screen with a different refresh rate
+    updateLiveMeasurementInterval();
+    QGraphicsView::showEvent(event);
 }
 
-double BlueprintView::calculateCurrentLength() const
+void BlueprintView::resizeEvent(QResizeEvent* event)
 {
-    return MathUtils::polylineLength(m_tempPoints);
+    QGraphicsView::resizeEvent(event);
+    scheduleDetailUpdate();
+}
+
+void BlueprintView::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+    scheduleDetailUpdate();
+
+    // The HUD is pinned to the viewport, so the scrolled copy must go
+    if (m_hudVisible) {
+        viewport()->update(m_hudRect.translated(dx, dy));
+        viewport()->update(m_hudRect);
+    }
 }
@@ -9,10 +9,17 @@
 #include <QVector>
 #include <QPointF>
 #include <QMap>
+#include <QHash>
 #include <QImage>
+#include <QLineF>
 
 #include "Measurement.h"
 #include "Calibration.h"
+#include "SnapEngine.h"
+#include "GeometryArena.h"
+#include "ImageDiff.h"
+
+class QTimer;
 
 /**
  * @brief Active tool mode for the blueprint view.
@@ -22,7 +29,17 @@ enum class Tool
     None,       // No tool active, pan mode
     Calibrate,  // Calibration mode
     Line,       // Line measurement tool
-    Polyline    // Polyline measurement tool
+    Polyline,   // Polyline measurement tool
+    Count       // Box a symbol to count its copies
+};
+
+/**
+ * @brief How another revision of a page is shown for comparison.
+ */
+enum class CompareMode
+{
+    Overlay,    // Drawn translucently over the page
+    SideBySide  // Placed to the right of the page
 };
 
 /**
@@ -55,6 +72,74 @@ public:
      */
     bool loadFromImage(const QImage& image);
 
+    /**
+     * @brief Display a low-resolution preview stretched over the page.
+     * @param preview Quickly rendered image of the whole page
+     * @param sceneSize Page size in scene coordinates
+     * @return true if loaded successfully
+     *
+     * Tools work on the preview right away. While it is shown,
+     * detailRequested() asks for sharper tiles of the visible area, which
+     * are added with setDetailTile().
+     */
+    bool loadPreview(const QImage& preview, const QSizeF& sceneSize);
+
+    /**
+     * @brief Place a sharper tile of the page over the preview.
+     * @param level Resolution level the tile was rendered at
+     * @param cell Column and row of the tile in that level's grid
+     * @param sceneRect Area of the page the tile covers
+     * @param image Tile image
+     *
+     * The first tile of a new level replaces all tiles of other levels, so
+     * only one level is held at a time.
+     */
+    void setDetailTile(int level, const QPoint& cell, const QRectF& sceneRect, const QImage& image);
+
+    /**
+     * @brief Check if a tile is already displayed.
+     */
+    bool hasDetailTile(int level, const QPoint& cell) const;
+
+    /**
+     * @brief Show another revision of the page for comparison.
+     * @param other Raster of the other revision at the page's scene scale
+     * @param mode Where the other revision is drawn
+     *
+     * Tools keep working on the page itself. The comparison ends when
+     * another image is loaded or endComparison() is called.
+     */
+    void startComparison(const QImage& other, CompareMode mode);
+
+    /**
+     * @brief Mark changed pixels over the page, and over the other
+     * revision when shown side by side.
+     * @param tiles Changed tiles in scene coordinates
+     */
+    void setComparisonTiles(const QVector<ImageDiff::Tile>& tiles);
+
+    /**
+     * @brief Outline measurements that touch changed areas.
+     */
+    void setFlaggedMeasurements(const QVector<int>& measurementIds);
+
+    /**
+     * @brief Remove the other revision, change marks and flags.
+     */
+    void endComparison();
+
+    bool isComparing() const;
+
+    /**
+     * @brief Get the part of the page currently visible.
+     */
+    QRectF visibleSceneRect() const;
+
+    /**
+     * @brief Get the number of screen pixels one scene unit covers at the current zoom.
+     */
+    double devicePixelsPerSceneUnit() const;
+
     /**
      * @brief Check if an image is currently loaded.
      * @return true if an image is displayed
@@ -102,6 +187,12 @@ public:
      */
     void addMeasurement(const Measurement& measurement);
 
+    /**
+     * @brief Add a completed measurement straight from stored geometry.
+     * @param points Read only during the call; nothing keeps the span
+     */
+    void addMeasurement(int measurementId, MeasurementType type, PointSpan points);
+
     /**
      * @brief Remove a measurement from display.
      * @param measurementId ID of measurement to remove
@@ -125,6 +216,57 @@ public:
      */
     void setNextMeasurementId(int nextId);
 
+    /**
+     * @brief Enable or disable snapping of tool clicks to nearby geometry.
+     */
+    void setSnapEnabled(bool enabled);
+    bool isSnapEnabled() const;
+
+    /**
+     * @brief Set the line segments found in the current sheet's content.
+     * @param segments Segments in scene coordinates
+     *
+     * The sheet grid is built here, once per page; measurements shown on
+     * the sheet are added to and removed from the snap overlay as they
+     * change. Cleared when a new image is loaded.
+     */
+    void setSheetSegments(const QVector<QLineF>& segments);
+
+    /**
+     * @brief Zoom to a search hit and highlight it.
+     * @param sceneRect Bounds of the hit in scene coordinates
+     *
+     * The highlight stays until Escape is pressed or another image is loaded.
+     */
+    void showSearchHit(const QRectF& sceneRect);
+
+    /**
+     * @brief Counters shown in the performance HUD that the view does not
+     * track itself.
+     */
+    struct HudStats {
+        int pendingTiles = 0;            // Detail tiles queued or rendering
+        qint64 tileLookups = 0;          // Visible tiles checked for a sharper version
+        qint64 tileHits = 0;             // ... that were already displayed
+        int busyThreads = 0;             // Global thread pool threads at work
+        int maxThreads = 0;
+        int migrationBatches = 0;        // Deferred schema migration batches left
+    };
+
+    /**
+     * @brief Show or hide the performance HUD in the top-left corner.
+     *
+     * While shown, the HUD is refreshed a few times per second and
+     * hudRefreshRequested() is emitted before each refresh.
+     */
+    void setHudVisible(bool visible);
+    bool isHudVisible() const;
+
+    /**
+     * @brief Update the externally tracked HUD counters.
+     */
+    void setHudStats(const HudStats& stats);
+
 signals:
     /**
      * @brief Emitted when calibration is completed.
@@ -138,6 +280,12 @@ signals:
      */
     void measurementCompleted(const Measurement& measurement);
 
+    /**
+     * @brief Emitted when a symbol has been boxed with the Count tool.
+     * @param sceneRect The boxed area in scene coordinates
+     */
+    void countTemplateSelected(const QRectF& sceneRect);
+
     /**
      * @brief Emitted when live measurement value changes during drawing.
      * @param inches Current measured distance in inches
@@ -149,6 +297,18 @@ signals:
      */
     void toolCancelled();
 
+    /**
+     * @brief Emitted shortly after the zoom or visible area changes while a
+     * preview is shown.
+     */
+    void detailRequested();
+
+    /**
+     * @brief Emitted before the performance HUD is refreshed, so counters
+     * kept elsewhere can be passed in with setHudStats().
+     */
+    void hudRefreshRequested();
+
 protected:
     void wheelEvent(QWheelEvent* event) override;
     void mousePressEvent(QMouseEvent* event) override;
@@ -156,34 +316,68 @@ protected:
     void mouseReleaseEvent(QMouseEvent* event) override;
     void mouseDoubleClickEvent(QMouseEvent* event) override;
     void keyPressEvent(QKeyEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void drawForeground(QPainter* painter, const QRectF& rect) override;
+    void showEvent(QShowEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void scrollContentsBy(int dx, int dy) override;
 
 private:
     void setupScene();
     void cancelCurrentTool();
     void updateTempDrawing(const QPointF& currentPos);
     void clearTempDrawing();
+    QRect rubberBandRect() const;
+    void drawToolOverlay(QPainter* painter) const;
+    void drawSnapMarker(QPainter* painter) const;
+    void drawSearchHit(QPainter* painter) const;
     void finishCalibration();
     void finishLineMeasurement();
     void finishPolylineMeasurement();
-    void createMeasurementGraphics(const Measurement& measurement);
-    double calculateCurrentLength() const;
-    void displayPixmap(const QPixmap& pixmap);
+    void finishCountSelection();
+    void createMeasurementGraphics(int measurementId, MeasurementType type, PointSpan points);
+    void clearTempPoints();
+    void resetLiveMeasurement();
+    void updateLiveMeasurementInterval();
+    void displayPixmap(const QPixmap& pixmap, const QSizeF& sceneSize);
+    void clearDetailTiles();
+    void clearFlags();
+    void scheduleDetailUpdate();
+    QPointF snapScenePos(const QPoint& viewPos);
+    void updateSnapMarker(const SnapEngine::Result& snap);
+    QRect snapMarkerRect(const QPointF& scenePos) const;
+    void refreshHud();
+    void drawHud(QPainter* painter);
 
     // Scene and image
     QGraphicsScene* m_scene;
     QGraphicsPixmapItem* m_imageItem;
 
+    // Sharper tiles over a preview, keyed by level and cell. Requests are
+    // debounced so a zoom gesture asks for one level, not every step.
+    bool m_showsPreview;
+    int m_detailLevel;
+    QHash<quint64, QGraphicsPixmapItem*> m_detailTiles;
+    QTimer* m_detailTimer;
+
     // Tool state
     Tool m_currentTool;
     QVector<QPointF> m_tempPoints;
     
+    // Length of the committed temp segments, updated as points are added
+    double m_committedLengthPx;
+
+    // Latest live length, emitted when the coalescing timer fires
+    double m_pendingLiveInches;
+    QTimer* m_liveMeasurementTimer;
+
     // Calibration
     Calibration m_calibration;
 
-    // Temporary drawing items (during tool use)
-    QVector<QGraphicsLineItem*> m_tempLines;
-    QGraphicsEllipseItem* m_tempStartPoint;
-    QGraphicsLineItem* m_rubberBand;
+    // Cursor position for the rubber band. Temp drawing is painted in
+    // drawForeground() rather than added to the scene.
+    QPointF m_cursorScenePos;
+    bool m_hasCursorPos;
 
     // Permanent measurement graphics
     // Map from measurement ID to list of graphics items
@@ -197,11 +391,44 @@ private:
     // Measurement ID counter
     int m_nextMeasurementId;
 
+    // Comparison with another revision: the other raster and change marks,
+    // plus outlines of flagged measurements keyed by measurement ID
+    CompareMode m_compareMode;
+    QGraphicsPixmapItem* m_compareItem;
+    QVector<QGraphicsItem*> m_compareTiles;
+    QMap<int, QGraphicsItem*> m_flagItems;
+
+    // Snapping. The index is rebuilt lazily on the next query after the
+    // sheet or measurement geometry changes.
+    SnapEngine m_snapEngine;
+    bool m_snapEnabled;
+    SnapEngine::Result m_currentSnap;
+
+    // Highlighted text search hit, null if none
+    QRectF m_searchHit;
+
+    // Performance HUD. Frame time is smoothed over recent paints; scene
+    // and tile counts are sampled on the refresh timer, not per frame.
+    bool m_hudVisible;
+    QTimer* m_hudTimer;
+    HudStats m_hudStats;
+    double m_frameMs;
+    int m_hudItemCount;
+    int m_hudVisibleTiles;
+    QRect m_hudRect;
+
     // Colors
     static const QColor TEMP_COLOR;
     static const QColor MEASUREMENT_COLOR;
     static const QColor HIGHLIGHT_COLOR;
     static const QColor POINT_COLOR;
+    static const QColor SNAP_COLOR;
+    static const QColor SEARCH_HIT_COLOR;
+    static const QColor FLAG_COLOR;
+    static const double SNAP_TOLERANCE_PX;
+    static const int DETAIL_DELAY_MS;
+    static const int MAX_DETAIL_TILES;
+    static const int HUD_INTERVAL_MS;
 };
 
 #endif // BLUEPRINTVIEW_H
@@ -2,6 +2,15 @@
 #include "UndoCommands.h"
 #include "PdfImportDialog.h"
 #include "ShapePickerDialog.h"
+#include "LineDetector.h"
+#include "TemplateMatcher.h"
+#include "ParallelFor.h"
+#include "PdfImporter.h"
+#include "PdfDocumentPool.h"
+#include "Trace.h"
+#include "ImageDiff.h"
+#include "RasterOps.h"
+#include "MathUtils.h"
 
 #include <QMenuBar>
 #include <QMenu>
@@ -10,6 +19,125 @@
 #include <QLabel>
 #include <QFileInfo>
 #include <QVBoxLayout>
+#include <QThreadPool>
+#include <QProgressDialog>
+#include <QPointer>
+#include <QPushButton>
+#include <QInputDialog>
+#include <QSignalBlocker>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// PDF pages open with a whole-page preview at PREVIEW_DPI, which takes a
+// fraction of a full render. Zoomed-in areas are then refined with tiles
+// from the lowest ladder level at least as sharp as the screen.
+const double PREVIEW_DPI = 36.0;
+const double DETAIL_DPIS[] = {75.0, 150.0, 300.0, 600.0};
+const int DETAIL_LEVEL_COUNT = sizeof(DETAIL_DPIS) / sizeof(DETAIL_DPIS[0]);
+const int DETAIL_TILE_SIZE = 512;
+
+// Page pairs whose comparison results are kept, and the margin in scene
+// units within which an item counts as touching a change
+const int MAX_CACHED_COMPARISONS = 4;
+const double CHANGE_MARGIN = 4.0;
+
+// Symbol sizes tried when counting, relative to the boxed symbol, so copies
+// drawn slightly larger or smaller on other sheets are still found
+const QVector<double> COUNT_SCALES = {0.8, 0.9, 1.0, 1.1, 1.25};
+
+// Rows rewritten per deferred migration step; small batches keep each
+// event loop iteration short
+const int MIGRATION_BATCH_SIZE = 500;
+
+TakeoffItem::Kind takeoffKindFor(MeasurementType type)
+{
+    switch (type) {
+        case MeasurementType::Polyline: return TakeoffItem::Polyline;
+        case MeasurementType::Count: return TakeoffItem::Count;
+        default: return TakeoffItem::Line;
+    }
+}
+
+MeasurementType measurementTypeFor(TakeoffItem::Kind kind)
+{
+    switch (kind) {
+        case TakeoffItem::Polyline: return MeasurementType::Polyline;
+        case TakeoffItem::Count: return MeasurementType::Count;
+        default: return MeasurementType::Line;
+    }
+}
+
+// Takeoff items are still shown through the Measurement display types
+Measurement displayMeasurement(const TakeoffItem& item)
+{
+    Measurement m;
+    m.setId(item.id());
+    m.setPageId(item.pageId());
+    m.setType(measurementTypeFor(item.kind()));
+    m.setPoints(item.points());
+    m.setLengthInches(item.lengthInches());
+    m.setSize(item.designation());
+    return m;
+}
+
+// True if an item's points (count) or segments (lines) touch the rectangle
+bool itemTouches(const TakeoffItemView& item, const QRectF& rect)
+{
+    const PointSpan points = item.points();
+    const QRectF bounds = MathUtils::boundingRect(points);
+    if (points.isEmpty() || bounds.left() > rect.right() || bounds.right() < rect.left() ||
+        bounds.top() > rect.bottom() || bounds.bottom() < rect.top()) {
+        return false;
+    }
+    for (const QPointF& point : points) {
+        if (rect.contains(point)) {
+            return true;
+        }
+    }
+    if (item.kind() == TakeoffItem::Count) {
+        return false;
+    }
+
+    // A segment passing through the circle inscribed in the rectangle
+    const double radius = std::min(rect.width(), rect.height()) / 2.0;
+    if (MathUtils::distanceToPolyline(rect.center(), points) <= radius) {
+        return true;
+    }
+
+    const QLineF edges[] = {
+        QLineF(rect.topLeft(), rect.topRight()),
+        QLineF(rect.topRight(), rect.bottomRight()),
+        QLineF(rect.bottomRight(), rect.bottomLeft()),
+        QLineF(rect.bottomLeft(), rect.topLeft())
+    };
+    for (int i = 1; i < points.size; ++i) {
+        const QLineF segment(points[i - 1], points[i]);
+        for (const QLineF& edge : edges) {
+            if (segment.intersects(edge, nullptr) == QLineF::BoundedIntersection) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Loads the raster a page is measured on: the image file, or the PDF page
+// rendered at the default resolution. Safe to call from worker threads.
+QImage loadPageRaster(const Page& page)
+{
+    if (page.type() == Page::Image) {
+        return QImage(page.sourcePath());
+    }
+    PdfDocumentPool::Lease document = PdfDocumentPool::instance().acquire(page.sourcePath());
+    if (!document.isValid()) {
+        return QImage();
+    }
+    return document->renderPage(page.pdfPageIndex());
+}
+
+} // namespace
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
@@ -18,6 +146,7 @@ MainWindow::MainWindow(QWidget* parent)
     , m_itemsPanel(nullptr)
     , m_propertiesDock(nullptr)
     , m_quoteDock(nullptr)
+    , m_searchPanel(nullptr)
     , m_mainSplitter(nullptr)
     , m_leftSplitter(nullptr)
     , m_toolBar(nullptr)
@@ -31,16 +160,29 @@ MainWindow::MainWindow(QWidget* parent)
     , m_redoAction(nullptr)
     , m_deleteAction(nullptr)
     , m_deletePageAction(nullptr)
+    , m_findTextAction(nullptr)
+    , m_compareAction(nullptr)
+    , m_hudAction(nullptr)
+    , m_recordTraceAction(nullptr)
+    , m_saveTraceAction(nullptr)
     , m_noneToolAction(nullptr)
     , m_calibrateAction(nullptr)
     , m_lineAction(nullptr)
     , m_polylineAction(nullptr)
+    , m_countAction(nullptr)
     , m_toolGroup(nullptr)
+    , m_snapAction(nullptr)
     , m_undoStack(nullptr)
+    , m_migrationTimer(nullptr)
+    , m_detailTileLookups(0)
+    , m_detailTileHits(0)
     , m_currentPageId()
     , m_selectedItemId(-1)
 {
     m_undoStack = new QUndoStack(this);
+
+    m_migrationTimer = new QTimer(this);
+    m_migrationTimer->setInterval(0);
     
     setupUi();
     connectSignals();
@@ -50,6 +192,15 @@ MainWindow::MainWindow(QWidget* parent)
 
 MainWindow::~MainWindow()
 {
+    // Background jobs deliver results to this window; let them drain first
+    cancelDetailRendering();
+    cancelLineDetection();
+    cancelSymbolCount();
+    cancelTextIndexing();
+    cancelPdfImport();
+    cancelComparison();
+    QThreadPool::globalInstance()->waitForDone();
+    PdfDocumentPool::instance().clear();
 }
 
 void MainWindow::setupUi()
@@ -129,6 +280,41 @@ void MainWindow::createMenuBar()
     m_deletePageAction->setStatusTip("Delete the selected page");
     m_deletePageAction->setEnabled(false);
     editMenu->addAction(m_deletePageAction);
+
+    editMenu->addSeparator();
+
+    m_findTextAction = new QAction("&Find Text...", this);
+    m_findTextAction->setShortcut(QKeySequence::Find);
+    m_findTextAction->setStatusTip("Search the text of all PDF sheets");
+    editMenu->addAction(m_findTextAction);
+
+    // === View menu ===
+    QMenu* viewMenu = menuBar->addMenu("&View");
+
+    m_compareAction = new QAction("&Compare With Page...", this);
+    m_compareAction->setCheckable(true);
+    m_compareAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_K));
+    m_compareAction->setStatusTip("Highlight what changed between this page and another revision");
+    viewMenu->addAction(m_compareAction);
+
+    m_hudAction = new QAction("Performance &HUD", this);
+    m_hudAction->setCheckable(true);
+    m_hudAction->setShortcut(QKeySequence(Qt::Key_F12));
+    m_hudAction->setStatusTip("Show frame time, tile cache and background work over the page");
+    viewMenu->addAction(m_hudAction);
+
+#ifdef TAKEOFF_ENABLE_TRACING
+    viewMenu->addSeparator();
+
+    m_recordTraceAction = new QAction("&Record Performance Trace", this);
+    m_recordTraceAction->setCheckable(true);
+    m_recordTraceAction->setStatusTip("Record timings of rendering, database and painting work");
+    viewMenu->addAction(m_recordTraceAction);
+
+    m_saveTraceAction = new QAction("Save Performance Trace...", this);
+    m_saveTraceAction->setStatusTip("Save recorded timings for chrome://tracing or Perfetto");
+    viewMenu->addAction(m_saveTraceAction);
+#endif
 }
 
 void MainWindow::createToolBar()
@@ -177,6 +363,23 @@ void MainWindow::createToolBar()
     m_polylineAction->setStatusTip("Measure a polyline: click points, double-click to finish");
     m_toolGroup->addAction(m_polylineAction);
     m_toolBar->addAction(m_polylineAction);
+
+    // Count tool
+    m_countAction = new QAction("Count", this);
+    m_countAction->setCheckable(true);
+    m_countAction->setStatusTip("Count symbols: click two corners around one symbol to find its copies");
+    m_toolGroup->addAction(m_countAction);
+    m_toolBar->addAction(m_countAction);
+
+    m_toolBar->addSeparator();
+
+    // Snap toggle (independent of the exclusive tool group)
+    m_snapAction = new QAction("Snap", this);
+    m_snapAction->setCheckable(true);
+    m_snapAction->setChecked(true);
+    m_snapAction->setShortcut(QKeySequence(Qt::Key_S));
+    m_snapAction->setStatusTip("Snap clicks to nearby endpoints, midpoints and intersections");
+    m_toolBar->addAction(m_snapAction);
 }
 
 void MainWindow::createStatusBar()
@@ -223,6 +426,12 @@ void MainWindow::createDockWidgets()
     // Quote dock (bottom)
     m_quoteDock = new QuoteDock(this);
     addDockWidget(Qt::BottomDockWidgetArea, m_quoteDock);
+
+    // Search dock (tabbed with properties)
+    m_searchPanel = new SearchPanel(this);
+    addDockWidget(Qt::RightDockWidgetArea, m_searchPanel);
+    tabifyDockWidget(m_propertiesDock, m_searchPanel);
+    m_propertiesDock->raise();
 }
 
 void MainWindow::connectSignals()
@@ -238,22 +447,39 @@ void MainWindow::connectSignals()
     // Edit menu actions
     connect(m_deleteAction, &QAction::triggered, this, &MainWindow::onDeleteItem);
     connect(m_deletePageAction, &QAction::triggered, this, &MainWindow::onDeletePage);
+    connect(m_findTextAction, &QAction::triggered, this, &MainWindow::onFindText);
+
+    // View menu actions
+    connect(m_compareAction, &QAction::toggled, this, &MainWindow::onCompareToggled);
+    connect(m_hudAction, &QAction::toggled, m_blueprintView, &BlueprintView::setHudVisible);
+    if (m_recordTraceAction) {
+        connect(m_recordTraceAction, &QAction::toggled, this, &MainWindow::onRecordTraceToggled);
+        connect(m_saveTraceAction, &QAction::triggered, this, &MainWindow::onSaveTrace);
+    }
 
     // Tool actions
     connect(m_noneToolAction, &QAction::triggered, this, &MainWindow::onToolNone);
     connect(m_calibrateAction, &QAction::triggered, this, &MainWindow::onToolCalibrate);
     connect(m_lineAction, &QAction::triggered, this, &MainWindow::onToolLine);
     connect(m_polylineAction, &QAction::triggered, this, &MainWindow::onToolPolyline);
+    connect(m_countAction, &QAction::triggered, this, &MainWindow::onToolCount);
+    connect(m_snapAction, &QAction::toggled, m_blueprintView, &BlueprintView::setSnapEnabled);
 
     // Blueprint view signals
     connect(m_blueprintView, &BlueprintView::calibrationCompleted,
             this, &MainWindow::onCalibrationCompleted);
     connect(m_blueprintView, &BlueprintView::measurementCompleted,
             this, &MainWindow::onMeasurementCompleted);
+    connect(m_blueprintView, &BlueprintView::countTemplateSelected,
+            this, &MainWindow::onCountTemplateSelected);
     connect(m_blueprintView, &BlueprintView::liveMeasurementChanged,
             this, &MainWindow::onLiveMeasurementChanged);
     connect(m_blueprintView, &BlueprintView::toolCancelled,
             this, &MainWindow::onToolCancelled);
+    connect(m_blueprintView, &BlueprintView::detailRequested,
+            this, &MainWindow::onDetailRequested);
+    connect(m_blueprintView, &BlueprintView::hudRefreshRequested,
+            this, &MainWindow::onHudRefreshRequested);
 
     // Pages panel signals
     connect(m_pagesPanel, &PagesPanel::pageSelected,
@@ -284,6 +510,15 @@ void MainWindow::connectSignals()
             this, &MainWindow::onMaterialPriceChanged);
     connect(m_quoteDock, &QuoteDock::currentPageOnlyChanged,
             this, &MainWindow::onCurrentPageOnlyChanged);
+
+    // Search panel signals
+    connect(m_searchPanel, &SearchPanel::searchRequested,
+            this, &MainWindow::onSearchRequested);
+    connect(m_searchPanel, &SearchPanel::hitActivated,
+            this, &MainWindow::onSearchHitActivated);
+
+    // Deferred migration batches
+    connect(m_migrationTimer, &QTimer::timeout, this, &MainWindow::onMigrationTimer);
 }
 
 void MainWindow::closeEvent(QCloseEvent* event)
@@ -367,8 +602,10 @@ void MainWindow::onOpenProject()
         m_importShapesAction->setEnabled(true);
         
         // Populate pages panel
+        const QHash<QString, QByteArray> thumbnails = m_project.pageThumbnails();
         for (const Page& page : m_project.pages()) {
             m_pagesPanel->addPage(page);
+            m_pagesPanel->setPageThumbnail(page.id(), thumbnails.value(page.id()));
         }
         
         // Select first page if available
@@ -381,6 +618,14 @@ void MainWindow::onOpenProject()
         refreshDesignationAutocomplete();
         updateQuoteSummary();
         
+        // Finish any large data rewrites from a schema upgrade in the background
+        if (m_project.database()->hasPendingMigrationWork()) {
+            m_migrationTimer->start();
+        }
+
+        // Index the text of any PDF pages added before text search existed
+        startTextIndexing();
+        
         updateWindowTitle();
         updateStatusBar(QString("Project loaded: %1").arg(QFileInfo(filePath).fileName()));
     } else {
@@ -443,51 +688,34 @@ void MainWindow::onAddPdf()
         return;
     }
 
-    // Try to open the PDF
-    if (!m_pdfRenderer.openPdf(filePath)) {
-        QMessageBox::warning(this, "Error", 
-            QString("Failed to open PDF: %1").arg(m_pdfRenderer.lastError()));
-        return;
+    // Try to open the PDF; the pool keeps it open for the import workers
+    int totalPages = 0;
+    {
+        QString error;
+        PdfDocumentPool::Lease document = PdfDocumentPool::instance().acquire(filePath, &error);
+        if (!document.isValid()) {
+            QMessageBox::warning(this, "Error", QString("Failed to open PDF: %1").arg(error));
+            return;
+        }
+        totalPages = document->pageCount();
     }
 
-    int totalPages = m_pdfRenderer.pageCount();
     if (totalPages == 0) {
         QMessageBox::warning(this, "Error", "PDF has no pages.");
-        m_pdfRenderer.close();
         return;
     }
 
     // Show import dialog
     PdfImportDialog dialog(filePath, totalPages, this);
     if (dialog.exec() != QDialog::Accepted) {
-        m_pdfRenderer.close();
         return;
     }
 
     int fromPage = dialog.fromPage();
     int toPage = dialog.toPage();
 
-    // Import selected pages
-    QString firstPageId;
-    for (int i = fromPage; i <= toPage; ++i) {
-        Page page = Page::createPdfPage(filePath, i - 1, totalPages);  // 0-based index
-        m_project.addPage(page);
-        m_pagesPanel->addPage(page);
-        
-        if (firstPageId.isEmpty()) {
-            firstPageId = page.id();
-        }
-    }
-
-    m_pdfRenderer.close();
-
-    // Select the first imported page
-    if (!firstPageId.isEmpty()) {
-        m_pagesPanel->selectPage(firstPageId);
-    }
-
-    int count = toPage - fromPage + 1;
-    updateStatusBar(QString("Added %1 page(s) from PDF. Calibrate before measuring.").arg(count));
+    // Import selected pages (0-based indexes)
+    startPdfImport(filePath, fromPage - 1, toPage - 1);
 }
 
 void MainWindow::onImportShapes()
@@ -549,13 +777,13 @@ void MainWindow::onDeleteItem()
     }
 
     // Find the item
-    TakeoffItem* item = m_project.findTakeoffItem(selectedId);
-    if (!item) {
+    TakeoffItem item = m_project.takeoffItem(selectedId);
+    if (item.id() < 0) {
         return;
     }
 
     // Create copy for undo
-    TakeoffItem copy = *item;
+    TakeoffItem copy = item;
     
     // Remove the item
     removeTakeoffItemInternal(selectedId);
@@ -572,6 +800,108 @@ void MainWindow::onDeletePage()
     onPageDeleteRequested(m_currentPageId);
 }
 
+void MainWindow::onFindText()
+{
+    m_searchPanel->show();
+    m_searchPanel->raise();
+    m_searchPanel->focusSearchField();
+}
+
+// ============================================================================
+// View Menu Slots
+// ============================================================================
+
+void MainWindow::onCompareToggled(bool checked)
+{
+    if (!checked) {
+        endComparison();
+        updateStatusBar("Comparison closed.");
+        return;
+    }
+
+    QStringList names;
+    QVector<const Page*> candidates;
+    for (const Page& page : m_project.pages()) {
+        if (page.id() != m_currentPageId) {
+            names.append(page.listDisplayString());
+            candidates.append(&page);
+        }
+    }
+    if (m_currentPageId.isEmpty() || candidates.isEmpty()) {
+        QMessageBox::information(this, "Compare Pages",
+            "Select a page first. Its other revision must be added to the project as another page.");
+        endComparison();
+        return;
+    }
+
+    bool ok = false;
+    const QString choice = QInputDialog::getItem(this, "Compare Pages",
+        "Compare this page with:", names, 0, false, &ok);
+    const int index = names.indexOf(choice);
+    if (!ok || index < 0) {
+        endComparison();
+        return;
+    }
+
+    QMessageBox modeBox(this);
+    modeBox.setWindowTitle("Compare Pages");
+    modeBox.setText("Show the other revision:");
+    QPushButton* overlayButton = modeBox.addButton("Overlay", QMessageBox::AcceptRole);
+    QPushButton* sideBySideButton = modeBox.addButton("Side by Side", QMessageBox::AcceptRole);
+    modeBox.addButton(QMessageBox::Cancel);
+    modeBox.setDefaultButton(overlayButton);
+    modeBox.exec();
+
+    if (modeBox.clickedButton() == overlayButton) {
+        startComparison(*candidates[index], CompareMode::Overlay);
+    } else if (modeBox.clickedButton() == sideBySideButton) {
+        startComparison(*candidates[index], CompareMode::SideBySide);
+    } else {
+        endComparison();
+    }
+}
+
+void MainWindow::onRecordTraceToggled(bool checked)
+{
+    if (checked) {
+        Trace::clear();
+    }
+    Trace::setEnabled(checked);
+    updateStatusBar(checked ? "Recording performance trace." : "Performance trace stopped.");
+}
+
+void MainWindow::onSaveTrace()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, "Save Performance Trace",
+        QString(), "Chrome Trace (*.json);;All Files (*)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+    if (!filePath.endsWith(".json", Qt::CaseInsensitive)) {
+        filePath += ".json";
+    }
+
+    QString error;
+    if (!Trace::writeChromeJson(filePath, &error)) {
+        QMessageBox::critical(this, "Save Trace", error);
+        return;
+    }
+    updateStatusBar(QString("Trace saved to %1").arg(filePath));
+}
+
+void MainWindow::onHudRefreshRequested()
+{
+    BlueprintView::HudStats stats;
+    stats.pendingTiles = m_detailTilesPending ? m_detailTilesPending->load() : 0;
+    stats.tileLookups = m_detailTileLookups;
+    stats.tileHits = m_detailTileHits;
+    stats.busyThreads = QThreadPool::globalInstance()->activeThreadCount();
+    stats.maxThreads = QThreadPool::globalInstance()->maxThreadCount();
+    stats.migrationBatches = m_project.isOpen()
+        ? m_project.database()->pendingMigrationBatches(MIGRATION_BATCH_SIZE) : 0;
+    m_blueprintView->setHudStats(stats);
+}
+
 // ============================================================================
 // Tool Slots
 // ============================================================================
@@ -644,22 +974,46 @@ void MainWindow::onToolPolyline()
     updateStatusBar("Polyline tool: Click points, double-click to finish.");
 }
 
+void MainWindow::onToolCount()
+{
+    if (m_currentPageId.isEmpty()) {
+        QMessageBox::information(this, "No Page Selected",
+            "Please add and select a page first.");
+        m_noneToolAction->setChecked(true);
+        m_blueprintView->setTool(Tool::None);
+        return;
+    }
+
+    // Counts are unitless, so no calibration is needed
+    m_blueprintView->setTool(Tool::Count);
+    updateStatusBar("Count tool: Click two corners of a box around one symbol.");
+}
+
 // ============================================================================
 // View Signal Slots
 // ============================================================================
 
 void MainWindow::onCalibrationCompleted(double pixelsPerInch)
 {
-    // Sync calibration to current page
+    // Sync calibration to current page and re-measure its items at the new scale
     Page* page = m_project.findPage(m_currentPageId);
     if (page) {
-        page->calibration() = m_blueprintView->calibration();
-        m_project.updatePage(*page);
+        const Calibration oldCalibration = page->calibration();
+        const Calibration newCalibration = m_blueprintView->calibration();
+        const Project::ItemLengths lengths = m_project.measureItemLengths(m_currentPageId, pixelsPerInch);
+        Project::ItemLengths previous;
+        if (applyCalibrationInternal(m_currentPageId, newCalibration, lengths, &previous)) {
+            m_undoStack->push(new RecalibratePageCommand(this, m_currentPageId, oldCalibration, previous,
+                                                         newCalibration, lengths));
+            updateStatusBar(QString("Calibration complete: %1 pixels/inch, %2 item length(s) updated. "
+                                    "Ready to measure.")
+                            .arg(pixelsPerInch, 0, 'f', 2).arg(lengths.itemIds.size()));
+        } else {
+            // Keep measuring at the scale the project still has
+            m_blueprintView->setCalibration(oldCalibration);
+        }
     }
     
-    updateStatusBar(QString("Calibration complete: %1 pixels/inch. Ready to measure.")
-                    .arg(pixelsPerInch, 0, 'f', 2));
-    
     // Switch to pan mode after calibration
     m_noneToolAction->setChecked(true);
 }
@@ -669,8 +1023,7 @@ void MainWindow::onMeasurementCompleted(const Measurement& measurement)
     // Convert Measurement to TakeoffItem
     TakeoffItem item;
     item.setPageId(m_currentPageId);
-    item.setKind(measurement.type() == MeasurementType::Line ? 
-                 TakeoffItem::Line : TakeoffItem::Polyline);
+    item.setKind(takeoffKindFor(measurement.type()));
     item.setPoints(measurement.points());
     item.setLengthInches(measurement.lengthInches());
     item.setQty(1);
@@ -688,6 +1041,47 @@ void MainWindow::onMeasurementCompleted(const Measurement& measurement)
     updateStatusBar(QString("Item added: %1 - assign material.").arg(item.displayString()));
 }
 
+void MainWindow::onCountTemplateSelected(const QRectF& sceneRect)
+{
+    m_noneToolAction->setChecked(true);
+    m_blueprintView->setTool(Tool::None);
+
+    const Page* currentPage = m_project.findPage(m_currentPageId);
+    if (!currentPage) {
+        return;
+    }
+    if (sceneRect.width() < 4.0 || sceneRect.height() < 4.0) {
+        updateStatusBar("Count cancelled: the box is too small to hold a symbol.");
+        return;
+    }
+
+    QMessageBox scopeBox(this);
+    scopeBox.setWindowTitle("Count Symbols");
+    scopeBox.setText("Count copies of the boxed symbol on:");
+    QPushButton* thisPageButton = scopeBox.addButton("This Page", QMessageBox::AcceptRole);
+    QPushButton* allPagesButton = scopeBox.addButton("All Pages", QMessageBox::AcceptRole);
+    scopeBox.addButton(QMessageBox::Cancel);
+    scopeBox.setDefaultButton(thisPageButton);
+    scopeBox.exec();
+
+    QVector<Page> pages;
+    if (scopeBox.clickedButton() == thisPageButton) {
+        pages.append(*currentPage);
+    } else if (scopeBox.clickedButton() == allPagesButton) {
+        // The template comes from the current page, so search it first
+        pages.append(*currentPage);
+        for (const Page& page : m_project.pages()) {
+            if (page.id() != m_currentPageId) {
+                pages.append(page);
+            }
+        }
+    } else {
+        return;
+    }
+
+    startSymbolCount(sceneRect, pages);
+}
+
 void MainWindow::onLiveMeasurementChanged(double inches)
 {
     if (inches > 0.0) {
@@ -705,9 +1099,9 @@ void MainWindow::onItemSelected(int itemId)
     updatePropertiesPanel();
     
     if (itemId >= 0) {
-        const TakeoffItem* item = m_project.findTakeoffItem(itemId);
-        if (item) {
-            updateStatusBar(QString("Selected: %1").arg(item->displayString()));
+        const TakeoffItem item = m_project.takeoffItem(itemId);
+        if (item.id() >= 0) {
+            updateStatusBar(QString("Selected: %1").arg(item.displayString()));
         }
     }
 }
@@ -719,6 +1113,57 @@ void MainWindow::onToolCancelled()
     updateStatusBar("Tool cancelled. Pan mode.");
 }
 
+void MainWindow::onDetailRequested()
+{
+    const Page* page = m_project.findPage(m_currentPageId);
+    if (!page || page->type() != Page::Pdf) {
+        return;
+    }
+
+    // Scene units are pixels at the default resolution
+    const double neededDpi = m_blueprintView->devicePixelsPerSceneUnit() * PdfRenderer::DEFAULT_DPI;
+    if (neededDpi <= PREVIEW_DPI) {
+        return;  // The preview is already as sharp as the screen
+    }
+    int level = 0;
+    while (level < DETAIL_LEVEL_COUNT - 1 && DETAIL_DPIS[level] < neededDpi) {
+        ++level;
+    }
+
+    // Missing tiles over the visible area, nearest the center first
+    const double scale = DETAIL_DPIS[level] / PdfRenderer::DEFAULT_DPI;
+    const QRectF visible = m_blueprintView->visibleSceneRect();
+    if (visible.isEmpty()) {
+        return;
+    }
+    const QRectF levelRect(visible.x() * scale, visible.y() * scale,
+                           visible.width() * scale, visible.height() * scale);
+    const int column0 = static_cast<int>(levelRect.left()) / DETAIL_TILE_SIZE;
+    const int column1 = static_cast<int>(levelRect.right()) / DETAIL_TILE_SIZE;
+    const int row0 = static_cast<int>(levelRect.top()) / DETAIL_TILE_SIZE;
+    const int row1 = static_cast<int>(levelRect.bottom()) / DETAIL_TILE_SIZE;
+
+    QVector<QPoint> cells;
+    for (int row = row0; row <= row1; ++row) {
+        for (int column = column0; column <= column1; ++column) {
+            ++m_detailTileLookups;
+            if (m_blueprintView->hasDetailTile(level, QPoint(column, row))) {
+                ++m_detailTileHits;
+            } else {
+                cells.append(QPoint(column, row));
+            }
+        }
+    }
+    const QPointF center = levelRect.center() / DETAIL_TILE_SIZE - QPointF(0.5, 0.5);
+    std::sort(cells.begin(), cells.end(), [&center](const QPoint& a, const QPoint& b) {
+        return QLineF(center, a).length() < QLineF(center, b).length();
+    });
+
+    if (!cells.isEmpty()) {
+        startDetailRendering(*page, level, cells);
+    }
+}
+
 // ============================================================================
 // Pages Panel Slots
 // ============================================================================
@@ -777,7 +1222,7 @@ void MainWindow::onPageDeleteRequested(const QString& pageId)
     }
     
     // Confirm deletion
-    int itemCount = m_project.takeoffItemsForPage(pageId).size();
+    int itemCount = m_project.takeoffItemCountForPage(pageId);
     QString message;
     if (itemCount > 0) {
         message = QString("Delete page '%1' and its %2 item(s)?")
@@ -795,6 +1240,14 @@ void MainWindow::onPageDeleteRequested(const QString& pageId)
         return;
     }
     
+    // Comparisons involving the page go with it
+    endComparison();
+    for (int i = m_comparisonOrder.size() - 1; i >= 0; --i) {
+        if (m_comparisonOrder[i].split('|').contains(pageId)) {
+            m_comparisons.remove(m_comparisonOrder.takeAt(i));
+        }
+    }
+
     // Remove from UI
     m_pagesPanel->removePage(pageId);
     
@@ -834,16 +1287,16 @@ void MainWindow::onUndoStackCleanChanged(bool clean)
 void MainWindow::onDesignationChanged(int itemId, const QString& oldVal, const QString& newVal,
                                        int oldShapeId, int newShapeId)
 {
-    TakeoffItem* item = m_project.findTakeoffItem(itemId);
-    if (!item) return;
+    TakeoffItem item = m_project.takeoffItem(itemId);
+    if (item.id() < 0) return;
 
     // Look up shape by designation
     auto shape = m_project.getShapeByDesignation(newVal);
     int resolvedShapeId = shape.id;
     
-    item->setDesignation(newVal);
-    item->setShapeId(resolvedShapeId);
-    m_project.updateTakeoffItem(*item);
+    item.setDesignation(newVal);
+    item.setShapeId(resolvedShapeId);
+    m_project.updateTakeoffItem(item);
     
     // Update UI
     updateItemDisplay(itemId);
@@ -857,11 +1310,11 @@ void MainWindow::onDesignationChanged(int itemId, const QString& oldVal, const Q
 
 void MainWindow::onQtyChanged(int itemId, int oldVal, int newVal)
 {
-    TakeoffItem* item = m_project.findTakeoffItem(itemId);
-    if (!item) return;
+    TakeoffItem item = m_project.takeoffItem(itemId);
+    if (item.id() < 0) return;
 
-    item->setQty(newVal);
-    m_project.updateTakeoffItem(*item);
+    item.setQty(newVal);
+    m_project.updateTakeoffItem(item);
     
     updateItemDisplay(itemId);
     updatePropertiesPanel();
@@ -873,11 +1326,11 @@ void MainWindow::onQtyChanged(int itemId, int oldVal, int newVal)
 
 void MainWindow::onNotesChanged(int itemId, const QString& oldVal, const QString& newVal)
 {
-    TakeoffItem* item = m_project.findTakeoffItem(itemId);
-    if (!item) return;
+    TakeoffItem item = m_project.takeoffItem(itemId);
+    if (item.id() < 0) return;
 
-    item->setNotes(newVal);
-    m_project.updateTakeoffItem(*item);
+    item.setNotes(newVal);
+    m_project.updateTakeoffItem(item);
     
     m_undoStack->push(new SetTakeoffItemFieldCommand(
         this, itemId, TakeoffItemField::Notes, oldVal, newVal));
@@ -885,8 +1338,8 @@ void MainWindow::onNotesChanged(int itemId, const QString& oldVal, const QString
 
 void MainWindow::onPickShapeRequested(int itemId)
 {
-    TakeoffItem* item = m_project.findTakeoffItem(itemId);
-    if (!item) return;
+    TakeoffItem item = m_project.takeoffItem(itemId);
+    if (item.id() < 0) return;
 
     // Check if shapes are imported
     if (!m_project.hasShapes()) {
@@ -919,12 +1372,12 @@ void MainWindow::onPickShapeRequested(int itemId)
     }
 
     // Store old values for undo
-    QString oldDesignation = item->designation();
+    QString oldDesignation = item.designation();
 
     // Update item
-    item->setDesignation(newDesignation);
-    item->setShapeId(newShapeId);
-    m_project.updateTakeoffItem(*item);
+    item.setDesignation(newDesignation);
+    item.setShapeId(newShapeId);
+    m_project.updateTakeoffItem(item);
     
     // Update UI
     updateItemDisplay(itemId);
@@ -953,6 +1406,62 @@ void MainWindow::onCurrentPageOnlyChanged(bool currentPageOnly)
     updateQuoteSummary();
 }
 
+// ============================================================================
+// Search Panel Slots
+// ============================================================================
+
+void MainWindow::onSearchRequested(const QString& text)
+{
+    if (!m_project.isOpen() || text.trimmed().size() < 2) {
+        m_searchPanel->setResults(QVector<ProjectDatabase::TextHit>(), QHash<QString, QString>());
+        return;
+    }
+
+    QVector<ProjectDatabase::TextHit> hits = m_project.searchText(text.trimmed());
+
+    QHash<QString, QString> pageNames;
+    for (const ProjectDatabase::TextHit& hit : hits) {
+        if (!pageNames.contains(hit.pageId)) {
+            const Page* page = m_project.findPage(hit.pageId);
+            pageNames.insert(hit.pageId, page ? page->listDisplayString() : hit.pageId);
+        }
+    }
+    m_searchPanel->setResults(hits, pageNames);
+}
+
+void MainWindow::onSearchHitActivated(const QString& pageId, const QRectF& rect)
+{
+    if (!m_project.findPage(pageId)) {
+        return;
+    }
+
+    // Selecting the page in the panel loads it through onPageSelected()
+    if (pageId != m_currentPageId) {
+        m_pagesPanel->selectPage(pageId);
+    }
+    if (pageId == m_currentPageId) {
+        m_blueprintView->showSearchHit(rect);
+    }
+}
+
+// ============================================================================
+// Deferred Migration
+// ============================================================================
+
+void MainWindow::onMigrationTimer()
+{
+    ProjectDatabase* db = m_project.database();
+    if (!m_project.isOpen() || !db->hasPendingMigrationWork()) {
+        m_migrationTimer->stop();
+        return;
+    }
+
+    if (db->runMigrationStep(MIGRATION_BATCH_SIZE) < 0) {
+        m_migrationTimer->stop();
+        updateStatusBar(QString("Project upgrade paused: %1").arg(db->lastError()));
+    }
+}
+
 // ============================================================================
 // Internal Methods
 // ============================================================================
@@ -964,13 +1473,8 @@ void MainWindow::addTakeoffItemInternal(TakeoffItem& item)
     // Only add to panel if it's for the current page
     if (item.pageId() == m_currentPageId) {
         // Convert to Measurement for display (temporary compatibility)
-        Measurement m;
+        Measurement m = displayMeasurement(item);
         m.setId(newId);
-        m.setPageId(item.pageId());
-        m.setType(item.kind() == TakeoffItem::Line ? MeasurementType::Line : MeasurementType::Polyline);
-        m.setPoints(item.points());
-        m.setLengthInches(item.lengthInches());
-        m.setSize(item.designation());
         
         m_itemsPanel->addMeasurement(m);
         m_blueprintView->addMeasurement(m);
@@ -981,8 +1485,8 @@ void MainWindow::addTakeoffItemInternal(TakeoffItem& item)
 
 void MainWindow::removeTakeoffItemInternal(int itemId)
 {
-    const TakeoffItem* item = m_project.findTakeoffItem(itemId);
-    bool isCurrentPage = (item && item->pageId() == m_currentPageId);
+    const TakeoffItem item = m_project.takeoffItem(itemId);
+    bool isCurrentPage = (item.id() >= 0 && item.pageId() == m_currentPageId);
     
     m_project.removeTakeoffItem(itemId);
     
@@ -1003,34 +1507,34 @@ void MainWindow::removeTakeoffItemInternal(int itemId)
 
 void MainWindow::setTakeoffItemFieldInternal(int itemId, TakeoffItemField field, const QVariant& value)
 {
-    TakeoffItem* item = m_project.findTakeoffItem(itemId);
-    if (!item) return;
+    TakeoffItem item = m_project.takeoffItem(itemId);
+    if (item.id() < 0) return;
 
     switch (field) {
         case TakeoffItemField::Designation: {
             QString designation = value.toString();
-            item->setDesignation(designation);
+            item.setDesignation(designation);
             // Also update shape ID
             auto shape = m_project.getShapeByDesignation(designation);
-            item->setShapeId(shape.id);
+            item.setShapeId(shape.id);
             break;
         }
         case TakeoffItemField::Qty:
-            item->setQty(value.toInt());
+            item.setQty(value.toInt());
             break;
         case TakeoffItemField::Notes:
-            item->setNotes(value.toString());
+            item.setNotes(value.toString());
             break;
         case TakeoffItemField::ShapeId:
-            item->setShapeId(value.toInt());
+            item.setShapeId(value.toInt());
             break;
     }
 
-    m_project.updateTakeoffItem(*item);
+    m_project.updateTakeoffItem(item);
 
     // Update properties panel if this is the selected item
     if (m_selectedItemId == itemId) {
-        m_propertiesDock->updateFromItem(item);
+        m_propertiesDock->updateFromItem(&item);
     }
 
     updateQuoteSummary();
@@ -1061,6 +1565,17 @@ bool MainWindow::maybeSave()
 
 void MainWindow::clearProject()
 {
+    m_migrationTimer->stop();
+    endComparison();
+    m_comparisons.clear();
+    m_comparisonOrder.clear();
+    cancelDetailRendering();
+    cancelLineDetection();
+    cancelSymbolCount();
+    cancelTextIndexing();
+    cancelPdfImport();
+    m_sheetSegments.clear();
+    PdfDocumentPool::instance().clear();
     m_project.close();
     m_currentPageId.clear();
     m_undoStack->clear();
@@ -1069,6 +1584,7 @@ void MainWindow::clearProject()
     m_itemsPanel->clearMeasurements();
     m_propertiesDock->clearSelection();
     m_propertiesDock->setDesignationList(QStringList());
+    m_searchPanel->clear();
     m_selectedItemId = -1;
     m_deleteAction->setEnabled(false);
     m_deletePageAction->setEnabled(false);
@@ -1083,6 +1599,33 @@ void MainWindow::clearProject()
     m_blueprintView->setTool(Tool::None);
 }
 
+bool MainWindow::applyCalibrationInternal(const QString& pageId, const Calibration& calibration,
+                                          const Project::ItemLengths& lengths,
+                                          Project::ItemLengths* previous)
+{
+    Project::ItemLengths before;
+    if (!m_project.applyCalibration(pageId, calibration, lengths, &before)) {
+        QMessageBox::warning(this, "Calibration Error",
+            QString("Could not store the calibration: %1").arg(m_project.lastError()));
+        return false;
+    }
+
+    if (pageId == m_currentPageId) {
+        m_blueprintView->setCalibration(calibration);
+        for (int itemId : lengths.itemIds) {
+            m_itemsPanel->updateMeasurement(displayMeasurement(m_project.takeoffItem(itemId)));
+        }
+    }
+    m_quoteDock->applyLengthChanges(&m_project, lengths.itemIds, before.lengthsInches,
+                                    lengths.lengthsInches);
+    updatePropertiesPanel();
+
+    if (previous) {
+        *previous = before;
+    }
+    return true;
+}
+
 void MainWindow::updateQuoteSummary()
 {
     m_quoteDock->updateFromProject(&m_project);
@@ -1091,14 +1634,14 @@ void MainWindow::updateQuoteSummary()
 void MainWindow::updatePropertiesPanel()
 {
     if (m_selectedItemId >= 0) {
-        const TakeoffItem* item = m_project.findTakeoffItem(m_selectedItemId);
-        if (item) {
-            m_propertiesDock->setTakeoffItem(item, m_selectedItemId);
+        const TakeoffItem item = m_project.takeoffItem(m_selectedItemId);
+        if (item.id() >= 0) {
+            m_propertiesDock->setTakeoffItem(&item, m_selectedItemId);
             
             // Update computed values
             double wLbPerFt = 0.0;
-            if (item->shapeId() > 0) {
-                auto shape = m_project.getShape(item->shapeId());
+            if (item.shapeId() > 0) {
+                auto shape = m_project.getShape(item.shapeId());
                 wLbPerFt = shape.wLbPerFt;
             }
             m_propertiesDock->updateComputedValues(wLbPerFt, m_project.materialPricePerLb());
@@ -1112,6 +1655,10 @@ void MainWindow::updatePropertiesPanel()
 
 void MainWindow::loadCurrentPage()
 {
+    TAKEOFF_TRACE_SCOPE("MainWindow::loadCurrentPage");
+    cancelDetailRendering();
+    endComparison();
+
     if (m_currentPageId.isEmpty()) {
         m_blueprintView->clearImage();
         return;
@@ -1133,21 +1680,27 @@ void MainWindow::loadCurrentPage()
                 .arg(page->sourcePath()));
         }
     } else if (page->type() == Page::Pdf) {
-        if (!m_pdfRenderer.isOpen() || m_pdfRenderer.currentPath() != page->sourcePath()) {
-            if (!m_pdfRenderer.openPdf(page->sourcePath())) {
-                QMessageBox::warning(this, "PDF Not Found",
-                    QString("Could not open PDF: %1\n%2")
-                    .arg(page->sourcePath(), m_pdfRenderer.lastError()));
-                return;
-            }
+        // Switching between sets reuses the documents the pool keeps open
+        QString error;
+        PdfDocumentPool::Lease document = PdfDocumentPool::instance().acquire(page->sourcePath(), &error);
+        if (!document.isValid()) {
+            QMessageBox::warning(this, "PDF Not Found",
+                QString("Could not open PDF: %1\n%2").arg(page->sourcePath(), error));
+            return;
         }
         
-        QImage image = m_pdfRenderer.renderPage(page->pdfPageIndex());
-        if (image.isNull()) {
+        // A quick low-resolution preview lets measuring start at once;
+        // the view asks for sharper tiles as it is zoomed
+        const QSizeF pagePoints = document->pageSize(page->pdfPageIndex());
+        const double sceneScale = PdfRenderer::DEFAULT_DPI / 72.0;
+        const QSizeF sceneSize(std::floor(pagePoints.width() * sceneScale),
+                               std::floor(pagePoints.height() * sceneScale));
+        QImage preview = document->renderPage(page->pdfPageIndex(), PREVIEW_DPI);
+        if (preview.isNull()) {
             QMessageBox::warning(this, "Render Error",
-                QString("Could not render PDF page: %1").arg(m_pdfRenderer.lastError()));
+                QString("Could not render PDF page: %1").arg(document->lastError()));
         } else {
-            loaded = m_blueprintView->loadFromImage(image);
+            loaded = m_blueprintView->loadPreview(preview, sceneSize);
         }
     }
     
@@ -1155,31 +1708,528 @@ void MainWindow::loadCurrentPage()
         // Restore calibration for this page
         m_blueprintView->setCalibration(page->calibration());
         
-        // Restore items for this page (as Measurement for display)
+        // Restore items for this page, drawn straight from the project's
+        // geometry arena, and find the max ID across all items
         int maxId = 0;
-        QVector<TakeoffItem> pageItems = m_project.takeoffItemsForPage(m_currentPageId);
-        for (const TakeoffItem& item : pageItems) {
-            Measurement m;
-            m.setId(item.id());
-            m.setPageId(item.pageId());
-            m.setType(item.kind() == TakeoffItem::Line ? MeasurementType::Line : MeasurementType::Polyline);
-            m.setPoints(item.points());
-            m.setLengthInches(item.lengthInches());
-            m.setSize(item.designation());
-            
-            m_blueprintView->addMeasurement(m);
-            if (item.id() > maxId) {
-                maxId = item.id();
+        const TakeoffItemStore& items = m_project.takeoffItems();
+        const int pageKey = items.pageIds().find(m_currentPageId);
+        for (const TakeoffItemView item : items) {
+            if (item.pageKey() == pageKey) {
+                m_blueprintView->addMeasurement(item.id(), measurementTypeFor(item.kind()), item.points());
             }
-        }
-        
-        // Find the max ID across all items
-        for (const TakeoffItem& item : m_project.takeoffItems()) {
             if (item.id() > maxId) {
                 maxId = item.id();
             }
         }
         m_blueprintView->setNextMeasurementId(maxId + 1);
+
+        // Lines on the sheet become snap targets once detected
+        auto cached = m_sheetSegments.constFind(m_currentPageId);
+        if (cached != m_sheetSegments.constEnd()) {
+            m_blueprintView->setSheetSegments(cached.value());
+        } else {
+            startLineDetection(*page);
+        }
+    }
+}
+
+void MainWindow::startLineDetection(const Page& page)
+{
+    cancelLineDetection();
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_lineDetectionCancel = cancelled;
+
+    // The view may only show a preview, so lines are found on a full
+    // resolution raster loaded in the worker
+    const QString pageId = page.id();
+    QThreadPool::globalInstance()->start([this, cancelled, pageId, page]() {
+        QImage source = loadPageRaster(page);
+        if (cancelled->load()) {
+            return;
+        }
+        QVector<QLineF> segments = LineDetector::detect(source, LineDetector::Options(), cancelled.get());
+        if (cancelled->load()) {
+            return;
+        }
+
+        QMetaObject::invokeMethod(this, [this, cancelled, pageId, segments]() {
+            if (cancelled->load()) {
+                return;
+            }
+            m_sheetSegments.insert(pageId, segments);
+            if (pageId == m_currentPageId) {
+                m_blueprintView->setSheetSegments(segments);
+                updateStatusBar(QString("Found %1 lines on this page for snapping").arg(segments.size()));
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::startDetailRendering(const Page& page, int level, const QVector<QPoint>& cells)
+{
+    cancelDetailRendering();
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    auto pending = std::make_shared<std::atomic<int>>(cells.size());
+    m_detailRenderCancel = cancelled;
+    m_detailTilesPending = pending;
+
+    // Tiles are delivered one by one so the visible center sharpens first
+    const QString path = page.sourcePath();
+    const int pageIndex = page.pdfPageIndex();
+    QThreadPool::globalInstance()->start([this, cancelled, pending, path, pageIndex, level, cells]() {
+        PdfDocumentPool::Lease document = PdfDocumentPool::instance().acquire(path);
+        if (!document.isValid()) {
+            pending->store(0);
+            return;
+        }
+
+        const double dpi = DETAIL_DPIS[level];
+        const double scale = dpi / PdfRenderer::DEFAULT_DPI;
+        for (const QPoint& cell : cells) {
+            if (cancelled->load()) {
+                return;
+            }
+            QRect region(cell.x() * DETAIL_TILE_SIZE, cell.y() * DETAIL_TILE_SIZE,
+                         DETAIL_TILE_SIZE, DETAIL_TILE_SIZE);
+            QImage tile = document->renderRegion(pageIndex, dpi, region);
+            --*pending;
+            if (tile.isNull()) {
+                continue;
+            }
+            const QRectF sceneRect(region.x() / scale, region.y() / scale,
+                                   tile.width() / scale, tile.height() / scale);
+
+            QMetaObject::invokeMethod(this, [this, cancelled, level, cell, sceneRect, tile]() {
+                if (!cancelled->load()) {
+                    m_blueprintView->setDetailTile(level, cell, sceneRect, tile);
+                }
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+void MainWindow::cancelDetailRendering()
+{
+    if (m_detailRenderCancel) {
+        m_detailRenderCancel->store(true);
+        m_detailRenderCancel.reset();
+    }
+    m_detailTilesPending.reset();
+}
+
+void MainWindow::startComparison(const Page& other, CompareMode mode)
+{
+    cancelComparison();
+    const Page* current = m_project.findPage(m_currentPageId);
+    if (!current) {
+        return;
+    }
+
+    const QString key = m_currentPageId + '|' + other.id();
+    auto cached = m_comparisons.constFind(key);
+    if (cached != m_comparisons.constEnd()) {
+        m_comparisonOrder.removeOne(key);
+        m_comparisonOrder.append(key);
+        applyComparison(cached->other, cached->tiles, mode);
+        return;
+    }
+
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_compareCancel = cancelled;
+    updateStatusBar(QString("Comparing with %1...").arg(other.listDisplayString()));
+
+    // Both revisions are rasterized at the scale the view measures on, so
+    // changed tiles land in scene coordinates of the current page
+    const Page before = *current;
+    QThreadPool::globalInstance()->start([this, cancelled, key, before, other, mode]() {
+        QImage beforeRaster = loadPageRaster(before);
+        QImage afterRaster = loadPageRaster(other);
+        if (cancelled->load()) {
+            return;
+        }
+        if (beforeRaster.isNull() || afterRaster.isNull()) {
+            QMetaObject::invokeMethod(this, [this, cancelled]() {
+                if (!cancelled->load()) {
+                    endComparison();
+                    updateStatusBar("Comparison failed: could not load both pages.");
+                }
+            }, Qt::QueuedConnection);
+            return;
+        }
+
+        QVector<ImageDiff::Tile> tiles = ImageDiff::compare(beforeRaster, afterRaster,
+                                                            ImageDiff::Options(), cancelled.get());
+        // The other revision is only shown for reference; gray keeps it small
+        QImage shown = RasterOps::toGrayscale(afterRaster, cancelled.get());
+        if (cancelled->load()) {
+            return;
+        }
+
+        QMetaObject::invokeMethod(this, [this, cancelled, key, shown, tiles, mode]() {
+            if (cancelled->load()) {
+                return;
+            }
+            m_compareCancel.reset();
+            m_comparisons.insert(key, Comparison{shown, tiles});
+            m_comparisonOrder.append(key);
+            while (m_comparisonOrder.size() > MAX_CACHED_COMPARISONS) {
+                m_comparisons.remove(m_comparisonOrder.takeFirst());
+            }
+            applyComparison(shown, tiles, mode);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::applyComparison(const QImage& other, const QVector<ImageDiff::Tile>& tiles,
+                                 CompareMode mode)
+{
+    m_blueprintView->startComparison(other, mode);
+    m_blueprintView->setComparisonTiles(tiles);
+
+    // Items drawn over changed areas may need to be re-measured
+    QVector<int> flagged;
+    const TakeoffItemStore& items = m_project.takeoffItems();
+    const int pageKey = items.pageIds().find(m_currentPageId);
+    for (const TakeoffItemView item : items) {
+        if (item.pageKey() != pageKey) {
+            continue;
+        }
+        for (const ImageDiff::Tile& tile : tiles) {
+            const QRectF area = QRectF(tile.changedBounds).adjusted(
+                -CHANGE_MARGIN, -CHANGE_MARGIN, CHANGE_MARGIN, CHANGE_MARGIN);
+            if (itemTouches(item, area)) {
+                flagged.append(item.id());
+                break;
+            }
+        }
+    }
+    m_blueprintView->setFlaggedMeasurements(flagged);
+
+    updateStatusBar(QString("%1 changed tile(s); %2 takeoff item(s) touch a change")
+                    .arg(tiles.size()).arg(flagged.size()));
+}
+
+void MainWindow::endComparison()
+{
+    cancelComparison();
+    m_blueprintView->endComparison();
+    QSignalBlocker blocker(m_compareAction);
+    m_compareAction->setChecked(false);
+}
+
+void MainWindow::cancelComparison()
+{
+    if (m_compareCancel) {
+        m_compareCancel->store(true);
+        m_compareCancel.reset();
+    }
+}
+
+void MainWindow::cancelLineDetection()
+{
+    if (m_lineDetectionCancel) {
+        m_lineDetectionCancel->store(true);
+        m_lineDetectionCancel.reset();
+    }
+}
+
+void MainWindow::startSymbolCount(const QRectF& templateRect, const QVector<Page>& pages)
+{
+    cancelSymbolCount();
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_symbolCountCancel = cancelled;
+
+    QPointer<QProgressDialog> progress = new QProgressDialog("Counting symbols...", "Cancel", 0, pages.size(), this);
+    progress->setWindowTitle("Count Symbols");
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setValue(0);
+    connect(progress, &QProgressDialog::canceled, this, [this, cancelled]() {
+        cancelled->store(true);
+        updateStatusBar("Symbol count cancelled.");
+    });
+
+    TemplateMatcher::Options options;
+    options.scales = COUNT_SCALES;
+
+    // Pages are rasterized in the worker at the same resolution the view
+    // uses, so matches land in scene coordinates
+    QThreadPool::globalInstance()->start([this, cancelled, progress, templateRect, pages, options]() {
+        QImage templateImage;
+        QVector<QPair<QString, QVector<QPointF>>> results;
+
+        for (int i = 0; i < pages.size() && !cancelled->load(); ++i) {
+            QImage raster = loadPageRaster(pages[i]);
+            if (i == 0) {
+                templateImage = raster.copy(templateRect.toAlignedRect() & raster.rect());
+                if (templateImage.isNull()) {
+                    break;
+                }
+            }
+            if (!raster.isNull()) {
+                QVector<QPointF> centers;
+                for (const TemplateMatcher::Match& match :
+                     TemplateMatcher::findMatches(raster, templateImage, options, cancelled.get())) {
+                    centers.append(match.center());
+                }
+                if (!centers.isEmpty()) {
+                    results.append(qMakePair(pages[i].id(), centers));
+                }
+            }
+
+            QMetaObject::invokeMethod(this, [progress, i]() {
+                if (progress) {
+                    progress->setValue(i + 1);
+                }
+            }, Qt::QueuedConnection);
+        }
+
+        QMetaObject::invokeMethod(this, [this, cancelled, progress, results]() {
+            // Closing the dialog emits canceled(), so read the flag first
+            // and drop the cancel handler before closing
+            const bool wasCancelled = cancelled->load();
+            if (progress) {
+                progress->disconnect(this);
+                progress->close();
+            }
+            if (wasCancelled) {
+                return;
+            }
+            m_symbolCountCancel.reset();
+            addCountItems(results);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::cancelSymbolCount()
+{
+    if (m_symbolCountCancel) {
+        m_symbolCountCancel->store(true);
+        m_symbolCountCancel.reset();
+    }
+}
+
+void MainWindow::addCountItems(const QVector<QPair<QString, QVector<QPointF>>>& results)
+{
+    if (results.isEmpty()) {
+        updateStatusBar("No copies of the symbol were found.");
+        return;
+    }
+
+    // One Count item per page, undone together
+    int total = 0;
+    int lastItemId = -1;
+    m_undoStack->beginMacro("Count Symbols");
+    for (const auto& result : results) {
+        TakeoffItem item(TakeoffItem::Count, result.second, 0.0);
+        item.setPageId(result.first);
+        item.setQty(result.second.size());
+
+        addTakeoffItemInternal(item);
+        m_undoStack->push(new AddTakeoffItemCommand(this, item));
+
+        total += result.second.size();
+        if (item.pageId() == m_currentPageId) {
+            lastItemId = item.id();
+        }
+    }
+    m_undoStack->endMacro();
+
+    if (lastItemId >= 0) {
+        m_itemsPanel->selectMeasurement(lastItemId);
+        m_propertiesDock->focusDesignationField();
+    }
+
+    updateStatusBar(QString("Counted %1 symbols on %2 page(s).").arg(total).arg(results.size()));
+}
+
+void MainWindow::startPdfImport(const QString& filePath, int firstIndex, int lastIndex)
+{
+    cancelPdfImport();
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_pdfImportCancel = cancelled;
+    m_addPdfAction->setEnabled(false);
+
+    // The last step is storing the pages, so workers never complete the bar
+    const int count = lastIndex - firstIndex + 1;
+    QPointer<QProgressDialog> progress = new QProgressDialog("Reading pages...", "Cancel", 0, count + 1, this);
+    progress->setWindowTitle("Add PDF");
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setValue(0);
+    connect(progress, &QProgressDialog::canceled, this, [this, cancelled]() {
+        cancelled->store(true);
+        m_addPdfAction->setEnabled(m_project.isOpen());
+        updateStatusBar("PDF import cancelled. No pages were added.");
+    });
+
+    // Pages are validated, thumbnailed and text-extracted off the UI
+    // thread; nothing touches the project until every page has been read
+    QThreadPool::globalInstance()->start([this, cancelled, progress, filePath, firstIndex, lastIndex]() {
+        PdfImporter importer;
+        bool ok = importer.import(filePath, firstIndex, lastIndex, cancelled.get(), [this, progress](int done) {
+            QMetaObject::invokeMethod(this, [progress, done]() {
+                // Workers report concurrently, so updates may arrive out of order
+                if (progress && progress->value() < done) {
+                    progress->setValue(done);
+                }
+            }, Qt::QueuedConnection);
+        });
+        QVector<ImportedPage> pages = importer.pages();
+        QString error = importer.lastError();
+
+        QMetaObject::invokeMethod(this, [this, cancelled, progress, ok, pages, error]() {
+            // The import can no longer be cancelled, and closing the dialog
+            // emits canceled(), so drop the cancel handler first
+            if (progress) {
+                progress->disconnect(this);
+            }
+            if (cancelled->load()) {
+                if (progress) {
+                    progress->close();
+                }
+                return;
+            }
+            m_pdfImportCancel.reset();
+            m_addPdfAction->setEnabled(m_project.isOpen());
+
+            if (!ok) {
+                if (progress) {
+                    progress->close();
+                }
+                QMessageBox::warning(this, "Error", QString("Failed to import PDF: %1").arg(error));
+                return;
+            }
+
+            if (progress) {
+                progress->setLabelText("Saving pages...");
+                progress->setCancelButton(nullptr);
+                progress->setValue(pages.size());
+            }
+            addImportedPages(pages);
+            if (progress) {
+                progress->close();
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::cancelPdfImport()
+{
+    if (m_pdfImportCancel) {
+        m_pdfImportCancel->store(true);
+        m_pdfImportCancel.reset();
+    }
+}
+
+void MainWindow::addImportedPages(const QVector<ImportedPage>& pages)
+{
+    if (pages.isEmpty()) {
+        return;
+    }
+
+    // All pages and their text are stored in one transaction
+    if (!m_project.addImportedPages(pages)) {
+        QMessageBox::warning(this, "Error",
+            QString("Failed to add pages: %1").arg(m_project.lastError()));
+        return;
+    }
+
+    for (const ImportedPage& imported : pages) {
+        m_pagesPanel->addPage(imported.page);
+        m_pagesPanel->setPageThumbnail(imported.page.id(), imported.thumbnailPng);
+    }
+    m_pagesPanel->selectPage(pages.first().page.id());
+
+    updateStatusBar(QString("Added %1 page(s) from PDF. Calibrate before measuring.").arg(pages.size()));
+}
+
+void MainWindow::startTextIndexing()
+{
+    cancelTextIndexing();
+
+    const QStringList pageIds = m_project.pagesMissingText();
+    if (pageIds.isEmpty() || !PdfRenderer::isAvailable()) {
+        return;
+    }
+
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_textIndexCancel = cancelled;
+
+    // Split each document's pages into chunks; every chunk opens its own
+    // renderer because a PDF document must not be shared between threads
+    struct Chunk {
+        QString path;
+        QVector<QPair<QString, int>> pages;   // Page ID, PDF page index
+    };
+    QHash<QString, QVector<QPair<QString, int>>> pagesByPath;
+    for (const QString& pageId : pageIds) {
+        const Page* page = m_project.findPage(pageId);
+        pagesByPath[page->sourcePath()].append(qMakePair(pageId, page->pdfPageIndex()));
+    }
+    const int threads = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    QVector<Chunk> chunks;
+    for (auto it = pagesByPath.constBegin(); it != pagesByPath.constEnd(); ++it) {
+        const int chunkSize = qMax(4, (it.value().size() + threads - 1) / threads);
+        for (int i = 0; i < it.value().size(); i += chunkSize) {
+            chunks.append({it.key(), it.value().mid(i, chunkSize)});
+        }
+    }
+
+    const int total = pageIds.size();
+    auto indexed = std::make_shared<int>(0);
+    m_searchPanel->setStatus(QString("Indexing sheet text: 0 of %1 pages").arg(total));
+
+    QThreadPool::globalInstance()->start([this, cancelled, chunks, indexed, total]() {
+        parallelFor(chunks.size(), [&](int c) {
+            // Pages of a document that fails to open stay unindexed and are
+            // retried next time, but still count towards completion
+            PdfDocumentPool::Lease document = PdfDocumentPool::instance().acquire(chunks[c].path);
+            QVector<QPair<QString, QVector<PdfWord>>> results;
+            if (document.isValid()) {
+                for (const auto& page : chunks[c].pages) {
+                    if (cancelled->load()) {
+                        return;
+                    }
+                    results.append(qMakePair(page.first, document->extractWords(page.second)));
+                }
+            }
+            const int pageCount = chunks[c].pages.size();
+
+            // Each chunk is stored in the GUI thread, which owns the database
+            QMetaObject::invokeMethod(this, [this, cancelled, results, pageCount, indexed, total]() {
+                if (cancelled->load()) {
+                    return;
+                }
+                for (const auto& result : results) {
+                    if (m_project.findPage(result.first)) {
+                        m_project.setPageText(result.first, result.second);
+                    }
+                }
+
+                *indexed += pageCount;
+                if (*indexed < total) {
+                    m_searchPanel->setStatus(QString("Indexing sheet text: %1 of %2 pages").arg(*indexed).arg(total));
+                    return;
+                }
+                m_searchPanel->setStatus(QString());
+                m_textIndexCancel.reset();
+                // Refresh results that were computed against a partial index
+                if (!m_searchPanel->searchText().isEmpty()) {
+                    onSearchRequested(m_searchPanel->searchText());
+                }
+            }, Qt::QueuedConnection);
+        });
+    });
+}
+
+void MainWindow::cancelTextIndexing()
+{
+    if (m_textIndexCancel) {
+        m_textIndexCancel->store(true);
+        m_textIndexCancel.reset();
     }
 }
 
@@ -1194,13 +2244,7 @@ void MainWindow::updateItemsPanelForPage()
     QVector<TakeoffItem> pageItems = m_project.takeoffItemsForPage(m_currentPageId);
     for (const TakeoffItem& item : pageItems) {
         // Convert to Measurement for display
-        Measurement m;
-        m.setId(item.id());
-        m.setPageId(item.pageId());
-        m.setType(item.kind() == TakeoffItem::Line ? MeasurementType::Line : MeasurementType::Polyline);
-        m.setPoints(item.points());
-        m.setLengthInches(item.lengthInches());
-        m.setSize(item.designation());
+        Measurement m = displayMeasurement(item);
         
         m_itemsPanel->addMeasurement(m);
     }
@@ -1216,19 +2260,13 @@ void MainWindow::refreshDesignationAutocomplete()
 // Helper function for updating item display
 void MainWindow::updateItemDisplay(int itemId)
 {
-    const TakeoffItem* item = m_project.findTakeoffItem(itemId);
-    if (!item || item->pageId() != m_currentPageId) {
+    const TakeoffItem item = m_project.takeoffItem(itemId);
+    if (item.id() < 0 || item.pageId() != m_currentPageId) {
         return;
     }
     
     // Convert to Measurement for display
-    Measurement m;
-    m.setId(item->id());
-    m.setPageId(item->pageId());
-    m.setType(item->kind() == TakeoffItem::Line ? MeasurementType::Line : MeasurementType::Polyline);
-    m.setPoints(item->points());
-    m.setLengthInches(item->lengthInches());
-    m.setSize(item->designation());
+    Measurement m = displayMeasurement(item);
     
     m_itemsPanel->updateMeasurement(m);
 }
@@ -10,12 +10,19 @@
 #include <QUndoStack>
 #include <QCloseEvent>
 #include <QVariant>
+#include <QTimer>
+#include <QHash>
+#include <QLineF>
+#include <QPair>
+#include <atomic>
+#include <memory>
 
 #include "BlueprintView.h"
 #include "MeasurementPanel.h"
 #include "PagesPanel.h"
 #include "PropertiesDock.h"
 #include "QuoteDock.h"
+#include "SearchPanel.h"
 #include "../models/Project.h"
 #include "../models/TakeoffItem.h"
 #include "UndoCommands.h"
@@ -40,6 +47,15 @@ public:
     void removeTakeoffItemInternal(int itemId);
     void setTakeoffItemFieldInternal(int itemId, TakeoffItemField field, const QVariant& value);
 
+    /**
+     * @brief Set a page's calibration and item lengths, and refresh what shows them.
+     * @param previous If given, receives the lengths the items had before
+     * @return false if the project could not store the change
+     */
+    bool applyCalibrationInternal(const QString& pageId, const Calibration& calibration,
+                                  const Project::ItemLengths& lengths,
+                                  Project::ItemLengths* previous = nullptr);
+
 protected:
     void closeEvent(QCloseEvent* event) override;
 
@@ -56,19 +72,29 @@ private slots:
     void onUndo();
     void onRedo();
     void onDeleteItem();
+    void onFindText();
+
+    // View menu
+    void onCompareToggled(bool checked);
+    void onRecordTraceToggled(bool checked);
+    void onSaveTrace();
+    void onHudRefreshRequested();
 
     // Tool actions
     void onToolNone();
     void onToolCalibrate();
     void onToolLine();
     void onToolPolyline();
+    void onToolCount();
 
     // View signals
     void onCalibrationCompleted(double pixelsPerInch);
     void onMeasurementCompleted(const Measurement& measurement);
+    void onCountTemplateSelected(const QRectF& sceneRect);
     void onLiveMeasurementChanged(double inches);
     void onItemSelected(int itemId);
     void onToolCancelled();
+    void onDetailRequested();
 
     // Pages panel signals
     void onPageSelected(const QString& pageId);
@@ -89,6 +115,13 @@ private slots:
     void onMaterialPriceChanged(double pricePerLb);
     void onCurrentPageOnlyChanged(bool currentPageOnly);
 
+    // Search panel signals
+    void onSearchRequested(const QString& text);
+    void onSearchHitActivated(const QString& pageId, const QRectF& rect);
+
+    // Deferred schema migration work
+    void onMigrationTimer();
+
 private:
     void setupUi();
     void createMenuBar();
@@ -107,6 +140,22 @@ private:
     void updateItemsPanelForPage();
     void refreshDesignationAutocomplete();
     void updateItemDisplay(int itemId);
+    void startLineDetection(const Page& page);
+    void cancelLineDetection();
+    void startDetailRendering(const Page& page, int level, const QVector<QPoint>& cells);
+    void cancelDetailRendering();
+    void startSymbolCount(const QRectF& templateRect, const QVector<Page>& pages);
+    void cancelSymbolCount();
+    void addCountItems(const QVector<QPair<QString, QVector<QPointF>>>& results);
+    void startTextIndexing();
+    void cancelTextIndexing();
+    void startPdfImport(const QString& filePath, int firstIndex, int lastIndex);
+    void cancelPdfImport();
+    void addImportedPages(const QVector<ImportedPage>& pages);
+    void startComparison(const Page& other, CompareMode mode);
+    void cancelComparison();
+    void endComparison();
+    void applyComparison(const QImage& other, const QVector<ImageDiff::Tile>& tiles, CompareMode mode);
 
     // UI Components
     BlueprintView* m_blueprintView;
@@ -114,13 +163,11 @@ private:
     MeasurementPanel* m_itemsPanel;  // Renamed from measurementPanel
     PropertiesDock* m_propertiesDock;
     QuoteDock* m_quoteDock;
+    SearchPanel* m_searchPanel;
     QSplitter* m_mainSplitter;
     QSplitter* m_leftSplitter;
     QToolBar* m_toolBar;
 
-    // PDF Renderer
-    PdfRenderer m_pdfRenderer;
-
     // File menu actions
     QAction* m_newProjectAction;
     QAction* m_openProjectAction;
@@ -134,17 +181,61 @@ private:
     QAction* m_redoAction;
     QAction* m_deleteAction;
     QAction* m_deletePageAction;
+    QAction* m_findTextAction;
+
+    // View menu actions
+    QAction* m_compareAction;
+    QAction* m_hudAction;
+    QAction* m_recordTraceAction;   // Only with TAKEOFF_ENABLE_TRACING
+    QAction* m_saveTraceAction;
 
     // Tool actions
     QAction* m_noneToolAction;
     QAction* m_calibrateAction;
     QAction* m_lineAction;
     QAction* m_polylineAction;
+    QAction* m_countAction;
     QActionGroup* m_toolGroup;
+    QAction* m_snapAction;
 
     // Undo/Redo
     QUndoStack* m_undoStack;
 
+    // Runs large data migrations in small batches while the UI is idle
+    QTimer* m_migrationTimer;
+
+    // Lines detected on each page's raster for snapping, computed once per
+    // page in the background. Only one detection runs at a time.
+    QHash<QString, QVector<QLineF>> m_sheetSegments;
+    std::shared_ptr<std::atomic<bool>> m_lineDetectionCancel;
+
+    // Sharper tiles for the visible area of the current PDF page, with
+    // the tiles left in the running job and lookup counts for the HUD
+    std::shared_ptr<std::atomic<bool>> m_detailRenderCancel;
+    std::shared_ptr<std::atomic<int>> m_detailTilesPending;
+    qint64 m_detailTileLookups;
+    qint64 m_detailTileHits;
+
+    // Symbol count running in the background, if any
+    std::shared_ptr<std::atomic<bool>> m_symbolCountCancel;
+
+    // Text layer extraction for PDF pages not yet in the search index
+    std::shared_ptr<std::atomic<bool>> m_textIndexCancel;
+
+    // PDF import reading pages in the background, if any
+    std::shared_ptr<std::atomic<bool>> m_pdfImportCancel;
+
+    // Diffs of the current page against another revision. Results are
+    // kept per page pair, most recent last, so flipping back and forth
+    // between revisions does not recompute them.
+    struct Comparison {
+        QImage other;
+        QVector<ImageDiff::Tile> tiles;
+    };
+    QHash<QString, Comparison> m_comparisons;
+    QStringList m_comparisonOrder;
+    std::shared_ptr<std::atomic<bool>> m_compareCancel;
+
     // Project data
     Project m_project;
 
@@ -5,6 +5,8 @@
 #include <QLabel>
 #include <QMenu>
 #include <QAction>
+#include <QIcon>
+#include <QPixmap>
 
 PagesPanel::PagesPanel(QWidget* parent)
     : QWidget(parent)
@@ -28,6 +30,7 @@ PagesPanel::PagesPanel(QWidget* parent)
     // List widget
     m_listWidget->setSelectionMode(QAbstractItemView::SingleSelection);
     m_listWidget->setContextMenuPolicy(Qt::CustomContextMenu);
+    m_listWidget->setIconSize(QSize(THUMBNAIL_ICON_SIZE, THUMBNAIL_ICON_SIZE));
     layout->addWidget(m_listWidget);
 
     // Connections
@@ -90,6 +93,18 @@ void PagesPanel::updatePage(const Page& page)
     item->setToolTip(page.sourcePath());
 }
 
+void PagesPanel::setPageThumbnail(const QString& pageId, const QByteArray& png)
+{
+    if (!m_idToItem.contains(pageId)) {
+        return;
+    }
+
+    QPixmap pixmap;
+    if (pixmap.loadFromData(png, "PNG")) {
+        m_idToItem[pageId]->setIcon(QIcon(pixmap));
+    }
+}
+
 void PagesPanel::selectPage(const QString& pageId)
 {
     if (!m_idToItem.contains(pageId)) {
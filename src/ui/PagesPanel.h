@@ -45,6 +45,13 @@ public:
      */
     void updatePage(const Page& page);
 
+    /**
+     * @brief Show a thumbnail next to a page.
+     * @param pageId Page ID
+     * @param png PNG-encoded thumbnail
+     */
+    void setPageThumbnail(const QString& pageId, const QByteArray& png);
+
     /**
      * @brief Select a page by ID.
      * @param pageId Page ID to select
@@ -88,6 +95,8 @@ private slots:
     void onDeleteButtonClicked();
 
 private:
+    static const int THUMBNAIL_ICON_SIZE = 64;
+
     QListWidget* m_listWidget;
     QPushButton* m_deleteButton;
     QMap<QString, QListWidgetItem*> m_idToItem;
@@ -193,10 +193,16 @@ void PropertiesDock::updateFromItem(const TakeoffItem* item)
     m_notesEdit->setPlainText(item->notes());
 
     // Info label
-    m_infoLabel->setText(QString("%1: %2 in (%3 ft)")
-        .arg(item->kindString())
-        .arg(item->lengthInches(), 0, 'f', 2)
-        .arg(item->lengthFeet(), 0, 'f', 2));
+    if (item->kind() == TakeoffItem::Count) {
+        m_infoLabel->setText(QString("%1: %2 ea")
+            .arg(item->kindString())
+            .arg(item->qty()));
+    } else {
+        m_infoLabel->setText(QString("%1: %2 in (%3 ft)")
+            .arg(item->kindString())
+            .arg(item->lengthInches(), 0, 'f', 2)
+            .arg(item->lengthFeet(), 0, 'f', 2));
+    }
 
     // Cache values for change detection
     m_cachedDesignation = item->designation();
@@ -1,4 +1,5 @@
 #include "QuoteDock.h"
+#include "Trace.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -7,9 +8,6 @@
 #include <QHeaderView>
 #include <QFileDialog>
 #include <QMessageBox>
-#include <QFile>
-#include <QTextStream>
-#include <QMap>
 
 QuoteDock::QuoteDock(QWidget* parent)
     : QDockWidget("Quote Summary", parent)
@@ -110,17 +108,42 @@ void QuoteDock::updateFromProject(Project* project)
     m_cachedProject = project;
 
     if (!project || !project->isOpen()) {
+        m_quote = QuoteCalculator::Quote();
         m_table->setRowCount(0);
         updateTotals(0, 0, 0);
         return;
     }
 
-    QString pageFilter;
-    if (m_currentPageOnlyCheck->isChecked() && !m_currentPageId.isEmpty()) {
-        pageFilter = m_currentPageId;
+    populateTable(project, pageFilter());
+}
+
+void QuoteDock::applyLengthChanges(Project* project, const QVector<int>& itemIds,
+                                   const QVector<double>& oldLengthsInches,
+                                   const QVector<double>& newLengthsInches)
+{
+    if (!project || project != m_cachedProject || !project->isOpen()) {
+        updateFromProject(project);
+        return;
     }
 
-    populateTable(project, pageFilter);
+    QVector<int> changedLines;
+    if (!QuoteCalculator::applyLengthChanges(m_quote, *project, pageFilter(), itemIds,
+                                             oldLengthsInches, newLengthsInches, &changedLines)) {
+        updateFromProject(project);
+        return;
+    }
+    for (int row : changedLines) {
+        setTableRow(row, m_quote.lines[row]);
+    }
+    updateTotals(m_quote.totalWeightLb, m_quote.totalCost, m_quote.totalQty);
+}
+
+QString QuoteDock::pageFilter() const
+{
+    if (m_currentPageOnlyCheck->isChecked() && !m_currentPageId.isEmpty()) {
+        return m_currentPageId;
+    }
+    return QString();
 }
 
 double QuoteDock::materialPricePerLb() const
@@ -142,77 +165,29 @@ bool QuoteDock::isCurrentPageOnly() const
 
 void QuoteDock::populateTable(Project* project, const QString& pageFilter)
 {
-    // Group items by designation
-    struct DesignationGroup {
-        QString designation;
-        int qty = 0;
-        double totalLengthFt = 0.0;
-        double wLbPerFt = 0.0;
-        double totalWeightLb = 0.0;
-        double totalCost = 0.0;
-    };
-
-    QMap<QString, DesignationGroup> groups;
-    double pricePerLb = m_pricePerLbSpin->value();
-
-    const QVector<TakeoffItem>& items = project->takeoffItems();
-    for (const TakeoffItem& item : items) {
-        // Filter by page if specified
-        if (!pageFilter.isEmpty() && item.pageId() != pageFilter) {
-            continue;
-        }
-
-        QString key = item.designation().isEmpty() ? "(Unassigned)" : item.designation();
-        
-        if (!groups.contains(key)) {
-            groups[key].designation = key;
-            // Get weight per foot from shape
-            if (item.shapeId() > 0) {
-                auto shape = project->getShape(item.shapeId());
-                groups[key].wLbPerFt = shape.wLbPerFt;
-            }
-        }
-
-        DesignationGroup& group = groups[key];
-        group.qty += item.qty();
-        double lengthFt = item.totalLengthFeet();
-        group.totalLengthFt += lengthFt;
-        
-        if (group.wLbPerFt > 0) {
-            double weight = lengthFt * group.wLbPerFt;
-            group.totalWeightLb += weight;
-            group.totalCost += weight * pricePerLb;
-        }
-    }
+    TAKEOFF_TRACE_SCOPE("QuoteDock::populateTable");
+    m_quote = QuoteCalculator::calculate(*project, m_pricePerLbSpin->value(), pageFilter);
 
-    // Populate table
-    m_table->setRowCount(groups.size());
-    
-    double grandTotalWeight = 0.0;
-    double grandTotalCost = 0.0;
-    int grandTotalQty = 0;
-    
-    int row = 0;
-    for (auto it = groups.begin(); it != groups.end(); ++it, ++row) {
-        const DesignationGroup& group = it.value();
-        
-        m_table->setItem(row, 0, new QTableWidgetItem(group.designation));
-        m_table->setItem(row, 1, new QTableWidgetItem(QString::number(group.qty)));
-        m_table->setItem(row, 2, new QTableWidgetItem(QString::number(group.totalLengthFt, 'f', 2)));
-        m_table->setItem(row, 3, new QTableWidgetItem(
-            group.wLbPerFt > 0 ? QString::number(group.wLbPerFt, 'f', 2) : "-"));
-        m_table->setItem(row, 4, new QTableWidgetItem(
-            group.totalWeightLb > 0 ? QString::number(group.totalWeightLb, 'f', 1) : "-"));
-        m_table->setItem(row, 5, new QTableWidgetItem(QString::number(pricePerLb, 'f', 2)));
-        m_table->setItem(row, 6, new QTableWidgetItem(
-            group.totalCost > 0 ? QString::number(group.totalCost, 'f', 2) : "-"));
-        
-        grandTotalWeight += group.totalWeightLb;
-        grandTotalCost += group.totalCost;
-        grandTotalQty += group.qty;
+    m_table->setRowCount(m_quote.lines.size());
+    for (int row = 0; row < m_quote.lines.size(); ++row) {
+        setTableRow(row, m_quote.lines[row]);
     }
 
-    updateTotals(grandTotalWeight, grandTotalCost, grandTotalQty);
+    updateTotals(m_quote.totalWeightLb, m_quote.totalCost, m_quote.totalQty);
+}
+
+void QuoteDock::setTableRow(int row, const QuoteCalculator::Line& line)
+{
+    m_table->setItem(row, 0, new QTableWidgetItem(line.designation));
+    m_table->setItem(row, 1, new QTableWidgetItem(QString::number(line.qty)));
+    m_table->setItem(row, 2, new QTableWidgetItem(QString::number(line.totalLengthFt, 'f', 2)));
+    m_table->setItem(row, 3, new QTableWidgetItem(
+        line.wLbPerFt > 0 ? QString::number(line.wLbPerFt, 'f', 2) : "-"));
+    m_table->setItem(row, 4, new QTableWidgetItem(
+        line.totalWeightLb > 0 ? QString::number(line.totalWeightLb, 'f', 1) : "-"));
+    m_table->setItem(row, 5, new QTableWidgetItem(QString::number(m_quote.pricePerLb, 'f', 2)));
+    m_table->setItem(row, 6, new QTableWidgetItem(
+        line.totalCost > 0 ? QString::number(line.totalCost, 'f', 2) : "-"));
 }
 
 void QuoteDock::updateTotals(double totalWeight, double totalCost, int totalQty)
@@ -240,42 +215,12 @@ void QuoteDock::onExportCsv()
         filePath += ".csv";
     }
 
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "Export Error",
-            QString("Cannot open file for writing: %1").arg(file.errorString()));
+    QString error;
+    if (!QuoteCalculator::writeCsv(m_quote, filePath, &error)) {
+        QMessageBox::critical(this, "Export Error", error);
         return;
     }
 
-    QTextStream out(&file);
-
-    // Header
-    out << "Designation,Qty,Total (ft),lb/ft,Weight (lb),$/lb,Cost ($)\n";
-
-    // Data rows from table
-    for (int row = 0; row < m_table->rowCount(); ++row) {
-        QStringList rowData;
-        for (int col = 0; col < m_table->columnCount(); ++col) {
-            QTableWidgetItem* item = m_table->item(row, col);
-            QString text = item ? item->text() : "";
-            // Escape fields that might contain commas
-            if (text.contains(',') || text.contains('"')) {
-                text = "\"" + text.replace("\"", "\"\"") + "\"";
-            }
-            rowData << text;
-        }
-        out << rowData.join(",") << "\n";
-    }
-
-    // Summary
-    out << "\n";
-    out << "Material Rate:,$" << QString::number(m_pricePerLbSpin->value(), 'f', 2) << "/lb\n";
-    out << m_totalQtyLabel->text() << "\n";
-    out << m_totalWeightLabel->text() << "\n";
-    out << m_totalCostLabel->text() << "\n";
-
-    file.close();
-
     QMessageBox::information(this, "Export Complete",
         QString("Quote summary exported to:\n%1").arg(filePath));
 }
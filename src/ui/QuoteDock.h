@@ -10,6 +10,7 @@
 
 #include "../models/Project.h"
 #include "../models/TakeoffItem.h"
+#include "../models/QuoteCalculator.h"
 
 /**
  * @brief Dock widget for quote summary display with weight/cost calculations.
@@ -39,6 +40,16 @@ public:
      */
     void updateFromProject(Project* project);
 
+    /**
+     * @brief Update only the lines of items whose length changed.
+     *
+     * Falls back to a full update if the shown quote does not cover them.
+     * @param project The project, already holding the new lengths
+     */
+    void applyLengthChanges(Project* project, const QVector<int>& itemIds,
+                            const QVector<double>& oldLengthsInches,
+                            const QVector<double>& newLengthsInches);
+
     /**
      * @brief Get the current material price per lb.
      */
@@ -72,7 +83,9 @@ private slots:
 
 private:
     void setupUi();
+    QString pageFilter() const;
     void populateTable(Project* project, const QString& pageFilter = QString());
+    void setTableRow(int row, const QuoteCalculator::Line& line);
     void updateTotals(double totalWeight, double totalCost, int totalQty);
 
     // Container
@@ -95,6 +108,9 @@ private:
     // Export button
     QPushButton* m_exportButton;
 
+    // Last computed quote, as shown and exported
+    QuoteCalculator::Quote m_quote;
+
     // Cached project pointer for recalculation
     Project* m_cachedProject;
     QString m_currentPageId;
@@ -0,0 +1,92 @@
+#include "SearchPanel.h"
+
+#include <QVBoxLayout>
+
+namespace {
+
+const int PageIdRole = Qt::UserRole;
+const int RectRole = Qt::UserRole + 1;
+
+} // namespace
+
+SearchPanel::SearchPanel(QWidget* parent)
+    : QDockWidget("Search Sheets", parent)
+    , m_container(nullptr)
+    , m_searchEdit(nullptr)
+    , m_statusLabel(nullptr)
+    , m_resultsList(nullptr)
+{
+    setupUi();
+}
+
+SearchPanel::~SearchPanel()
+{
+}
+
+void SearchPanel::setupUi()
+{
+    m_container = new QWidget(this);
+    QVBoxLayout* layout = new QVBoxLayout(m_container);
+    layout->setContentsMargins(10, 10, 10, 10);
+
+    m_searchEdit = new QLineEdit(m_container);
+    m_searchEdit->setPlaceholderText("Find text on sheets, e.g. W12X26");
+    m_searchEdit->setClearButtonEnabled(true);
+    connect(m_searchEdit, &QLineEdit::textChanged, this, &SearchPanel::searchRequested);
+    layout->addWidget(m_searchEdit);
+
+    m_statusLabel = new QLabel(m_container);
+    m_statusLabel->setStyleSheet("color: gray;");
+    layout->addWidget(m_statusLabel);
+
+    m_resultsList = new QListWidget(m_container);
+    m_resultsList->setAlternatingRowColors(true);
+    connect(m_resultsList, &QListWidget::itemActivated, this, &SearchPanel::onItemActivated);
+    connect(m_resultsList, &QListWidget::itemClicked, this, &SearchPanel::onItemActivated);
+    layout->addWidget(m_resultsList, 1);
+
+    setWidget(m_container);
+}
+
+void SearchPanel::setResults(const QVector<ProjectDatabase::TextHit>& hits,
+                             const QHash<QString, QString>& pageNames)
+{
+    m_resultsList->clear();
+    for (const ProjectDatabase::TextHit& hit : hits) {
+        QListWidgetItem* item = new QListWidgetItem(
+            QString("%1 - %2").arg(hit.text, pageNames.value(hit.pageId, hit.pageId)), m_resultsList);
+        item->setData(PageIdRole, hit.pageId);
+        item->setData(RectRole, hit.rect);
+    }
+}
+
+void SearchPanel::setStatus(const QString& status)
+{
+    m_statusLabel->setText(status);
+}
+
+QString SearchPanel::searchText() const
+{
+    return m_searchEdit->text();
+}
+
+void SearchPanel::clear()
+{
+    m_searchEdit->clear();
+    m_resultsList->clear();
+    m_statusLabel->clear();
+}
+
+void SearchPanel::focusSearchField()
+{
+    m_searchEdit->setFocus();
+    m_searchEdit->selectAll();
+}
+
+void SearchPanel::onItemActivated(QListWidgetItem* item)
+{
+    if (!item) {
+        return;
+    }
+    emit hitActivated(item->data(PageIdRole).toString(), item->data(RectRole).toRectF());
+}
@@ -0,0 +1,80 @@
+#ifndef SEARCHPANEL_H
+#define SEARCHPANEL_H
+
+#include <QDockWidget>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QLabel>
+#include <QHash>
+
+#include "../core/ProjectDatabase.h"
+
+/**
+ * @brief Dock widget for searching the text of all PDF sheets.
+ *
+ * Queries are sent as they are typed; MainWindow answers them from the
+ * project's text index and feeds the hits back. Activating a hit asks
+ * MainWindow to open its page and zoom to it.
+ */
+class SearchPanel : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SearchPanel(QWidget* parent = nullptr);
+    ~SearchPanel();
+
+    /**
+     * @brief Show search results.
+     * @param hits Matching words
+     * @param pageNames Display name per page ID
+     */
+    void setResults(const QVector<ProjectDatabase::TextHit>& hits,
+                    const QHash<QString, QString>& pageNames);
+
+    /**
+     * @brief Show the text indexing state below the search field.
+     */
+    void setStatus(const QString& status);
+
+    /**
+     * @brief Get the current query.
+     */
+    QString searchText() const;
+
+    /**
+     * @brief Clear the query and results.
+     */
+    void clear();
+
+    /**
+     * @brief Focus the search field and select its text.
+     */
+    void focusSearchField();
+
+signals:
+    /**
+     * @brief Emitted when the query text changes.
+     */
+    void searchRequested(const QString& text);
+
+    /**
+     * @brief Emitted when the user activates a hit.
+     * @param pageId Page containing the hit
+     * @param rect Word bounds in scene coordinates
+     */
+    void hitActivated(const QString& pageId, const QRectF& rect);
+
+private slots:
+    void onItemActivated(QListWidgetItem* item);
+
+private:
+    void setupUi();
+
+    QWidget* m_container;
+    QLineEdit* m_searchEdit;
+    QLabel* m_statusLabel;
+    QListWidget* m_resultsList;
+};
+
+#endif // SEARCHPANEL_H
@@ -131,3 +131,40 @@ QString SetTakeoffItemFieldCommand::fieldName() const
         default:                            return "Field";
     }
 }
+
+// ============================================================================
+// RecalibratePageCommand
+// ============================================================================
+
+RecalibratePageCommand::RecalibratePageCommand(MainWindow* mainWindow,
+                                               const QString& pageId,
+                                               const Calibration& oldCalibration,
+                                               const Project::ItemLengths& oldLengths,
+                                               const Calibration& newCalibration,
+                                               const Project::ItemLengths& newLengths,
+                                               QUndoCommand* parent)
+    : QUndoCommand(parent)
+    , m_mainWindow(mainWindow)
+    , m_pageId(pageId)
+    , m_oldCalibration(oldCalibration)
+    , m_oldLengths(oldLengths)
+    , m_newCalibration(newCalibration)
+    , m_newLengths(newLengths)
+    , m_firstRedo(true)
+{
+    setText("Calibrate Page");
+}
+
+void RecalibratePageCommand::undo()
+{
+    m_mainWindow->applyCalibrationInternal(m_pageId, m_oldCalibration, m_oldLengths);
+}
+
+void RecalibratePageCommand::redo()
+{
+    if (m_firstRedo) {
+        m_firstRedo = false;
+        return;
+    }
+    m_mainWindow->applyCalibrationInternal(m_pageId, m_newCalibration, m_newLengths);
+}
@@ -4,6 +4,8 @@
 #include <QUndoCommand>
 #include <QVariant>
 #include "../models/TakeoffItem.h"
+#include "../models/Calibration.h"
+#include "../models/Project.h"
 
 // Forward declarations
 class MainWindow;
@@ -86,4 +88,34 @@ private:
     bool m_firstRedo;
 };
 
+/**
+ * @brief Undo command for recalibrating a page.
+ *
+ * Restores the page's calibration together with the lengths its items
+ * had, so a recalibration and the re-measuring it caused undo as one step.
+ */
+class RecalibratePageCommand : public QUndoCommand
+{
+public:
+    RecalibratePageCommand(MainWindow* mainWindow,
+                           const QString& pageId,
+                           const Calibration& oldCalibration,
+                           const Project::ItemLengths& oldLengths,
+                           const Calibration& newCalibration,
+                           const Project::ItemLengths& newLengths,
+                           QUndoCommand* parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+
+private:
+    MainWindow* m_mainWindow;
+    QString m_pageId;
+    Calibration m_oldCalibration;
+    Project::ItemLengths m_oldLengths;
+    Calibration m_newCalibration;
+    Project::ItemLengths m_newLengths;
+    bool m_firstRedo;
+};
+
 #endif // UNDOCOMMANDS_H